@@ -0,0 +1,129 @@
+#include "fps_ipc/queue_telemetry_probe.h"
+#include "fps_fs/glob.h"
+#include "fps_fs/path.h"
+#include "fps_string/format.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Print the telemetry recorded by queues built w/ ipc::telemetry::Shm ( see
+// fps_ipc/queue_telemetry.h ) : writer counters, and for each attached reader
+// its lag, losses and enqueue-to-dequeue latency percentiles.  Stats blocks
+// are mapped read only, so running this never disturbs the queues.
+//
+// Usage: queue_stats [ interval_millis ] [ queue_name ... ]
+//
+// W/o queue names, every stats block under /dev/shm is shown.  A non-zero
+// interval ( default 1000 ) samples the counters twice to report rates.
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Default_Interval_Millis = 1000 ;
+
+  //-------------------------------------------------------------------------------------
+  struct Entry
+  {
+    std::string                name_ ;
+    ipc::telemetry::StatsProbe probe_ ;
+    uint64_t                   writes_ ;                                // At discovery.
+    uint64_t                   reads_[ ipc::telemetry::Max_Readers ] ;  // At discovery.
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  void
+  add_entry( const std::string & name, std::vector< std::unique_ptr<Entry> > & entries )
+  {
+    std::unique_ptr<Entry> entry( new Entry ) ;
+    entry->name_ = name ;
+    if( !entry->probe_.open( name ) )
+    { std::cerr << "queue_stats :: Unable to open stats for '" << name << "' ( errno " << entry->probe_.last_error() << " )" << std::endl ;
+      return ;
+    }
+
+    entry->writes_ = entry->probe_.writes() ;
+    for( uint32_t idx = 0 ; idx < ipc::telemetry::Max_Readers ; ++idx )
+    { ipc::telemetry::StatsProbe::Reader reader ;
+      entry->reads_[ idx ] = entry->probe_.reader( idx, reader ) ? reader.reads_ : 0 ;
+    }
+    entries.push_back( std::move( entry ) ) ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  uint64_t interval_millis = ( argc > 1 ) ? std::strtoull( argv[ 1 ], NULL, 10 ) : Default_Interval_Millis ;
+
+  std::vector< std::unique_ptr<Entry> > entries ;
+  if( argc > 2 )
+  { for( int32_t idx = 2 ; idx < argc ; ++idx )
+      add_entry( argv[ idx ], entries ) ;
+  }
+  else
+  { fs::Glob shm_files( string::sprintf( "%s/*%s", ipc::constants::Shm_Dir, ipc::telemetry::Segment_Suffix ) ) ;
+    std::size_t suffix_length = std::strlen( ipc::telemetry::Segment_Suffix ) ;
+    for( auto itr = shm_files.begin() ; itr != shm_files.end() ; ++itr )
+    { std::string leaf = fs::Path( *itr ).leaf() ;
+      add_entry( leaf.substr( 0, leaf.size() - suffix_length ), entries ) ;
+    }
+  }
+
+  if( interval_millis > 0 && !entries.empty() )
+    ::usleep( interval_millis * 1000 ) ;
+
+  std::cout << "[ queue stats ]" << std::endl
+            << "|--[ count    => " << entries.size()  << " ]" << std::endl
+            << "|--[ interval => " << interval_millis << "ms ]" << std::endl
+            << "|" << std::endl ;
+
+  for( std::size_t e_idx = 0 ; e_idx < entries.size() ; ++e_idx )
+  {
+    const Entry                      & entry = *entries[ e_idx ] ;
+    const ipc::telemetry::StatsProbe & probe = entry.probe_ ;
+
+    uint64_t writes = probe.writes() ;
+    std::cout << "|--[ " << entry.name_ << " ]" << std::endl
+              << "|  |--[ capacity     => " << probe.capacity() << " ]" << std::endl
+              << "|  |--[ writer_pid   => " << probe.writer_pid()
+                                            << ( probe.writer_alive() ? " ( alive )" : " ( gone )" ) << " ]" << std::endl
+              << "|  |--[ writes       => " << writes             << " ]" << std::endl
+              << "|  |--[ full         => " << probe.full()       << " ]" << std::endl
+              << "|  |--[ high_water   => " << probe.high_water() << " ]" << std::endl ;
+    if( interval_millis > 0 )
+      std::cout << "|  |--[ writes/sec   => " << ( ( writes - entry.writes_ ) * 1000 ) / interval_millis << " ]" << std::endl ;
+
+    for( uint32_t idx = 0 ; idx < ipc::telemetry::Max_Readers ; ++idx )
+    {
+      ipc::telemetry::StatsProbe::Reader reader ;
+      if( !probe.reader( idx, reader ) )
+        continue ;
+
+      const ipc::telemetry::Histogram & latency = *reader.latency_ ;
+      std::cout << "|  |--[ reader " << idx << " ]" << std::endl
+                << "|  |  |--[ pid          => " << reader.pid_ << ( reader.alive_ ? " ( alive )" : " ( gone )" ) << " ]" << std::endl
+                << "|  |  |--[ reads        => " << reader.reads_    << " ]" << std::endl
+                << "|  |  |--[ lag          => " << reader.lag_      << " ]" << std::endl
+                << "|  |  |--[ max_lag      => " << reader.max_lag_  << " ]" << std::endl
+                << "|  |  |--[ lost         => " << reader.lost_     << " ]" << std::endl
+                << "|  |  |--[ overruns     => " << reader.overruns_ << " ]" << std::endl ;
+      if( interval_millis > 0 && reader.reads_ >= entry.reads_[ idx ] )
+        std::cout << "|  |  |--[ reads/sec    => " << ( ( reader.reads_ - entry.reads_[ idx ] ) * 1000 ) / interval_millis << " ]" << std::endl ;
+
+      // Percentiles are bucket upper bounds, so read them as "under".
+      std::cout << "|  |  |--[ latency      => samples " << latency.total()
+                                                   << ", p50 < " << latency.percentile( 0.50 ) << "ns"
+                                                   << ", p99 < " << latency.percentile( 0.99 ) << "ns"
+                                                   << ", max < " << latency.percentile( 1.00 ) << "ns ]" << std::endl ;
+    }
+    std::cout << "|" << std::endl ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,92 @@
+#include "fps_ipc/swmr_shm_queue_probe.h"
+#include "fps_fs/glob.h"
+#include "fps_fs/path.h"
+#include "fps_string/format.h"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// List the swmr shm queues under /dev/shm ( and on hugetlbfs, see 
+// ipc::constants::Huge_Page_Dir ) along w/ their header contents and
+// each queue's publish rate, measured by sampling its write sequence twice.
+//
+// Usage: shm_queue_list [ interval_millis ]   ( default 1000, zero skips the rate )
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Default_Interval_Millis = 1000 ;
+
+  //-------------------------------------------------------------------------------------
+  struct Entry
+  {
+    std::string              name_ ;
+    ipc::swmr::ShmQueueProbe probe_ ;
+    uint64_t                 seq_ ;   // Write sequence at discovery.
+  } ;
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  uint64_t interval_millis = ( argc > 1 ) ? std::strtoull( argv[ 1 ], NULL, 10 ) : Default_Interval_Millis ;
+
+  std::vector< std::unique_ptr<Entry> > queues ;
+  fs::Glob shm_files( string::sprintf( "{%s,%s}/*", ipc::constants::Shm_Dir, ipc::constants::Huge_Page_Dir ) ) ;
+  for( auto itr = shm_files.begin() ; itr != shm_files.end() ; ++itr )
+  {
+    // GLOB_MARK tags directories w/ a trailing '/'.
+    std::size_t length = std::strlen( *itr ) ;
+    if( length == 0 || ( *itr )[ length - 1 ] == '/' )
+      continue ;
+
+    std::unique_ptr<Entry> entry( new Entry ) ;
+    entry->name_ = fs::Path( *itr ).leaf() ;
+    if( !entry->probe_.open( entry->name_ ) )
+      continue ;
+
+    entry->seq_ = entry->probe_.write_sequence() ;
+    queues.push_back( std::move( entry ) ) ;
+  }
+
+  if( interval_millis > 0 && !queues.empty() )
+    ::usleep( interval_millis * 1000 ) ;
+
+  std::cout << "[ swmr shm queues ]" << std::endl
+            << "|--[ count    => " << queues.size()   << " ]" << std::endl
+            << "|--[ interval => " << interval_millis << "ms ]" << std::endl
+            << "|" << std::endl ;
+
+  for( std::size_t idx = 0 ; idx < queues.size() ; ++idx )
+  {
+    const Entry                    & entry = *queues[ idx ] ;
+    const ipc::swmr::ShmQueueProbe & probe = entry.probe_ ;
+
+    uint64_t seq = probe.write_sequence() ;
+    std::cout << "|--[ " << entry.name_ << " ]" << std::endl
+              << "|  |--[ kind         => " << ipc::swmr::queue_kind::to_string( probe.kind() ) << " ]" << std::endl
+              << "|  |--[ element_size => " << probe.element_size() << " ]" << std::endl
+              << "|  |--[ capacity     => " << probe.capacity()     << " ]" << std::endl
+              << "|  |--[ type_hash    => 0x" << std::hex << std::setw( 16 ) << std::setfill( '0' )
+                                              << probe.type_hash() << std::dec << std::setfill( ' ' ) << " ]" << std::endl
+              << "|  |--[ segment_size => " << probe.segment_size() << " ]" << std::endl
+              << "|  |--[ writer_pid   => " << probe.writer_pid()
+                                            << ( probe.writer_alive() ? " ( alive )" : " ( gone )" ) << " ]" << std::endl
+              << "|  |--[ sequence     => " << seq << " ]" << std::endl ;
+
+    if( interval_millis > 0 )
+    { uint64_t per_sec = ( ( seq - entry.seq_ ) * 1000 ) / interval_millis ;
+      std::cout << "|  |--[ msgs/sec     => " << per_sec << " ]" << std::endl ;
+    }
+    std::cout << "|" << std::endl ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,188 @@
+#include "fps_container/byte_queue.h"
+#include "fps_container/byte_scan.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// How much do the vectorized extractors buy over a byte at a time loop?  We split
+// buffers of newline delimited records ( 1KB to 1MB, records of 16 to 240 bytes ) and
+// of FIX messages, first w/ the byte loop ByNewline used to be, then at each scan
+// level w/ get() called once per record and w/ one get_all() per 64 records.
+//
+// Usage: example.byte_scan.benchmark
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Bytes_Per_Run = 256 * 1024 * 1024 ;
+  static const uint32_t Batch_Size    = 64 ;
+  static const uint32_t Buffer_Sizes[] = { 1024, 16 * 1024, 256 * 1024, 1024 * 1024 } ;
+
+  namespace extract = container::extract ;
+
+  //-------------------------------------------------------------------------------------
+  // ByNewline, as it was.
+  //-------------------------------------------------------------------------------------
+  struct ByteLoop
+  {
+    static
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      const char * end = begin + len ;
+      for( ; begin != end ; ++begin )
+      { if( *begin == '\n' )
+          return begin + 1 ;
+      }
+      return NULL ;
+    }
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  struct FixByteLoop
+  {
+    static
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      const char * end = begin + len ;
+      for( const char * ptr = begin ; ptr + 4 <= end ; ++ptr )
+      { if( ptr[ 0 ] == '\x01' && ptr[ 1 ] == '1' && ptr[ 2 ] == '0' && ptr[ 3 ] == '=' )
+        { for( ptr += 4 ; ptr != end ; ++ptr )
+          { if( *ptr == '\x01' )
+              return ptr + 1 ;
+          }
+          return NULL ;
+        }
+      }
+      return NULL ;
+    }
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  std::string
+  make_lines( uint32_t size )
+  {
+    std::string rv ;
+    uint32_t    seed = 42 ;
+    while( rv.size() < size )
+    { seed = seed * 1103515245 + 12345 ;
+      rv.append( 16 + ( seed >> 16 ) % 224, 'x' ) ;
+      rv.push_back( '\n' ) ;
+    }
+    rv.resize( size ) ;
+    return rv ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  std::string
+  make_fix( uint32_t size )
+  {
+    static const char Body[] = "8=FIX.4.2\x01" "9=120\x01" "35=D\x01" "49=SENDER\x01" "56=TARGET\x01"
+                               "34=12\x01" "52=20260101-12:00:00.000\x01" "11=ORDER1\x01" "55=ABCD\x01"
+                               "54=1\x01" "38=100\x01" "44=10.25\x01" "40=2\x01" ;
+    std::string rv ;
+    uint32_t    seed = 42 ;
+    while( rv.size() < size )
+    { seed = seed * 1103515245 + 12345 ;
+      rv.append( Body ) ;
+      rv.append( "58=" ).append( ( seed >> 16 ) % 64, 'x' ).append( "\x01" "10=" ) ;
+      rv.append( std::to_string( 100 + ( seed >> 8 ) % 900 ) ).append( "\x01" ) ;
+    }
+    rv.resize( size ) ;
+    return rv ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Extractor>
+  uint64_t
+  split_each( const std::string & buf )
+  {
+    uint64_t     rv  = 0 ;
+    const char * ptr = buf.data() ;
+    const char * end = ptr + buf.size() ;
+    for( const char * next ; ( next = T_Extractor::get( ptr, end - ptr ) ) != NULL ; ptr = next )
+      ++rv ;
+    return rv ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Extractor>
+  uint64_t
+  split_all( const std::string & buf )
+  {
+    uint64_t     rv  = 0 ;
+    const char * ptr = buf.data() ;
+    const char * end = ptr + buf.size() ;
+    uint32_t     ends[ Batch_Size ] ;
+    for( ;; )
+    { uint32_t count = T_Extractor::get_all( ptr, end - ptr, ends, Batch_Size ) ;
+      rv += count ;
+      if( count < Batch_Size )
+        break ;
+      ptr += ends[ count - 1 ] ;
+    }
+    return rv ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  // MB/sec splitting 'buf' over and over w/ 'split'.
+  //-------------------------------------------------------------------------------------
+  uint64_t
+  measure( uint64_t ( *split )( const std::string & ), const std::string & buf, uint64_t & records )
+  {
+    uint64_t runs  = Bytes_Per_Run / buf.size() ;
+    uint64_t begin = time::Clock::now() ;
+    records = 0 ;
+    for( uint64_t idx = 0 ; idx < runs ; ++idx )
+      records += split( buf ) ;
+    uint64_t nanos = time::Clock::now() - begin ;
+    return ( nanos == 0 ) ? 0 : static_cast<uint64_t>( ( static_cast<double>( runs * buf.size() ) * time::Nanos_Per_Second ) / nanos / ( 1024 * 1024 ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Loop, typename T_Extractor>
+  void
+  run( const char * label, std::string ( *make )( uint32_t ) )
+  {
+    std::cout << "|--[ " << label << " ( MB/sec ) ]" << std::endl ;
+    for( uint32_t size : Buffer_Sizes )
+    { std::string buf = make( size ) ;
+      uint64_t    expect = 0 ;
+      uint64_t    count  = 0 ;
+
+      std::cout << "|  |--[ " << ( size / 1024 ) << "KB ]" << std::endl
+                << "|  |  |--[ byte loop    => " << measure( split_each<T_Loop>, buf, expect ) << " ]" << std::endl ;
+
+      for( int lvl = container::scan::level::Scalar ; lvl <= container::scan::best_level() ; ++lvl )
+      { container::scan::set_level( static_cast<container::scan::level::Enum>( lvl ) ) ;
+        const char * name = container::scan::level_name( container::scan::active_level() ) ;
+
+        uint64_t each = measure( split_each<T_Extractor>, buf, count ) ;
+        std::cout << "|  |  |--[ " << name << " get()     => " << each << ( count != expect ? " MISMATCH" : "" ) << " ]" << std::endl ;
+
+        uint64_t all = measure( split_all<T_Extractor>, buf, count ) ;
+        std::cout << "|  |  |--[ " << name << " get_all() => " << all << ( count != expect ? " MISMATCH" : "" ) << " ]" << std::endl ;
+      }
+      container::scan::set_level( container::scan::best_level() ) ;
+    }
+    std::cout << "|" << std::endl ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int, char ** )
+{
+  std::cout << "[ container::scan benchmark ]" << std::endl
+            << "|--[ best level => " << container::scan::level_name( container::scan::best_level() ) << " ]" << std::endl
+            << "|" << std::endl ;
+
+  run<ByteLoop, extract::ByNewline>      ( "newline records", make_lines ) ;
+  run<FixByteLoop, extract::ByFixMessage>( "FIX messages", make_fix ) ;
+  return 0 ;
+}
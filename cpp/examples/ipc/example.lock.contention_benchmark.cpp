@@ -0,0 +1,159 @@
+#include "fps_ipc/spinlock.h"
+#include "fps_ipc/ticket_lock.h"
+#include "fps_ipc/mcs_lock.h"
+#include "fps_system/fps_system.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Compare ipc::SpinLock_Atomic, ipc::SpinLock_Intrinsic, ipc::TicketLock and
+// ipc::McsLock at 2, 4 and 8 threads.  Every thread repeatedly acquires the
+// lock, bumps a shared counter and releases it.  For each lock we report
+// acquisitions/sec along w/ the median, p99 and worst lock() latency seen by
+// any thread - the last being the best indicator of starvation.  Threads are
+// pinned round robin across the available cpus.
+//
+// Usage: example.lock.contention_benchmark [ acquisitions_per_thread ]
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Default_Acquisitions = 100000 ;
+
+  typedef ipc::McsLock<> mcs_t ;
+
+  //-------------------------------------------------------------------------------------
+  // Adapts each lock to a per-thread lock()/unlock() interface.  McsLock
+  // threads each need a slot of their own.
+  //-------------------------------------------------------------------------------------
+  template<typename T_Lock>
+  class Locker
+  {
+  private :
+    T_Lock & lock_ ;
+
+  public :
+    inline Locker( T_Lock & lock ) : lock_( lock ) {}
+    inline void lock()   { lock_.lock() ; }
+    inline void unlock() { lock_.unlock() ; }
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  template<>
+  class Locker<mcs_t> : public mcs_t::Handle
+  {
+  public :
+    inline Locker( mcs_t & lock ) : mcs_t::Handle( lock ) {}
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  struct Result
+  {
+    double   rate_ ;       // Acquisitions/sec across all threads.
+    uint64_t p50_nanos_ ;
+    uint64_t p99_nanos_ ;
+    uint64_t max_nanos_ ;
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  void
+  pin( uint32_t idx )
+  { uint32_t cores = system::cpu::core_count() ;
+    system::cpu::set_affinity( system::cpu::AffinityMask( ( cores > 0 ) ? ( idx % cores ) : 0 ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Lock>
+  Result
+  run( uint32_t thread_count, uint64_t acquisitions )
+  {
+    T_Lock                             * lock    = new T_Lock() ;
+    volatile uint64_t                    counter = 0 ;
+    std::vector< std::vector<uint64_t> > waits( thread_count ) ;
+    std::vector<std::thread>             threads ;
+
+    uint64_t begin = time::Clock::now() ;
+    for( uint32_t idx = 0 ; idx < thread_count ; ++idx )
+    { threads.emplace_back
+      ( [&, idx]()
+        { pin( idx ) ;
+          Locker<T_Lock>          locker( *lock ) ;
+          std::vector<uint64_t> & samples = waits[ idx ] ;
+          samples.reserve( acquisitions ) ;
+          for( uint64_t iter = 0 ; iter < acquisitions ; ++iter )
+          { uint64_t start = time::Clock::now() ;
+            locker.lock() ;
+            samples.push_back( time::Clock::now() - start ) ;
+            counter = counter + 1 ;
+            locker.unlock() ;
+          }
+        }
+      ) ;
+    }
+    for( std::thread & thread : threads )
+      thread.join() ;
+    uint64_t nanos = time::Clock::now() - begin ;
+
+    std::vector<uint64_t> all ;
+    for( const std::vector<uint64_t> & samples : waits )
+      all.insert( all.end(), samples.begin(), samples.end() ) ;
+    std::sort( all.begin(), all.end() ) ;
+
+    Result rv ;
+    rv.rate_      = ( static_cast<double>( all.size() ) * time::Nanos_Per_Second ) / nanos ;
+    rv.p50_nanos_ = all[ all.size() / 2 ] ;
+    rv.p99_nanos_ = all[ ( all.size() * 99 ) / 100 ] ;
+    rv.max_nanos_ = all.back() ;
+
+    delete lock ;
+    return rv ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Lock>
+  void
+  report( const char * name, uint32_t thread_count, uint64_t acquisitions )
+  {
+    Result result = run<T_Lock>( thread_count, acquisitions ) ;
+    std::cout << "|  |--[ " << name << " ]" << std::endl
+              << "|  |  |--[ acquisitions/sec => " << static_cast<uint64_t>( result.rate_ ) << " ]" << std::endl
+              << "|  |  |--[ p50 wait ns      => " << result.p50_nanos_ << " ]" << std::endl
+              << "|  |  |--[ p99 wait ns      => " << result.p99_nanos_ << " ]" << std::endl
+              << "|  |  |--[ max wait ns      => " << result.max_nanos_ << " ]" << std::endl ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  uint64_t acquisitions = ( argc > 1 ) ? std::strtoull( argv[ 1 ], NULL, 10 ) : Default_Acquisitions ;
+  if( acquisitions == 0 )
+    acquisitions = Default_Acquisitions ;
+
+  const uint32_t thread_counts[] = { 2, 4, 8 } ;
+
+  std::cout << "[ ipc lock contention benchmark ]" << std::endl
+            << "|--[ acquisitions/thread => " << acquisitions << " ]" << std::endl
+            << "|--[ core_count()        => " << system::cpu::core_count() << " ]" << std::endl
+            << "|" << std::endl ;
+
+  for( uint32_t thread_count : thread_counts )
+  {
+    std::cout << "|--[ threads " << thread_count << " ]" << std::endl ;
+    report<ipc::SpinLock_Atomic>   ( "SpinLock_Atomic", thread_count, acquisitions ) ;
+    report<ipc::SpinLock_Intrinsic>( "SpinLock_Intrinsic", thread_count, acquisitions ) ;
+    report<ipc::TicketLock>        ( "TicketLock", thread_count, acquisitions ) ;
+    report<mcs_t>                  ( "McsLock", thread_count, acquisitions ) ;
+    std::cout << "|" << std::endl ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,141 @@
+#include "fps_ipc/mpmc_ring_buffer.h"
+#include "fps_ipc/thread_fifo.h"
+#include "fps_ipc/spinlock.h"
+#include "fps_system/fps_system.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Compare multi-producer/single-consumer throughput of mpsc::RingBuffer against
+// a ThreadFifo whose producers are serialized by an ipc::SpinLock, at 2, 4 and 8
+// producer threads.  Producers are pinned round robin across the available
+// cpus, and the consumer gets a cpu of its own when one is available.
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint32_t Capacity      = 4096 ;
+  static const uint64_t Message_Count = 1024 * 1024 * 8 ;  // Total, across all producers.
+
+  //-------------------------------------------------------------------------------------
+  struct Message
+  {
+    uint64_t producer_ ;
+    uint64_t seq_ ;
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  typedef ipc::mpsc::RingBuffer<Message, Capacity> ring_t ;
+
+  //-------------------------------------------------------------------------------------
+  class LockedFifo
+  {
+  private :
+    ipc::SpinLock            lock_ ;
+    ipc::ThreadFifo<Message> fifo_ ;
+
+  public :
+    //-----------------------------------------------------------------------------------
+    LockedFifo() : fifo_( Capacity ) {}
+
+    //-----------------------------------------------------------------------------------
+    inline
+    bool
+    write( const Message & msg )
+    { lock_.lock() ;
+      bool rv = fifo_.write( msg ) ;
+      lock_.unlock() ;
+      return rv ;
+    }
+
+    //-----------------------------------------------------------------------------------
+    // Note: Single consumer, so reads don't need the lock.
+    //-----------------------------------------------------------------------------------
+    inline bool read( Message & msg ) { return fifo_.read( msg ) ; }
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  void
+  pin( uint32_t idx )
+  { uint32_t cores = system::cpu::core_count() ;
+    system::cpu::set_affinity( system::cpu::AffinityMask( ( cores > 0 ) ? ( idx % cores ) : 0 ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  // Returns messages/sec, measured from the start of the run until the consumer
+  // has drained every message.
+  //-------------------------------------------------------------------------------------
+  template<typename T_Queue>
+  double
+  run( T_Queue & queue, uint32_t producers )
+  {
+    uint64_t per_producer = Message_Count / producers ;
+    uint64_t total        = per_producer * producers ;
+
+    std::vector<std::thread> threads ;
+    uint64_t begin = time::Clock::now() ;
+    for( uint32_t producer = 0 ; producer < producers ; ++producer )
+    { threads.emplace_back
+      ( [&queue, producer, per_producer]()
+        { pin( producer + 1 ) ;
+          Message msg = { producer, 0 } ;
+          for( uint64_t seq = 1 ; seq <= per_producer ; ++seq )
+          { msg.seq_ = seq ;
+            for( uint32_t counter = 0 ; !queue.write( msg ) ; ++counter )
+              ipc::progressive_yield( counter ) ;
+          }
+        }
+      ) ;
+    }
+
+    pin( 0 ) ;
+    Message msg ;
+    for( uint64_t count = 0 ; count < total ; )
+    { if( queue.read( msg ) )
+        ++count ;
+    }
+    uint64_t nanos = time::Clock::now() - begin ;
+
+    for( std::thread & thread : threads )
+      thread.join() ;
+
+    return ( static_cast<double>( total ) * time::Nanos_Per_Second ) / nanos ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  const uint32_t producer_counts[] = { 2, 4, 8 } ;
+
+  std::cout << "[ mpsc::RingBuffer contention benchmark ]" << std::endl
+            << "|--[ Capacity      => " << Capacity      << " ]" << std::endl
+            << "|--[ Message_Count => " << Message_Count << " ]" << std::endl
+            << "|--[ core_count()  => " << system::cpu::core_count() << " ]" << std::endl
+            << "|" << std::endl ;
+
+  for( uint32_t producers : producer_counts )
+  {
+    ring_t     * ring = new ring_t() ;
+    LockedFifo * fifo = new LockedFifo() ;
+
+    double ring_rate = run( *ring, producers ) ;
+    double fifo_rate = run( *fifo, producers ) ;
+
+    std::cout << "|--[ producers " << producers << " ]" << std::endl
+              << "|  |--[ mpsc::RingBuffer msgs/sec      => " << static_cast<uint64_t>( ring_rate ) << " ]" << std::endl
+              << "|  |--[ SpinLock + ThreadFifo msgs/sec => " << static_cast<uint64_t>( fifo_rate ) << " ]" << std::endl
+              << "|" << std::endl ;
+
+    delete fifo ;
+    delete ring ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,215 @@
+#include "fps_ipc/spsc_ring_buffer.h"
+#include "fps_ipc/ipc_util.h"
+#include "fps_system/fps_system.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include <thread>
+#include <cstdlib>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Compare spsc::RingBuffer ( cached acquire/release indices ) against the
+// original ThreadFifo design ( a shared size_ counter updated w/ locked
+// read-modify-writes ) :
+//
+//   ping-pong  - two threads bounce a message back and forth over a pair of
+//                queues, so every hop crosses cores.
+//   streaming  - one thread writes as fast as it can while the other drains.
+//
+// The two threads are pinned to distinct cpus w/ system::cpu::set_affinity().
+// Usage: example.spsc_ring_buffer.ping_pong_benchmark [ round_trips ]
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Capacity       = 1024 ;
+  static const uint64_t Stream_Count   = 1024 * 1024 * 32 ;
+  static const uint64_t Default_Trips  = 1024 * 1024 ;
+  static const uint32_t Ping_CPU       = 0 ;
+  static const uint32_t Pong_CPU       = 1 ;
+
+  //-------------------------------------------------------------------------------------
+  // The original ThreadFifo algorithm, kept here as the baseline.
+  //-------------------------------------------------------------------------------------
+  template<typename T>
+  class CountedFifo
+  {
+  private :
+    static const std::size_t Alignment = system::cpu::Cache_Line_Size ;
+
+    uint64_t          capacity_ alignas( Alignment ) ;
+    volatile uint64_t size_     alignas( Alignment ) ;
+    uint64_t          r_idx_    alignas( Alignment ) ;
+    uint64_t          w_idx_    alignas( Alignment ) ;
+    T               * data_ ;
+
+  public :
+    //-----------------------------------------------------------------------------------
+    CountedFifo( uint64_t capacity )
+      : capacity_( capacity )
+      , size_    ( 0 )
+      , r_idx_   ( 0 )
+      , w_idx_   ( 0 )
+      , data_    ( new T[ capacity ] )
+    {}
+
+    //-----------------------------------------------------------------------------------
+    ~CountedFifo() { delete [] data_ ; }
+
+    //-----------------------------------------------------------------------------------
+    inline
+    bool
+    write( const T & value )
+    { if( size_ == capacity_ )
+        return false ;
+      data_[ w_idx_ ] = value ;
+      ::__sync_fetch_and_add( &size_, 1 ) ;
+      if( w_idx_ == ( capacity_ - 1 ) )
+        w_idx_ = 0 ;
+      else
+        ++w_idx_ ;
+      return true ;
+    }
+
+    //-----------------------------------------------------------------------------------
+    inline
+    bool
+    read( T & result )
+    { if( size_ == 0 )
+        return false ;
+      result = data_[ r_idx_ ] ;
+      ::__sync_fetch_and_sub( &size_, 1 ) ;
+      if( r_idx_ == ( capacity_ - 1 ) )
+        r_idx_ = 0 ;
+      else
+        ++r_idx_ ;
+      return true ;
+    }
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  void
+  pin( uint32_t cpu )
+  { uint32_t cores = system::cpu::core_count() ;
+    system::cpu::set_affinity( system::cpu::AffinityMask( ( cores > 0 ) ? ( cpu % cores ) : 0 ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Queue>
+  inline
+  void
+  blocking_write( T_Queue & queue, uint64_t value )
+  { for( uint32_t counter = 0 ; !queue.write( value ) ; ++counter )
+      ipc::progressive_yield( counter ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T_Queue>
+  inline
+  uint64_t
+  blocking_read( T_Queue & queue )
+  { uint64_t value ;
+    for( uint32_t counter = 0 ; !queue.read( value ) ; ++counter )
+      ipc::progressive_yield( counter ) ;
+    return value ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  // Returns round trips/sec.
+  //-------------------------------------------------------------------------------------
+  template<typename T_Queue>
+  double
+  ping_pong( uint64_t round_trips )
+  {
+    T_Queue * ping = new T_Queue( Capacity ) ;
+    T_Queue * pong = new T_Queue( Capacity ) ;
+
+    std::thread pong_thread
+    ( [=]()
+      { pin( Pong_CPU ) ;
+        for( uint64_t idx = 0 ; idx < round_trips ; ++idx )
+          blocking_write( *pong, blocking_read( *ping ) ) ;
+      }
+    ) ;
+
+    pin( Ping_CPU ) ;
+    uint64_t begin = time::Clock::now() ;
+    for( uint64_t idx = 0 ; idx < round_trips ; ++idx )
+    { blocking_write( *ping, idx ) ;
+      blocking_read( *pong ) ;
+    }
+    uint64_t nanos = time::Clock::now() - begin ;
+
+    pong_thread.join() ;
+    delete pong ;
+    delete ping ;
+    return ( static_cast<double>( round_trips ) * time::Nanos_Per_Second ) / nanos ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  // Returns messages/sec.
+  //-------------------------------------------------------------------------------------
+  template<typename T_Queue>
+  double
+  streaming()
+  {
+    T_Queue * queue = new T_Queue( Capacity ) ;
+
+    std::thread writer_thread
+    ( [=]()
+      { pin( Pong_CPU ) ;
+        for( uint64_t idx = 0 ; idx < Stream_Count ; ++idx )
+          blocking_write( *queue, idx ) ;
+      }
+    ) ;
+
+    pin( Ping_CPU ) ;
+    uint64_t begin = time::Clock::now() ;
+    for( uint64_t idx = 0 ; idx < Stream_Count ; ++idx )
+      blocking_read( *queue ) ;
+    uint64_t nanos = time::Clock::now() - begin ;
+
+    writer_thread.join() ;
+    delete queue ;
+    return ( static_cast<double>( Stream_Count ) * time::Nanos_Per_Second ) / nanos ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  uint64_t round_trips = ( argc > 1 ) ? std::strtoull( argv[ 1 ], NULL, 10 ) : Default_Trips ;
+  if( round_trips == 0 )
+    round_trips = Default_Trips ;
+
+  typedef ipc::spsc::RingBuffer<uint64_t> spsc_t ;
+  typedef CountedFifo<uint64_t>           counted_t ;
+
+  std::cout << "[ spsc::RingBuffer ping-pong benchmark ]" << std::endl
+            << "|--[ Capacity     => " << Capacity     << " ]" << std::endl
+            << "|--[ round trips  => " << round_trips  << " ]" << std::endl
+            << "|--[ Stream_Count => " << Stream_Count << " ]" << std::endl
+            << "|--[ core_count() => " << system::cpu::core_count() << " ]" << std::endl
+            << "|" << std::endl ;
+
+  double spsc_trips    = ping_pong<spsc_t>   ( round_trips ) ;
+  double counted_trips = ping_pong<counted_t>( round_trips ) ;
+  double spsc_msgs     = streaming<spsc_t>   () ;
+  double counted_msgs  = streaming<counted_t>() ;
+
+  std::cout << "|--[ ping-pong round trips/sec ]" << std::endl
+            << "|  |--[ spsc::RingBuffer => " << static_cast<uint64_t>( spsc_trips )    << " ]" << std::endl
+            << "|  |--[ CountedFifo      => " << static_cast<uint64_t>( counted_trips ) << " ]" << std::endl
+            << "|  |--[ speedup          => " << ( spsc_trips / counted_trips )         << "x ]" << std::endl
+            << "|" << std::endl
+            << "|--[ streaming msgs/sec ]" << std::endl
+            << "|  |--[ spsc::RingBuffer => " << static_cast<uint64_t>( spsc_msgs )     << " ]" << std::endl
+            << "|  |--[ CountedFifo      => " << static_cast<uint64_t>( counted_msgs )  << " ]" << std::endl
+            << "|  |--[ speedup          => " << ( spsc_msgs / counted_msgs )           << "x ]" << std::endl
+            << "|" << std::endl ;
+
+  return 0 ;
+}
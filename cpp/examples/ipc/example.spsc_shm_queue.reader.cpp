@@ -0,0 +1,76 @@
+#include "fps_ipc/spsc_shm_queue.h"
+#include "fps_util/signal.h"
+#include "fps_time/timer.h"
+#include "spsc_shm_queue.common.h"
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+bool exit_flag = false ;
+
+//---------------------------------------------------------------------------------------
+void interrupt_handler( int ) 
+{ 
+  exit_flag = true ;
+}
+
+//---------------------------------------------------------------------------------------
+int 
+main( int argc, char * argv[] ) 
+{
+  typedef examples::ipc::spsc::Message msg_t ;
+  typedef ipc::spsc::ShmQueueReader<msg_t, examples::ipc::spsc::Capacity> reader_t ;
+
+  std::cout << "[ spsc::ShmQueueReader ]" << std::endl ;
+  reader_t reader ;
+  reader.open( examples::ipc::spsc::Queue_Name ) ;
+  
+  std::cout << "|--[ CPU            => '" << examples::ipc::spsc::Reader_CPU << "' ]" << std::endl 
+            << "|--[ open()         <= '" << examples::ipc::spsc::Queue_Name << "' ]" << std::endl 
+            << "|--[ is_open()      => '" << (reader.is_open()?"true":"false") << "' ]" << std::endl 
+            << "|--[ capacity()     => '" << reader.capacity() << "' ]" << std::endl
+            << "|--[ last_error()   => '" << reader.last_error() << "' ]" << std::endl 
+            << "|" << std::endl 
+            ;
+
+  if( !reader.is_open() ) 
+  { std::cout << "|--[ ERROR        :: Failed to open reader instance ]" << std::endl 
+              << "|" << std::endl ;
+    return 1 ;
+  }
+
+  system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::spsc::Reader_CPU ) ) ;
+
+  util::signal::set_handler( util::signal::Sig_Int,  interrupt_handler ) ;
+  util::signal::set_handler( util::signal::Sig_Term, interrupt_handler ) ;
+  
+  msg_t       msg ;
+  time::Timer console_timer ;
+  console_timer.set( time::Nanos_Per_Second * 3 ) ;
+  console_timer.start() ;
+  uint64_t last_delta = 0 ;
+  uint64_t last_seq   = reader.read_count() ;
+  uint64_t gaps       = 0 ;
+
+  while( !exit_flag ) 
+  {
+    if( reader.read( msg ) ) 
+    { if( last_seq + 1 != msg.seq_ ) 
+        ++gaps ;
+      last_seq   = msg.seq_ ;
+      last_delta = time::Clock::now() - msg.w_ts_ ;
+    }
+
+    if( console_timer.expired() ) 
+    { std::cout << "|--[ read_count         => " << reader.read_count() << " ]" << std::endl 
+                << "|--[ last sequence      => " << last_seq            << " ]" << std::endl 
+                << "|--[ last delta (nanos) => " << last_delta          << " ]" << std::endl 
+                << "|--[ gaps               => " << gaps                << " ]" << std::endl 
+                << "|--[ writer alive       => " << reader.is_writer_alive() << " ]" << std::endl ;
+      console_timer.restart() ;
+    }
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,81 @@
+#include "fps_ipc/spsc_shm_queue.h"
+#include "fps_util/signal.h"
+#include "fps_time/timer.h"
+#include "spsc_shm_queue.common.h"
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+bool exit_flag = false ;
+
+//---------------------------------------------------------------------------------------
+void interrupt_handler( int ) 
+{ 
+  exit_flag = true ;
+}
+
+//---------------------------------------------------------------------------------------
+// Publish sequenced messages as fast as the reader consumes them.  When the queue is
+// full the writer counts the rejected attempt and retries, so no message is ever 
+// dropped.
+//---------------------------------------------------------------------------------------
+int 
+main( int argc, char * argv[] ) 
+{
+  typedef examples::ipc::spsc::Message msg_t ;
+  typedef ipc::spsc::ShmQueueWriter<msg_t, examples::ipc::spsc::Capacity> writer_t ;
+
+  fs::Path shm_path( "/dev/shm", examples::ipc::spsc::Queue_Name ) ;
+  if( shm_path.exists() ) 
+    shm_path.rm() ;
+  
+  std::cout << "[ spsc::ShmQueueWriter ]" << std::endl ;
+  writer_t writer ;
+  writer.open( examples::ipc::spsc::Queue_Name ) ;
+
+  std::cout << "|--[ CPU            => '" << examples::ipc::spsc::Writer_CPU << "' ]" << std::endl 
+            << "|--[ open()         <= '" << examples::ipc::spsc::Queue_Name << "' ]" << std::endl 
+            << "|--[ is_open()      => '" << (writer.is_open()?"true":"false") << "' ]" << std::endl 
+            << "|--[ capacity()     => '" << writer.capacity() << "' ]" << std::endl
+            << "|--[ shm.size()     => '" << writer.shared_memory().size() << "' ]" << std::endl
+            << "|--[ last_error()   => '" << writer.last_error() << "' ]" << std::endl 
+            << "|" << std::endl 
+            ;
+
+  if( !writer.is_open() ) 
+  { std::cout << "|--[ ERROR        :: Failed to open writer instance ]" << std::endl 
+              << "|" << std::endl ;
+    return 1 ;
+  }
+
+  system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::spsc::Writer_CPU ) ) ;
+
+  util::signal::set_handler( util::signal::Sig_Int,  interrupt_handler ) ;
+  util::signal::set_handler( util::signal::Sig_Term, interrupt_handler ) ;
+
+  uint64_t    sequence  = 1 ;
+  uint64_t    full_count = 0 ;
+  time::Timer console_timer ;
+  console_timer.set( time::Nanos_Per_Second * 3 ) ;
+  console_timer.start() ;
+
+  while( !exit_flag ) 
+  {
+    uint64_t now_ts = time::Clock::now() ;
+    msg_t    msg    = { sequence, now_ts } ;
+    if( writer.write( msg ) ) 
+      ++sequence ;
+    else 
+      ++full_count ;
+
+    if( console_timer.expired( now_ts ) ) 
+    { std::cout << "|--[ write_count        => " << writer.write_count()       << " ]" << std::endl 
+                << "|--[ full_count         => " << full_count                 << " ]" << std::endl 
+                << "|--[ reader attached    => " << writer.is_reader_attached() << " ]" << std::endl ;
+      console_timer.restart() ;
+    }
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,172 @@
+#include "fps_ipc/swmr_ring_buffer.h"
+#include "fps_ipc/options.h"
+#include "fps_system/fps_system.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdlib>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Quantify false sharing between a swmr writer and a reader that trails it by
+// a slot or two.  W/ packed slots the writer's store to slot N invalidates
+// the line the reader is copying slot N - 1 out of; padding every slot to a
+// cache line ( or line pair, for adjacent line prefetchers ) removes that at
+// the cost of memory.  Each payload size is run packed, line aligned and
+// line pair aligned, and we report write and read rates along w/ the number
+// of torn reads ( overruns ) and empty polls the reader saw.  Writer and
+// reader are pinned to cpus 0 and 1.
+//
+// Usage: example.swmr_ring_buffer.false_sharing_benchmark [ message_count ]
+//---------------------------------------------------------------------------------------
+namespace
+{
+  static const uint64_t Default_Message_Count = 1024 * 1024 * 16 ;
+  static const uint32_t Capacity              = 1024 ;
+  static const uint32_t Line                  = system::cpu::Cache_Line_Size ;
+
+  //-------------------------------------------------------------------------------------
+  template<uint32_t T_Size>
+  struct Payload
+  {
+    uint64_t seq_ ;
+    uint8_t  pad_[ T_Size - sizeof( uint64_t ) ] ;
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  struct Result
+  {
+    uint64_t w_nanos_     ;
+    uint64_t r_nanos_     ;
+    uint64_t r_count_     ;
+    uint64_t overruns_    ;
+    uint64_t empty_polls_ ;
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  void
+  pin( uint32_t idx )
+  { uint32_t cores = system::cpu::core_count() ;
+    system::cpu::set_affinity( system::cpu::AffinityMask( ( cores > 0 ) ? ( idx % cores ) : 0 ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  inline
+  uint64_t
+  per_second( uint64_t count, uint64_t nanos )
+  { return ( nanos == 0 ) ? 0 : static_cast<uint64_t>( ( static_cast<double>( count ) * time::Nanos_Per_Second ) / nanos ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T, uint32_t T_Alignment>
+  Result
+  run( uint64_t message_count )
+  {
+    typedef ipc::swmr::detail::RingBuffer<T, Capacity, ipc::opt::Slot_Alignment<T_Alignment> > ring_t ;
+    std::unique_ptr<ring_t> ring( new ring_t() ) ;
+
+    Result            result = { 0, 0, 0, 0, 0 } ;
+    std::atomic<bool> w_done( false ) ;
+    std::atomic<bool> r_ready( false ) ;
+
+    std::thread r_thread
+    ( [&]()
+      { pin( 1 ) ;
+        T        msg ;
+        uint64_t r_seq = 0 ;
+        r_ready.store( true, std::memory_order_release ) ;
+
+        uint64_t r_begin = time::Clock::now() ;
+        for( ;; )
+        { int32_t status = ring->read( r_seq, msg ) ;
+          if( fps_likely( status == ipc::swmr::read_status::Success ) )
+          { ++r_seq ;
+            ++result.r_count_ ;
+          }
+          else if( status == ipc::swmr::read_status::Empty )
+          { if( w_done.load( std::memory_order_acquire ) && ring->write_sequence() <= r_seq )
+              break ;
+            ++result.empty_polls_ ;
+          }
+          else
+          { ++result.overruns_ ;
+            uint64_t oldest = ring->oldest_sequence() ;
+            r_seq = ( oldest > r_seq ) ? oldest : r_seq + 1 ;
+          }
+        }
+        result.r_nanos_ = time::Clock::now() - r_begin ;
+      }
+    ) ;
+
+    pin( 0 ) ;
+    while( !r_ready.load( std::memory_order_acquire ) ) ;
+
+    T msg ;
+    for( uint32_t idx = 0 ; idx < sizeof( msg.pad_ ) ; ++idx )
+      msg.pad_[ idx ] = static_cast<uint8_t>( idx ) ;
+
+    uint64_t w_begin = time::Clock::now() ;
+    for( uint64_t seq = 1 ; seq <= message_count ; ++seq )
+    { msg.seq_ = seq ;
+      ring->write( msg ) ;
+    }
+    result.w_nanos_ = time::Clock::now() - w_begin ;
+
+    w_done.store( true, std::memory_order_release ) ;
+    r_thread.join() ;
+    return result ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<typename T, uint32_t T_Alignment>
+  void
+  report( const char * name, uint64_t message_count )
+  {
+    typedef ipc::swmr::detail::RingBuffer<T, Capacity, ipc::opt::Slot_Alignment<T_Alignment> > ring_t ;
+
+    Result result = run<T, T_Alignment>( message_count ) ;
+    std::cout << "|  |--[ " << name << " ( slot size " << sizeof( typename ring_t::slot_t ) << " ) ]" << std::endl
+              << "|  |  |--[ write msgs/sec => " << per_second( message_count,   result.w_nanos_ ) << " ]" << std::endl
+              << "|  |  |--[ read msgs/sec  => " << per_second( result.r_count_, result.r_nanos_ ) << " ]" << std::endl
+              << "|  |  |--[ read count     => " << result.r_count_     << " ]" << std::endl
+              << "|  |  |--[ overruns       => " << result.overruns_    << " ]" << std::endl
+              << "|  |  |--[ empty polls    => " << result.empty_polls_ << " ]" << std::endl ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  template<uint32_t T_Size>
+  void
+  report_all( uint64_t message_count )
+  {
+    std::cout << "|--[ payload " << T_Size << " bytes ]" << std::endl ;
+    report< Payload<T_Size>, 0 >       ( "packed", message_count ) ;
+    report< Payload<T_Size>, Line >    ( "Slot_Alignment<Cache_Line_Size>", message_count ) ;
+    report< Payload<T_Size>, 2 * Line >( "Slot_Alignment<2 * Cache_Line_Size>", message_count ) ;
+    std::cout << "|" << std::endl ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  uint64_t message_count = ( argc > 1 ) ? std::strtoull( argv[ 1 ], NULL, 10 ) : Default_Message_Count ;
+  if( message_count == 0 )
+    message_count = Default_Message_Count ;
+
+  std::cout << "[ swmr::RingBuffer false sharing benchmark ]" << std::endl
+            << "|--[ Capacity      => " << Capacity << " ]" << std::endl
+            << "|--[ Message_Count => " << message_count << " ]" << std::endl
+            << "|--[ core_count()  => " << system::cpu::core_count() << " ]" << std::endl
+            << "|" << std::endl ;
+
+  report_all<16>( message_count ) ;
+  report_all<48>( message_count ) ;
+  report_all<200>( message_count ) ;
+  return 0 ;
+}
@@ -0,0 +1,132 @@
+#include "fps_ipc/swmr_shm_queue.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include "swmr_shm_queue.common.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Measure swmr::ShmQueueWriter/ShmQueueReader throughput ( messages/sec ) when
+// messages are published and drained in batches of 1, 16 and 256 elements.
+//---------------------------------------------------------------------------------------
+namespace
+{
+  typedef examples::ipc::swmr::Message msg_t ;
+  static const uint32_t Capacity      = examples::ipc::swmr::Capacity ;
+  static const uint64_t Message_Count = 1024 * 1024 * 16 ;
+  static const char     Queue_Name[]  = "fps.swmr_shm_queue.batch_benchmark" ;
+
+  typedef ipc::swmr::ShmQueueWriter<msg_t, Capacity> writer_t ;
+  typedef ipc::swmr::ShmQueueReader<msg_t, Capacity> reader_t ;
+
+  //-------------------------------------------------------------------------------------
+  struct Result
+  {
+    uint64_t w_nanos_ ;
+    uint64_t r_nanos_ ;
+    uint64_t r_count_ ;
+    uint64_t r_lost_  ;
+  } ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  double
+  per_second( uint64_t count, uint64_t nanos )
+  { return ( nanos == 0 )
+           ? 0.0
+           : ( static_cast<double>( count ) * time::Nanos_Per_Second ) / nanos
+           ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  bool
+  run( uint32_t batch_size, Result & result )
+  {
+    fs::Path shm_path( "/dev/shm", Queue_Name ) ;
+    if( shm_path.exists() )
+      shm_path.rm() ;
+
+    writer_t writer ;
+    if( !writer.open( Queue_Name ) )
+    { std::cout << "|--[ ERROR :: Failed to open writer ( errno: " << writer.last_error() << " ) ]" << std::endl ;
+      return false ;
+    }
+
+    reader_t reader ;
+    if( !reader.open( Queue_Name ) )
+    { std::cout << "|--[ ERROR :: Failed to open reader ( errno: " << reader.last_error() << " ) ]" << std::endl ;
+      return false ;
+    }
+
+    std::atomic<bool> w_done( false ) ;
+    result.r_count_ = 0 ;
+
+    std::thread r_thread
+    ( [&]()
+      { system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::swmr::Reader_CPU ) ) ;
+        std::vector<msg_t> r_buf( batch_size ) ;
+        uint64_t r_begin = time::Clock::now() ;
+        for( ;; )
+        { uint32_t count = reader.read_batch( r_buf.data(), batch_size ) ;
+          result.r_count_ += count ;
+          if( count == 0 && w_done.load( std::memory_order_acquire ) )
+            break ;
+        }
+        result.r_nanos_ = time::Clock::now() - r_begin ;
+      }
+    ) ;
+
+    system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::swmr::Writer_CPU ) ) ;
+
+    std::vector<msg_t> w_buf( batch_size ) ;
+    uint64_t w_seq   = 1 ;
+    uint64_t w_begin = time::Clock::now() ;
+    while( w_seq <= Message_Count )
+    { uint64_t now_ts = time::Clock::now() ;
+      for( uint32_t idx = 0 ; idx < batch_size ; ++idx )
+        w_buf[ idx ].on_write( w_seq++, now_ts ) ;
+      writer.write_batch( w_buf.data(), batch_size ) ;
+    }
+    result.w_nanos_ = time::Clock::now() - w_begin ;
+
+    w_done.store( true, std::memory_order_release ) ;
+    r_thread.join() ;
+    result.r_lost_ = reader.lost_count() ;
+
+    reader.close() ;
+    writer.close() ;
+    shm_path.rm() ;
+    return true ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  const uint32_t batch_sizes[] = { 1, 16, 256 } ;
+
+  std::cout << "[ swmr::ShmQueue batch benchmark ]" << std::endl
+            << "|--[ Capacity      => " << Capacity      << " ]" << std::endl
+            << "|--[ Message_Count => " << Message_Count << " ]" << std::endl
+            << "|" << std::endl ;
+
+  for( uint32_t batch_size : batch_sizes )
+  {
+    Result result ;
+    if( !run( batch_size, result ) )
+      return 1 ;
+
+    std::cout << "|--[ batch_size " << batch_size << " ]" << std::endl
+              << "|  |--[ write msgs/sec => " << static_cast<uint64_t>( per_second( Message_Count,   result.w_nanos_ ) ) << " ]" << std::endl
+              << "|  |--[ read msgs/sec  => " << static_cast<uint64_t>( per_second( result.r_count_, result.r_nanos_ ) ) << " ]" << std::endl
+              << "|  |--[ read count     => " << result.r_count_ << " ( lost " << result.r_lost_ << " ) ]" << std::endl
+              << "|" << std::endl ;
+  }
+
+  return 0 ;
+}
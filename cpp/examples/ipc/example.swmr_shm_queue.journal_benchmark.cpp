@@ -0,0 +1,142 @@
+#include "fps_ipc/swmr_shm_queue_journal.h"
+#include "fps_fs/path.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include "swmr_shm_queue.common.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace fps ;
+
+//---------------------------------------------------------------------------------------
+// Can a swmr::ShmQueueJournal keep up w/ a writer publishing as fast as it can?  The
+// writer publishes Message_Count messages in batches of 16 while a journal, pinned to
+// the reader cpu, tees them to disk.  We report the write and capture rates, how many
+// messages the journal was lapped out of, and then how fast the journal replays into a
+// second queue.
+//
+// Usage: example.swmr_shm_queue.journal_benchmark [ journal_path ]
+//---------------------------------------------------------------------------------------
+namespace
+{
+  typedef examples::ipc::swmr::Message msg_t ;
+  static const uint32_t Capacity       = examples::ipc::swmr::Capacity ;
+  static const uint64_t Message_Count  = 1024 * 1024 * 16 ;
+  static const uint32_t Batch_Size     = 16 ;
+  static const char     Queue_Name[]   = "fps.swmr_shm_queue.journal_benchmark" ;
+  static const char     Replay_Name[]  = "fps.swmr_shm_queue.journal_benchmark.replay" ;
+  static const char     Default_Path[] = "/tmp/fps.swmr_shm_queue.journal_benchmark.journal" ;
+
+  typedef ipc::swmr::ShmQueueWriter <msg_t, Capacity> writer_t ;
+  typedef ipc::swmr::ShmQueueJournal<msg_t, Capacity> journal_t ;
+  typedef ipc::swmr::ShmQueueReplay <msg_t>           replay_t ;
+
+  //-------------------------------------------------------------------------------------
+  inline
+  uint64_t
+  per_second( uint64_t count, uint64_t nanos )
+  { return ( nanos == 0 ) ? 0 : static_cast<uint64_t>( ( static_cast<double>( count ) * time::Nanos_Per_Second ) / nanos ) ;
+  }
+
+  //-------------------------------------------------------------------------------------
+  void
+  remove_file( const std::string & path )
+  { fs::Path fs_path( path ) ;
+    if( fs_path.exists() )
+      fs_path.rm() ;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+int
+main( int argc, char * argv[] )
+{
+  std::string path = ( argc > 1 ) ? argv[ 1 ] : Default_Path ;
+  remove_file( std::string( "/dev/shm/" ) + Queue_Name ) ;
+  remove_file( std::string( "/dev/shm/" ) + Replay_Name ) ;
+  remove_file( path ) ;
+  remove_file( ipc::journal::index_path( path ) ) ;
+
+  std::cout << "[ swmr::ShmQueueJournal benchmark ]" << std::endl
+            << "|--[ Capacity      => " << Capacity      << " ]" << std::endl
+            << "|--[ Message_Count => " << Message_Count << " ]" << std::endl
+            << "|--[ Journal       => " << path          << " ]" << std::endl
+            << "|" << std::endl ;
+
+  writer_t  writer ;
+  journal_t journal ;
+  if( !writer.open( Queue_Name ) || !journal.open( Queue_Name, path ) )
+  { std::cout << "|--[ ERROR :: Failed to open queue or journal ( errno: " << writer.last_error() << "/" << journal.last_error() << " ) ]" << std::endl ;
+    return 1 ;
+  }
+
+  //
+  // Capture.
+  //
+  std::atomic<bool> stop( false ) ;
+  uint64_t          j_count = 0 ;
+  uint64_t          j_nanos = 0 ;
+  std::thread j_thread
+  ( [&]()
+    { system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::swmr::Reader_CPU ) ) ;
+      uint64_t j_begin = time::Clock::now() ;
+      j_count = journal.run( stop ) ;
+      j_nanos = time::Clock::now() - j_begin ;
+    }
+  ) ;
+
+  system::cpu::set_affinity( system::cpu::AffinityMask( examples::ipc::swmr::Writer_CPU ) ) ;
+
+  std::vector<msg_t> w_buf( Batch_Size ) ;
+  uint64_t w_seq   = 1 ;
+  uint64_t w_begin = time::Clock::now() ;
+  while( w_seq <= Message_Count )
+  { uint64_t now_ts = time::Clock::now() ;
+    for( uint32_t idx = 0 ; idx < Batch_Size ; ++idx )
+      w_buf[ idx ].on_write( w_seq++, now_ts ) ;
+    writer.write_batch( w_buf.data(), Batch_Size ) ;
+  }
+  uint64_t w_nanos = time::Clock::now() - w_begin ;
+
+  stop.store( true, std::memory_order_release ) ;
+  j_thread.join() ;
+  uint64_t j_bytes = journal.journal().size() ;
+  uint64_t j_lost  = journal.lost_count() ;
+  journal.close() ;
+  writer.close() ;
+
+  std::cout << "|--[ capture ]" << std::endl
+            << "|  |--[ write msgs/sec   => " << per_second( Message_Count, w_nanos ) << " ]" << std::endl
+            << "|  |--[ journal msgs/sec => " << per_second( j_count, j_nanos ) << " ]" << std::endl
+            << "|  |--[ journal MB/sec   => " << per_second( j_bytes, j_nanos ) / ( 1024 * 1024 ) << " ]" << std::endl
+            << "|  |--[ journaled        => " << j_count << " ( lost " << j_lost << " ) ]" << std::endl
+            << "|" << std::endl ;
+
+  //
+  // Replay, as fast as possible.
+  //
+  writer_t replay_writer ;
+  replay_t replay ;
+  if( !replay_writer.open( Replay_Name ) || !replay.open( path ) )
+  { std::cout << "|--[ ERROR :: Failed to open replay ( errno: " << replay_writer.last_error() << "/" << replay.last_error() << " ) ]" << std::endl ;
+    return 1 ;
+  }
+
+  uint64_t r_begin = time::Clock::now() ;
+  uint64_t r_count = replay.replay( replay_writer, 0.0 ) ;
+  uint64_t r_nanos = time::Clock::now() - r_begin ;
+
+  std::cout << "|--[ replay ]" << std::endl
+            << "|  |--[ replay msgs/sec  => " << per_second( r_count, r_nanos ) << " ]" << std::endl
+            << "|  |--[ replayed         => " << r_count << " ( gaps " << replay.gap_count() << " ) ]" << std::endl ;
+
+  replay.close() ;
+  replay_writer.close() ;
+  remove_file( std::string( "/dev/shm/" ) + Queue_Name ) ;
+  remove_file( std::string( "/dev/shm/" ) + Replay_Name ) ;
+  remove_file( path ) ;
+  remove_file( ipc::journal::index_path( path ) ) ;
+  return 0 ;
+}
@@ -3,6 +3,7 @@
 #include "fps_time/timer.h"
 #include "swmr_shm_queue.common.h"
 #include <iostream>
+#include <cstring>
 
 using namespace fps ;
 
@@ -26,11 +27,16 @@ main( int argc, char * argv[] )
   reader_t reader ;
   std::cout << "|--[ Constructed ]" << std::endl << "|" << std::endl ;
 
-  reader.open( examples::ipc::swmr::Queue_Name ) ;
+  // Pass '--wait' to park on the queue's futex between messages rather than 
+  // busy polling.
+  bool waitable = ( argc > 1 && std::strcmp( argv[ 1 ], "--wait" ) == 0 ) ;
+
+  reader.open( examples::ipc::swmr::Queue_Name, waitable ) ;
   
   std::cout << "|--[ CPU            => '" << examples::ipc::swmr::Reader_CPU << "' ]" << std::endl 
             << "|--[ open()         <= '" << examples::ipc::swmr::Queue_Name << "' ]" << std::endl 
             << "|--[ is_open()      => '" << (reader.is_open()?"true":"false") << "' ]" << std::endl 
+            << "|--[ is_waitable()  => '" << (reader.is_waitable()?"true":"false") << "' ]" << std::endl 
             << "|--[ shm.size()     => '" << reader.shared_memory().size() << "' ]" << std::endl
             << "|--[ shm_map.size() => '" << reader.mapped_memory().size() << "' ]" << std::endl
             << "|--[ last_error()   => '" << reader.last_error() << "' ]" << std::endl 
@@ -60,9 +66,13 @@ main( int argc, char * argv[] )
   while( !exit_flag ) 
   {
     uint64_t loop_ts = time::Clock::now() ;
-    if( reader.read( msg ) ) 
+    bool have_msg = waitable 
+                  ? reader.read_wait( msg, time::Nanos_Per_Second / 10 ) 
+                  : reader.read( msg ) 
+                  ;
+    if( have_msg ) 
     { ++read_count ;
-      msg.on_read( loop_ts ) ;
+      msg.on_read( waitable ? time::Clock::now() : loop_ts ) ;
       if( last_seq + 1 != msg.sequence() ) 
         ++mismatches ;
       last_seq   = msg.sequence() ;
@@ -75,6 +85,8 @@ main( int argc, char * argv[] )
       std::cout << "|--[ last sequence      => " << msg.sequence() << " ]" << std::endl ;
       std::cout << "|--[ last delta (nanos) => " << last_delta     << " ]" << std::endl ;
       std::cout << "|--[ mismatches         => " << mismatches     << " ]" << std::endl ;
+      std::cout << "|--[ lost_count         => " << reader.lost_count()    << " ]" << std::endl ;
+      std::cout << "|--[ overrun_count      => " << reader.overrun_count() << " ]" << std::endl ;
       console_timer.restart() ;
     }
     // else { ::usleep( 10 ) ; }
@@ -0,0 +1,26 @@
+#ifndef FPS__EXAMPLES__SPSC_QUEUE_COMMON__H
+#define FPS__EXAMPLES__SPSC_QUEUE_COMMON__H
+
+#include <stdint.h>
+
+namespace fps {
+namespace examples {
+namespace ipc      {
+namespace spsc     {
+
+  //---------------------------------------------------------------------------------------
+  static const uint32_t Capacity     = 1024 * 16 ;
+  static const char     Queue_Name[] = "fps.spsc_shm_queue.example" ;
+  static const uint32_t Reader_CPU   = 0 ;
+  static const uint32_t Writer_CPU   = Reader_CPU + 1 ;
+
+  //---------------------------------------------------------------------------------------
+  struct Message 
+  {
+    uint64_t seq_  ;
+    uint64_t w_ts_ ;
+  } ;
+
+}}}}
+
+#endif
@@ -0,0 +1,150 @@
+#include "fps_container/byte_allocator.h"
+#include <cstring>
+
+namespace fps       {
+namespace container {
+
+  //--------------------------------------------------------------------------------------
+  char *
+  HeapAllocator::allocate( uint32_t & size )
+  { return new char[ size ] ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  void
+  HeapAllocator::release( char * ptr, uint32_t )
+  { delete [] ptr ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  HeapAllocator &
+  HeapAllocator::instance()
+  { static HeapAllocator rv ;
+    return rv ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  SlabPool::SlabPool()
+    : oversize_       ( 0 )
+    , oversize_in_use_( 0 )
+  {
+    for( uint32_t idx = 0 ; idx < Class_Count ; ++idx )
+      std::memset( &classes_[ idx ].stats_, 0, sizeof( Stats ) ) ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  SlabPool::~SlabPool()
+  {
+    for( char * slab : slabs_ )
+      delete [] slab ;
+    slabs_.clear() ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  char *
+  SlabPool::allocate( uint32_t & size )
+  {
+    uint32_t class_idx = class_of( size ) ;
+    if( class_idx == Class_Count )
+    { std::lock_guard<std::mutex> guard( mutex_ ) ;
+      ++oversize_ ;
+      ++oversize_in_use_ ;
+      return new char[ size ] ;
+    }
+
+    std::lock_guard<std::mutex> guard( mutex_ ) ;
+    SizeClass & size_class = classes_[ class_idx ] ;
+    uint32_t    buf_size   = class_size( class_idx ) ;
+    size = buf_size ;
+
+    if( !size_class.free_.empty() )
+    { char * rv = size_class.free_.back() ;
+      size_class.free_.pop_back() ;
+      ++size_class.stats_.hits_ ;
+      ++size_class.stats_.in_use_ ;
+      --size_class.stats_.cached_ ;
+      return rv ;
+    }
+
+    // Carve a new slab into as many buffers as fit.  Classes bigger than a
+    // slab get a slab of their own.
+    uint32_t slab_size = ( buf_size > Slab_Size ) ? buf_size : Slab_Size ;
+    char *   slab      = new char[ slab_size ] ;
+    slabs_.push_back( slab ) ;
+
+    for( uint32_t offset = buf_size ; offset + buf_size <= slab_size ; offset += buf_size )
+    { size_class.free_.push_back( slab + offset ) ;
+      ++size_class.stats_.cached_ ;
+    }
+
+    ++size_class.stats_.misses_ ;
+    ++size_class.stats_.in_use_ ;
+    size_class.stats_.reserved_ += slab_size ;
+    return slab ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  void
+  SlabPool::release( char * ptr, uint32_t size )
+  {
+    if( ptr == NULL )
+      return ;
+
+    uint32_t class_idx = class_of( size ) ;
+    std::lock_guard<std::mutex> guard( mutex_ ) ;
+    if( class_idx == Class_Count )
+    { --oversize_in_use_ ;
+      delete [] ptr ;
+      return ;
+    }
+
+    SizeClass & size_class = classes_[ class_idx ] ;
+    size_class.free_.push_back( ptr ) ;
+    --size_class.stats_.in_use_ ;
+    ++size_class.stats_.cached_ ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  SlabPool::Stats
+  SlabPool::stats() const
+  {
+    Stats rv ;
+    std::memset( &rv, 0, sizeof( rv ) ) ;
+
+    std::lock_guard<std::mutex> guard( mutex_ ) ;
+    for( uint32_t idx = 0 ; idx < Class_Count ; ++idx )
+    { const Stats & cls = classes_[ idx ].stats_ ;
+      rv.hits_     += cls.hits_ ;
+      rv.misses_   += cls.misses_ ;
+      rv.in_use_   += cls.in_use_ ;
+      rv.cached_   += cls.cached_ ;
+      rv.reserved_ += cls.reserved_ ;
+    }
+    rv.oversize_  = oversize_ ;
+    rv.in_use_   += oversize_in_use_ ;
+    return rv ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  SlabPool::Stats
+  SlabPool::class_stats( uint32_t size ) const
+  {
+    Stats rv ;
+    std::memset( &rv, 0, sizeof( rv ) ) ;
+
+    uint32_t class_idx = class_of( size ) ;
+    if( class_idx == Class_Count )
+      return rv ;
+
+    std::lock_guard<std::mutex> guard( mutex_ ) ;
+    return classes_[ class_idx ].stats_ ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  SlabPool &
+  SlabPool::shared()
+  { static SlabPool rv ;
+    return rv ;
+  }
+
+}}
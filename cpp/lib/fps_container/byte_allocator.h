@@ -0,0 +1,139 @@
+#ifndef FPS__CONTAINER__BYTE_ALLOCATOR__H
+#define FPS__CONTAINER__BYTE_ALLOCATOR__H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+//
+// Buffer allocators for ByteQueue.
+//
+//   HeapAllocator : new[] / delete[].  The default.
+//   SlabPool      : Power of two size classes, carved from slabs and recycled
+//                   through per-class free lists.  One pool can be shared by
+//                   any number of queues ( and threads ), so a server w/
+//                   thousands of connections reuses the same few slabs
+//                   instead of churning the heap.  Slabs are only returned
+//                   to the heap when the pool is destroyed.
+//
+// An allocator must outlive every queue that uses it.
+//
+namespace fps       {
+namespace container {
+
+  //----------------------------------------------------------------------------------
+  class IByteAllocator
+  {
+  public :
+    inline virtual ~IByteAllocator() {}
+
+    //--------------------------------------------------------------------------------
+    // Return a buffer of at least 'size' bytes and set 'size' to the size
+    // actually allocated ( all of which the caller may use ).  release()
+    // takes that size back.
+    //--------------------------------------------------------------------------------
+    virtual char * allocate( uint32_t & size )            = 0 ;
+    virtual void   release ( char * ptr, uint32_t size )  = 0 ;
+  } ;
+
+  //----------------------------------------------------------------------------------
+  class HeapAllocator : public IByteAllocator
+  {
+  public :
+    virtual char * allocate( uint32_t & size ) ;
+    virtual void   release ( char * ptr, uint32_t size ) ;
+
+    //--------------------------------------------------------------------------------
+    static HeapAllocator & instance() ;
+  } ;
+
+  //----------------------------------------------------------------------------------
+  class SlabPool : public IByteAllocator
+  {
+  public :
+    //--------------------------------------------------------------------------------
+    static const uint32_t Min_Class_Shift = 8 ;    // 256 bytes
+    static const uint32_t Max_Class_Shift = 20 ;   // 1MB
+    static const uint32_t Class_Count     = Max_Class_Shift - Min_Class_Shift + 1 ;
+    static const uint32_t Slab_Size       = 256 * 1024 ;
+
+    //--------------------------------------------------------------------------------
+    // hits_     : Allocations served from a free list.
+    // misses_   : Allocations that needed a new slab.
+    // oversize_ : Allocations above the largest class, passed to the heap.
+    // in_use_   : Buffers currently allocated.
+    // cached_   : Buffers on the free lists.
+    // reserved_ : Bytes held in slabs.
+    //--------------------------------------------------------------------------------
+    struct Stats
+    {
+      uint64_t hits_     ;
+      uint64_t misses_   ;
+      uint64_t oversize_ ;
+      uint64_t in_use_   ;
+      uint64_t cached_   ;
+      uint64_t reserved_ ;
+    } ;
+
+  private :
+    //--------------------------------------------------------------------------------
+    struct SizeClass
+    {
+      std::vector<char *> free_ ;
+      Stats               stats_ ;
+    } ;
+
+    //--------------------------------------------------------------------------------
+    mutable std::mutex  mutex_ ;
+    SizeClass           classes_[ Class_Count ] ;
+    std::vector<char *> slabs_ ;
+    uint64_t            oversize_ ;
+    uint64_t            oversize_in_use_ ;
+
+    //--------------------------------------------------------------------------------
+    SlabPool( const SlabPool & ) ;
+    SlabPool & operator=( const SlabPool & ) ;
+
+  public :
+    //--------------------------------------------------------------------------------
+    SlabPool() ;
+    virtual ~SlabPool() ;
+
+    //--------------------------------------------------------------------------------
+    virtual char * allocate( uint32_t & size ) ;
+    virtual void   release ( char * ptr, uint32_t size ) ;
+
+    //--------------------------------------------------------------------------------
+    // Totals across all classes, and for the class of 'class_size' bytes
+    // ( a power of two between the smallest and largest class sizes ).
+    //--------------------------------------------------------------------------------
+    Stats stats() const ;
+    Stats class_stats( uint32_t class_size ) const ;
+
+    //--------------------------------------------------------------------------------
+    // Index of the smallest class that holds 'size' bytes, or Class_Count if
+    // there isn't one.
+    //--------------------------------------------------------------------------------
+    static
+    inline
+    uint32_t
+    class_of( uint32_t size )
+    {
+      if( size <= ( 1u << Min_Class_Shift ) )
+        return 0 ;
+      uint32_t shift = 32 - __builtin_clz( size - 1 ) ;
+      return ( shift > Max_Class_Shift ) ? Class_Count : shift - Min_Class_Shift ;
+    }
+
+    //--------------------------------------------------------------------------------
+    static inline uint32_t class_size( uint32_t class_idx ) { return 1u << ( class_idx + Min_Class_Shift ) ; }
+
+    //--------------------------------------------------------------------------------
+    // A pool shared by everything that asks for it.
+    //--------------------------------------------------------------------------------
+    static SlabPool & shared() ;
+  } ;
+
+}}
+
+#endif
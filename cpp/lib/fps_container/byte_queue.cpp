@@ -1,27 +1,114 @@
 #include "fps_container/byte_queue.h"
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 
 namespace fps  {
 namespace container {
 
+namespace {
+
+  //--------------------------------------------------------------------------------------
+  inline
+  uint32_t
+  page_round( uint32_t len )
+  {
+    static const uint32_t Page_Size = static_cast<uint32_t>( ::sysconf( _SC_PAGESIZE ) ) ;
+    return ( ( len + Page_Size - 1 ) / Page_Size ) * Page_Size ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Map 'size' bytes ( a page multiple ) of a memfd twice, back to back, and
+  // return the start of the first copy.  The second copy is the same memory,
+  // so writes past the end of the first land at its start.  On failure, 
+  // return NULL and set 'error'.
   //--------------------------------------------------------------------------------------
-  ByteQueue::ByteQueue( uint32_t capacity ) 
-    : data_    ( NULL ) 
-    , capacity_( 0 ) 
-    , r_ptr_   ( NULL )
-    , r_size_  ( 0 ) 
-    , w_size_  ( 0 )
-  {}
+  char *
+  map_mirrored( uint32_t size, int32_t & error )
+  {
+    int32_t fd = ::memfd_create( "fps.byte_queue", MFD_CLOEXEC ) ;
+    if( fd < 0 ) 
+    { error = errno ;
+      return NULL ;
+    }
+
+    // Reserve both halves first, so nothing else can be mapped between them.
+    char * rv = NULL ;
+    void * region = ::mmap( NULL, 2 * static_cast<size_t>( size ), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ;
+    if( ::ftruncate( fd, size ) != 0 || region == MAP_FAILED ) 
+      error = errno ;
+    else 
+    { char * lo = static_cast<char *>( region ) ;
+      if( ::mmap( lo,        size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ||
+          ::mmap( lo + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED   ) 
+        error = errno ;
+      else 
+        rv = lo ;
+    }
+
+    if( rv == NULL && region != MAP_FAILED ) 
+      ::munmap( region, 2 * static_cast<size_t>( size ) ) ;
+
+    // The mappings keep the memory alive.
+    ::close( fd ) ;
+    return rv ;
+  }
+}
+
+  //--------------------------------------------------------------------------------------
+  ByteQueue::ByteQueue( uint32_t capacity, queue_mode::Enum mode, IByteAllocator * allocator ) 
+    : data_        ( NULL ) 
+    , capacity_    ( 0 ) 
+    , r_ptr_       ( NULL )
+    , r_size_      ( 0 ) 
+    , w_size_      ( 0 )
+    , mode_        ( mode )
+    , error_       ( 0 )
+    , allocator_   ( allocator ? allocator : &HeapAllocator::instance() )
+    , min_capacity_( capacity )
+  {
+    reallocate( capacity ) ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  ByteQueue::ByteQueue( uint32_t capacity, IByteAllocator & allocator ) 
+    : data_        ( NULL ) 
+    , capacity_    ( 0 ) 
+    , r_ptr_       ( NULL )
+    , r_size_      ( 0 ) 
+    , w_size_      ( 0 )
+    , mode_        ( queue_mode::Heap )
+    , error_       ( 0 )
+    , allocator_   ( &allocator )
+    , min_capacity_( capacity )
+  {
+    reallocate( capacity ) ;
+  }
 
   //--------------------------------------------------------------------------------------
   ByteQueue::~ByteQueue()
   {
-    delete [] data_ ;
+    release() ;
     data_   = NULL ;
     w_size_ = 0 ;
     r_size_ = 0 ;
     r_ptr_  = NULL ;
   }
 
+  //--------------------------------------------------------------------------------------
+  void 
+  ByteQueue::release() 
+  {
+    if( data_ == NULL ) 
+      return ;
+
+    if( mode_ == queue_mode::Mirrored ) 
+      ::munmap( data_, 2 * static_cast<size_t>( capacity_ ) ) ;
+    else 
+      allocator_->release( data_, capacity_ ) ;
+  }
+
   //--------------------------------------------------------------------------------------
   void 
   ByteQueue::reallocate( uint32_t new_capacity ) 
@@ -32,25 +119,36 @@ namespace container {
     if( new_capacity < r_size_ ) 
       new_capacity = r_size_ ;
 
-    char * old_data = data_ ;
-    data_ = new char[ new_capacity ] ;
+    char *           new_data = NULL ;
+    queue_mode::Enum new_mode = mode_ ;
+    if( mode_ == queue_mode::Mirrored ) 
+    { new_capacity = page_round( new_capacity ) ;
+      new_data     = map_mirrored( new_capacity, error_ ) ;
+
+      // Carry on w/ a plain buffer rather than fail the insert.
+      if( new_data == NULL ) 
+        new_mode = queue_mode::Heap ;
+    }
+
+    if( new_data == NULL ) 
+      new_data = allocator_->allocate( new_capacity ) ;
 
     if( r_size_ ) 
-      std::memcpy( data_, r_ptr_, r_size_ ) ;
+      std::memcpy( new_data, r_ptr_, r_size_ ) ;
 
+    release() ;
+    data_     = new_data ;
+    mode_     = new_mode ;
     capacity_ = new_capacity ;
     r_ptr_    = data_ ;
     w_size_   = capacity_ - r_size_ ;
-  
-    if( old_data )
-      delete [] old_data ;
   }
 
   //--------------------------------------------------------------------------------------
   void 
   ByteQueue::reclaim() 
   { 
-    if( r_ptr_ == data_ || r_size_ == 0 ) 
+    if( r_ptr_ == data_ || r_size_ == 0 || mode_ == queue_mode::Mirrored ) 
       return ;
 
     ::memmove( data_, r_ptr_, r_size_ ) ;
@@ -71,11 +169,103 @@ namespace container {
 
     // Either reclaim the necessary space from the start of the underlying
     // buffer, or reallocate the buffer and copy the current unread content to the
-    // new location.
+    // new location.  ( In Mirrored mode all free space is already writable, 
+    // so we only get here when the queue needs to grow. )  Growth is at
+    // least double, so a stream of inserts reallocates a logarithmic number
+    // of times.
     return ( free_w_bytes >= min_w_bytes ) 
            ? reclaim()                              
-           : reallocate( capacity_ + min_w_bytes ) 
+           : reallocate( capacity_ + ( ( min_w_bytes > capacity_ ) ? min_w_bytes : capacity_ ) ) 
            ;
   }
-  
+
+  //--------------------------------------------------------------------------------------
+  void 
+  ByteQueue::shrink() 
+  {
+    uint32_t target = ( r_size_ > min_capacity_ ) ? r_size_ : min_capacity_ ;
+    if( target < capacity_ / 2 ) 
+      reallocate( target ) ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  void 
+  ByteQueue::insert( const struct iovec * iov, uint32_t count ) 
+  {
+    uint64_t total = 0 ;
+    for( uint32_t idx = 0 ; idx < count ; ++idx ) 
+      total += iov[ idx ].iov_len ;
+
+    reserve( static_cast<uint32_t>( total ) ) ;
+    for( uint32_t idx = 0 ; idx < count ; ++idx ) 
+    { ::memcpy( end(), iov[ idx ].iov_base, iov[ idx ].iov_len ) ;
+      r_size_ += iov[ idx ].iov_len ;
+      w_size_ -= iov[ idx ].iov_len ;
+    }
+  }
+
+  //--------------------------------------------------------------------------------------
+  int64_t 
+  ByteQueue::read_from( int32_t fd, uint32_t max_bytes ) 
+  {
+    if( max_bytes == 0 ) 
+      return 0 ;
+
+    // Move unread content to the front first, if that frees up space.
+    if( w_size_ < max_bytes ) 
+      reclaim() ;
+
+    char         spill[ Spill_Size ] ;
+    uint32_t     direct = ( w_size_ < max_bytes ) ? w_size_ : max_bytes ;
+    uint32_t     extra  = max_bytes - direct ;
+    struct iovec iov[ 2 ] ;
+    iov[ 0 ].iov_base = end() ;
+    iov[ 0 ].iov_len  = direct ;
+    iov[ 1 ].iov_base = spill ;
+    iov[ 1 ].iov_len  = ( extra < Spill_Size ) ? extra : Spill_Size ;
+
+    ssize_t rv ;
+    do 
+    { rv = ::readv( fd, iov, ( extra > 0 ) ? 2 : 1 ) ;
+    }
+    while( rv < 0 && errno == EINTR ) ;
+
+    if( rv < 0 ) 
+    { error_ = errno ;
+      return -1 ;
+    }
+
+    uint32_t in_place = ( static_cast<uint64_t>( rv ) < direct ) ? static_cast<uint32_t>( rv ) : direct ;
+    r_size_ += in_place ;
+    w_size_ -= in_place ;
+    if( rv > in_place ) 
+      insert( spill, static_cast<uint32_t>( rv - in_place ) ) ;
+
+    return rv ;
+  }
+
+  //--------------------------------------------------------------------------------------
+  int64_t 
+  ByteQueue::write_to( int32_t fd ) 
+  {
+    if( empty() ) 
+      return 0 ;
+
+    // Unread content is always contiguous ( in Mirrored mode too ), so 
+    // there's only ever one region to write.
+    ssize_t rv ;
+    do 
+    { rv = ::write( fd, r_ptr_, r_size_ ) ;
+    }
+    while( rv < 0 && errno == EINTR ) ;
+
+    if( rv < 0 ) 
+    { error_ = errno ;
+      return -1 ;
+    }
+
+    consume( static_cast<uint32_t>( rv ) ) ;
+    return rv ;
+  }
+
 }}
@@ -3,8 +3,10 @@
 
 #include <cstdint>
 #include <cstring>
+#include <sys/uio.h>
 
 #include "fps_container/extractors.h"
+#include "fps_container/byte_allocator.h"
 
 namespace fps  {
 namespace container {
@@ -62,6 +64,24 @@ namespace container {
     }
   } ;
 
+  //--------------------------------------------------------------------------------------
+  // Heap     : One buffer.  Unread data is moved back to the start of the
+  //            buffer ( or copied to a bigger one ) when the free space at 
+  //            the end runs out.
+  // Mirrored : The buffer's pages are mapped twice, back to back ( memfd ), 
+  //            so a range that runs off the end of the buffer continues at 
+  //            its start.  Reads and writes are always contiguous and unread 
+  //            data is only copied when the queue grows.  Capacity is 
+  //            rounded up to a multiple of the page size.
+  //--------------------------------------------------------------------------------------
+  namespace queue_mode
+  {
+    enum Enum
+    { Heap     = 0
+    , Mirrored = 1
+    } ;
+  }
+
   //--------------------------------------------------------------------------------------
   class ByteQueue
   {
@@ -69,21 +89,40 @@ namespace container {
     //------------------------------------------------------------------------
     static const uint32_t Default_Capacity = 4096 ;
     static const uint32_t Minimum_Capacity = 64 ;
+    static const uint32_t Spill_Size       = 64 * 1024 ;
 
     //------------------------------------------------------------------------
-    char *   data_     ;
-    uint32_t capacity_ ;
-    char *   r_ptr_    ;
-    uint32_t r_size_   ;
-    uint32_t w_size_   ;
+    char *           data_         ;
+    uint32_t         capacity_     ;
+    char *           r_ptr_        ;
+    uint32_t         r_size_       ;
+    uint32_t         w_size_       ;
+    queue_mode::Enum mode_         ;
+    int32_t          error_        ;
+    IByteAllocator * allocator_    ;
+    uint32_t         min_capacity_ ;
     
     //------------------------------------------------------------------------
     void reallocate( uint32_t new_capacity ) ;
     void reclaim() ;
+    void release() ;
+
+    //------------------------------------------------------------------------
+    inline void consume( uint32_t len ) ;
 
   public :
     //------------------------------------------------------------------------
-    explicit ByteQueue( uint32_t capacity = Default_Capacity ) ;
+    // The buffer is allocated up front, w/ at least 'capacity' bytes.  Heap
+    // mode buffers come from 'allocator' ( HeapAllocator::instance() if 
+    // NULL ), which must outlive the queue - see byte_allocator.h.  A 
+    // Mirrored queue maps its own memory.  If that fails, the queue falls 
+    // back to Heap mode and last_error() holds the errno value.
+    //------------------------------------------------------------------------
+    explicit ByteQueue( uint32_t         capacity  = Default_Capacity
+                      , queue_mode::Enum mode      = queue_mode::Heap 
+                      , IByteAllocator * allocator = NULL
+                      ) ;
+    ByteQueue( uint32_t capacity, IByteAllocator & allocator ) ;
     ~ByteQueue() ;
     
     //------------------------------------------------------------------------
@@ -99,6 +138,10 @@ namespace container {
     inline uint32_t size()       const { return r_size_ ; }
     inline bool     empty()      const { return size() == 0 ; }
 
+    //------------------------------------------------------------------------
+    inline queue_mode::Enum mode()       const { return mode_ ; }
+    inline int32_t          last_error() const { return error_ ; }
+
     //------------------------------------------------------------------------
     // Call reserve() to guarantee that the indicated number of bytes are 
     // available for insert() operations.  If sufficient space already 
@@ -110,6 +153,14 @@ namespace container {
     //------------------------------------------------------------------------
     void reserve( uint32_t min_w_bytes ) ;
 
+    //------------------------------------------------------------------------
+    // Call shrink() after a burst to give memory back : the buffer is 
+    // reallocated at the larger of the unread size and the capacity the 
+    // queue was constructed w/, if that's under half what it has now.  
+    // Like insert(), this invalidates ranges returned by extract().
+    //------------------------------------------------------------------------
+    void shrink() ;
+
     //------------------------------------------------------------------------
     // Call insert() to append data to the end of the queue.
     //------------------------------------------------------------------------
@@ -117,6 +168,27 @@ namespace container {
 
     //------------------------------------------------------------------------
     template<typename T_Inserter> void insert( const T_Inserter & ) ;
+
+    //------------------------------------------------------------------------
+    // Append the contents of 'count' iovecs w/ a single reserve().
+    //------------------------------------------------------------------------
+    void insert( const struct iovec * iov, uint32_t count ) ;
+
+    //------------------------------------------------------------------------
+    // Call read_from() to read up to 'max_bytes' from 'fd' straight into the
+    // queue, and write_to() to write the unread content to 'fd' and drop 
+    // what was written.  Both return the number of bytes moved ( 0 at end 
+    // of file for read_from() ), or -1 w/ last_error() set to the errno 
+    // value ( EAGAIN when a non-blocking fd isn't ready ).
+    //
+    // read_from() doesn't grow the queue up front.  It reads into the free 
+    // space at the end of the queue and any overflow into a stack buffer 
+    // ( Spill_Size bytes ), which is then appended, so the queue only grows
+    // by what actually arrived.  One call reads at most Spill_Size bytes 
+    // more than the current free space.
+    //------------------------------------------------------------------------
+    int64_t read_from( int32_t fd, uint32_t max_bytes ) ;
+    int64_t write_to ( int32_t fd ) ;
     
     //------------------------------------------------------------------------
     // Call extract() to remove all data from the queue.  The return value
@@ -136,6 +208,16 @@ namespace container {
     ByteRange 
     extract( const T & tokenizer ) ;
 
+    //------------------------------------------------------------------------
+    // Call extract_all() to remove every complete record at once.  The 
+    // extractor's get_all() finds the record boundaries in batches, and 
+    // 'visitor' is called w/ a ByteRange for each record, in order.  Partial
+    // records are left in the queue.  Returns the number of records removed.
+    //------------------------------------------------------------------------
+    template<typename T_Extractor, typename T_Visitor>
+    uint32_t
+    extract_all( T_Visitor && visitor ) ;
+
     //------------------------------------------------------------------------
     // Call clear to invalidate all unread data and reset size_ to zero.
     //------------------------------------------------------------------------
@@ -189,14 +271,8 @@ namespace container {
       return rv ;
 
     rv.assign( r_ptr_, static_cast<uint32_t>( r_end - r_ptr_ ) ) ;
-    
-    if( rv.size() < r_size_ )
-    { r_ptr_  += rv.size() ;
-      r_size_ -= rv.size() ;
-    }
-    else 
-      clear() ;
 
+    consume( rv.size() ) ;
     return rv ;
   }
 
@@ -214,17 +290,62 @@ namespace container {
       return rv ;
 
     rv.assign( r_ptr_, static_cast<uint32_t>( r_end - r_ptr_ ) ) ;
-    
-    if( rv.size() < r_size_ )
-    { r_ptr_  += rv.size() ;
-      r_size_ -= rv.size() ;
-    }
-    else 
-      clear() ;
 
+    consume( rv.size() ) ;
+    return rv ;
+  }
+
+  //-----------------------------------------------------------------------
+  template<typename T_Extractor, typename T_Visitor>
+  uint32_t
+  ByteQueue::extract_all( T_Visitor && visitor )
+  {
+    static const uint32_t Batch_Size = 64 ;
+
+    uint32_t rv = 0 ;
+    uint32_t ends[ Batch_Size ] ;
+    while( !empty() ) 
+    {
+      uint32_t count = T_Extractor::get_all( r_ptr_, r_size_, ends, Batch_Size ) ;
+      if( count == 0 ) 
+        break ;
+
+      uint32_t offset = 0 ;
+      for( uint32_t idx = 0 ; idx < count ; ++idx )
+      { visitor( ByteRange( r_ptr_ + offset, ends[ idx ] - offset ) ) ;
+        offset = ends[ idx ] ;
+      }
+      rv += count ;
+      consume( offset ) ;
+
+      if( count < Batch_Size ) 
+        break ;
+    }
     return rv ;
   }
 
+  //-----------------------------------------------------------------------
+  // Drop 'len' bytes from the front of the queue.  In Mirrored mode they
+  // become free space immediately, and r_ptr_ is kept in the first copy
+  // of the buffer.
+  //-----------------------------------------------------------------------
+  void
+  ByteQueue::consume( uint32_t len )
+  {
+    if( len >= r_size_ ) 
+    { clear() ;
+      return ;
+    }
+
+    r_ptr_  += len ;
+    r_size_ -= len ;
+    if( mode_ == queue_mode::Mirrored ) 
+    { w_size_ += len ;
+      if( r_ptr_ >= data_ + capacity_ ) 
+        r_ptr_ -= capacity_ ;
+    }
+  }
+
   //-----------------------------------------------------------------------
   void 
   ByteQueue::clear() 
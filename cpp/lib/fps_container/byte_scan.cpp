@@ -0,0 +1,278 @@
+#include "fps_container/byte_scan.h"
+#include <cstring>
+
+#if defined( __x86_64__ )
+#include <immintrin.h>
+#endif
+
+namespace fps       {
+namespace container {
+namespace scan      {
+
+namespace {
+
+  //----------------------------------------------------------------------------------
+  // Byte at a time, w/ libc doing the heavy lifting where it can.  Also used
+  // to finish off buffers too short for the vector flavors.
+  //----------------------------------------------------------------------------------
+  namespace scalar
+  {
+    //--------------------------------------------------------------------------------
+    const char *
+    find_byte( const char * begin, const char * end, char c )
+    { return ( begin < end ) ? static_cast<const char *>( ::memchr( begin, c, end - begin ) ) : NULL ;
+    }
+
+    //--------------------------------------------------------------------------------
+    const char *
+    find_any( const char * begin, const char * end, const char * set, uint32_t set_len )
+    {
+      bool in_set[ 256 ] = { false } ;
+      for( uint32_t idx = 0 ; idx < set_len ; ++idx )
+        in_set[ static_cast<uint8_t>( set[ idx ] ) ] = true ;
+
+      for( ; begin < end ; ++begin )
+      { if( in_set[ static_cast<uint8_t>( *begin ) ] )
+          return begin ;
+      }
+      return NULL ;
+    }
+
+    //--------------------------------------------------------------------------------
+    const char *
+    find_seq( const char * begin, const char * end, const char * seq, uint32_t seq_len )
+    { return ( seq_len > 0 && end - begin >= static_cast<int64_t>( seq_len ) )
+             ? static_cast<const char *>( ::memmem( begin, end - begin, seq, seq_len ) )
+             : NULL
+             ;
+    }
+
+    //--------------------------------------------------------------------------------
+    uint32_t
+    find_all_byte( const char * begin, const char * end, char c, uint32_t * offsets, uint32_t max_count )
+    {
+      uint32_t rv = 0 ;
+      for( const char * ptr = begin ; rv < max_count ; ++ptr )
+      { ptr = find_byte( ptr, end, c ) ;
+        if( ptr == NULL )
+          break ;
+        offsets[ rv++ ] = static_cast<uint32_t>( ptr - begin ) ;
+      }
+      return rv ;
+    }
+
+    //--------------------------------------------------------------------------------
+    uint32_t
+    find_all_any( const char * begin
+                , const char * end
+                , const char * set
+                , uint32_t     set_len
+                , uint32_t   * offsets
+                , uint32_t     max_count
+                )
+    {
+      bool in_set[ 256 ] = { false } ;
+      for( uint32_t idx = 0 ; idx < set_len ; ++idx )
+        in_set[ static_cast<uint8_t>( set[ idx ] ) ] = true ;
+
+      uint32_t rv = 0 ;
+      for( const char * ptr = begin ; ptr < end && rv < max_count ; ++ptr )
+      { if( in_set[ static_cast<uint8_t>( *ptr ) ] )
+          offsets[ rv++ ] = static_cast<uint32_t>( ptr - begin ) ;
+      }
+      return rv ;
+    }
+
+    //--------------------------------------------------------------------------------
+    uint32_t
+    find_all_seq( const char * begin
+                , const char * end
+                , const char * seq
+                , uint32_t     seq_len
+                , uint32_t   * offsets
+                , uint32_t     max_count
+                )
+    {
+      uint32_t rv = 0 ;
+      for( const char * ptr = begin ; rv < max_count ; ptr += seq_len )
+      { ptr = find_seq( ptr, end, seq, seq_len ) ;
+        if( ptr == NULL )
+          break ;
+        offsets[ rv++ ] = static_cast<uint32_t>( ptr - begin ) ;
+      }
+      return rv ;
+    }
+  }
+
+#if defined( __x86_64__ )
+
+  //----------------------------------------------------------------------------------
+  // The vector flavors are compiled for their own instruction sets, whatever
+  // the target of the rest of the build, and only called once the cpu has
+  // been checked.
+  //----------------------------------------------------------------------------------
+#pragma GCC push_options
+#pragma GCC target( "sse2" )
+  namespace sse2
+  {
+    struct V
+    {
+      typedef __m128i vec ;
+      static const uint32_t Width = 16 ;
+
+      static inline vec      load ( const char * ptr ) { return _mm_loadu_si128( reinterpret_cast<const __m128i *>( ptr ) ) ; }
+      static inline vec      splat( char c )           { return _mm_set1_epi8( c ) ; }
+      static inline vec      eq   ( vec lhs, vec rhs ) { return _mm_cmpeq_epi8( lhs, rhs ) ; }
+      static inline vec      or_  ( vec lhs, vec rhs ) { return _mm_or_si128( lhs, rhs ) ; }
+      static inline vec      and_ ( vec lhs, vec rhs ) { return _mm_and_si128( lhs, rhs ) ; }
+      static inline uint32_t mask ( vec bytes )        { return static_cast<uint32_t>( _mm_movemask_epi8( bytes ) ) ; }
+    } ;
+
+#include "fps_container/detail/byte_scan_impl.h"
+  }
+#pragma GCC pop_options
+
+  //----------------------------------------------------------------------------------
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+  namespace avx2
+  {
+    struct V
+    {
+      typedef __m256i vec ;
+      static const uint32_t Width = 32 ;
+
+      static inline vec      load ( const char * ptr ) { return _mm256_loadu_si256( reinterpret_cast<const __m256i *>( ptr ) ) ; }
+      static inline vec      splat( char c )           { return _mm256_set1_epi8( c ) ; }
+      static inline vec      eq   ( vec lhs, vec rhs ) { return _mm256_cmpeq_epi8( lhs, rhs ) ; }
+      static inline vec      or_  ( vec lhs, vec rhs ) { return _mm256_or_si256( lhs, rhs ) ; }
+      static inline vec      and_ ( vec lhs, vec rhs ) { return _mm256_and_si256( lhs, rhs ) ; }
+      static inline uint32_t mask ( vec bytes )        { return static_cast<uint32_t>( _mm256_movemask_epi8( bytes ) ) ; }
+    } ;
+
+#include "fps_container/detail/byte_scan_impl.h"
+  }
+#pragma GCC pop_options
+
+#endif
+
+  //----------------------------------------------------------------------------------
+  const detail::Ops Scalar_Ops =
+  { scalar::find_byte
+  , scalar::find_any
+  , scalar::find_seq
+  , scalar::find_all_byte
+  , scalar::find_all_any
+  , scalar::find_all_seq
+  } ;
+
+#if defined( __x86_64__ )
+
+  //----------------------------------------------------------------------------------
+  const detail::Ops SSE2_Ops =
+  { sse2::find_byte
+  , sse2::find_any
+  , sse2::find_seq
+  , sse2::find_all_byte
+  , sse2::find_all_any
+  , sse2::find_all_seq
+  } ;
+
+  //----------------------------------------------------------------------------------
+  const detail::Ops AVX2_Ops =
+  { avx2::find_byte
+  , avx2::find_any
+  , avx2::find_seq
+  , avx2::find_all_byte
+  , avx2::find_all_any
+  , avx2::find_all_seq
+  } ;
+
+#endif
+
+  //----------------------------------------------------------------------------------
+  const detail::Ops *
+  ops_for( level::Enum lvl )
+  {
+#if defined( __x86_64__ )
+    switch( lvl )
+    { case level::AVX2 : return &AVX2_Ops ;
+      case level::SSE2 : return &SSE2_Ops ;
+      default          : break ;
+    }
+#endif
+    return &Scalar_Ops ;
+  }
+
+  //----------------------------------------------------------------------------------
+  level::Enum
+  detect_level()
+  {
+#if defined( __x86_64__ )
+    __builtin_cpu_init() ;
+    if( __builtin_cpu_supports( "avx2" ) )
+      return level::AVX2 ;
+    if( __builtin_cpu_supports( "sse2" ) )
+      return level::SSE2 ;
+#endif
+    return level::Scalar ;
+  }
+
+  //----------------------------------------------------------------------------------
+  level::Enum active = level::Scalar ;
+}
+
+namespace detail {
+
+  //----------------------------------------------------------------------------------
+  // Constant initialized, so searches made before the pick below still work.
+  //----------------------------------------------------------------------------------
+  const Ops * active_ops = &Scalar_Ops ;
+
+}
+
+namespace {
+
+  //----------------------------------------------------------------------------------
+  const bool Level_Picked = set_level( best_level() ) ;
+}
+
+  //----------------------------------------------------------------------------------
+  level::Enum
+  best_level()
+  {
+    static const level::Enum rv = detect_level() ;
+    return rv ;
+  }
+
+  //----------------------------------------------------------------------------------
+  level::Enum
+  active_level()
+  { return active ;
+  }
+
+  //----------------------------------------------------------------------------------
+  bool
+  set_level( level::Enum lvl )
+  {
+    if( lvl > best_level() )
+      return false ;
+
+    detail::active_ops = ops_for( lvl ) ;
+    active             = lvl ;
+    return true ;
+  }
+
+  //----------------------------------------------------------------------------------
+  const char *
+  level_name( level::Enum lvl )
+  {
+    switch( lvl )
+    { case level::Scalar : return "scalar" ;
+      case level::SSE2   : return "sse2" ;
+      case level::AVX2   : return "avx2" ;
+    }
+    return "unknown" ;
+  }
+
+}}}
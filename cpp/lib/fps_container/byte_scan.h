@@ -0,0 +1,129 @@
+#ifndef FPS__CONTAINER__BYTE_SCAN__H
+#define FPS__CONTAINER__BYTE_SCAN__H
+
+#include <cstdint>
+
+//
+// Vectorized delimiter search, used by the ByteQueue extractors.
+//
+// Each search comes in three flavors ( scalar, SSE2 and AVX2 ).  The best one
+// the cpu supports is picked at startup, so binaries built for an older
+// target still use AVX2 where it's available.  Searches called from static
+// initializers that run before the pick use the scalar flavor.
+//
+//   find_byte( c )         : First 'c'.
+//   find_any ( set, n )    : First byte that's any of the 'n' bytes in 'set'
+//                            ( n <= Max_Set_Size ).  Costs grow w/ 'n'.
+//   find_seq ( seq, n )    : First occurrence of the 'n' byte sequence 'seq'.
+//
+// The find_all_...() versions record the offset of every match in
+// [ begin, end ) ( up to 'max_count' of them ), so a buffer of records can be
+// split in one pass.  Sequence matches don't overlap.
+//
+namespace fps       {
+namespace container {
+namespace scan      {
+
+  //----------------------------------------------------------------------------------
+  static const uint32_t Max_Set_Size = 16 ;
+
+  //----------------------------------------------------------------------------------
+  namespace level
+  {
+    enum Enum
+    { Scalar = 0
+    , SSE2   = 1
+    , AVX2   = 2
+    } ;
+  }
+
+  //----------------------------------------------------------------------------------
+  // The best level this cpu supports, the level in use, and a way to force a
+  // lower one ( for tests and benchmarks - not thread safe ).  set_level()
+  // returns false if the cpu doesn't support 'lvl'.
+  //----------------------------------------------------------------------------------
+  level::Enum  best_level() ;
+  level::Enum  active_level() ;
+  bool         set_level( level::Enum lvl ) ;
+  const char * level_name( level::Enum lvl ) ;
+
+namespace detail {
+
+  //----------------------------------------------------------------------------------
+  struct Ops
+  {
+    const char * ( *find_byte )    ( const char *, const char *, char ) ;
+    const char * ( *find_any )     ( const char *, const char *, const char *, uint32_t ) ;
+    const char * ( *find_seq )     ( const char *, const char *, const char *, uint32_t ) ;
+    uint32_t     ( *find_all_byte )( const char *, const char *, char, uint32_t *, uint32_t ) ;
+    uint32_t     ( *find_all_any ) ( const char *, const char *, const char *, uint32_t, uint32_t *, uint32_t ) ;
+    uint32_t     ( *find_all_seq ) ( const char *, const char *, const char *, uint32_t, uint32_t *, uint32_t ) ;
+  } ;
+
+  //----------------------------------------------------------------------------------
+  extern const Ops * active_ops ;
+
+}
+
+  //----------------------------------------------------------------------------------
+  // Return a pointer to the first match in [ begin, end ), or NULL.
+  //----------------------------------------------------------------------------------
+  inline
+  const char *
+  find_byte( const char * begin, const char * end, char c )
+  { return detail::active_ops->find_byte( begin, end, c ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  inline
+  const char *
+  find_any( const char * begin, const char * end, const char * set, uint32_t set_len )
+  { return detail::active_ops->find_any( begin, end, set, set_len ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  inline
+  const char *
+  find_seq( const char * begin, const char * end, const char * seq, uint32_t seq_len )
+  { return detail::active_ops->find_seq( begin, end, seq, seq_len ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  // Store the offset ( from 'begin' ) of up to 'max_count' matches in
+  // 'offsets', and return how many were found.
+  //----------------------------------------------------------------------------------
+  inline
+  uint32_t
+  find_all_byte( const char * begin, const char * end, char c, uint32_t * offsets, uint32_t max_count )
+  { return detail::active_ops->find_all_byte( begin, end, c, offsets, max_count ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  inline
+  uint32_t
+  find_all_any( const char * begin
+              , const char * end
+              , const char * set
+              , uint32_t     set_len
+              , uint32_t   * offsets
+              , uint32_t     max_count
+              )
+  { return detail::active_ops->find_all_any( begin, end, set, set_len, offsets, max_count ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  inline
+  uint32_t
+  find_all_seq( const char * begin
+              , const char * end
+              , const char * seq
+              , uint32_t     seq_len
+              , uint32_t   * offsets
+              , uint32_t     max_count
+              )
+  { return detail::active_ops->find_all_seq( begin, end, seq, seq_len, offsets, max_count ) ;
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,266 @@
+//
+// No include guard : byte_scan.cpp includes this once per instruction set,
+// inside a namespace that defines 'V', the vector type's traits :
+//
+//   vec                  The vector type.
+//   Width                Bytes per vector.
+//   load ( p )           Unaligned load of Width bytes at 'p'.
+//   splat( c )           Every byte set to 'c'.
+//   eq   ( a, b )        Bytewise equality.
+//   or_  ( a, b )
+//   and_ ( a, b )
+//   mask ( a )           One bit per byte, the top bit of each.
+//
+// and a 'scalar' namespace to finish off short buffers.
+//
+
+  //----------------------------------------------------------------------------------
+  typedef V::vec vec ;
+
+  //----------------------------------------------------------------------------------
+  inline
+  uint32_t
+  lowest( uint32_t bits )
+  { return __builtin_ctz( bits ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  struct ByteMask
+  {
+    vec needle_ ;
+
+    inline explicit ByteMask( char c ) : needle_( V::splat( c ) ) {}
+
+    inline uint32_t operator()( const char * ptr ) const { return V::mask( V::eq( V::load( ptr ), needle_ ) ) ; }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  struct AnyMask
+  {
+    vec      needles_[ Max_Set_Size ] ;
+    uint32_t count_ ;
+
+    inline
+    AnyMask( const char * set, uint32_t set_len )
+      : count_( set_len )
+    { for( uint32_t idx = 0 ; idx < set_len ; ++idx )
+        needles_[ idx ] = V::splat( set[ idx ] ) ;
+    }
+
+    inline
+    uint32_t
+    operator()( const char * ptr ) const
+    { vec bytes = V::load( ptr ) ;
+      vec hits  = V::eq( bytes, needles_[ 0 ] ) ;
+      for( uint32_t idx = 1 ; idx < count_ ; ++idx )
+        hits = V::or_( hits, V::eq( bytes, needles_[ idx ] ) ) ;
+      return V::mask( hits ) ;
+    }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  // Positions whose first, second and last bytes match the sequence's.  The
+  // second byte weeds out most false candidates when the first and last are
+  // common ( e.g. FIX's <SOH>10=, where <SOH>nn= starts every other field ).
+  // Candidates still need any middle bytes compared.  Reads seq_len - 1
+  // bytes past the block.  Requires seq_len >= 2.
+  //----------------------------------------------------------------------------------
+  struct SeqMask
+  {
+    vec      first_ ;
+    vec      second_ ;
+    vec      last_ ;
+    uint32_t len_ ;
+
+    inline
+    SeqMask( const char * seq, uint32_t seq_len )
+      : first_ ( V::splat( seq[ 0 ] ) )
+      , second_( V::splat( seq[ 1 ] ) )
+      , last_  ( V::splat( seq[ seq_len - 1 ] ) )
+      , len_   ( seq_len )
+    {}
+
+    inline
+    uint32_t
+    operator()( const char * ptr ) const
+    { vec hits = V::and_( V::eq( V::load( ptr ), first_ ), V::eq( V::load( ptr + 1 ), second_ ) ) ;
+      if( len_ > 2 )
+        hits = V::and_( hits, V::eq( V::load( ptr + len_ - 1 ), last_ ) ) ;
+      return V::mask( hits ) ;
+    }
+
+    inline
+    bool
+    verify( const char * match, const char * seq ) const
+    { return len_ <= 3 || std::memcmp( match + 2, seq + 2, len_ - 3 ) == 0 ;
+    }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  // Bits of a mask of the Width bytes ending at 'end' that fall at or after
+  // 'ptr'.  Finishes a buffer w/ one overlapping load rather than a byte loop.
+  //----------------------------------------------------------------------------------
+  template<typename T_Mask>
+  inline
+  uint32_t
+  tail_mask( const T_Mask & bits, const char * ptr, const char * end )
+  { return bits( end - V::Width ) >> ( V::Width - ( end - ptr ) ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  template<typename T_Mask>
+  inline
+  const char *
+  find_first( const char * begin, const char * end, const T_Mask & bits )
+  {
+    const char * ptr = begin ;
+    for( ; end - ptr >= static_cast<int64_t>( 2 * V::Width ) ; ptr += 2 * V::Width )
+    { uint32_t lo = bits( ptr ) ;
+      if( lo )
+        return ptr + lowest( lo ) ;
+      uint32_t hi = bits( ptr + V::Width ) ;
+      if( hi )
+        return ptr + V::Width + lowest( hi ) ;
+    }
+
+    if( end - ptr >= static_cast<int64_t>( V::Width ) )
+    { uint32_t lo = bits( ptr ) ;
+      if( lo )
+        return ptr + lowest( lo ) ;
+      ptr += V::Width ;
+    }
+
+    if( ptr == end )
+      return NULL ;
+
+    uint32_t tail = tail_mask( bits, ptr, end ) ;
+    return tail ? ptr + lowest( tail ) : NULL ;
+  }
+
+  //----------------------------------------------------------------------------------
+  template<typename T_Mask>
+  inline
+  uint32_t
+  find_every( const char * begin, const char * end, const T_Mask & bits, uint32_t * offsets, uint32_t max_count )
+  {
+    uint32_t     rv  = 0 ;
+    const char * ptr = begin ;
+    for( ; end - ptr >= static_cast<int64_t>( V::Width ) ; ptr += V::Width )
+    { for( uint32_t hits = bits( ptr ) ; hits != 0 ; hits &= hits - 1 )
+      { offsets[ rv ] = static_cast<uint32_t>( ptr - begin ) + lowest( hits ) ;
+        if( ++rv == max_count )
+          return rv ;
+      }
+    }
+
+    if( ptr != end )
+    { for( uint32_t hits = tail_mask( bits, ptr, end ) ; hits != 0 ; hits &= hits - 1 )
+      { offsets[ rv ] = static_cast<uint32_t>( ptr - begin ) + lowest( hits ) ;
+        if( ++rv == max_count )
+          return rv ;
+      }
+    }
+    return rv ;
+  }
+
+  //----------------------------------------------------------------------------------
+  const char *
+  find_byte( const char * begin, const char * end, char c )
+  {
+    return ( end - begin < static_cast<int64_t>( V::Width ) )
+           ? scalar::find_byte( begin, end, c )
+           : find_first( begin, end, ByteMask( c ) )
+           ;
+  }
+
+  //----------------------------------------------------------------------------------
+  const char *
+  find_any( const char * begin, const char * end, const char * set, uint32_t set_len )
+  {
+    return ( end - begin < static_cast<int64_t>( V::Width ) || set_len == 0 || set_len > Max_Set_Size )
+           ? scalar::find_any( begin, end, set, set_len )
+           : find_first( begin, end, AnyMask( set, set_len ) )
+           ;
+  }
+
+  //----------------------------------------------------------------------------------
+  uint32_t
+  find_all_byte( const char * begin, const char * end, char c, uint32_t * offsets, uint32_t max_count )
+  {
+    return ( end - begin < static_cast<int64_t>( V::Width ) || max_count == 0 )
+           ? scalar::find_all_byte( begin, end, c, offsets, max_count )
+           : find_every( begin, end, ByteMask( c ), offsets, max_count )
+           ;
+  }
+
+  //----------------------------------------------------------------------------------
+  uint32_t
+  find_all_any( const char * begin
+              , const char * end
+              , const char * set
+              , uint32_t     set_len
+              , uint32_t   * offsets
+              , uint32_t     max_count
+              )
+  {
+    return ( end - begin < static_cast<int64_t>( V::Width ) || set_len == 0 || set_len > Max_Set_Size || max_count == 0 )
+           ? scalar::find_all_any( begin, end, set, set_len, offsets, max_count )
+           : find_every( begin, end, AnyMask( set, set_len ), offsets, max_count )
+           ;
+  }
+
+  //----------------------------------------------------------------------------------
+  const char *
+  find_seq( const char * begin, const char * end, const char * seq, uint32_t seq_len )
+  {
+    if( seq_len < 2 )
+      return ( seq_len == 1 ) ? find_byte( begin, end, seq[ 0 ] ) : NULL ;
+
+    SeqMask      bits( seq, seq_len ) ;
+    const char * ptr = begin ;
+    for( ; end - ptr >= static_cast<int64_t>( V::Width + seq_len - 1 ) ; ptr += V::Width )
+    { for( uint32_t hits = bits( ptr ) ; hits != 0 ; hits &= hits - 1 )
+      { const char * match = ptr + lowest( hits ) ;
+        if( bits.verify( match, seq ) )
+          return match ;
+      }
+    }
+    return scalar::find_seq( ptr, end, seq, seq_len ) ;
+  }
+
+  //----------------------------------------------------------------------------------
+  uint32_t
+  find_all_seq( const char * begin
+              , const char * end
+              , const char * seq
+              , uint32_t     seq_len
+              , uint32_t   * offsets
+              , uint32_t     max_count
+              )
+  {
+    if( seq_len < 2 || max_count == 0 )
+      return scalar::find_all_seq( begin, end, seq, seq_len, offsets, max_count ) ;
+
+    SeqMask      bits( seq, seq_len ) ;
+    uint32_t     rv   = 0 ;
+    const char * next = begin ;   // Matches may not overlap.
+    const char * ptr  = begin ;
+    for( ; end - ptr >= static_cast<int64_t>( V::Width + seq_len - 1 ) ; ptr += V::Width )
+    { for( uint32_t hits = bits( ptr ) ; hits != 0 ; hits &= hits - 1 )
+      { const char * match = ptr + lowest( hits ) ;
+        if( match >= next && bits.verify( match, seq ) )
+        { offsets[ rv ] = static_cast<uint32_t>( match - begin ) ;
+          if( ++rv == max_count )
+            return rv ;
+          next = match + seq_len ;
+        }
+      }
+    }
+
+    if( next > ptr )
+      ptr = next ;
+    uint32_t count = scalar::find_all_seq( ptr, end, seq, seq_len, offsets + rv, max_count - rv ) ;
+    for( uint32_t idx = rv ; idx < rv + count ; ++idx )
+      offsets[ idx ] += static_cast<uint32_t>( ptr - begin ) ;
+    return rv + count ;
+  }
@@ -2,45 +2,230 @@
 #define FPS__CONTAINER__EXTRACT__H
 
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "fps_container/byte_scan.h"
+#include "fps_container/options.h"
+#include "fps_util/bswap.h"
 
 namespace fps  {
 namespace container {
 namespace extract {
 
   //----------------------------------------------------------------------------------
-  struct ByNewline 
+  // Delimited records.  get() returns the end of the first record ( one past
+  // its delimiter ), or NULL if there isn't a complete one.  get_all() stores
+  // the end offset of up to 'max_count' records in 'ends' and returns how
+  // many it found, so a buffer full of records can be split in one pass.
+  //----------------------------------------------------------------------------------
+  template<char T_Delimiter>
+  struct ByDelimiter
+  {
+    //--------------------------------------------------------
+    static
+    inline
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      if( begin == NULL || len == 0 )
+        return NULL ;
+
+      const char * rv = scan::find_byte( begin, begin + len, T_Delimiter ) ;
+      return ( rv == NULL ) ? NULL : rv + 1 ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      if( begin == NULL || len == 0 )
+        return 0 ;
+
+      uint32_t rv = scan::find_all_byte( begin, begin + len, T_Delimiter, ends, max_count ) ;
+      for( uint32_t idx = 0 ; idx < rv ; ++idx )
+        ++ends[ idx ] ;
+      return rv ;
+    }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  struct ByNewline : public ByDelimiter<'\n'> {} ;
+
+  //----------------------------------------------------------------------------------
+  // Records ending in any one of the T_Delimiters ( at most scan::Max_Set_Size ).
+  //----------------------------------------------------------------------------------
+  template<char... T_Delimiters>
+  struct ByAnyOf
+  {
+    static_assert( sizeof...( T_Delimiters ) > 0 && sizeof...( T_Delimiters ) <= scan::Max_Set_Size
+                 , "ByAnyOf<> takes between 1 and scan::Max_Set_Size delimiters"
+                 ) ;
+
+    static constexpr char     Set[]   = { T_Delimiters... } ;
+    static constexpr uint32_t Set_Len = sizeof...( T_Delimiters ) ;
+
+    //--------------------------------------------------------
+    static
+    inline
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      if( begin == NULL || len == 0 )
+        return NULL ;
+
+      const char * rv = scan::find_any( begin, begin + len, Set, Set_Len ) ;
+      return ( rv == NULL ) ? NULL : rv + 1 ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      if( begin == NULL || len == 0 )
+        return 0 ;
+
+      uint32_t rv = scan::find_all_any( begin, begin + len, Set, Set_Len, ends, max_count ) ;
+      for( uint32_t idx = 0 ; idx < rv ; ++idx )
+        ++ends[ idx ] ;
+      return rv ;
+    }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  // Records ending in the multi-byte delimiter T_Sequence ( e.g. "\r\n" ).
+  //----------------------------------------------------------------------------------
+  template<char... T_Sequence>
+  struct BySequence
   {
+    static_assert( sizeof...( T_Sequence ) > 0, "BySequence<> needs at least one byte" ) ;
+
+    static constexpr char     Seq[]   = { T_Sequence... } ;
+    static constexpr uint32_t Seq_Len = sizeof...( T_Sequence ) ;
+
+    //--------------------------------------------------------
     static
+    inline
     const char *
     get( const char * begin, uint32_t len )
     {
       if( begin == NULL || len == 0 )
         return NULL ;
 
+      const char * rv = scan::find_seq( begin, begin + len, Seq, Seq_Len ) ;
+      return ( rv == NULL ) ? NULL : rv + Seq_Len ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      if( begin == NULL || len == 0 )
+        return 0 ;
+
+      uint32_t rv = scan::find_all_seq( begin, begin + len, Seq, Seq_Len, ends, max_count ) ;
+      for( uint32_t idx = 0 ; idx < rv ; ++idx )
+        ends[ idx ] += Seq_Len ;
+      return rv ;
+    }
+  } ;
+
+  //----------------------------------------------------------------------------------
+  // FIX messages, which end w/ a checksum field : <SOH>10=nnn<SOH>.  We look
+  // for the <SOH>10= trailer, then the SOH that closes it.
+  //----------------------------------------------------------------------------------
+  struct ByFixMessage
+  {
+    static const char     SOH         = '\x01' ;
+    static const uint32_t Trailer_Len = 4 ;
+
+    //--------------------------------------------------------
+    static
+    inline
+    const char *
+    trailer()
+    { return "\x01" "10=" ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      if( begin == NULL || len == 0 )
+        return NULL ;
+
+      const char * end = begin + len ;
+      const char * rv  = scan::find_seq( begin, end, trailer(), Trailer_Len ) ;
+      if( rv == NULL )
+        return NULL ;
+
+      rv = scan::find_byte( rv + Trailer_Len, end, SOH ) ;
+      return ( rv == NULL ) ? NULL : rv + 1 ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      if( begin == NULL || len == 0 )
+        return 0 ;
+
+      // Trailer offsets go in 'ends' and are overwritten, in place, w/ the
+      // message ends.  A trailer inside the previous message's checksum
+      // can't happen ( checksums are digits ), so they're already in order.
       const char * end = begin + len ;
-      while( begin != end )
-      {
-        if( *begin == '\n' )
-          return begin + 1 ;
-        ++begin ;
+      uint32_t     rv  = scan::find_all_seq( begin, end, trailer(), Trailer_Len, ends, max_count ) ;
+      for( uint32_t idx = 0 ; idx < rv ; ++idx )
+      { const char * soh = scan::find_byte( begin + ends[ idx ] + Trailer_Len, end, SOH ) ;
+        if( soh == NULL )
+          return idx ;
+        ends[ idx ] = static_cast<uint32_t>( soh + 1 - begin ) ;
       }
-      return NULL ;
+      return rv ;
     }
   } ;
 
+  //----------------------------------------------------------------------------------
+  // Fixed size records of sizeof( T ) bytes.
   //----------------------------------------------------------------------------------
   template<typename T>
   struct ByType
   {
+    //--------------------------------------------------------
     static
+    inline
     const char *
     get( const char * begin, uint32_t len )
     {
       return ( begin == NULL || len == 0 || len < sizeof( T ) )
              ? NULL
-             : begin + sizeof( T ) + 1
+             : begin + sizeof( T )
              ;
     }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      uint32_t rv = ( begin == NULL ) ? 0 : len / sizeof( T ) ;
+      if( rv > max_count )
+        rv = max_count ;
+      for( uint32_t idx = 0 ; idx < rv ; ++idx )
+        ends[ idx ] = ( idx + 1 ) * sizeof( T ) ;
+      return rv ;
+    }
   } ;
 
   //----------------------------------------------------------------------------------
@@ -58,15 +243,119 @@ namespace extract {
     //--------------------------------------------------------
     inline
     const char *
-    get( const char * begin, uint32_t len )
+    get( const char * begin, uint32_t len ) const
     {
       return ( begin == NULL || len == 0 || len < sz_ )
              ? NULL
-             : begin + sz_ + 1
+             : begin + sz_
              ;
     }
   } ;
 
+  //----------------------------------------------------------------------------------
+  // Length prefixed frames ( e.g. SoupBinTCP / MoldUDP64 message blocks, or SBE
+  // w/ a framing header ).  Each frame starts w/ an unsigned length field, and
+  // the record returned is the whole frame, header included.  Options :
+  //
+  //   opt::Header_Size< 2 >                Length field size : 1, 2 or 4 bytes.
+  //   opt::Big_Endian< true >              Length field byte order.
+  //   opt::Length_Includes_Header< false > Whether the length counts the 
+  //                                        length field itself.  Shorter 
+  //                                        lengths are read as empty frames.
+  //
+  // eg. ByLengthPrefix< opt::Header_Size<4>, opt::Big_Endian<false> >
+  //----------------------------------------------------------------------------------
+  template<typename... T_Args>
+  struct ByLengthPrefix
+  {
+    //--------------------------------------------------------
+    static
+    const
+    uint32_t
+    Header_Size = ntp::get_value< opt::Header_Size<2>, T_Args...>::value ;
+
+    //--------------------------------------------------------
+    static
+    const
+    bool
+    Big_Endian = ntp::get_value< opt::Big_Endian<true>, T_Args...>::value ;
+
+    //--------------------------------------------------------
+    static
+    const
+    bool
+    Length_Includes_Header = ntp::get_value< opt::Length_Includes_Header<false>, T_Args...>::value ;
+
+    //--------------------------------------------------------
+    static_assert( Header_Size == 1 || Header_Size == 2 || Header_Size == 4
+                 , "ByLengthPrefix<> length field must be 1, 2 or 4 bytes"
+                 ) ;
+
+    //--------------------------------------------------------
+    typedef
+    typename
+    std::conditional< Header_Size == 1
+                    , uint8_t
+                    , typename std::conditional< Header_Size == 2, uint16_t, uint32_t >::type
+                    >::type
+    length_t ;
+
+    //--------------------------------------------------------
+    // Size of the frame starting at 'begin', header included.  There must be
+    // at least Header_Size bytes at 'begin'.
+    //--------------------------------------------------------
+    static
+    inline
+    uint64_t
+    frame_size( const char * begin )
+    {
+      static const bool Host_Big_Endian = ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ ) ;
+
+      length_t len ;
+      std::memcpy( &len, begin, sizeof( len ) ) ;
+      if( Big_Endian != Host_Big_Endian )
+        len = util::bswap( len ) ;
+
+      if( !Length_Includes_Header )
+        return static_cast<uint64_t>( len ) + Header_Size ;
+      return ( len < Header_Size ) ? Header_Size : len ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    const char *
+    get( const char * begin, uint32_t len )
+    {
+      if( begin == NULL || len < Header_Size )
+        return NULL ;
+
+      uint64_t size = frame_size( begin ) ;
+      return ( size > len ) ? NULL : begin + size ;
+    }
+
+    //--------------------------------------------------------
+    static
+    inline
+    uint32_t
+    get_all( const char * begin, uint32_t len, uint32_t * ends, uint32_t max_count )
+    {
+      if( begin == NULL )
+        return 0 ;
+
+      uint32_t rv     = 0 ;
+      uint64_t offset = 0 ;
+      while( rv < max_count && len - offset >= Header_Size )
+      { uint64_t next = offset + frame_size( begin + offset ) ;
+        if( next > len )
+          break ;
+        ends[ rv++ ] = static_cast<uint32_t>( next ) ;
+        offset       = next ;
+      }
+      return rv ;
+    }
+  } ;
+
 }}}
 
 #endif
@@ -20,6 +20,13 @@ namespace opt {
   FPS_Declare_NTP_Value( Construct,        bool ) ;
   FPS_Declare_NTP_Value( Destruct,         bool ) ;
 
+  //
+  // Length prefixed framing ( see extract::ByLengthPrefix ).
+  //
+  FPS_Declare_NTP_Value( Header_Size,            uint32_t ) ;
+  FPS_Declare_NTP_Value( Big_Endian,             bool ) ;
+  FPS_Declare_NTP_Value( Length_Includes_Header, bool ) ;
+
 }}}
 
 #endif
@@ -8,6 +8,8 @@
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace fps ;
 
@@ -25,7 +27,7 @@ BOOST_AUTO_TEST_CASE( fps_container__byte_queue )
   ) ;
 
   BOOST_CHECK_MESSAGE
-  ( (bq.capacity() < Capacity ) 
+  ( (bq.capacity() == Capacity ) 
   , string::sprintf( "\n\tByteQueue::capacity() returned %u - expected %u"
                   , bq.capacity()
                   , Capacity 
@@ -79,6 +81,496 @@ BOOST_AUTO_TEST_CASE( fps_container__byte_queue )
   std::cout << "|--[ Success ]" << std::endl << std::endl ;
 }
 
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__byte_queue_mirrored ) 
+{
+  std::cout << "[ util::ByteQueue ( Mirrored ) unit tests ]" << std::endl ;
+
+  container::ByteQueue bq( 100, container::queue_mode::Mirrored ) ;
+  BOOST_REQUIRE_MESSAGE
+  ( bq.mode() == container::queue_mode::Mirrored 
+  , string::sprintf( "\n\tMirrored ByteQueue fell back to Heap mode ( errno: %d )", bq.last_error() )
+  ) ;
+
+  const uint32_t Capacity = bq.capacity() ;
+  BOOST_CHECK_MESSAGE
+  ( Capacity >= 100 && Capacity % 4096 == 0 && bq.empty() 
+  , string::sprintf( "\n\tByteQueue::capacity() returned %u - expected a page multiple >= 100", Capacity )
+  ) ;
+
+  // Records of 1 to 250 bytes, a few at a time, so the queue wraps many times
+  // and records straddle the end of the buffer.
+  uint32_t    seq      = 0 ;
+  uint32_t    next     = 0 ;
+  uint32_t    failures = 0 ;
+  std::string record ;
+  for( uint32_t round = 0 ; round < 5000 ; ++round ) 
+  {
+    for( uint32_t idx = 0 ; idx < 1 + round % 7 ; ++idx, ++seq ) 
+    { record.assign( 1 + seq % 250, static_cast<char>( 'a' + seq % 26 ) ) ;
+      record.push_back( '\n' ) ;
+      bq.insert( record.c_str(), record.size() ) ;
+    }
+
+    for( uint32_t idx = 0 ; idx < 1 + ( round + 3 ) % 7 ; ++idx, ++next ) 
+    { container::ByteRange q_data = bq.extract<container::extract::ByNewline>() ;
+      if( !q_data ) 
+        break ;
+
+      record.assign( 1 + next % 250, static_cast<char>( 'a' + next % 26 ) ) ;
+      record.push_back( '\n' ) ;
+      if( std::string( q_data.begin(), q_data.end() ) != record ) 
+        ++failures ;
+    }
+  }
+
+  BOOST_CHECK_MESSAGE
+  ( failures == 0 && next > 10000
+  , string::sprintf( "\n\tMirrored ByteQueue returned %u bad records out of %u", failures, next )
+  ) ;
+
+  BOOST_CHECK_MESSAGE
+  ( bq.capacity() == Capacity 
+  , string::sprintf( "\n\tMirrored ByteQueue grew from %u to %u bytes w/out ever being full", Capacity, bq.capacity() )
+  ) ;
+
+  // Grow while wrapped : unread content must survive the move.
+  std::string big( Capacity, 'z' ) ;
+  uint32_t    before = bq.size() ;
+  bq.insert( big.c_str(), big.size() ) ;
+  BOOST_CHECK_MESSAGE
+  ( bq.capacity() > Capacity && bq.size() == before + big.size() && bq.mode() == container::queue_mode::Mirrored 
+  , string::sprintf( "\n\tMirrored ByteQueue::capacity() returned %u after growing - expected more than %u", bq.capacity(), Capacity ) 
+  ) ;
+
+  uint32_t leftover = 0 ;
+  while( container::ByteRange q_data = bq.extract<container::extract::ByNewline>() ) 
+  { record.assign( 1 + next % 250, static_cast<char>( 'a' + next % 26 ) ) ;
+    record.push_back( '\n' ) ;
+    leftover += ( std::string( q_data.begin(), q_data.end() ) == record ) ? 0 : 1 ;
+    ++next ;
+  }
+  BOOST_CHECK_MESSAGE( leftover == 0 && next == seq, "\n\tMirrored ByteQueue lost records while growing" ) ;
+  BOOST_CHECK( std::string( bq.begin(), bq.end() ) == big ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__byte_queue_fd_io ) 
+{
+  std::cout << "[ util::ByteQueue fd i/o unit tests ]" << std::endl ;
+
+  std::string content ;
+  for( uint32_t idx = 0 ; content.size() < 48 * 1024 ; ++idx ) 
+    content += string::sprintf( "record %u\n", idx ) ;
+
+  for( int mode = container::queue_mode::Heap ; mode <= container::queue_mode::Mirrored ; ++mode ) 
+  {
+    container::ByteQueue bq( 4096, static_cast<container::queue_mode::Enum>( mode ) ) ;
+    int32_t              rx[ 2 ] ;
+    int32_t              tx[ 2 ] ;
+    BOOST_REQUIRE( ::pipe( rx ) == 0 && ::pipe( tx ) == 0 ) ;
+
+    // More than the queue's free space, so part of it goes through the spill buffer.
+    BOOST_REQUIRE( ::write( rx[ 1 ], content.c_str(), content.size() ) == static_cast<ssize_t>( content.size() ) ) ;
+    ::close( rx[ 1 ] ) ;
+
+    int64_t  rv    = 0 ;
+    uint64_t total = 0 ;
+    while( ( rv = bq.read_from( rx[ 0 ], 8192 ) ) > 0 ) 
+      total += rv ;
+
+    BOOST_CHECK_MESSAGE
+    ( rv == 0 && total == content.size() && std::string( bq.begin(), bq.end() ) == content 
+    , string::sprintf( "\n\tByteQueue::read_from() read %lu bytes - expected %lu", total, content.size() )
+    ) ;
+
+    // Drop a few records, then write the rest out.
+    for( uint32_t idx = 0 ; idx < 10 ; ++idx ) 
+      bq.extract<container::extract::ByNewline>() ;
+
+    std::string expect( bq.begin(), bq.end() ) ;
+    ::fcntl( tx[ 1 ], F_SETPIPE_SZ, 1024 * 1024 ) ;
+    while( !bq.empty() && bq.write_to( tx[ 1 ] ) > 0 ) 
+      ;
+    ::close( tx[ 1 ] ) ;
+
+    std::string got ;
+    char        buf[ 4096 ] ;
+    for( ssize_t len ; ( len = ::read( tx[ 0 ], buf, sizeof( buf ) ) ) > 0 ; ) 
+      got.append( buf, len ) ;
+
+    BOOST_CHECK_MESSAGE
+    ( bq.empty() && got == expect 
+    , string::sprintf( "\n\tByteQueue::write_to() wrote %lu bytes - expected %lu", got.size(), expect.size() )
+    ) ;
+
+    // A non-blocking fd w/ nothing to read.
+    int32_t empty_fd[ 2 ] ;
+    BOOST_REQUIRE( ::pipe2( empty_fd, O_NONBLOCK ) == 0 ) ;
+    BOOST_CHECK( bq.read_from( empty_fd[ 0 ], 100 ) == -1 && bq.last_error() == EAGAIN ) ;
+
+    ::close( rx[ 0 ] ) ;
+    ::close( tx[ 0 ] ) ;
+    ::close( empty_fd[ 0 ] ) ;
+    ::close( empty_fd[ 1 ] ) ;
+  }
+
+  // Gather insert.
+  container::ByteQueue bq ;
+  char                 head[] = "abc" ;
+  char                 body[] = "defgh\n" ;
+  struct iovec         iov[ 2 ] = { { head, 3 }, { body, 6 } } ;
+  bq.insert( iov, 2 ) ;
+  BOOST_CHECK( std::string( bq.begin(), bq.end() ) == "abcdefgh\n" ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//---------------------------------------------------------------------------------------------------
+// Append a frame w/ a 'T_Extractor' style length header and 'payload_len' bytes of payload.
+//---------------------------------------------------------------------------------------------------
+template<typename T_Extractor>
+void
+append_frame( std::string & dest, uint32_t payload_len ) 
+{
+  uint32_t len = payload_len + ( T_Extractor::Length_Includes_Header ? T_Extractor::Header_Size : 0 ) ;
+  for( uint32_t idx = 0 ; idx < T_Extractor::Header_Size ; ++idx ) 
+  { uint32_t shift = T_Extractor::Big_Endian ? 8 * ( T_Extractor::Header_Size - 1 - idx ) : 8 * idx ;
+    dest.push_back( static_cast<char>( ( len >> shift ) & 0xff ) ) ;
+  }
+  dest.append( payload_len, static_cast<char>( 'a' + payload_len % 26 ) ) ;
+}
+
+//---------------------------------------------------------------------------------------------------
+template<typename T_Extractor>
+void
+length_prefix_test( const std::string & label ) 
+{
+  std::cout << "|--[ " << label << " ]" << std::endl ;
+
+  // 300 frames, some big enough to need the high byte(s) of the length.
+  std::string           content ;
+  std::vector<uint32_t> sizes ;
+  for( uint32_t idx = 0 ; idx < 300 ; ++idx ) 
+  { uint32_t big         = ( T_Extractor::Header_Size == 1 ) ? 200 : 250 + idx * 4 ;
+    uint32_t payload_len = ( idx % 50 == 0 ) ? big : idx % 40 ;
+    append_frame<T_Extractor>( content, payload_len ) ;
+    sizes.push_back( payload_len + T_Extractor::Header_Size ) ;
+  }
+
+  // Feed it in odd sized chunks, so frames and headers are split.
+  container::ByteQueue  bq ;
+  std::vector<uint32_t> got ;
+  uint32_t              bad = 0 ;
+  for( uint32_t offset = 0 ; offset < content.size() ; offset += 97 ) 
+  { bq.insert( content.c_str() + offset, std::min<uint32_t>( 97, content.size() - offset ) ) ;
+    bq.extract_all<T_Extractor>
+    ( [&]( const container::ByteRange & frame ) 
+      { got.push_back( frame.size() ) ;
+        if( frame.size() > T_Extractor::Header_Size && *( frame.end() - 1 ) != static_cast<char>( 'a' + ( frame.size() - T_Extractor::Header_Size ) % 26 ) ) 
+          ++bad ;
+      }
+    ) ;
+  }
+
+  BOOST_CHECK_MESSAGE
+  ( got == sizes && bad == 0 && bq.empty() 
+  , string::sprintf( "\n\t%s : extract_all() returned %u frames ( %u bad ) - expected %u"
+                   , label.c_str()
+                   , static_cast<uint32_t>( got.size() )
+                   , bad
+                   , static_cast<uint32_t>( sizes.size() )
+                   )
+  ) ;
+
+  // A partial frame stays put until it's complete.
+  std::string frame ;
+  append_frame<T_Extractor>( frame, 10 ) ;
+  bq.insert( frame.c_str(), frame.size() - 1 ) ;
+  BOOST_CHECK( !bq.extract<T_Extractor>() && bq.size() == frame.size() - 1 ) ;
+  bq.insert( frame.c_str() + frame.size() - 1, 1 ) ;
+  BOOST_CHECK( bq.extract<T_Extractor>().size() == frame.size() && bq.empty() ) ;
+}
+
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__length_prefix ) 
+{
+  std::cout << "[ extract::ByLengthPrefix unit tests ]" << std::endl ;
+
+  namespace opt = container::opt ;
+  using container::extract::ByLengthPrefix ;
+
+  length_prefix_test< ByLengthPrefix<> >( "2 byte big endian" ) ;
+  length_prefix_test< ByLengthPrefix< opt::Big_Endian<false> > >( "2 byte little endian" ) ;
+  length_prefix_test< ByLengthPrefix< opt::Header_Size<4> > >( "4 byte big endian" ) ;
+  length_prefix_test< ByLengthPrefix< opt::Header_Size<4>, opt::Big_Endian<false> > >( "4 byte little endian" ) ;
+  length_prefix_test< ByLengthPrefix< opt::Length_Includes_Header<true>, opt::Header_Size<4> > >( "4 byte big endian, inclusive" ) ;
+  length_prefix_test< ByLengthPrefix< opt::Header_Size<1> > >( "1 byte" ) ;
+
+  // Fixed size records don't over-consume.
+  struct Record { char bytes[ 12 ] ; } ;
+  container::ByteQueue bq ;
+  std::string          content( 30, 'r' ) ;
+  bq.insert( content.c_str(), content.size() ) ;
+  BOOST_CHECK( bq.extract<container::extract::ByType<Record> >().size() == sizeof( Record ) && bq.size() == 18 ) ;
+  BOOST_CHECK( bq.extract( container::extract::BySize( 12 ) ).size() == 12 && bq.size() == 6 ) ;
+  BOOST_CHECK( !bq.extract( container::extract::BySize( 12 ) ) && bq.size() == 6 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__byte_queue_slab_pool ) 
+{
+  std::cout << "[ util::ByteQueue w/ SlabPool unit tests ]" << std::endl ;
+
+  typedef container::SlabPool pool_t ;
+  pool_t pool ;
+
+  BOOST_CHECK( pool_t::class_of( 1 ) == 0 && pool_t::class_of( 256 ) == 0 && pool_t::class_of( 257 ) == 1 ) ;
+  BOOST_CHECK( pool_t::class_of( 1024 * 1024 ) == pool_t::Class_Count - 1 && pool_t::class_of( 1024 * 1024 + 1 ) == pool_t::Class_Count ) ;
+
+  {
+    // 64 queues share one 256KB slab of 4KB buffers.
+    std::vector<container::ByteQueue *> queues ;
+    for( uint32_t idx = 0 ; idx < 64 ; ++idx ) 
+      queues.push_back( new container::ByteQueue( 3000, pool ) ) ;
+
+    pool_t::Stats stats = pool.class_stats( 4096 ) ;
+    BOOST_CHECK_MESSAGE
+    ( queues[ 0 ]->capacity() == 4096 && stats.misses_ == 1 && stats.hits_ == 63 && stats.in_use_ == 64 && stats.cached_ == 0 
+    , string::sprintf( "\n\tSlabPool 4KB class : capacity %u, %lu misses, %lu hits, %lu in use - expected 4096, 1, 63, 64"
+                     , queues[ 0 ]->capacity()
+                     , stats.misses_
+                     , stats.hits_
+                     , stats.in_use_
+                     )
+    ) ;
+
+    // A burst grows one queue, and shrink() gives the memory back w/out losing unread content.
+    std::string burst( 100000, 'b' ) ;
+    container::ByteQueue & bq = *queues[ 0 ] ;
+    bq.insert( burst.c_str(), burst.size() ) ;
+    BOOST_CHECK( bq.capacity() >= burst.size() && bq.capacity() == pool_t::class_size( pool_t::class_of( bq.capacity() ) ) ) ;
+
+    bq.extract( container::extract::BySize( burst.size() - 10 ) ) ;
+    bq.shrink() ;
+    BOOST_CHECK_MESSAGE
+    ( bq.capacity() == 4096 && std::string( bq.begin(), bq.end() ) == std::string( 10, 'b' ) 
+    , string::sprintf( "\n\tByteQueue::shrink() left capacity at %u - expected 4096", bq.capacity() )
+    ) ;
+
+    // The burst's buffers are cached for the next one.
+    uint64_t misses = pool.stats().misses_ ;
+    queues[ 1 ]->insert( burst.c_str(), burst.size() ) ;
+    BOOST_CHECK( pool.stats().misses_ == misses ) ;
+
+    for( container::ByteQueue * queue : queues ) 
+      delete queue ;
+  }
+
+  pool_t::Stats stats = pool.stats() ;
+  std::cout << "|--[ hits " << stats.hits_ << ", misses " << stats.misses_ << ", reserved " << stats.reserved_ << " ]" << std::endl ;
+  BOOST_CHECK_MESSAGE
+  ( stats.in_use_ == 0 && stats.oversize_ == 0 && stats.cached_ > 0 
+  , string::sprintf( "\n\tSlabPool has %lu buffers in use after every queue was destroyed", stats.in_use_ )
+  ) ;
+
+  // Above the largest class goes straight to the heap.
+  {
+    container::ByteQueue big( 2 * 1024 * 1024, pool ) ;
+    BOOST_CHECK( pool.stats().oversize_ == 1 && pool.stats().in_use_ == 1 ) ;
+  }
+  BOOST_CHECK( pool.stats().in_use_ == 0 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//---------------------------------------------------------------------------------------------------
+// Reference byte loops for the scan tests.
+//---------------------------------------------------------------------------------------------------
+namespace
+{
+  const char *
+  ref_find_any( const char * begin, const char * end, const char * set, uint32_t set_len )
+  {
+    for( ; begin < end ; ++begin )
+    { if( std::memchr( set, *begin, set_len ) != NULL )
+        return begin ;
+    }
+    return NULL ;
+  }
+
+  std::vector<uint32_t>
+  ref_find_all_seq( const char * begin, const char * end, const char * seq, uint32_t seq_len )
+  {
+    std::vector<uint32_t> rv ;
+    for( const char * ptr = begin ; ptr + seq_len <= end ; )
+    { if( std::memcmp( ptr, seq, seq_len ) == 0 )
+      { rv.push_back( static_cast<uint32_t>( ptr - begin ) ) ;
+        ptr += seq_len ;
+      }
+      else
+        ++ptr ;
+    }
+    return rv ;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__byte_scan ) 
+{
+  std::cout << "[ container::scan unit tests ]" << std::endl 
+            << "|--[ best level => " << container::scan::level_name( container::scan::best_level() ) << " ]" << std::endl ;
+
+  namespace scan = container::scan ;
+
+  // Sparse matches over an alphabet small enough that sequences recur, at
+  // every length and alignment around the vector widths.
+  std::vector<char> buf( 1024 ) ;
+  uint32_t seed = 12345 ;
+  for( char & c : buf ) 
+  { seed = seed * 1103515245 + 12345 ;
+    c = "abcdefgh,;\n\x01"[ ( seed >> 16 ) % 12 ] ;
+  }
+
+  const char     set[]   = ",;\n" ;
+  const char     seq[]   = "\x01" "ab" ;
+  const uint32_t Max     = 1024 ;
+  uint32_t       offsets[ Max ] ;
+  uint32_t       failures = 0 ;
+
+  for( int lvl = scan::level::Scalar ; lvl <= scan::best_level() ; ++lvl ) 
+  {
+    BOOST_REQUIRE( scan::set_level( static_cast<scan::level::Enum>( lvl ) ) ) ;
+    std::cout << "|--[ " << scan::level_name( scan::active_level() ) << " ]" << std::endl ;
+
+    for( uint32_t first = 0 ; first < 40 ; ++first ) 
+    { for( uint32_t last = first ; last < first + 300 ; ++last ) 
+      {
+        const char * begin = buf.data() + first ;
+        const char * end   = buf.data() + last ;
+
+        const char * expect = static_cast<const char *>( std::memchr( begin, '\n', end - begin ) ) ;
+        if( scan::find_byte( begin, end, '\n' ) != expect ) 
+          ++failures ;
+
+        if( scan::find_any( begin, end, set, 3 ) != ref_find_any( begin, end, set, 3 ) ) 
+          ++failures ;
+
+        std::vector<uint32_t> seqs = ref_find_all_seq( begin, end, seq, 3 ) ;
+        if( scan::find_seq( begin, end, seq, 3 ) != ( seqs.empty() ? NULL : begin + seqs[ 0 ] ) ) 
+          ++failures ;
+
+        uint32_t count = scan::find_all_seq( begin, end, seq, 3, offsets, Max ) ;
+        if( std::vector<uint32_t>( offsets, offsets + count ) != seqs ) 
+          ++failures ;
+
+        std::vector<uint32_t> anys ;
+        for( const char * ptr = begin ; ( ptr = ref_find_any( ptr, end, set, 3 ) ) != NULL ; ++ptr ) 
+          anys.push_back( static_cast<uint32_t>( ptr - begin ) ) ;
+        count = scan::find_all_any( begin, end, set, 3, offsets, Max ) ;
+        if( std::vector<uint32_t>( offsets, offsets + count ) != anys ) 
+          ++failures ;
+
+        std::vector<uint32_t> bytes ;
+        for( const char * ptr = begin ; ptr < end ; ++ptr ) 
+        { if( *ptr == '\n' ) 
+            bytes.push_back( static_cast<uint32_t>( ptr - begin ) ) ;
+        }
+        count = scan::find_all_byte( begin, end, '\n', offsets, Max ) ;
+        if( std::vector<uint32_t>( offsets, offsets + count ) != bytes ) 
+          ++failures ;
+
+        // Truncated batches stop at max_count.
+        if( bytes.size() > 1 && scan::find_all_byte( begin, end, '\n', offsets, 1 ) != 1 ) 
+          ++failures ;
+      }
+    }
+
+    BOOST_CHECK_MESSAGE
+    ( failures == 0 
+    , string::sprintf( "\n\tscan level '%s' disagreed w/ the reference loops %u times"
+                     , scan::level_name( scan::active_level() )
+                     , failures 
+                     )
+    ) ;
+  }
+  scan::set_level( scan::best_level() ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//---------------------------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_container__byte_queue_extract_all ) 
+{
+  std::cout << "[ util::ByteQueue::extract_all() unit tests ]" << std::endl ;
+
+  container::ByteQueue     bq ;
+  std::vector<std::string> lines ;
+  std::string              content ;
+  for( uint32_t idx = 0 ; idx < 200 ; ++idx ) 
+  { lines.push_back( std::string( idx % 37, 'x' ) + "\n" ) ;
+    content += lines.back() ;
+  }
+  content += "partial" ;
+  bq.insert( content.c_str(), content.size() ) ;
+
+  std::vector<std::string> got ;
+  uint32_t count = bq.extract_all<container::extract::ByNewline>
+                   ( [&]( const container::ByteRange & range ) { got.push_back( std::string( range.begin(), range.end() ) ) ; } ) ;
+
+  BOOST_CHECK_MESSAGE
+  ( count == lines.size() && got == lines 
+  , string::sprintf( "\n\tByteQueue::extract_all<ByNewline>() returned %u records - expected %u"
+                   , count
+                   , static_cast<uint32_t>( lines.size() )
+                   )
+  ) ;
+
+  BOOST_CHECK_MESSAGE
+  ( std::string( bq.begin(), bq.end() ) == "partial" 
+  , "\n\tByteQueue::extract_all() should leave partial records in the queue" 
+  ) ;
+
+  // FIX messages, w/ the last one missing its closing SOH.
+  bq.clear() ;
+  std::string fix = "8=FIX.4.2\x01" "9=5\x01" "35=0\x01" "10=161\x01" ;
+  for( uint32_t idx = 0 ; idx < 3 ; ++idx ) 
+    bq.insert( fix.c_str(), fix.size() ) ;
+  bq.insert( fix.c_str(), fix.size() - 1 ) ;
+
+  got.clear() ;
+  count = bq.extract_all<container::extract::ByFixMessage>
+          ( [&]( const container::ByteRange & range ) { got.push_back( std::string( range.begin(), range.end() ) ) ; } ) ;
+
+  BOOST_CHECK_MESSAGE
+  ( count == 3 && got.size() == 3 && got[ 0 ] == fix && got[ 2 ] == fix && bq.size() == fix.size() - 1 
+  , string::sprintf( "\n\tByteQueue::extract_all<ByFixMessage>() returned %u messages - expected 3", count ) 
+  ) ;
+
+  container::ByteRange last = bq.extract<container::extract::ByFixMessage>() ;
+  BOOST_CHECK_MESSAGE( !last, "\n\tByFixMessage::get() should not match a message missing its closing SOH" ) ;
+
+  bq.insert( "\x01", 1 ) ;
+  last = bq.extract<container::extract::ByFixMessage>() ;
+  BOOST_CHECK_MESSAGE( last && last.size() == fix.size() && bq.empty(), "\n\tByFixMessage::get() should match a completed message" ) ;
+
+  // Either delimiter, and a two byte one.
+  typedef container::extract::ByAnyOf<',', ';'>     by_any_t ;
+  typedef container::extract::BySequence<'\r', '\n'> by_crlf_t ;
+
+  bq.insert( "a,b;c,", 6 ) ;
+  BOOST_CHECK( bq.extract_all<by_any_t>( []( const container::ByteRange & ) {} ) == 3 ) ;
+  bq.insert( "a\r\nb\r\nc\r", 8 ) ;
+  BOOST_CHECK( bq.extract_all<by_crlf_t>( []( const container::ByteRange & ) {} ) == 2 ) ;
+  BOOST_CHECK( bq.size() == 2 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
 //---------------------------------------------------------------------------------------------------
 template<typename T>
 void
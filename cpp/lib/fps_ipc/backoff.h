@@ -0,0 +1,250 @@
+#ifndef FPS__IPC__BACKOFF__H
+#define FPS__IPC__BACKOFF__H
+
+#include <ctime>
+#include <sched.h>
+#include <stdint.h>
+
+//
+// Compile-time backoff policies for spin loops.  A policy is a type w/ a
+// static wait( counter ) member, called w/ counter = 0, 1, 2 ... for as long
+// as the caller's condition is unmet.  Locks and readers take the policy as a
+// template parameter, so each can be tuned for the thread using it :
+//
+//   backoff::Spin<>         - pause every iteration; never leaves the cpu.
+//                             For pinned, latency critical threads.
+//   backoff::Exponential<>  - pause 1, 2, 4 ... up to N times per iteration.
+//                             Eases pressure on a contended cache line.
+//   backoff::Yield<>        - sched_yield() every iteration.
+//   backoff::Sleep<>        - nanosleep() every iteration.  For background
+//                             threads that shouldn't burn a cpu.
+//   backoff::Progressive<>  - retry, then pause, then yield, then sleep, w/
+//                             tunable thresholds.  The defaults match
+//                             ipc::progressive_yield().
+//
+// Each policy also takes a stats policy.  backoff::Thread_Stats counts, per
+// thread, how many iterations were spent in each phase ( see Counters ),
+// which is cheap enough to leave on while profiling contention.  The default,
+// backoff::No_Stats, compiles away.
+//
+
+namespace fps     {
+namespace ipc     {
+namespace backoff {
+
+  //--------------------------------------------------------------------------------
+  namespace phase
+  {
+    enum Enum
+    { Spin  = 0  // Immediate retry.
+    , Pause = 1  // One or more x86 'pause' instructions.
+    , Yield = 2  // sched_yield().
+    , Sleep = 3  // nanosleep().
+    , Count = 4
+    } ;
+
+    //------------------------------------------------------------------------------
+    inline
+    const char *
+    to_string( uint32_t value )
+    { switch( value )
+      { case Spin  : return "spin" ;
+        case Pause : return "pause" ;
+        case Yield : return "yield" ;
+        case Sleep : return "sleep" ;
+      }
+      return "unknown" ;
+    }
+  }
+
+  //--------------------------------------------------------------------------------
+  // Backoff iterations by phase.
+  //--------------------------------------------------------------------------------
+  struct Counters
+  {
+    uint64_t phase_[ phase::Count ] ;
+
+    //------------------------------------------------------------------------------
+    inline
+    void
+    reset()
+    { for( uint32_t idx = 0 ; idx < phase::Count ; ++idx )
+        phase_[ idx ] = 0 ;
+    }
+
+    //------------------------------------------------------------------------------
+    inline
+    uint64_t
+    total() const
+    { uint64_t rv = 0 ;
+      for( uint32_t idx = 0 ; idx < phase::Count ; ++idx )
+        rv += phase_[ idx ] ;
+      return rv ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  // Stats policies.
+  //--------------------------------------------------------------------------------
+  struct No_Stats
+  {
+    static inline void record( phase::Enum ) {}
+  } ;
+
+  //--------------------------------------------------------------------------------
+  struct Thread_Stats
+  {
+    //------------------------------------------------------------------------------
+    // The calling thread's counters, shared by every policy that uses
+    // Thread_Stats.
+    //------------------------------------------------------------------------------
+    static
+    inline
+    Counters &
+    counters()
+    { static thread_local Counters rv = { { 0 } } ;
+      return rv ;
+    }
+
+    //------------------------------------------------------------------------------
+    static inline void record( phase::Enum value ) { ++counters().phase_[ value ] ; }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  inline void cpu_pause() { __asm__ __volatile__( "pause;" ) ; }
+
+  //--------------------------------------------------------------------------------
+  inline
+  void
+  sleep_nanos( uint32_t nanos )
+  { // g++ -Wextra warns on {} or {0}
+    ::timespec timeout ;
+    timeout.tv_sec  = 0 ;
+    timeout.tv_nsec = nanos ;
+    ::nanosleep( &timeout, 0 ) ;
+  }
+
+  //--------------------------------------------------------------------------------
+  template<typename T_Stats = No_Stats>
+  struct Spin
+  {
+    typedef T_Stats stats_t ;
+
+    static
+    inline
+    void
+    wait( uint32_t )
+    { T_Stats::record( phase::Pause ) ;
+      cpu_pause() ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  // Pause 2^counter times, capped at T_Max_Pauses.
+  //--------------------------------------------------------------------------------
+  template<uint32_t T_Max_Pauses = 64, typename T_Stats = No_Stats>
+  struct Exponential
+  {
+    typedef T_Stats stats_t ;
+    static const uint32_t Max_Pauses = T_Max_Pauses ;
+
+    static
+    inline
+    void
+    wait( uint32_t counter )
+    { T_Stats::record( phase::Pause ) ;
+      uint32_t pauses = ( counter < 31 ) ? ( 1u << counter ) : Max_Pauses ;
+      if( pauses > Max_Pauses )
+        pauses = Max_Pauses ;
+      for( uint32_t idx = 0 ; idx < pauses ; ++idx )
+        cpu_pause() ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  template<typename T_Stats = No_Stats>
+  struct Yield
+  {
+    typedef T_Stats stats_t ;
+
+    static
+    inline
+    void
+    wait( uint32_t )
+    { T_Stats::record( phase::Yield ) ;
+      ::sched_yield() ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  template<uint32_t T_Sleep_Nanos = 1000, typename T_Stats = No_Stats>
+  struct Sleep
+  {
+    typedef T_Stats stats_t ;
+    static const uint32_t Sleep_Nanos = T_Sleep_Nanos ;
+
+    static
+    inline
+    void
+    wait( uint32_t )
+    { T_Stats::record( phase::Sleep ) ;
+      sleep_nanos( Sleep_Nanos ) ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  // Retry immediately until 'counter' reaches T_Spin_Limit, then pause until
+  // T_Pause_Limit, then yield until T_Yield_Limit.  Beyond that, alternate
+  // between yielding ( odd counters ) and sleeping T_Sleep_Nanos ( even
+  // counters ).  A T_Yield_Limit of UINT32_MAX never sleeps, and
+  // T_Pause_Limit = T_Yield_Limit = UINT32_MAX never leaves the cpu.
+  //--------------------------------------------------------------------------------
+  template< uint32_t T_Spin_Limit  = 4
+          , uint32_t T_Pause_Limit = 16
+          , uint32_t T_Yield_Limit = 32
+          , uint32_t T_Sleep_Nanos = 1000
+          , typename T_Stats       = No_Stats
+          >
+  struct Progressive
+  {
+    typedef T_Stats stats_t ;
+    static const uint32_t Spin_Limit  = T_Spin_Limit ;
+    static const uint32_t Pause_Limit = T_Pause_Limit ;
+    static const uint32_t Yield_Limit = T_Yield_Limit ;
+    static const uint32_t Sleep_Nanos = T_Sleep_Nanos ;
+
+    static
+    inline
+    void
+    wait( uint32_t counter )
+    {
+      if( counter < Spin_Limit )
+      { T_Stats::record( phase::Spin ) ;
+      }
+      else if( counter < Pause_Limit )
+      { T_Stats::record( phase::Pause ) ;
+        cpu_pause() ;
+      }
+      else if( counter < Yield_Limit || ( counter & 1 ) )
+      { T_Stats::record( phase::Yield ) ;
+        ::sched_yield() ;
+      }
+      else
+      { T_Stats::record( phase::Sleep ) ;
+        sleep_nanos( Sleep_Nanos ) ;
+      }
+    }
+  } ;
+
+  //--------------------------------------------------------------------------------
+  typedef Progressive<> Default ;
+
+  //--------------------------------------------------------------------------------
+  // Progressive backoff that never sleeps, for pinned threads that may still
+  // yield to others sharing their cpu.
+  //--------------------------------------------------------------------------------
+  typedef Progressive<4, 16, UINT32_MAX> No_Sleep ;
+
+}}}
+
+#endif
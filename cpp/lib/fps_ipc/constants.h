@@ -1,10 +1,32 @@
 #ifndef FPS_IPC__CONSTANTS__H
 #define FPS_IPC__CONSTANTS__H
 
+#include <stdint.h>
+
 namespace fps { 
 namespace ipc {
 namespace constants { 
 
+  //--------------------------------------------------------------------------------
+  // Filesystems backing ipc::SharedMemory segments.  Huge page segments live on a 
+  // hugetlbfs mount, which must exist and have pages reserved 
+  // ( vm.nr_hugepages ) before access::Huge_Pages can be used.
+  //--------------------------------------------------------------------------------
+  static const char Shm_Dir[]       = "/dev/shm" ;
+  static const char Huge_Page_Dir[] = "/dev/hugepages" ;
+
+  //--------------------------------------------------------------------------------
+  // Home of the named fifos behind notify::Subscriber.  Kept out of Shm_Dir so 
+  // tools that open everything there as a segment never open a fifo.  Created 
+  // on demand, world writable and sticky like /tmp.
+  //--------------------------------------------------------------------------------
+  static const char Fifo_Dir[]      = "/tmp/fps_ipc" ;
+
+  //--------------------------------------------------------------------------------
+  // Highest numa node accepted by access::numa_node().
+  //--------------------------------------------------------------------------------
+  static const int32_t Max_Numa_Node = 254 ;
+
 }}}
 
 #endif
@@ -5,6 +5,20 @@
 #include "fps_ipc/mapped_memory.h"
 #include "fps_ipc/thread_fifo.h"
 #include "fps_ipc/swmr_shm_queue.h"
+#include "fps_ipc/swmr_shm_queue_probe.h"
+#include "fps_ipc/swmr_shm_conflating_store.h"
+#include "fps_ipc/swmr_shm_queue_journal.h"
+#include "fps_ipc/spsc_shm_queue.h"
+#include "fps_ipc/queue_telemetry_probe.h"
+#include "fps_ipc/notifier.h"
+#include "fps_ipc/mpmc_ring_buffer.h"
+#include "fps_ipc/spinlock.h"
+#include "fps_ipc/ticket_lock.h"
+#include "fps_ipc/mcs_lock.h"
+#include "fps_ipc/rw_spinlock.h"
+#include "fps_ipc/seqlocked.h"
+#include "fps_ipc/offset_ptr.h"
+#include "fps_ipc/shm_arena.h"
 
 namespace fps {
 namespace ipc {
@@ -2,7 +2,14 @@
 #define FPS__IPC__IPC_UTIL__H
 
 #include <ctime>
+#include <cerrno>
 #include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "fps_ipc/constants.h"
+#include "fps_ipc/backoff.h"
 
 namespace fps {
 namespace ipc {
@@ -14,41 +21,78 @@ namespace ipc {
     static const uint32_t Read_Write = 1 ;
     static const uint32_t Create     = 2 ;
     static const uint32_t Exclusive  = 4 ;
+    static const uint32_t Huge_Pages = 8 ;   // SharedMemory : back the segment w/ hugetlbfs.
+    static const uint32_t Populate   = 16 ;  // MappedMemory : prefault the mapping on open.
+    static const uint32_t Lock       = 32 ;  // MappedMemory : prefault and mlock() the mapping.
+    static const uint32_t Notify     = 64 ;  // swmr::ShmQueueWriter/Reader : eventfd style notification ( see notifier.h ).
+
+    //------------------------------------------------------------------------------
+    // MappedMemory : bind the mapping's pages to numa node 'node' ( mbind ).  OR 
+    // the result into the other access flags.  Nodes above 
+    // constants::Max_Numa_Node can't be encoded and are ignored.
+    //------------------------------------------------------------------------------
+    inline 
+    uint32_t 
+    numa_node( int32_t node ) 
+    { return ( node >= 0 && node <= constants::Max_Numa_Node ) 
+             ? static_cast<uint32_t>( node + 1 ) << 16 
+             : 0 
+             ;
+    }
+
+    //------------------------------------------------------------------------------
+    // Return the numa node encoded in 'flags', or -1 if there isn't one.
+    //------------------------------------------------------------------------------
+    inline 
+    int32_t 
+    numa_node_of( uint32_t flags ) 
+    { return static_cast<int32_t>( ( flags >> 16 ) & 0xff ) - 1 ;
+    }
   } ;
 
+  //--------------------------------------------------------------------------------
+  // Default spin loop backoff : retry, then pause, then yield, then sleep 1us.  
+  // Code that needs a different trade-off should take a backoff policy as a 
+  // template parameter instead ( see backoff.h ).
   //--------------------------------------------------------------------------------
   inline
   void
   progressive_yield( uint32_t counter )
   {
-    // 1) If the yield counter is close to zero, optimistically retry immediately.
-    if( counter < 4 ) 
-    {
-    }
-    // 2) Once we've passed the optimistic retry threshold, start executing an
-    //    x86 "pause" instruction before returning.
-    else if( counter < 16 ) 
-    {
-      __asm__( "pause;" ) ;
-    }
-    // 3) After passing the "pause" threshold, start yielding our timeslice 
-    //    before returning.  Additionally, execute this logic any time the
-    //    value of counter is odd. 
-    else if( counter < 32 || (counter & 1) )
-    {
-      ::sched_yield() ;
-    }
-    // 4) After passing the sched_yield() threshold, sleep for one microsecond
-    //    every time the counter value is numerically even.
-    else
-    {
-      // g++ -Wextra warns on {} or {0}
-      ::timespec timeout ;
-      timeout.tv_sec  = 0 ;
-      timeout.tv_nsec = 1000 ;
+    backoff::Default::wait( counter ) ;
+  }
 
-      ::nanosleep( &timeout, 0 ) ;
+  //--------------------------------------------------------------------------------
+  // Block while the 32-bit word at 'addr' equals 'expected', for at most
+  // 'timeout_nanos' ( forever if zero ).  Works across processes, so 'addr' may
+  // live in shared memory ( which must be mapped writable ).  Returns false on 
+  // timeout.  Spurious and EAGAIN ( value already changed ) returns count as 
+  // wakeups - callers must recheck their condition.
+  //--------------------------------------------------------------------------------
+  inline
+  bool
+  futex_wait( const volatile uint32_t * addr, uint32_t expected, uint64_t timeout_nanos = 0 )
+  {
+    ::timespec   timeout ;
+    ::timespec * timeout_ptr = NULL ;
+    if( timeout_nanos > 0 ) 
+    { timeout.tv_sec  = timeout_nanos / 1000000000 ;
+      timeout.tv_nsec = timeout_nanos % 1000000000 ;
+      timeout_ptr     = &timeout ;
     }
+
+    long rc = ::syscall( SYS_futex, addr, FUTEX_WAIT, expected, timeout_ptr, NULL, 0 ) ;
+    return !( rc == -1 && errno == ETIMEDOUT ) ;
+  }
+
+  //--------------------------------------------------------------------------------
+  // Wake up to 'count' threads/processes blocked in futex_wait() on 'addr'.
+  //--------------------------------------------------------------------------------
+  inline
+  void
+  futex_wake( volatile uint32_t * addr, uint32_t count = INT32_MAX )
+  {
+    ::syscall( SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0 ) ;
   }
 
   namespace detail 
@@ -0,0 +1,494 @@
+#include "fps_ipc/journal.h"
+#include "fps_time/clock.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace fps     {
+namespace ipc     {
+namespace journal {
+
+  //-------------------------------------------------------------------------------------------
+  namespace
+  {
+    //-----------------------------------------------------------------------------------------
+    // Map 'size' bytes of 'fd', or resize an existing mapping.  Returns NULL and leaves errno
+    // set on failure.
+    //-----------------------------------------------------------------------------------------
+    void *
+    map_file( int32_t fd, int32_t prot, void * begin, uint64_t old_size, uint64_t new_size )
+    {
+      void * rv = ( begin == NULL )
+                ? ::mmap( NULL, new_size, prot, MAP_SHARED, fd, 0 )
+                : ::mremap( begin, old_size, new_size, MREMAP_MAYMOVE )
+                ;
+      return ( rv == MAP_FAILED ) ? NULL : rv ;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // Allocate disk blocks up front, so that a full disk fails here rather than w/ a SIGBUS
+    // on first touch of the mapping.  Filesystems w/o fallocate() get a sparse file.
+    //-----------------------------------------------------------------------------------------
+    int32_t
+    allocate( int32_t fd, uint64_t size )
+    {
+      int32_t rv = ::posix_fallocate( fd, 0, size ) ;
+      if( rv == EOPNOTSUPP || rv == EINVAL )
+        rv = ( ::ftruncate( fd, size ) == 0 ) ? 0 : errno ;
+      return rv ;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // Fault in a freshly mapped chunk w/ one system call, rather than one page fault per
+    // page appended to.  Best effort; older kernels just take the faults.
+    //-----------------------------------------------------------------------------------------
+    inline
+    void
+    prefault( char * begin, uint64_t size )
+    {
+#ifdef MADV_POPULATE_WRITE
+      ::madvise( begin, size, MADV_POPULATE_WRITE ) ;
+#endif
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Writer::
+  Writer()
+    : fd_                 ( -1 )
+    , index_fd_           ( -1 )
+    , error_              ( 0 )
+    , begin_              ( NULL )
+    , mapped_             ( 0 )
+    , offset_             ( 0 )
+    , record_count_       ( 0 )
+    , last_sequence_      ( 0 )
+    , chunk_size_         ( Default_Chunk_Size )
+    , checkpoint_interval_( Default_Checkpoint_Interval )
+    , pending_            ( 0 )
+    , header_             ( NULL )
+  {
+    std::memset( &first_, 0, sizeof( first_ ) ) ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Writer::
+  ~Writer()
+  { close() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Writer::
+  open( const std::string & path
+      , uint32_t            element_size
+      , uint64_t            type_hash
+      , uint64_t            chunk_size
+      , uint32_t            checkpoint_interval
+      )
+  {
+    close() ;
+
+    fd_ = ::open( path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644 ) ;
+    struct ::stat st ;
+    if( fd_ < 0 || ::fstat( fd_, &st ) != 0 )
+    { error_ = errno ;
+      close() ;
+      return false ;
+    }
+
+    bool existing = ( st.st_size > 0 ) ;
+    if( existing && static_cast<uint64_t>( st.st_size ) < FileHeader::Size )
+    { error_ = EPROTO ;
+      close() ;
+      return false ;
+    }
+
+    // Round the chunk size up to whole pages.
+    uint64_t page = ::sysconf( _SC_PAGESIZE ) ;
+    chunk_size_          = std::max( ( chunk_size + page - 1 ) & ~( page - 1 ), page ) ;
+    checkpoint_interval_ = std::max( checkpoint_interval, 1u ) ;
+
+    uint64_t size = existing ? st.st_size : FileHeader::Size ;
+    size = ( size + chunk_size_ + page - 1 ) & ~( page - 1 ) ;
+    if( ( error_ = allocate( fd_, size ) ) != 0
+     || ( begin_ = static_cast<char *>( map_file( fd_, PROT_READ | PROT_WRITE, NULL, 0, size ) ) ) == NULL )
+    { if( error_ == 0 )
+        error_ = errno ;
+      close() ;
+      return false ;
+    }
+
+    mapped_ = size ;
+    header_ = reinterpret_cast<FileHeader *>( begin_ ) ;
+
+    if( existing )
+    {
+      if( header_->magic_ != FileHeader::Magic || header_->version_ != FileHeader::Version )
+        error_ = EPROTO ;
+      else if( header_->element_size_ != element_size || header_->type_hash_ != type_hash )
+        error_ = EINVAL ;
+
+      if( error_ != 0 )
+      { // Don't leave the file any bigger than we found it.
+        ::munmap( begin_, mapped_ ) ;
+        begin_  = NULL ;
+        header_ = NULL ;
+        if( ::ftruncate( fd_, st.st_size ) != 0 )
+          { /* Nothing more to be done */ }
+        int32_t error = error_ ;
+        close() ;
+        error_ = error ;
+        return false ;
+      }
+
+      recover( st.st_size ) ;
+    }
+    else
+    { header_->magic_        = FileHeader::Magic ;
+      header_->version_      = FileHeader::Version ;
+      header_->element_size_ = element_size ;
+      header_->type_hash_    = type_hash ;
+      header_->created_      = time::Clock::now() ;
+      header_->committed_.store   ( FileHeader::Size, std::memory_order_relaxed ) ;
+      header_->record_count_.store( 0, std::memory_order_relaxed ) ;
+      header_->sequence_.store    ( 0, std::memory_order_release ) ;
+      offset_ = FileHeader::Size ;
+    }
+
+    // Only the space past the recovered records is about to be written; the
+    // records themselves needn't be dirtied.
+    uint64_t tail = offset_ & ~( page - 1 ) ;
+    prefault( begin_ + tail, mapped_ - tail ) ;
+
+    index_fd_ = ::open( index_path( path ).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 ) ;
+    if( index_fd_ < 0 )
+    { error_ = errno ;
+      close() ;
+      return false ;
+    }
+
+    path_ = path ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Writer::
+  recover( uint64_t file_size )
+  {
+    offset_        = header_->committed_.load( std::memory_order_acquire ) ;
+    record_count_  = header_->record_count_.load( std::memory_order_relaxed ) ;
+    last_sequence_ = header_->sequence_.load( std::memory_order_relaxed ) ;
+
+    // Records appended after the last checkpoint are kept, up to the first incomplete one.
+    while( offset_ + sizeof( RecordHeader ) <= mapped_ )
+    {
+      const RecordHeader * record = reinterpret_cast<const RecordHeader *>( begin_ + offset_ ) ;
+      uint32_t             size   = record->size_.load( std::memory_order_acquire ) ;
+      if( size < sizeof( RecordHeader ) || offset_ + padded_size( size ) > mapped_ )
+        break ;
+
+      offset_ += padded_size( size ) ;
+      last_sequence_ = record->sequence_ ;
+      ++record_count_ ;
+    }
+
+    // An incomplete record's size is still zero, but the bytes after it may not be, and
+    // the records we append needn't line up w/ the ones the last writer was appending.
+    if( file_size > offset_ )
+      std::memset( begin_ + offset_, 0, file_size - offset_ ) ;
+    pending_ = 0 ;
+    checkpoint() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Writer::
+  grow( uint64_t bytes )
+  {
+    uint64_t size = mapped_ + std::max( chunk_size_, ( bytes + sizeof( RecordHeader ) + chunk_size_ - 1 ) / chunk_size_ * chunk_size_ ) ;
+    int32_t  rv   = allocate( fd_, size ) ;
+    if( rv != 0 )
+    { error_ = rv ;
+      return false ;
+    }
+
+    char * begin = static_cast<char *>( map_file( fd_, PROT_READ | PROT_WRITE, begin_, mapped_, size ) ) ;
+    if( begin == NULL )
+    { error_ = errno ;
+      return false ;
+    }
+
+    prefault( begin + mapped_, size - mapped_ ) ;
+    begin_  = begin ;
+    header_ = reinterpret_cast<FileHeader *>( begin_ ) ;
+    mapped_ = size ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Writer::
+  checkpoint()
+  {
+    if( header_ == NULL )
+      return ;
+
+    // A failed index write only costs readers some scanning.
+    if( pending_ > 0 && index_fd_ >= 0 && ::write( index_fd_, &first_, sizeof( first_ ) ) != sizeof( first_ ) )
+      error_ = errno ;
+
+    header_->record_count_.store( record_count_,  std::memory_order_relaxed ) ;
+    header_->sequence_.store    ( last_sequence_, std::memory_order_relaxed ) ;
+    header_->committed_.store   ( offset_,        std::memory_order_release ) ;
+    pending_ = 0 ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Writer::
+  flush()
+  {
+    if( header_ == NULL )
+      return false ;
+
+    checkpoint() ;
+    if( ::msync( begin_, offset_, MS_SYNC ) != 0 || ::fdatasync( index_fd_ ) != 0 )
+    { error_ = errno ;
+      return false ;
+    }
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Writer::
+  close()
+  {
+    if( header_ != NULL )
+    { checkpoint() ;
+      ::munmap( begin_, mapped_ ) ;
+
+      // Give back the unused part of the last chunk.  The zero size after the last record
+      // stays, and so does the page it's on : a reader may have it mapped.
+      uint64_t page = ::sysconf( _SC_PAGESIZE ) ;
+      if( ::ftruncate( fd_, ( offset_ + sizeof( RecordHeader ) + page - 1 ) & ~( page - 1 ) ) != 0 )
+        { /* The next writer will reuse it */ }
+    }
+
+    if( index_fd_ >= 0 )
+      ::close( index_fd_ ) ;
+
+    if( fd_ >= 0 )
+      ::close( fd_ ) ;
+
+    fd_            = -1 ;
+    index_fd_      = -1 ;
+    error_         = 0 ;
+    begin_         = NULL ;
+    mapped_        = 0 ;
+    offset_        = 0 ;
+    record_count_  = 0 ;
+    last_sequence_ = 0 ;
+    pending_       = 0 ;
+    header_        = NULL ;
+    path_.clear() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Reader::
+  Reader()
+    : fd_    ( -1 )
+    , error_ ( 0 )
+    , begin_ ( NULL )
+    , mapped_( 0 )
+    , offset_( 0 )
+    , header_( NULL )
+  {
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Reader::
+  ~Reader()
+  { close() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Reader::
+  open( const std::string & path, uint32_t element_size, uint64_t type_hash )
+  {
+    close() ;
+
+    fd_ = ::open( path.c_str(), O_RDONLY | O_CLOEXEC ) ;
+    if( fd_ < 0 )
+    { error_ = errno ;
+      return false ;
+    }
+
+    if( !remap() || mapped_ < FileHeader::Size )
+    { error_ = ( error_ != 0 ) ? error_ : EPROTO ;
+      int32_t error = error_ ;
+      close() ;
+      error_ = error ;
+      return false ;
+    }
+
+    const FileHeader * header = reinterpret_cast<const FileHeader *>( begin_ ) ;
+    if( header->magic_ != FileHeader::Magic || header->version_ != FileHeader::Version )
+      error_ = EPROTO ;
+    else if( ( element_size != 0 && header->element_size_ != element_size )
+          || ( type_hash    != 0 && header->type_hash_    != type_hash ) )
+      error_ = EINVAL ;
+
+    if( error_ != 0 )
+    { int32_t error = error_ ;
+      close() ;
+      error_ = error ;
+      return false ;
+    }
+
+    header_ = header ;
+    offset_ = FileHeader::Size ;
+    path_   = path ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Reader::
+  close()
+  {
+    if( begin_ != NULL )
+      ::munmap( const_cast<char *>( begin_ ), mapped_ ) ;
+
+    if( fd_ >= 0 )
+      ::close( fd_ ) ;
+
+    fd_     = -1 ;
+    error_  = 0 ;
+    begin_  = NULL ;
+    mapped_ = 0 ;
+    offset_ = 0 ;
+    header_ = NULL ;
+    path_.clear() ;
+    index_.clear() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Reader::
+  remap()
+  {
+    struct ::stat st ;
+    if( ::fstat( fd_, &st ) != 0 )
+    { error_ = errno ;
+      return false ;
+    }
+
+    // Mappings are whole pages; the file may not be.
+    uint64_t size = st.st_size ;
+    if( size <= mapped_ )
+      return false ;
+
+    void * begin = map_file( fd_, PROT_READ, const_cast<char *>( begin_ ), mapped_, size ) ;
+    if( begin == NULL )
+    { error_ = errno ;
+      return false ;
+    }
+
+    begin_  = static_cast<const char *>( begin ) ;
+    mapped_ = size ;
+    if( header_ != NULL )
+      header_ = reinterpret_cast<const FileHeader *>( begin_ ) ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  const RecordHeader *
+  Reader::
+  next()
+  {
+    if( fps_unlikely( header_ == NULL ) )
+      return NULL ;
+
+    if( offset_ + sizeof( RecordHeader ) > mapped_ && !remap() )
+      return NULL ;
+
+    const RecordHeader * record = reinterpret_cast<const RecordHeader *>( begin_ + offset_ ) ;
+    uint32_t             size   = record->size_.load( std::memory_order_acquire ) ;
+    if( size < sizeof( RecordHeader ) )
+      return NULL ;
+
+    uint64_t padded = padded_size( size ) ;
+    if( offset_ + padded > mapped_ )
+    { // A record that runs off the end of the file is corrupt, not pending.
+      if( !remap() || offset_ + padded > mapped_ )
+        return NULL ;
+      record = reinterpret_cast<const RecordHeader *>( begin_ + offset_ ) ;
+    }
+
+    offset_ += padded ;
+    return record ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Reader::
+  load_index()
+  {
+    index_.clear() ;
+
+    int32_t fd = ::open( index_path( path_ ).c_str(), O_RDONLY | O_CLOEXEC ) ;
+    if( fd < 0 )
+      return false ;
+
+    IndexEntry entries[ 256 ] ;
+    for( ;; )
+    { ssize_t count = ::read( fd, entries, sizeof( entries ) ) ;
+      if( count < 0 && errno == EINTR )
+        continue ;
+      if( count <= 0 )
+        break ;
+      index_.insert( index_.end(), entries, entries + count / sizeof( IndexEntry ) ) ;
+    }
+
+    ::close( fd ) ;
+    return !index_.empty() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Reader::
+  seek( uint64_t sequence )
+  {
+    rewind() ;
+    if( header_ == NULL )
+      return ;
+
+    // The index may have grown since the last seek.
+    if( load_index() )
+    { auto itr = std::upper_bound( index_.begin()
+                                 , index_.end()
+                                 , sequence
+                                 , []( uint64_t seq, const IndexEntry & entry ) { return seq < entry.sequence_ ; }
+                                 ) ;
+      if( itr != index_.begin() )
+        offset_ = ( itr - 1 )->offset_ ;
+    }
+
+    for( ;; )
+    { uint64_t             offset = offset_ ;
+      const RecordHeader * record = next() ;
+      if( record == NULL || record->sequence_ >= sequence )
+      { offset_ = offset ;
+        return ;
+      }
+    }
+  }
+
+}}}
@@ -0,0 +1,316 @@
+#ifndef FPS__IPC__JOURNAL__H
+#define FPS__IPC__JOURNAL__H
+
+#include "fps_util/macros.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//
+// Append-only, memory mapped message journal.  Used to tee shm queues to
+// disk for replay and audit ( see swmr_shm_queue_journal.h ), but knows
+// nothing about queues itself.
+//
+// Layout of '<path>' :
+//
+//   FileHeader      : One page.  Identifies the journal and, at each
+//                     checkpoint, publishes how much of the file is valid.
+//   Record...       : RecordHeader + payload, padded to Record_Alignment.
+//                     A zero size marks the end of the data.
+//
+// '<path>.idx' holds an IndexEntry per checkpoint ( sequence, timestamp and
+// file offset of the first record it covers ), so readers can seek without
+// scanning the whole journal.
+//
+// The writer grows the file a chunk at a time and appends w/ plain stores
+// into the mapping; a record's size is stored last ( w/ release order ),
+// so a concurrent reader never sees a partial record, and a writer that
+// dies mid-append leaves a journal that ends at its last complete record.
+// No system calls are made per record : only when a chunk fills up, at
+// checkpoints ( one small write to the index ), and on flush().
+//
+namespace fps     {
+namespace ipc     {
+namespace journal {
+
+  //--------------------------------------------------------------------------
+  static const uint32_t Record_Alignment            = 8 ;
+  static const uint64_t Default_Chunk_Size          = 64ull * 1024 * 1024 ;
+  static const uint32_t Default_Checkpoint_Interval = 65536 ;
+  static const char     Index_Suffix[]              = ".idx" ;
+
+  //--------------------------------------------------------------------------
+  namespace record_flags
+  {
+    static const uint32_t None = 0 ;
+    static const uint32_t Gap  = 1 ;   // Payload-less; 'sequence_' is the first message lost.
+  }
+
+  //--------------------------------------------------------------------------
+  struct FileHeader
+  {
+    //------------------------------------------------------------------------
+    static const uint64_t Magic   = 0x4c4e52554f4a5046ull ;  // "FPJOURNL"
+    static const uint32_t Version = 1 ;
+    static const uint32_t Size    = 4096 ;  // Records start here.
+
+    //------------------------------------------------------------------------
+    uint64_t              magic_        ;
+    uint32_t              version_      ;
+    uint32_t              element_size_ ;  // Zero if records vary in length.
+    uint64_t              type_hash_    ;  // Zero if untyped.
+    uint64_t              created_      ;  // time::Clock::now() at creation.
+    std::atomic<uint64_t> committed_    ;  // End of the data as of the last checkpoint.
+    std::atomic<uint64_t> record_count_ ;  // Records as of the last checkpoint.
+    std::atomic<uint64_t> sequence_     ;  // Last record's sequence as of the last checkpoint.
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct RecordHeader
+  {
+    //------------------------------------------------------------------------
+    std::atomic<uint32_t> size_      ;  // Header + payload bytes, stored last.  Zero ends the data.
+    uint32_t              flags_     ;  // record_flags.
+    uint64_t              sequence_  ;  // Source sequence number.
+    uint64_t              timestamp_ ;  // Capture time, time::Clock::now().
+
+    //------------------------------------------------------------------------
+    inline const char * payload() const { return reinterpret_cast<const char *>( this + 1 ) ; }
+    inline char       * payload()       { return reinterpret_cast<char *>( this + 1 ) ; }
+
+    //------------------------------------------------------------------------
+    inline uint32_t length() const { return size_.load( std::memory_order_relaxed ) - sizeof( RecordHeader ) ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct IndexEntry
+  {
+    uint64_t sequence_  ;
+    uint64_t timestamp_ ;
+    uint64_t offset_    ;
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Bytes a record of 'size' bytes ( see RecordHeader::size_ ) occupies in
+  // the file.
+  //--------------------------------------------------------------------------
+  inline
+  uint64_t
+  padded_size( uint32_t size )
+  { return ( size + Record_Alignment - 1 ) & ~uint64_t( Record_Alignment - 1 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  inline
+  std::string
+  index_path( const std::string & path )
+  { return path + Index_Suffix ;
+  }
+
+  //--------------------------------------------------------------------------
+  // Single threaded appender.
+  //--------------------------------------------------------------------------
+  class Writer
+  {
+  private :
+    //------------------------------------------------------------------------
+    int32_t      fd_ ;
+    int32_t      index_fd_ ;
+    int32_t      error_ ;
+    char       * begin_ ;
+    uint64_t     mapped_ ;            // Bytes mapped ( and allocated on disk ).
+    uint64_t     offset_ ;            // End of the data.
+    uint64_t     record_count_ ;
+    uint64_t     last_sequence_ ;
+    uint64_t     chunk_size_ ;
+    uint32_t     checkpoint_interval_ ;
+    uint32_t     pending_ ;           // Records since the last checkpoint.
+    IndexEntry   first_ ;             // First record since the last checkpoint.
+    FileHeader * header_ ;
+    std::string  path_ ;
+
+    Writer( const Writer & ) ;
+    Writer & operator=( const Writer & ) ;
+
+    //------------------------------------------------------------------------
+    // Extend the file and mapping so that 'bytes' more fit after offset_.
+    //------------------------------------------------------------------------
+    bool grow( uint64_t bytes ) ;
+
+    //------------------------------------------------------------------------
+    // Find the end of the data in a journal being reopened.
+    //------------------------------------------------------------------------
+    void recover( uint64_t file_size ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    Writer() ;
+    ~Writer() ;
+
+    //------------------------------------------------------------------------
+    // Open 'path' for appending, creating it if need be.  An existing
+    // journal must have the same 'element_size' and 'type_hash' ( EINVAL
+    // otherwise ), and is appended to after its last complete record.
+    // The file grows 'chunk_size' bytes at a time, and a checkpoint is
+    // taken every 'checkpoint_interval' records.  Returns false and sets
+    // last_error() on failure.
+    //------------------------------------------------------------------------
+    bool open( const std::string & path
+             , uint32_t            element_size        = 0
+             , uint64_t            type_hash           = 0
+             , uint64_t            chunk_size          = Default_Chunk_Size
+             , uint32_t            checkpoint_interval = Default_Checkpoint_Interval
+             ) ;
+
+    //------------------------------------------------------------------------
+    // Checkpoint, then trim the file to the page holding the end of the data.
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Append a record.  Returns false and sets last_error() if the file
+    // couldn't be grown ( the record is dropped ).
+    //------------------------------------------------------------------------
+    inline
+    bool
+    append( const void * payload
+          , uint32_t     length
+          , uint64_t     sequence
+          , uint64_t     timestamp
+          , uint32_t     flags = record_flags::None
+          )
+    {
+      uint32_t size   = sizeof( RecordHeader ) + length ;
+      uint64_t padded = padded_size( size ) ;
+
+      // One spare header for the terminating zero size.
+      if( fps_unlikely( offset_ + padded + sizeof( RecordHeader ) > mapped_ ) && !grow( padded ) )
+        return false ;
+
+      if( fps_unlikely( pending_ == 0 ) )
+      { first_.sequence_  = sequence ;
+        first_.timestamp_ = timestamp ;
+        first_.offset_    = offset_ ;
+      }
+
+      RecordHeader * record = reinterpret_cast<RecordHeader *>( begin_ + offset_ ) ;
+      record->flags_     = flags ;
+      record->sequence_  = sequence ;
+      record->timestamp_ = timestamp ;
+      std::memcpy( record->payload(), payload, length ) ;
+      record->size_.store( size, std::memory_order_release ) ;
+
+      offset_       += padded ;
+      last_sequence_ = sequence ;
+      ++record_count_ ;
+      if( fps_unlikely( ++pending_ >= checkpoint_interval_ ) )
+        checkpoint() ;
+      return true ;
+    }
+
+    //------------------------------------------------------------------------
+    // Note that messages [ first, first + count ) were lost upstream.
+    //------------------------------------------------------------------------
+    inline
+    bool
+    append_gap( uint64_t first, uint64_t count, uint64_t timestamp )
+    { return append( &count, sizeof( count ), first, timestamp, record_flags::Gap ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Publish the data appended so far in the file header, and index the
+    // records appended since the last checkpoint.
+    //------------------------------------------------------------------------
+    void checkpoint() ;
+
+    //------------------------------------------------------------------------
+    // Checkpoint and msync().  Only needed to survive a machine ( rather
+    // than process ) failure; the page cache holds everything else.
+    //------------------------------------------------------------------------
+    bool flush() ;
+
+    //------------------------------------------------------------------------
+    inline bool                is_open()       const { return header_ != NULL ; }
+    inline int32_t             last_error()    const { return error_ ; }
+    inline uint64_t            record_count()  const { return record_count_ ; }
+    inline uint64_t            last_sequence() const { return last_sequence_ ; }
+    inline uint64_t            size()          const { return offset_ ; }
+    inline const std::string & path()          const { return path_ ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Sequential reader.  May follow a journal that's still being written :
+  // next() picks up records appended since open(), remapping as the file
+  // grows.
+  //--------------------------------------------------------------------------
+  class Reader
+  {
+  private :
+    //------------------------------------------------------------------------
+    int32_t                 fd_ ;
+    int32_t                 error_ ;
+    const char            * begin_ ;
+    uint64_t                mapped_ ;
+    uint64_t                offset_ ;   // Next record.
+    const FileHeader      * header_ ;
+    std::string             path_ ;
+    std::vector<IndexEntry> index_ ;
+
+    Reader( const Reader & ) ;
+    Reader & operator=( const Reader & ) ;
+
+    //------------------------------------------------------------------------
+    // Remap if the file has grown.  Returns true if it had.
+    //------------------------------------------------------------------------
+    bool remap() ;
+
+    //------------------------------------------------------------------------
+    bool load_index() ;
+
+  public :
+    //------------------------------------------------------------------------
+    Reader() ;
+    ~Reader() ;
+
+    //------------------------------------------------------------------------
+    // Open 'path' and position at the first record.  Fails w/ EPROTO if the
+    // file isn't a journal, EINVAL if 'element_size' or 'type_hash' are non
+    // zero and don't match the journal's.
+    //------------------------------------------------------------------------
+    bool open( const std::string & path, uint32_t element_size = 0, uint64_t type_hash = 0 ) ;
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Return the next record and step past it, or NULL at the end of the
+    // data.  The record remains valid until the next call to next() or
+    // seek().
+    //------------------------------------------------------------------------
+    const RecordHeader * next() ;
+
+    //------------------------------------------------------------------------
+    // Position at the first record w/ a sequence number of at least
+    // 'sequence', using the index to skip most of the journal.
+    //------------------------------------------------------------------------
+    void seek( uint64_t sequence ) ;
+
+    //------------------------------------------------------------------------
+    inline void rewind() { offset_ = FileHeader::Size ; }
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()      const { return header_ != NULL ; }
+    inline int32_t  last_error()   const { return error_ ; }
+    inline uint64_t offset()       const { return offset_ ; }
+    inline uint32_t element_size() const { return header_ ? header_->element_size_ : 0 ; }
+    inline uint64_t type_hash()    const { return header_ ? header_->type_hash_ : 0 ; }
+
+    //------------------------------------------------------------------------
+    // As of the writer's last checkpoint.
+    //------------------------------------------------------------------------
+    inline uint64_t committed_count() const { return header_ ? header_->record_count_.load( std::memory_order_acquire ) : 0 ; }
+  } ;
+
+}}}
+
+#endif
@@ -1,5 +1,8 @@
 #include "fps_ipc/mapped_memory.h"
 #include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
 
 namespace fps {
 namespace ipc {
@@ -25,7 +28,7 @@ namespace ipc {
     { 
       error_ = errno ;
       throw except::RuntimeError
-            ( "ipc::MappedMemory :: Failed to map memory ( fd: %d, size: %u, errno: %d )"
+            ( "ipc::MappedMemory :: Failed to map memory ( fd: %d, size: %lu, errno: %d )"
             , shm.fd()
             , shm.size()
             , error_  
@@ -37,8 +40,8 @@ namespace ipc {
   MappedMemory::
   MappedMemory( const SharedMemory & shm
               , uint32_t             flags 
-              , uint32_t             size
-              , uint32_t             offset
+              , uint64_t             size
+              , uint64_t             offset
               ) 
     : begin_ ( NULL )
     , size_  ( 0 )
@@ -53,7 +56,7 @@ namespace ipc {
     if( size > shm.size() || offset > size ) 
     { error_ = EINVAL ;
       throw except::RuntimeError
-            ( "ipc::MappedMemory :: Requested size %u exceeds available size %lu"
+            ( "ipc::MappedMemory :: Requested size %lu exceeds available size %lu"
             , size
             , shm.size() 
             ) ;
@@ -67,7 +70,7 @@ namespace ipc {
     if( !open( shm, flags, size, offset ) ) 
     { error_ = errno ;
       throw except::RuntimeError
-            ( "ipc::MappedMemory :: Failed to map memory ( fd: %d, size: %u, errno: %d )"
+            ( "ipc::MappedMemory :: Failed to map memory ( fd: %d, size: %lu, errno: %d )"
             , shm.fd()
             , shm.size()
             , error_ 
@@ -76,30 +79,85 @@ namespace ipc {
   }
 
 
+  //-------------------------------------------------------------------------------------------
+  bool
+  MappedMemory::
+  bind_numa_node( void * ptr, uint64_t size, int32_t node ) 
+  {
+    unsigned long node_mask[ ( constants::Max_Numa_Node + 1 + 63 ) / 64 ] = { 0 } ;
+    node_mask[ node / 64 ] |= 1UL << ( node % 64 ) ;
+
+    // The shared policy set here applies to every process mapping the segment.  
+    // MPOL_MF_MOVE migrates pages that were already faulted in elsewhere.
+    return 0 == ::syscall( SYS_mbind
+                         , ptr
+                         , size
+                         , MPOL_BIND
+                         , node_mask
+                         , sizeof( node_mask ) * 8
+                         , MPOL_MF_MOVE 
+                         ) ;
+  }
+
   //-------------------------------------------------------------------------------------------
   void * 
   MappedMemory::
   map_memory( int32_t     fd
             , uint32_t    flags
-            , uint32_t    size 
-            , uint32_t    offset 
+            , uint64_t    size 
+            , uint64_t    offset 
+            , uint64_t    page_size
             ) 
   {
     int32_t mmap_prot = PROT_READ ;
     if( flags & access::Read_Write ) 
       mmap_prot |= PROT_WRITE ;
+
+    // Pages must be bound to their numa node before they're faulted in, so 
+    // MAP_POPULATE can only be used for unbound mappings.
+    int32_t numa_node  = access::numa_node_of( flags ) ;
+    bool    prefault   = ( flags & ( access::Populate | access::Lock ) ) ;
+    int32_t mmap_flags = MAP_SHARED ;
+    if( prefault && numa_node < 0 ) 
+      mmap_flags |= MAP_POPULATE ;
   
-    void * rv = ::mmap( NULL, size, mmap_prot, MAP_SHARED, fd, offset ) ;
-    return ( rv == MAP_FAILED ) 
-           ? NULL 
-           : rv 
-           ;
+    void * rv = ::mmap( NULL, size, mmap_prot, mmap_flags, fd, offset ) ;
+    if( rv == MAP_FAILED ) 
+      return NULL ;
+
+    if( numa_node >= 0 ) 
+    { 
+      if( !bind_numa_node( rv, size, numa_node ) ) 
+      { int32_t last_err = errno ;
+        unmap_memory( rv, size ) ;
+        errno = last_err ;
+        return NULL ;
+      }
+
+      // Touch one byte per page ( per huge page on hugetlbfs ).  A read fault is 
+      // enough to allocate a shared page, and works for read only mappings too.
+      if( prefault ) 
+      { const volatile char * bytes = static_cast<const volatile char *>( rv ) ;
+        uint64_t              step  = ( page_size > 0 ) ? page_size : ::sysconf( _SC_PAGESIZE ) ;
+        for( uint64_t idx = 0 ; idx < size ; idx += step ) 
+          (void)bytes[ idx ] ;
+      }
+    }
+
+    if( ( flags & access::Lock ) && ::mlock( rv, size ) != 0 ) 
+    { int32_t last_err = errno ;
+      unmap_memory( rv, size ) ;
+      errno = last_err ;
+      return NULL ;
+    }
+
+    return rv ;
   }
 
   //-------------------------------------------------------------------------------------------
   bool
   MappedMemory::
-  unmap_memory( void * ptr, uint32_t size ) 
+  unmap_memory( void * ptr, uint64_t size ) 
   {
     return ( 0 == ::munmap( ptr, size ) ) ;
   }
@@ -110,8 +168,8 @@ namespace ipc {
   open( const SharedMemory & shm, uint32_t flags )
   { 
     error_ = 0 ;
-    uint32_t shm_size = shm.size() ;
-    begin_ = MappedMemory::map_memory( shm.fd(), flags, shm_size, 0 ) ;
+    uint64_t shm_size = shm.size() ;
+    begin_ = MappedMemory::map_memory( shm.fd(), flags, shm_size, 0, shm.page_size() ) ;
     if( begin_ == NULL ) 
     { error_ = errno ;
       return false ;
@@ -125,11 +183,11 @@ namespace ipc {
   //-------------------------------------------------------------------------------------------
   bool
   MappedMemory::
-  open( const SharedMemory & shm, uint32_t flags, uint32_t size, uint32_t offset )
+  open( const SharedMemory & shm, uint32_t flags, uint64_t size, uint64_t offset )
   { 
     error_ = 0 ;
 
-    begin_ = MappedMemory::map_memory( shm.fd(), flags, size, offset ) ;
+    begin_ = MappedMemory::map_memory( shm.fd(), flags, size, offset, shm.page_size() ) ;
     if( begin_ == NULL ) 
     { error_ = errno ;
       return false ;
@@ -4,7 +4,6 @@
 #include <errno.h>
 #include <unistd.h>
 #include <cstdint>
-#include <errno.h>
 
 #include "fps_ipc/shared_memory.h"
 #include "fps_ipc/ipc_util.h"
@@ -19,19 +18,29 @@ namespace ipc {
   private :
     //-------------------------------------------------------------------------------------------
     void       * begin_ ;
-    uint32_t     size_  ;
-    uint32_t     offset_ ;
+    uint64_t     size_  ;
+    uint64_t     offset_ ;
     uint32_t     error_ ;
 
+    //-------------------------------------------------------------------------------------------
+    // Map 'size' bytes of 'fd' at 'offset', then apply the numa binding, prefaulting and 
+    // locking requested by 'flags'.  'page_size' is that of the backing filesystem ( huge 
+    // for hugetlbfs ), or zero for the system page size.  Returns NULL and leaves errno 
+    // set on failure.
     //-------------------------------------------------------------------------------------------
     static
     void * 
-    map_memory( int32_t fd, uint32_t flags, uint32_t size, uint32_t offset ) ;
+    map_memory( int32_t fd, uint32_t flags, uint64_t size, uint64_t offset, uint64_t page_size ) ;
+
+    //-------------------------------------------------------------------------------------------
+    static 
+    bool
+    unmap_memory( void * ptr, uint64_t size ) ;
 
     //-------------------------------------------------------------------------------------------
     static 
     bool
-    unmap_memory( void * ptr, uint32_t size ) ;
+    bind_numa_node( void * ptr, uint64_t size, int32_t node ) ;
 
     //-------------------------------------------------------------------------------------------
     MappedMemory( const MappedMemory & ) = delete ;
@@ -55,8 +64,8 @@ namespace ipc {
     //-------------------------------------------------------------------------------------------
     MappedMemory( const SharedMemory & shm
                 , uint32_t             flags
-                , uint32_t             size
-                , uint32_t             offset
+                , uint64_t             size
+                , uint64_t             offset
                 ) ;
 
     //-------------------------------------------------------------------------------------------
@@ -70,9 +79,16 @@ namespace ipc {
     // or false on failure.  On failure, the internal error_ member will be populated with the
     // relevant system errno value describing the problem.  Users may check this value via the 
     // 'last_error()' function.
+    //
+    // Besides access::Read_Only/Read_Write, 'flags' may include :
+    //   access::Populate       ( Prefault every page now rather than on first touch )
+    //   access::Lock           ( Prefault and mlock() the mapping; subject to RLIMIT_MEMLOCK )
+    //   access::numa_node( n ) ( Bind the segment's pages to numa node 'n' before prefaulting )
+    //
+    // Pages already faulted in on another node are migrated where the kernel allows it.
     //-------------------------------------------------------------------------------------------
     bool open( const SharedMemory & shm, uint32_t flags ) ;
-    bool open( const SharedMemory & shm, uint32_t flags, uint32_t size, uint32_t offset ) ;
+    bool open( const SharedMemory & shm, uint32_t flags, uint64_t size, uint64_t offset ) ;
 
     //-------------------------------------------------------------------------------------------
     // The close() function unmaps this memory region and resets all member variables.
@@ -83,8 +99,8 @@ namespace ipc {
     //-------------------------------------------------------------------------------------------
     inline bool         is_open()    const { return begin_ != NULL ; }
     inline const void * begin()      const { return begin_  ; }
-    inline uint32_t     size()       const { return size_   ; }
-    inline uint32_t     offset()     const { return offset_ ; }
+    inline uint64_t     size()       const { return size_   ; }
+    inline uint64_t     offset()     const { return offset_ ; }
     inline uint32_t     last_error() const { return error_ ; }
 
     //-------------------------------------------------------------------------------------------
@@ -101,6 +117,29 @@ namespace ipc {
     { return !is_open() ? NULL : reinterpret_cast<const T *>( begin_ ) ;
     }
   
+    //-------------------------------------------------------------------------------------------
+    // Cast the region 'offset' bytes into the mapping.  Returns NULL if a T at that offset
+    // wouldn't fit inside the mapping.
+    //-------------------------------------------------------------------------------------------
+    template<typename T>
+    T * 
+    cast( uint64_t offset ) 
+    { return ( !is_open() || offset + sizeof( T ) > size() ) 
+             ? NULL 
+             : reinterpret_cast<T *>( static_cast<char *>( begin_ ) + offset ) 
+             ;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    template<typename T>
+    const T * 
+    cast( uint64_t offset ) const
+    { return ( !is_open() || offset + sizeof( T ) > size() ) 
+             ? NULL 
+             : reinterpret_cast<const T *>( static_cast<const char *>( begin_ ) + offset ) 
+             ;
+    }
+
     //-------------------------------------------------------------------------------------------
     template<typename T>
     T *  
@@ -123,6 +162,19 @@ namespace ipc {
              ;
     }
 
+    //-------------------------------------------------------------------------------------------
+    // Construct a T 'offset' bytes into the mapping.  Returns NULL if it wouldn't fit.
+    //-------------------------------------------------------------------------------------------
+    template<typename T, typename... Args>
+    T *  
+    construct_at( uint64_t offset, Args &&... args ) 
+    { 
+      return ( !is_open() || offset + sizeof( T ) > size() ) 
+             ? NULL 
+             : new ( static_cast<char *>( begin_ ) + offset ) T( std::forward<Args>( args )... ) 
+             ;
+    }
+
   } ;
 
 }}
@@ -0,0 +1,239 @@
+#ifndef FPS__IPC__MCS_LOCK__H
+#define FPS__IPC__MCS_LOCK__H
+
+#include <atomic>
+#include <cstdint>
+#include "fps_system/fps_system.h"
+#include "fps_ipc/backoff.h"
+#include "fps_except/logic_error.h"
+#include "fps_util/macros.h"
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // MCS queue lock.  Lockers form a FIFO queue through per-locker nodes, and
+  // each waiter spins on a flag in its own node ( its own cache line ), so a
+  // hand-off touches only the releasing and the next locker's lines no matter
+  // how many threads are waiting.
+  //
+  // To be usable from shared memory the nodes live inside the lock and are
+  // linked by slot index rather than by pointer.  Each participating thread
+  // ( or process ) claims a slot once w/ attach() and passes it to lock(),
+  // try_lock() and unlock(), or uses a Handle, which binds a lock to a slot
+  // and provides the usual argument-less lock/try_lock/unlock interface ( so
+  // it works w/ std::lock_guard ).  A slot must not be used by two lockers at
+  // once.
+  //
+  // attach() fails once all Max_Slots are claimed, so callers must check a
+  // Handle's valid() ( or attach()'s result ) before locking.  On an invalid
+  // Handle try_lock() returns false and lock() / unlock() throw
+  // except::LogicError.
+  //
+  // An McsLock may be constructed inside a MappedMemory region ( see
+  // MappedMemory::construct ) and shared between processes.  T_Backoff
+  // controls how waiters spin ( see backoff.h ).
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots = 64, typename T_Backoff = backoff::Default>
+  class McsLock
+  {
+  public :
+    typedef T_Backoff backoff_t ;
+
+    static const uint32_t    Max_Slots    = T_Max_Slots ;
+    static const uint32_t    Invalid_Slot = UINT32_MAX ;
+    static const std::size_t Alignment    = system::cpu::Cache_Line_Size ;
+
+  private :
+    //--------------------------------------------------------------------------
+    // Slot indices are stored plus one, so that zero means 'none'.
+    //--------------------------------------------------------------------------
+    struct alignas( Alignment ) Node
+    {
+      std::atomic<uint32_t> next_ ;     // Successor's slot + 1.
+      std::atomic<uint32_t> waiting_ ;  // Cleared by the predecessor on hand-off.
+      std::atomic<uint32_t> claimed_ ;  // Owned by an attach()ed participant.
+    } ;
+
+    std::atomic<uint32_t> tail_ alignas( Alignment ) ;  // Last queued slot + 1.
+    Node                  nodes_[ Max_Slots ] ;
+
+    McsLock( const McsLock & ) ;
+    McsLock & operator=( const McsLock & ) ;
+
+  public :
+    //--------------------------------------------------------------------------
+    class Handle
+    {
+    private :
+      McsLock * lock_ ;
+      uint32_t  slot_ ;
+
+    public :
+      //------------------------------------------------------------------------
+      inline Handle() : lock_( NULL ), slot_( Invalid_Slot ) {}
+      inline Handle( McsLock & lock ) : lock_( &lock ), slot_( lock.attach() ) {}
+      inline ~Handle() { if( valid() ) lock_->detach( slot_ ) ; }
+
+      //------------------------------------------------------------------------
+      inline bool     valid() const { return lock_ != NULL && slot_ != Invalid_Slot ; }
+      inline uint32_t slot()  const { return slot_ ; }
+
+      //------------------------------------------------------------------------
+      inline
+      void
+      lock()
+      { if( fps_unlikely( !valid() ) )
+          throw except::LogicError( "ipc::McsLock::Handle :: lock() w/o an attached slot" ) ;
+        lock_->lock( slot_ ) ;
+      }
+
+      //------------------------------------------------------------------------
+      inline bool try_lock() { return valid() && lock_->try_lock( slot_ ) ; }
+
+      //------------------------------------------------------------------------
+      inline
+      void
+      unlock()
+      { if( fps_unlikely( !valid() ) )
+          throw except::LogicError( "ipc::McsLock::Handle :: unlock() w/o an attached slot" ) ;
+        lock_->unlock( slot_ ) ;
+      }
+
+    private :
+      Handle( const Handle & ) ;
+      Handle & operator=( const Handle & ) ;
+    } ;
+
+    //--------------------------------------------------------------------------
+    inline McsLock() ;
+
+    //--------------------------------------------------------------------------
+    // Claim a free slot.  Returns Invalid_Slot if all Max_Slots are taken.
+    //--------------------------------------------------------------------------
+    inline uint32_t attach() ;
+
+    //--------------------------------------------------------------------------
+    // Return a slot claimed by attach().  The slot must not hold the lock.
+    //--------------------------------------------------------------------------
+    inline void detach( uint32_t slot ) ;
+
+    //--------------------------------------------------------------------------
+    inline void lock    ( uint32_t slot ) ;
+    inline bool try_lock( uint32_t slot ) ;
+    inline void unlock  ( uint32_t slot ) ;
+
+    //--------------------------------------------------------------------------
+    inline bool is_locked() const { return tail_.load( std::memory_order_acquire ) != 0 ; }
+  } ;
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  McsLock<T_Max_Slots,T_Backoff>::
+  McsLock()
+    : tail_( 0 )
+  {
+    for( uint32_t idx = 0 ; idx < Max_Slots ; ++idx )
+    { nodes_[ idx ].next_.store   ( 0, std::memory_order_relaxed ) ;
+      nodes_[ idx ].waiting_.store( 0, std::memory_order_relaxed ) ;
+      nodes_[ idx ].claimed_.store( 0, std::memory_order_relaxed ) ;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  uint32_t
+  McsLock<T_Max_Slots,T_Backoff>::
+  attach()
+  {
+    for( uint32_t idx = 0 ; idx < Max_Slots ; ++idx )
+    { uint32_t expected = 0 ;
+      if( nodes_[ idx ].claimed_.load( std::memory_order_relaxed ) == 0
+       && nodes_[ idx ].claimed_.compare_exchange_strong( expected, 1, std::memory_order_acquire )
+        )
+        return idx ;
+    }
+    return Invalid_Slot ;
+  }
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  void
+  McsLock<T_Max_Slots,T_Backoff>::
+  detach( uint32_t slot )
+  {
+    if( slot < Max_Slots )
+      nodes_[ slot ].claimed_.store( 0, std::memory_order_release ) ;
+  }
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  void
+  McsLock<T_Max_Slots,T_Backoff>::
+  lock( uint32_t slot )
+  {
+    Node & node = nodes_[ slot ] ;
+    node.next_.store   ( 0, std::memory_order_relaxed ) ;
+    node.waiting_.store( 1, std::memory_order_relaxed ) ;
+
+    // Append ourselves to the queue.  If there was no predecessor the lock is
+    // ours, otherwise link in behind it and spin on our own node.
+    uint32_t prev = tail_.exchange( slot + 1, std::memory_order_acq_rel ) ;
+    if( prev == 0 )
+      return ;
+
+    nodes_[ prev - 1 ].next_.store( slot + 1, std::memory_order_release ) ;
+    for( uint32_t counter = 0
+       ; node.waiting_.load( std::memory_order_acquire )
+       ; ++counter
+       )
+    { T_Backoff::wait( counter ) ;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  bool
+  McsLock<T_Max_Slots,T_Backoff>::
+  try_lock( uint32_t slot )
+  {
+    nodes_[ slot ].next_.store( 0, std::memory_order_relaxed ) ;
+
+    uint32_t expected = 0 ;
+    return tail_.compare_exchange_strong( expected
+                                        , slot + 1
+                                        , std::memory_order_acquire
+                                        , std::memory_order_relaxed
+                                        ) ;
+  }
+
+  //----------------------------------------------------------------------------
+  template<uint32_t T_Max_Slots, typename T_Backoff>
+  void
+  McsLock<T_Max_Slots,T_Backoff>::
+  unlock( uint32_t slot )
+  {
+    Node   & node = nodes_[ slot ] ;
+    uint32_t next = node.next_.load( std::memory_order_acquire ) ;
+    if( next == 0 )
+    {
+      // No known successor : if we're still the tail, the queue is empty.
+      uint32_t expected = slot + 1 ;
+      if( tail_.compare_exchange_strong( expected, 0, std::memory_order_release, std::memory_order_relaxed ) )
+        return ;
+
+      // A successor has swapped itself into tail_ but hasn't linked in yet.
+      for( uint32_t counter = 0
+         ; ( next = node.next_.load( std::memory_order_acquire ) ) == 0
+         ; ++counter
+         )
+      { T_Backoff::wait( counter ) ;
+      }
+    }
+
+    nodes_[ next - 1 ].waiting_.store( 0, std::memory_order_release ) ;
+  }
+
+}}
+
+#endif
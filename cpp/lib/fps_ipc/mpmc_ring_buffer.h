@@ -0,0 +1,194 @@
+#ifndef FPS__IPC__MPMC_RING_BUFFER__H
+#define FPS__IPC__MPMC_RING_BUFFER__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include "fps_util/fps_util.h"      // For fps_likely/unlikely
+#include <type_traits>
+#include <atomic>
+
+//
+// Bounded, lock-free, multi-producer ring buffers.
+//
+// Each slot carries a sequence number that tells producers and consumers
+// whose turn it is : a slot at index 'i' w/ sequence 'pos' ( pos & mask == i )
+// is free for the producer that claims position 'pos', and holds a message
+// for the consumer that claims position 'pos' once its sequence reaches
+// 'pos + 1'.  Producers ( and consumers, in the multi-consumer variant ) claim
+// positions w/ a CAS on their shared index, which lives on its own cache line.
+//
+// The ring holds everything inline and uses only address-free atomics, so it
+// may be constructed in a MappedMemory region ( see MappedMemory::construct )
+// and shared across processes as long as T is trivially copyable.
+//
+
+namespace fps  {
+namespace ipc  {
+namespace mpmc {
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, bool T_Single_Reader = false>
+  class RingBuffer
+  {
+  public :
+    typedef T value_t ;
+    static const uint32_t Capacity      = T_Capacity ;
+    static const bool     Single_Reader = T_Single_Reader ;
+
+    static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0
+                 , "mpmc::RingBuffer capacity must be a power of two"
+                 ) ;
+
+  private :
+    //------------------------------------------------------------------------
+    static const uint64_t Mask = Capacity - 1 ;
+
+    //------------------------------------------------------------------------
+    typedef std::atomic<uint64_t> atomic_pos_t ;
+
+    //------------------------------------------------------------------------
+    struct Slot
+    {
+      atomic_pos_t seq_  ;
+      T            data_ ;
+    } ;
+
+    //------------------------------------------------------------------------
+    atomic_pos_t w_pos_ alignas( system::cpu::Cache_Line_Size ) ;  // Next position to write.
+    atomic_pos_t r_pos_ alignas( system::cpu::Cache_Line_Size ) ;  // Next position to read.
+    Slot         slots_[ Capacity ] alignas( system::cpu::Cache_Line_Size ) ;
+
+    //------------------------------------------------------------------------
+    RingBuffer( const RingBuffer & ) = delete ;
+    RingBuffer & operator=( const RingBuffer & ) = delete ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline RingBuffer() ;
+
+    //------------------------------------------------------------------------
+    // Append 'value'.  Returns false if the ring is full.  Safe to call from
+    // any number of threads ( or processes ) concurrently.
+    //------------------------------------------------------------------------
+    inline bool write( const T & value ) ;
+
+    //------------------------------------------------------------------------
+    // Remove the oldest message into 'dest'.  Returns false if the ring is
+    // empty.  Safe to call concurrently unless Single_Reader is set, in which
+    // case only one thread may read and the claiming CAS is skipped.
+    //------------------------------------------------------------------------
+    inline bool read( T & dest ) ;
+
+    //------------------------------------------------------------------------
+    inline uint32_t capacity() const { return Capacity ; }
+
+    //------------------------------------------------------------------------
+    // Approximate number of messages in the ring ( exact when quiescent ).
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    size() const
+    { uint64_t r_pos = r_pos_.load( std::memory_order_relaxed ) ;
+      uint64_t w_pos = w_pos_.load( std::memory_order_relaxed ) ;
+      return ( w_pos > r_pos ) ? ( w_pos - r_pos ) : 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    inline bool empty() const { return size() == 0 ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, bool T_Single_Reader>
+  RingBuffer<T,T_Capacity,T_Single_Reader>::
+  RingBuffer()
+    : w_pos_( 0 )
+    , r_pos_( 0 )
+  {
+    for( uint32_t idx = 0 ; idx < Capacity ; ++idx )
+      slots_[ idx ].seq_.store( idx, std::memory_order_relaxed ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, bool T_Single_Reader>
+  bool
+  RingBuffer<T,T_Capacity,T_Single_Reader>::
+  write( const T & value )
+  {
+    uint64_t pos = w_pos_.load( std::memory_order_relaxed ) ;
+    Slot   * slot ;
+    for( ;; )
+    {
+      slot = &slots_[ pos & Mask ] ;
+      int64_t diff = static_cast<int64_t>( slot->seq_.load( std::memory_order_acquire ) - pos ) ;
+      if( fps_likely( diff == 0 ) )
+      { // The slot is free - try to claim it.  On failure 'pos' is reloaded.
+        if( w_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          break ;
+      }
+      else if( diff < 0 )
+      { // The slot still holds the message from the previous lap.
+        return false ;
+      }
+      else
+      { // Another producer claimed 'pos' first.
+        pos = w_pos_.load( std::memory_order_relaxed ) ;
+      }
+    }
+
+    slot->data_ = value ;
+    slot->seq_.store( pos + 1, std::memory_order_release ) ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, bool T_Single_Reader>
+  bool
+  RingBuffer<T,T_Capacity,T_Single_Reader>::
+  read( T & dest )
+  {
+    uint64_t pos = r_pos_.load( std::memory_order_relaxed ) ;
+    Slot   * slot ;
+    for( ;; )
+    {
+      slot = &slots_[ pos & Mask ] ;
+      int64_t diff = static_cast<int64_t>( slot->seq_.load( std::memory_order_acquire ) - ( pos + 1 ) ) ;
+      if( fps_likely( diff == 0 ) )
+      {
+        if( Single_Reader )
+        { r_pos_.store( pos + 1, std::memory_order_relaxed ) ;
+          break ;
+        }
+
+        if( r_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          break ;
+      }
+      else if( diff < 0 )
+      { // Nothing has been written to this slot since it was last read.
+        return false ;
+      }
+      else
+      { // Another consumer claimed 'pos' first.
+        pos = r_pos_.load( std::memory_order_relaxed ) ;
+      }
+    }
+
+    dest = slot->data_ ;
+
+    // Hand the slot back to producers for the next lap.
+    slot->seq_.store( pos + Capacity, std::memory_order_release ) ;
+    return true ;
+  }
+
+}
+
+namespace mpsc {
+
+  //--------------------------------------------------------------------------
+  // Multi-producer/single-consumer variant.  The consumer claims positions w/
+  // a plain store instead of a CAS.
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity>
+  using RingBuffer = mpmc::RingBuffer<T, T_Capacity, true> ;
+
+}}}
+
+#endif
@@ -0,0 +1,399 @@
+#include "fps_ipc/notifier.h"
+#include "fps_ipc/constants.h"
+#include "fps_string/format.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+namespace fps    {
+namespace ipc    {
+namespace notify {
+
+  //-------------------------------------------------------------------------------------------
+  namespace
+  {
+    //-----------------------------------------------------------------------------------------
+    inline
+    bool
+    process_alive( int32_t pid )
+    { return pid > 0 && ( ::kill( pid, 0 ) == 0 || errno == EPERM ) ;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // Read 'fd' until it's empty.  Returns true if anything was read.
+    //-----------------------------------------------------------------------------------------
+    bool
+    drain_fd( int32_t fd )
+    {
+      char buffer[ 64 ] ;
+      bool rv = false ;
+      for( ;; )
+      { ssize_t count = ::read( fd, buffer, sizeof( buffer ) ) ;
+        if( count > 0 )
+        { rv = true ;
+          continue ;
+        }
+        if( count < 0 && errno == EINTR )
+          continue ;
+        return rv ;
+      }
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // Create constants::Fifo_Dir if it doesn't exist yet.
+    //-----------------------------------------------------------------------------------------
+    bool
+    make_fifo_dir()
+    {
+      if( ::mkdir( constants::Fifo_Dir, 0777 ) == 0 )
+        return ::chmod( constants::Fifo_Dir, 01777 ) == 0 ;
+      return errno == EEXIST ;
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------
+  std::string
+  fifo_path( const std::string & queue_name, uint32_t idx )
+  {
+    return string::sprintf( "%s/%s%s.%u", constants::Fifo_Dir, queue_name.c_str(), Segment_Suffix, idx ) ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  EventFd::
+  EventFd()
+    : fd_     ( -1 )
+    , error_  ( 0 )
+    , signals_( 0 )
+  {
+    armed_.store( 0, std::memory_order_relaxed ) ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  EventFd::
+  ~EventFd()
+  { close() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  EventFd::
+  open()
+  {
+    close() ;
+    fd_ = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ;
+    if( fd_ < 0 )
+    { error_ = errno ;
+      return false ;
+    }
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  EventFd::
+  close()
+  {
+    if( fd_ >= 0 )
+      ::close( fd_ ) ;
+
+    fd_      = -1 ;
+    error_   = 0 ;
+    signals_ = 0 ;
+    armed_.store( 0, std::memory_order_relaxed ) ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  EventFd::
+  signal()
+  {
+    // Only fails if the counter would overflow, in which case the reader has
+    // a signal pending anyway.
+    uint64_t one = 1 ;
+    if( ::write( fd_, &one, sizeof( one ) ) == sizeof( one ) )
+      ++signals_ ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  EventFd::
+  drain() const
+  {
+    return ( fd_ >= 0 ) && drain_fd( fd_ ) ;
+  }
+
+namespace detail {
+
+  //-------------------------------------------------------------------------------------------
+  void
+  NotifyBlock::
+  initialize()
+  {
+    header_.initialized_.store( 0, std::memory_order_release ) ;
+
+    for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+    { if( !process_alive( slots_[ idx ].pid_.load( std::memory_order_relaxed ) ) )
+        slots_[ idx ].pid_.store( 0, std::memory_order_relaxed ) ;
+    }
+
+    // Signal every surviving reader once, in case it armed while the previous
+    // writer was going away.
+    uint32_t armed = 0 ;
+    for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+    { if( slots_[ idx ].pid_.load( std::memory_order_relaxed ) != 0 )
+        armed |= ( 1u << idx ) ;
+    }
+    armed_.store( armed, std::memory_order_relaxed ) ;
+
+    header_.magic_      = NotifyHeader::Magic ;
+    header_.version_    = NotifyHeader::Version ;
+    header_.writer_pid_ = ::getpid() ;
+    header_.initialized_.store( 1, std::memory_order_release ) ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  uint32_t
+  NotifyBlock::
+  attach_reader()
+  {
+    int32_t self = ::getpid() ;
+    for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+    { NotifySlot & slot = slots_[ idx ] ;
+      int32_t      pid  = slot.pid_.load( std::memory_order_acquire ) ;
+      if( pid != 0 && ( pid == self || process_alive( pid ) ) )
+        continue ;
+      if( slot.pid_.compare_exchange_strong( pid, self, std::memory_order_acq_rel ) )
+        return idx ;
+    }
+    return Max_Readers ;
+  }
+
+}
+
+  //-------------------------------------------------------------------------------------------
+  Publisher::
+  Publisher()
+    : error_  ( 0 )
+    , signals_( 0 )
+    , block_  ( NULL )
+  {
+    for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+    { fds_[ idx ]         = -1 ;
+      generations_[ idx ] = 0 ;
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Publisher::
+  ~Publisher()
+  { close() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Publisher::
+  create( const std::string & queue_name )
+  {
+    close() ;
+
+    // A block left behind by a previous writer is reset rather than refused.
+    uint32_t flags = ipc::access::Read_Write | ipc::access::Create ;
+    if( !shm_.open( segment_name( queue_name ), flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( !shm_.resize( sizeof( block_t ) ) || !shm_map_.open( shm_, flags ) )
+    { error_ = shm_.last_error() ? shm_.last_error() : shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    queue_name_ = queue_name ;
+    block_      = shm_map_.cast<block_t>( 0 ) ;
+    block_->initialize() ;
+
+    // Readers that survived a writer restart were armed by initialize().
+    notify() ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Publisher::
+  close()
+  {
+    for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+    { if( fds_[ idx ] >= 0 )
+        ::close( fds_[ idx ] ) ;
+      fds_[ idx ]         = -1 ;
+      generations_[ idx ] = 0 ;
+    }
+
+    if( block_ != NULL )
+      block_->header_.writer_pid_ = 0 ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    error_   = 0 ;
+    signals_ = 0 ;
+    block_   = NULL ;
+    queue_name_.clear() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Publisher::
+  signal( uint32_t mask )
+  {
+    for( uint32_t idx = 0 ; mask != 0 ; ++idx, mask >>= 1 )
+    {
+      if( ( mask & 1 ) == 0 )
+        continue ;
+
+      // A reader ( re )creates its fifo before bumping the slot's generation,
+      // so a changed generation means our fd, if any, is for a fifo nobody
+      // reads anymore.  Fifos are opened read/write : that never blocks, and
+      // a write can't raise SIGPIPE should the reader go away.
+      uint32_t generation = block_->slots_[ idx ].generation_.load( std::memory_order_acquire ) ;
+      if( fds_[ idx ] < 0 || generations_[ idx ] != generation )
+      { if( fds_[ idx ] >= 0 )
+          ::close( fds_[ idx ] ) ;
+        fds_[ idx ]         = ::open( fifo_path( queue_name_, idx ).c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC ) ;
+        generations_[ idx ] = generation ;
+        if( fds_[ idx ] < 0 )
+          continue ;
+      }
+
+      // A full pipe already holds a pending signal.
+      char byte = 1 ;
+      if( ::write( fds_[ idx ], &byte, 1 ) == 1 )
+        ++signals_ ;
+    }
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Subscriber::
+  Subscriber()
+    : error_( 0 )
+    , fd_   ( -1 )
+    , idx_  ( Max_Readers )
+    , block_( NULL )
+  {
+  }
+
+  //-------------------------------------------------------------------------------------------
+  Subscriber::
+  ~Subscriber()
+  { close() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Subscriber::
+  attach( const std::string & queue_name )
+  {
+    close() ;
+
+    uint32_t flags = ipc::access::Read_Write ;
+    if( !shm_.open( segment_name( queue_name ), flags ) )
+    { error_ = ( shm_.last_error() == ENOENT ) ? EAGAIN : shm_.last_error() ;
+      return false ;
+    }
+
+    if( shm_.size() < sizeof( block_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    block_t * block = shm_map_.cast<block_t>( 0 ) ;
+    if( !block->is_valid() )
+    { error_ = EAGAIN ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    uint32_t idx = block->attach_reader() ;
+    if( idx == Max_Readers )
+    { error_ = ENOSPC ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // The fifo is opened read/write so that it never reports a hangup, which
+    // would otherwise keep an epoll set spinning whenever the writer closes
+    // its end.
+    path_ = fifo_path( queue_name, idx ) ;
+    ::unlink( path_.c_str() ) ;
+    if( !make_fifo_dir()
+     || ::mkfifo( path_.c_str(), 0660 ) != 0
+     || ( fd_ = ::open( path_.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC ) ) < 0 )
+    { error_ = errno ;
+      ::unlink( path_.c_str() ) ;
+      block->slots_[ idx ].pid_.store( 0, std::memory_order_release ) ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    block->slots_[ idx ].generation_.fetch_add( 1, std::memory_order_release ) ;
+    block_ = block ;
+    idx_   = idx ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  void
+  Subscriber::
+  close()
+  {
+    // The fifo goes before the slot is released, since the slot's next
+    // owner recreates it under the same name.
+    if( fd_ >= 0 )
+    { ::close( fd_ ) ;
+      ::unlink( path_.c_str() ) ;
+    }
+
+    if( block_ != NULL )
+    { disarm() ;
+      block_->slots_[ idx_ ].pid_.store( 0, std::memory_order_release ) ;
+    }
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    error_ = 0 ;
+    fd_    = -1 ;
+    idx_   = Max_Readers ;
+    block_ = NULL ;
+    path_.clear() ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  Subscriber::
+  drain() const
+  {
+    return ( fd_ >= 0 ) && drain_fd( fd_ ) ;
+  }
+
+}}}
@@ -0,0 +1,311 @@
+#ifndef FPS__IPC__NOTIFIER__H
+#define FPS__IPC__NOTIFIER__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include "fps_util/macros.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include <atomic>
+#include <string>
+
+//
+// Event loop integration for fps_ipc queues.  A consumer that multiplexes
+// sockets, timers and queues on one thread registers the queue's notify fd
+// w/ epoll ( or poll/select ) for readability instead of polling the queue.
+//
+// The writer only makes a system call on an empty to non-empty transition,
+// as seen by a waiting reader : a reader that has drained the queue arms
+// itself, rechecks the queue, and only then blocks on the fd.  After each
+// publish the writer checks for armed readers, disarms them and signals
+// their fds.  Both sides fence between their store and the other side's
+// flag, so a message published while the reader arms is either seen by the
+// reader's recheck or signalled, never neither.  While nobody is armed the
+// writer pays a fence and a load of one cache line per publish; queues that
+// don't enable notification pay a single predictable branch.
+//
+// Two flavors :
+//
+//   EventFd               : In process ( ThreadFifo ).  One eventfd, one
+//                           reader.
+//   Publisher/Subscriber  : Across processes ( swmr::ShmQueueWriter/Reader ).
+//                           A side-band shm block named '<queue>.notify'
+//                           holds a bit per reader, and each reader waits on
+//                           a named fifo of its own, '<queue>.notify.<n>' in
+//                           constants::Fifo_Dir.  Up to Max_Readers readers.
+//
+// The typical consumer loop :
+//
+//   for( ;; )
+//   { while( queue.read( msg ) ) handle( msg ) ;
+//     if( queue.prepare_wait() )
+//       ::epoll_wait( ... ) ;   // notify_fd() is in the epoll set.
+//   }
+//
+
+namespace fps    {
+namespace ipc    {
+namespace notify {
+
+  //--------------------------------------------------------------------------
+  static const uint32_t Max_Readers      = 16 ;
+  static const char     Segment_Suffix[] = ".notify" ;
+
+  //--------------------------------------------------------------------------
+  inline
+  std::string
+  segment_name( const std::string & queue_name )
+  { return queue_name + Segment_Suffix ;
+  }
+
+  //--------------------------------------------------------------------------
+  // Path of reader slot 'idx''s fifo.
+  //--------------------------------------------------------------------------
+  std::string fifo_path( const std::string & queue_name, uint32_t idx ) ;
+
+  //--------------------------------------------------------------------------
+  // In process notifier : an eventfd and an armed flag.  notify() belongs to
+  // the writing thread, arm()/drain() to the reading thread.
+  //--------------------------------------------------------------------------
+  class EventFd
+  {
+  private :
+    //------------------------------------------------------------------------
+    int32_t                       fd_ ;
+    int32_t                       error_ ;
+    uint64_t                      signals_ ;   // Writer only.
+    mutable std::atomic<uint32_t> armed_ alignas( system::cpu::Cache_Line_Size ) ;
+
+    EventFd( const EventFd & ) ;
+    EventFd & operator=( const EventFd & ) ;
+
+    //------------------------------------------------------------------------
+    void signal() ;
+
+  public :
+    //------------------------------------------------------------------------
+    EventFd() ;
+    ~EventFd() ;
+
+    //------------------------------------------------------------------------
+    // Create the eventfd ( non-blocking ).  Returns false and sets
+    // last_error() on failure.
+    //------------------------------------------------------------------------
+    bool open() ;
+    void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return fd_ >= 0 ; }
+    inline int32_t  fd()         const { return fd_ ; }
+    inline int32_t  last_error() const { return error_ ; }
+    inline uint64_t signals()    const { return signals_ ; }
+
+    //------------------------------------------------------------------------
+    // Writer.  Call after publishing.
+    //------------------------------------------------------------------------
+    inline
+    void
+    notify()
+    {
+      if( fps_likely( fd_ < 0 ) )
+        return ;
+
+      std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+      if( fps_unlikely( armed_.load( std::memory_order_relaxed ) != 0 )
+       && armed_.exchange( 0, std::memory_order_acq_rel ) != 0 )
+        signal() ;
+    }
+
+    //------------------------------------------------------------------------
+    // Reader.  arm() must be followed by a recheck of the queue before
+    // blocking; disarm() if the recheck finds messages.  drain() consumes a
+    // pending signal, and returns true if there was one.
+    //------------------------------------------------------------------------
+    inline
+    void
+    arm() const
+    { armed_.store( 1, std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    }
+
+    inline void disarm() const { armed_.store( 0, std::memory_order_relaxed ) ; }
+
+    bool drain() const ;
+  } ;
+
+namespace detail {
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) NotifyHeader
+  {
+    //------------------------------------------------------------------------
+    static const uint64_t Magic   = 0x594649544f4e5046ull ;  // "FPNOTIFY"
+    static const uint32_t Version = 1 ;
+
+    //------------------------------------------------------------------------
+    uint64_t              magic_       ;
+    uint32_t              version_     ;
+    int32_t               writer_pid_  ;  // Zero once the writer has closed the queue.
+    std::atomic<uint32_t> initialized_ ;
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) NotifySlot
+  {
+    std::atomic<int32_t>  pid_        ;  // Owning process, or zero if the slot is free.
+    std::atomic<uint32_t> generation_ ;  // Bumped each time the slot's fifo is recreated.
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Layout of a notify segment.  armed_ has a line of its own since both
+  // the writer and every reader modify it.
+  //--------------------------------------------------------------------------
+  struct NotifyBlock
+  {
+    //------------------------------------------------------------------------
+    NotifyHeader          header_ ;
+    std::atomic<uint32_t> armed_ alignas( system::cpu::Cache_Line_Size ) ;  // Bit 'n' : slot 'n' is waiting.
+    NotifySlot            slots_[ Max_Readers ] ;
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    is_valid() const
+    { return header_.initialized_.load( std::memory_order_acquire ) == 1
+          && header_.magic_   == NotifyHeader::Magic
+          && header_.version_ == NotifyHeader::Version
+           ;
+    }
+
+    //------------------------------------------------------------------------
+    // Writer only.  Slots held by live readers survive a writer restart.
+    //------------------------------------------------------------------------
+    void initialize() ;
+
+    //------------------------------------------------------------------------
+    // Claim a slot for the calling process.  Returns its index, or
+    // Max_Readers if all are in use.
+    //------------------------------------------------------------------------
+    uint32_t attach_reader() ;
+  } ;
+
+}
+
+  //--------------------------------------------------------------------------
+  // Writer side of a cross process notifier.
+  //--------------------------------------------------------------------------
+  class Publisher
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef detail::NotifyBlock block_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    uint64_t          signals_ ;
+    block_t         * block_ ;
+    std::string       queue_name_ ;
+    int32_t           fds_        [ Max_Readers ] ;  // Opened lazily, see signal().
+    uint32_t          generations_[ Max_Readers ] ;  // Slot generation each fd was opened at.
+
+    Publisher( const Publisher & ) ;
+    Publisher & operator=( const Publisher & ) ;
+
+    //------------------------------------------------------------------------
+    void signal( uint32_t mask ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    Publisher() ;
+    ~Publisher() ;
+
+    //------------------------------------------------------------------------
+    // Create ( or reset ) the notify block for 'queue_name'.
+    //------------------------------------------------------------------------
+    bool create( const std::string & queue_name ) ;
+
+    //------------------------------------------------------------------------
+    // Like the queue segments, the block outlives the writer.
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return block_ != NULL ; }
+    inline int32_t  last_error() const { return error_ ; }
+    inline uint64_t signals()    const { return signals_ ; }
+
+    //------------------------------------------------------------------------
+    // Call after publishing.
+    //------------------------------------------------------------------------
+    inline
+    void
+    notify()
+    {
+      if( fps_likely( block_ == NULL ) )
+        return ;
+
+      std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+      if( fps_unlikely( block_->armed_.load( std::memory_order_relaxed ) != 0 ) )
+        signal( block_->armed_.exchange( 0, std::memory_order_acq_rel ) ) ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Reader side of a cross process notifier.
+  //--------------------------------------------------------------------------
+  class Subscriber
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef detail::NotifyBlock block_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    int32_t           fd_ ;
+    uint32_t          idx_ ;
+    block_t         * block_ ;
+    std::string       path_ ;
+
+    Subscriber( const Subscriber & ) ;
+    Subscriber & operator=( const Subscriber & ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    Subscriber() ;
+    ~Subscriber() ;
+
+    //------------------------------------------------------------------------
+    // Open the notify block for 'queue_name', claim a slot and create its
+    // fifo.  Fails w/ EAGAIN if the writer hasn't enabled notification,
+    // ENOSPC if every slot is taken.
+    //------------------------------------------------------------------------
+    bool attach( const std::string & queue_name ) ;
+    void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return block_ != NULL ; }
+    inline int32_t  fd()         const { return fd_ ; }
+    inline uint32_t slot()       const { return idx_ ; }
+    inline int32_t  last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    // As for EventFd.
+    //------------------------------------------------------------------------
+    inline
+    void
+    arm() const
+    { block_->armed_.fetch_or( 1u << idx_, std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    }
+
+    inline void disarm() const { block_->armed_.fetch_and( ~( 1u << idx_ ), std::memory_order_relaxed ) ; }
+
+    bool drain() const ;
+  } ;
+
+}}}
+
+#endif
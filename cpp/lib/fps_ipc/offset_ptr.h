@@ -0,0 +1,159 @@
+#ifndef FPS__IPC__OFFSET_PTR__H
+#define FPS__IPC__OFFSET_PTR__H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // A self-relative pointer : stores the distance from its own address to the
+  // target rather than the target's address.  As long as the pointer and its
+  // target live in the same shared memory segment, it remains valid no matter
+  // where each process maps the segment, so structures linked w/ OffsetPtr
+  // can be shared between processes without serialization.
+  //
+  // Copying an OffsetPtr recomputes the offset for the copy's address, so
+  // OffsetPtrs may also be held on the stack or heap of a process that has
+  // the segment mapped.
+  //
+  // As in boost::interprocess, an offset of 1 represents null, since a
+  // pointer to the byte following the pointer itself is never useful.
+  //
+  // OffsetPtr models a random access iterator and supports the
+  // std::pointer_traits interface, so it may be used as the 'pointer' type of
+  // an allocator ( see ShmAllocator ).
+  //----------------------------------------------------------------------------
+  template<typename T>
+  class OffsetPtr
+  {
+  public :
+    typedef T                                           element_type ;
+    typedef typename std::remove_cv<T>::type            value_type ;
+    typedef std::ptrdiff_t                              difference_type ;
+    typedef OffsetPtr<T>                                pointer ;
+    typedef typename std::add_lvalue_reference<T>::type reference ;
+    typedef std::random_access_iterator_tag             iterator_category ;
+
+    template<typename U> using rebind = OffsetPtr<U> ;
+
+    static const intptr_t Null_Offset = 1 ;
+
+  private :
+    intptr_t offset_ ;
+
+    //--------------------------------------------------------------------------
+    inline
+    void
+    set( const volatile void * target )
+    { offset_ = ( target == NULL )
+              ? Null_Offset
+              : reinterpret_cast<intptr_t>( target ) - reinterpret_cast<intptr_t>( this ) ;
+    }
+
+  public :
+    //--------------------------------------------------------------------------
+    inline OffsetPtr()                         : offset_( Null_Offset ) {}
+    inline OffsetPtr( T * target )             { set( target ) ; }
+    inline OffsetPtr( const OffsetPtr & other ) { set( other.get() ) ; }
+
+    //--------------------------------------------------------------------------
+    // Implicit conversion from OffsetPtr<U> wherever U * converts to T *.
+    //--------------------------------------------------------------------------
+    template< typename U
+            , typename = typename std::enable_if<std::is_convertible<U *, T *>::value>::type
+            >
+    inline OffsetPtr( const OffsetPtr<U> & other ) { set( static_cast<T *>( other.get() ) ) ; }
+
+    //--------------------------------------------------------------------------
+    inline OffsetPtr & operator=( const OffsetPtr & other ) { set( other.get() ) ; return *this ; }
+    inline OffsetPtr & operator=( T * target )              { set( target )      ; return *this ; }
+
+    //--------------------------------------------------------------------------
+    inline
+    T *
+    get() const
+    { return ( offset_ == Null_Offset )
+           ? NULL
+           : reinterpret_cast<T *>( reinterpret_cast<intptr_t>( this ) + offset_ ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline T *       operator->() const { return get() ; }
+    inline reference operator* () const { return *get() ; }
+    inline reference operator[]( difference_type idx ) const { return get()[ idx ] ; }
+
+    inline explicit operator bool() const { return offset_ != Null_Offset ; }
+    inline bool     operator!()     const { return offset_ == Null_Offset ; }
+
+    //--------------------------------------------------------------------------
+    // Required by std::pointer_traits.  A template so that OffsetPtr<void>,
+    // which has no reference type, can still be instantiated.
+    //--------------------------------------------------------------------------
+    template<typename U = T>
+    static
+    inline
+    OffsetPtr
+    pointer_to( typename std::add_lvalue_reference<U>::type target )
+    { return OffsetPtr( &target ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline OffsetPtr & operator+=( difference_type n ) { set( get() + n ) ; return *this ; }
+    inline OffsetPtr & operator-=( difference_type n ) { set( get() - n ) ; return *this ; }
+    inline OffsetPtr & operator++()                    { return *this += 1 ; }
+    inline OffsetPtr & operator--()                    { return *this -= 1 ; }
+    inline OffsetPtr   operator++( int )               { OffsetPtr rv( *this ) ; ++*this ; return rv ; }
+    inline OffsetPtr   operator--( int )               { OffsetPtr rv( *this ) ; --*this ; return rv ; }
+
+    inline OffsetPtr operator+( difference_type n ) const { return OffsetPtr( get() + n ) ; }
+    inline OffsetPtr operator-( difference_type n ) const { return OffsetPtr( get() - n ) ; }
+    inline difference_type operator-( const OffsetPtr & other ) const { return get() - other.get() ; }
+
+    friend inline OffsetPtr operator+( difference_type n, const OffsetPtr & ptr ) { return ptr + n ; }
+  } ;
+
+  //----------------------------------------------------------------------------
+  template<typename T, typename U>
+  inline bool operator==( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() == rhs.get() ; }
+
+  template<typename T, typename U>
+  inline bool operator!=( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() != rhs.get() ; }
+
+  template<typename T, typename U>
+  inline bool operator< ( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() <  rhs.get() ; }
+
+  template<typename T, typename U>
+  inline bool operator<=( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() <= rhs.get() ; }
+
+  template<typename T, typename U>
+  inline bool operator> ( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() >  rhs.get() ; }
+
+  template<typename T, typename U>
+  inline bool operator>=( const OffsetPtr<T> & lhs, const OffsetPtr<U> & rhs ) { return lhs.get() >= rhs.get() ; }
+
+  template<typename T>
+  inline bool operator==( const OffsetPtr<T> & lhs, std::nullptr_t ) { return !lhs ; }
+
+  template<typename T>
+  inline bool operator!=( const OffsetPtr<T> & lhs, std::nullptr_t ) { return static_cast<bool>( lhs ) ; }
+
+  template<typename T>
+  inline bool operator==( std::nullptr_t, const OffsetPtr<T> & rhs ) { return !rhs ; }
+
+  template<typename T>
+  inline bool operator!=( std::nullptr_t, const OffsetPtr<T> & rhs ) { return static_cast<bool>( rhs ) ; }
+
+  //----------------------------------------------------------------------------
+  template<typename T, typename U>
+  inline OffsetPtr<T> static_pointer_cast( const OffsetPtr<U> & ptr ) { return OffsetPtr<T>( static_cast<T *>( ptr.get() ) ) ; }
+
+  template<typename T, typename U>
+  inline OffsetPtr<T> const_pointer_cast( const OffsetPtr<U> & ptr ) { return OffsetPtr<T>( const_cast<T *>( ptr.get() ) ) ; }
+
+}}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef FPS__IPC__OPTIONS__H
+#define FPS__IPC__OPTIONS__H
+
+#include "fps_ntp/fps_ntp.h"
+
+namespace fps {
+namespace ipc {
+namespace opt {
+
+  //
+  // Named template parameters accepted by the swmr queues.
+  //
+  // Slot_Alignment<N> : Align ( and so pad ) each ring buffer slot to N bytes,
+  //                     a power of two.  N = Cache_Line_Size keeps the writer
+  //                     from invalidating the line a reader of the previous
+  //                     slot is on, N = 2 * Cache_Line_Size does the same for
+  //                     cpus whose prefetcher pulls in lines in pairs.  The
+  //                     default ( 0 ) packs slots at their natural alignment.
+  //
+  FPS_Declare_NTP_Value( Slot_Alignment, uint32_t ) ;
+
+}}}
+
+#endif
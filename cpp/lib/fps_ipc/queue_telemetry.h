@@ -0,0 +1,630 @@
+#ifndef FPS__IPC__QUEUE_TELEMETRY__H
+#define FPS__IPC__QUEUE_TELEMETRY__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include "fps_util/macros.h"
+#include "fps_math/logarithm.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include <atomic>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <signal.h>
+#include <unistd.h>
+
+//
+// Opt-in queue instrumentation.  Every queue in fps_ipc takes a telemetry
+// policy as its last template argument : telemetry::None ( the default )
+// compiles away entirely, while telemetry::Shm records into a side-band
+// shared memory stats block named '<queue name>.stats' ( see segment_name() ),
+// which the queue_stats tool reads w/o attaching to the queue itself.
+//
+// The writer records messages written, attempts refused because the queue
+// was full ( lossless queues only ) and the high-water mark of the queue
+// depth.  Each reader claims one of Max_Readers slots and records messages
+// read, its lag behind the writer ( current and max ), messages lost to
+// overruns ( swmr queues only ) and a histogram of enqueue-to-dequeue latency.
+//
+// Latency is sampled rather than measured per message, so the element layout
+// is untouched : the writer timestamps one message in every 2^Sample_Shift
+// into a small table in the stats block, and a reader that consumes a sampled
+// message looks its timestamp up.  Reader lag is refreshed on the same
+// messages, so neither side takes a clock reading or touches the other's
+// cache lines more often than once per sample.
+//
+// All counters are written by a single thread each, so they're updated w/
+// relaxed loads and stores rather than locked read-modify-writes.
+//
+
+namespace fps       {
+namespace ipc       {
+namespace telemetry {
+
+  //--------------------------------------------------------------------------
+  static const uint32_t Max_Readers          = 16 ;
+  static const uint32_t Sample_Count         = 64 ;  // Entries in the timestamp table.
+  static const uint32_t Default_Sample_Shift = 6 ;   // Sample one message in 64.
+  static const char     Segment_Suffix[]     = ".stats" ;
+
+  //--------------------------------------------------------------------------
+  inline
+  std::string
+  segment_name( const std::string & queue_name )
+  { return queue_name + Segment_Suffix ;
+  }
+
+  //--------------------------------------------------------------------------
+  inline
+  uint64_t
+  monotonic_nanos()
+  { ::timespec ts ;
+    ::clock_gettime( CLOCK_MONOTONIC, &ts ) ;
+    return static_cast<uint64_t>( ts.tv_sec ) * 1000000000 + ts.tv_nsec ;
+  }
+
+  //--------------------------------------------------------------------------
+  // Log2 bucketed histogram.  Bucket 'n' counts values in [ 2^n, 2^(n+1) ),
+  // and bucket zero also counts zero.  Single writer.
+  //--------------------------------------------------------------------------
+  struct Histogram
+  {
+    //------------------------------------------------------------------------
+    static const uint32_t Bucket_Count = 64 ;
+
+    //------------------------------------------------------------------------
+    std::atomic<uint64_t> buckets_[ Bucket_Count ] ;
+
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint32_t
+    bucket_of( uint64_t value )
+    { return ( value == 0 ) ? 0 : static_cast<uint32_t>( math::fast_log2( value ) ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Smallest value that lands in bucket 'idx' ( upper_bound() - 1 is the
+    // largest ).
+    //------------------------------------------------------------------------
+    static inline uint64_t lower_bound( uint32_t idx ) { return ( idx == 0 ) ? 0 : ( 1ull << idx ) ; }
+    static inline uint64_t upper_bound( uint32_t idx ) { return ( idx >= 63 ) ? ~0ull : ( 2ull << idx ) ; }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    clear()
+    { for( uint32_t idx = 0 ; idx < Bucket_Count ; ++idx )
+        buckets_[ idx ].store( 0, std::memory_order_relaxed ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    record( uint64_t value )
+    { std::atomic<uint64_t> & bucket = buckets_[ bucket_of( value ) ] ;
+      bucket.store( bucket.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline uint64_t count( uint32_t idx ) const { return buckets_[ idx ].load( std::memory_order_relaxed ) ; }
+
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    total() const
+    { uint64_t rv = 0 ;
+      for( uint32_t idx = 0 ; idx < Bucket_Count ; ++idx )
+        rv += count( idx ) ;
+      return rv ;
+    }
+
+    //------------------------------------------------------------------------
+    // Upper bound of the bucket holding the 'pct' percentile ( 0.0 - 1.0 ),
+    // or zero if nothing has been recorded.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    percentile( double pct ) const
+    { uint64_t samples = total() ;
+      if( samples == 0 )
+        return 0 ;
+
+      uint64_t rank = static_cast<uint64_t>( pct * samples ) ;
+      if( rank >= samples )
+        rank = samples - 1 ;
+
+      uint64_t seen = 0 ;
+      for( uint32_t idx = 0 ; idx < Bucket_Count ; ++idx )
+      { seen += count( idx ) ;
+        if( seen > rank )
+          return upper_bound( idx ) ;
+      }
+      return upper_bound( Bucket_Count - 1 ) ;
+    }
+  } ;
+
+namespace detail {
+
+  //--------------------------------------------------------------------------
+  inline
+  bool
+  process_alive( int32_t pid )
+  { return pid > 0 && ( ::kill( pid, 0 ) == 0 || errno == EPERM ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) StatsHeader
+  {
+    //------------------------------------------------------------------------
+    static const uint64_t Magic   = 0x5441545351535046ull ;  // "FPSQSTAT"
+    static const uint32_t Version = 1 ;
+
+    //------------------------------------------------------------------------
+    uint64_t              magic_        ;
+    uint32_t              version_      ;
+    uint32_t              sample_shift_ ;
+    uint64_t              capacity_     ;  // Queue capacity, informational.
+    int32_t               writer_pid_   ;  // Zero once the writer has closed the queue.
+    std::atomic<uint32_t> initialized_  ;
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) WriterStats
+  {
+    std::atomic<uint64_t> writes_     ;  // Messages published.
+    std::atomic<uint64_t> full_       ;  // Writes refused because the queue was full.
+    std::atomic<uint64_t> high_water_ ;  // Max queue depth seen by the writer.
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct Sample
+  {
+    static const uint64_t Invalid = ~0ull ;
+
+    std::atomic<uint64_t> pos_   ;  // Sampled position, or Invalid while being updated.
+    std::atomic<uint64_t> nanos_ ;  // monotonic_nanos() when it was published.
+  } ;
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) ReaderStats
+  {
+    std::atomic<int32_t>  pid_      ;  // Owning process, or zero if the slot is free.
+    std::atomic<uint64_t> reads_    ;  // Messages consumed.
+    std::atomic<uint64_t> lag_      ;  // Messages behind the writer, as of the last sample.
+    std::atomic<uint64_t> max_lag_  ;
+    std::atomic<uint64_t> lost_     ;  // Messages skipped due to overruns.
+    std::atomic<uint64_t> overruns_ ;  // Number of times the reader was lapped.
+    Histogram             latency_  ;  // Enqueue to dequeue, in nanos.
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    clear()
+    { reads_.store   ( 0, std::memory_order_relaxed ) ;
+      lag_.store     ( 0, std::memory_order_relaxed ) ;
+      max_lag_.store ( 0, std::memory_order_relaxed ) ;
+      lost_.store    ( 0, std::memory_order_relaxed ) ;
+      overruns_.store( 0, std::memory_order_relaxed ) ;
+      latency_.clear() ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Layout of a stats segment.  A fresh segment is zero filled, which is a
+  // valid ( empty ) state for everything but the sample table.
+  //--------------------------------------------------------------------------
+  struct StatsBlock
+  {
+    //------------------------------------------------------------------------
+    StatsHeader header_  ;
+    WriterStats writer_  ;
+    Sample      samples_[ Sample_Count ] ;
+    ReaderStats readers_[ Max_Readers ] ;
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    is_valid() const
+    { return header_.initialized_.load( std::memory_order_acquire ) == 1
+          && header_.magic_   == StatsHeader::Magic
+          && header_.version_ == StatsHeader::Version
+           ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    Sample &
+    sample( uint64_t pos )
+    { return samples_[ ( pos >> header_.sample_shift_ ) & ( Sample_Count - 1 ) ] ;
+    }
+
+    //------------------------------------------------------------------------
+    // Writer only.  Reset every counter and publish the header.
+    //------------------------------------------------------------------------
+    inline
+    void
+    initialize( uint64_t capacity, uint32_t sample_shift )
+    {
+      header_.initialized_.store( 0, std::memory_order_release ) ;
+
+      writer_.writes_.store    ( 0, std::memory_order_relaxed ) ;
+      writer_.full_.store      ( 0, std::memory_order_relaxed ) ;
+      writer_.high_water_.store( 0, std::memory_order_relaxed ) ;
+
+      for( uint32_t idx = 0 ; idx < Sample_Count ; ++idx )
+      { samples_[ idx ].pos_.store  ( Sample::Invalid, std::memory_order_relaxed ) ;
+        samples_[ idx ].nanos_.store( 0, std::memory_order_relaxed ) ;
+      }
+
+      // Slots held by live readers survive a writer restart.
+      for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+      { if( !process_alive( readers_[ idx ].pid_.load( std::memory_order_relaxed ) ) )
+        { readers_[ idx ].pid_.store( 0, std::memory_order_relaxed ) ;
+          readers_[ idx ].clear() ;
+        }
+      }
+
+      header_.magic_        = StatsHeader::Magic ;
+      header_.version_      = StatsHeader::Version ;
+      header_.sample_shift_ = sample_shift ;
+      header_.capacity_     = capacity ;
+      header_.writer_pid_   = ::getpid() ;
+      header_.initialized_.store( 1, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Claim a reader slot for the calling process.  Slots held by processes
+    // that have exited are taken over.  Returns NULL if all are in use.
+    //------------------------------------------------------------------------
+    inline
+    ReaderStats *
+    attach_reader()
+    {
+      int32_t self = ::getpid() ;
+      for( uint32_t idx = 0 ; idx < Max_Readers ; ++idx )
+      { ReaderStats & reader = readers_[ idx ] ;
+        int32_t       pid    = reader.pid_.load( std::memory_order_acquire ) ;
+        if( pid != 0 && ( pid == self || process_alive( pid ) ) )
+          continue ;
+        if( reader.pid_.compare_exchange_strong( pid, self, std::memory_order_acq_rel ) )
+        { reader.clear() ;
+          return &reader ;
+        }
+      }
+      return NULL ;
+    }
+  } ;
+
+} // detail
+
+  //--------------------------------------------------------------------------
+  // Default policy : records nothing, and every hook compiles away.
+  //--------------------------------------------------------------------------
+  struct None
+  {
+    static const bool Enabled = false ;
+
+    //------------------------------------------------------------------------
+    inline bool create( const std::string &, uint64_t ) { return false ; }
+    inline bool attach( const std::string & )            { return false ; }
+    inline bool attach_reader()                          { return false ; }
+    inline void close()                                  {}
+    inline bool is_open() const                          { return false ; }
+
+    //------------------------------------------------------------------------
+    inline void on_write( uint64_t, uint64_t, uint64_t ) {}
+    inline void on_full()                                {}
+    inline bool on_read( uint64_t, uint64_t )            { return false ; }
+    inline void on_lag( uint64_t )                       {}
+    inline void on_lost( uint64_t )                      {}
+  } ;
+
+  //--------------------------------------------------------------------------
+  // Record into a shared memory stats block.  One instance serves a queue
+  // endpoint : the writer create()s the block, each reader attach()es to it
+  // and claims a slot.  An in-process queue ( ThreadFifo ) uses a single
+  // instance for both ends, calling create() and then attach_reader().
+  //
+  // Hooks are no-ops until the block is open, so a failure to create or
+  // attach never affects the queue itself.
+  //
+  // Positions passed to the hooks are the queue's own message numbering; the
+  // writer and readers only need to agree on it.
+  //--------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift = Default_Sample_Shift>
+  class Shm
+  {
+  public :
+    static const bool     Enabled      = true ;
+    static const uint32_t Sample_Shift = T_Sample_Shift ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef detail::StatsBlock  block_t ;
+    typedef detail::ReaderStats reader_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    bool              owner_ ;        // Created the block.
+    uint64_t          sample_mask_ ;
+    block_t         * block_ ;
+    reader_t        * reader_ ;
+
+    Shm( const Shm & ) ;
+    Shm & operator=( const Shm & ) ;
+
+    //------------------------------------------------------------------------
+    // Position of the last sampled message in [ begin, end ), or Invalid.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    sampled( uint64_t begin, uint64_t end ) const
+    { uint64_t pos = ( end - 1 ) & ~sample_mask_ ;
+      return ( end > begin && pos >= begin ) ? pos : detail::Sample::Invalid ;
+    }
+
+    //------------------------------------------------------------------------
+    bool map( const std::string & queue_name, uint32_t flags ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline Shm() ;
+    inline ~Shm() { close() ; }
+
+    //------------------------------------------------------------------------
+    // Writer.  Create ( or reset ) the stats block for 'queue_name'.
+    //------------------------------------------------------------------------
+    inline bool create( const std::string & queue_name, uint64_t capacity ) ;
+
+    //------------------------------------------------------------------------
+    // Reader.  Open the stats block for 'queue_name' and claim a reader slot.
+    // Fails w/ EAGAIN if the writer hasn't created it, ENOSPC if every slot
+    // is taken.
+    //------------------------------------------------------------------------
+    inline bool attach( const std::string & queue_name ) ;
+
+    //------------------------------------------------------------------------
+    // Claim a reader slot in a block opened via create().
+    //------------------------------------------------------------------------
+    inline bool attach_reader() ;
+
+    //------------------------------------------------------------------------
+    inline void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool             is_open()    const { return block_ != NULL ; }
+    inline int32_t          last_error() const { return error_ ; }
+    inline const block_t  * block()      const { return block_ ; }
+    inline const reader_t * reader()     const { return reader_ ; }
+
+    //------------------------------------------------------------------------
+    // Writer hooks.  on_write() is called just before positions [ begin, end )
+    // are published, w/ the writer's view of the queue depth once they are
+    // ( zero if the queue doesn't track one ).  The publishing release store
+    // then makes the sample visible to readers along w/ the messages.
+    // on_full() is called when a write is refused.
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_write( uint64_t begin, uint64_t end, uint64_t depth )
+    {
+      if( fps_unlikely( block_ == NULL ) )
+        return ;
+
+      detail::WriterStats & writer = block_->writer_ ;
+      writer.writes_.store( writer.writes_.load( std::memory_order_relaxed ) + ( end - begin ), std::memory_order_relaxed ) ;
+      if( depth > writer.high_water_.load( std::memory_order_relaxed ) )
+        writer.high_water_.store( depth, std::memory_order_relaxed ) ;
+
+      uint64_t pos = sampled( begin, end ) ;
+      if( fps_unlikely( pos != detail::Sample::Invalid ) )
+      { detail::Sample & sample = block_->sample( pos ) ;
+        sample.pos_.store( detail::Sample::Invalid, std::memory_order_relaxed ) ;
+        std::atomic_thread_fence( std::memory_order_release ) ;
+        sample.nanos_.store( monotonic_nanos(), std::memory_order_relaxed ) ;
+        sample.pos_.store( pos, std::memory_order_release ) ;
+      }
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_full()
+    { if( fps_likely( block_ != NULL ) )
+        block_->writer_.full_.store( block_->writer_.full_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Reader hooks.  on_read() is called after positions [ begin, end ) are
+    // consumed, and returns true if one of them was sampled, in which case
+    // the caller should follow up w/ on_lag().
+    //------------------------------------------------------------------------
+    inline
+    bool
+    on_read( uint64_t begin, uint64_t end )
+    {
+      if( fps_unlikely( reader_ == NULL ) )
+        return false ;
+
+      reader_->reads_.store( reader_->reads_.load( std::memory_order_relaxed ) + ( end - begin ), std::memory_order_relaxed ) ;
+
+      uint64_t pos = sampled( begin, end ) ;
+      if( fps_likely( pos == detail::Sample::Invalid ) )
+        return false ;
+
+      // The entry is skipped if the writer has since reused it.
+      detail::Sample & sample = block_->sample( pos ) ;
+      uint64_t before = sample.pos_.load( std::memory_order_acquire ) ;
+      uint64_t nanos  = sample.nanos_.load( std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_acquire ) ;
+      uint64_t after  = sample.pos_.load( std::memory_order_relaxed ) ;
+      if( before == pos && after == pos )
+      { uint64_t now = monotonic_nanos() ;
+        reader_->latency_.record( ( now > nanos ) ? now - nanos : 0 ) ;
+      }
+      return true ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_lag( uint64_t lag )
+    { reader_->lag_.store( lag, std::memory_order_relaxed ) ;
+      if( lag > reader_->max_lag_.load( std::memory_order_relaxed ) )
+        reader_->max_lag_.store( lag, std::memory_order_relaxed ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_lost( uint64_t count )
+    { if( fps_likely( reader_ != NULL ) )
+      { reader_->lost_.store( reader_->lost_.load( std::memory_order_relaxed ) + count, std::memory_order_relaxed ) ;
+        reader_->overruns_.store( reader_->overruns_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+      }
+    }
+  } ;
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  Shm<T_Sample_Shift>::
+  Shm()
+    : error_      ( 0 )
+    , owner_      ( false )
+    , sample_mask_( ( 1ull << T_Sample_Shift ) - 1 )
+    , block_      ( NULL )
+    , reader_     ( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  void
+  Shm<T_Sample_Shift>::
+  close()
+  {
+    if( reader_ != NULL )
+      reader_->pid_.store( 0, std::memory_order_release ) ;
+
+    if( owner_ && block_ != NULL )
+      block_->header_.writer_pid_ = 0 ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    // Like the queue segments, the block outlives the writer so the last
+    // counters can still be inspected.
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    error_  = 0 ;
+    owner_  = false ;
+    block_  = NULL ;
+    reader_ = NULL ;
+  }
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  bool
+  Shm<T_Sample_Shift>::
+  map( const std::string & queue_name, uint32_t flags )
+  {
+    if( !shm_.open( segment_name( queue_name ), flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( ( flags & ipc::access::Create ) && !shm_.resize( sizeof( block_t ) ) )
+    { error_ = shm_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( shm_.size() < sizeof( block_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  bool
+  Shm<T_Sample_Shift>::
+  create( const std::string & queue_name, uint64_t capacity )
+  {
+    close() ;
+
+    // A block left behind by a previous writer is reset rather than refused.
+    if( !map( queue_name, ipc::access::Read_Write | ipc::access::Create ) )
+      return false ;
+
+    block_ = shm_map_.cast<block_t>( 0 ) ;
+    block_->initialize( capacity, T_Sample_Shift ) ;
+    owner_ = true ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  bool
+  Shm<T_Sample_Shift>::
+  attach( const std::string & queue_name )
+  {
+    close() ;
+
+    if( !map( queue_name, ipc::access::Read_Write ) )
+      return false ;
+
+    block_t * block = shm_map_.cast<block_t>( 0 ) ;
+    if( !block->is_valid() )
+    { error_ = EAGAIN ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // Follow the writer's sampling rate.
+    block_       = block ;
+    sample_mask_ = ( 1ull << block->header_.sample_shift_ ) - 1 ;
+    if( !attach_reader() )
+    { int32_t error = error_ ;
+      close() ;
+      error_ = error ;
+      return false ;
+    }
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<uint32_t T_Sample_Shift>
+  bool
+  Shm<T_Sample_Shift>::
+  attach_reader()
+  {
+    if( block_ == NULL )
+    { error_ = EBADF ;
+      return false ;
+    }
+
+    reader_ = block_->attach_reader() ;
+    if( reader_ == NULL )
+    { error_ = ENOSPC ;
+      return false ;
+    }
+    return true ;
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef FPS__IPC__QUEUE_TELEMETRY_PROBE__H
+#define FPS__IPC__QUEUE_TELEMETRY_PROBE__H
+
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include <cerrno>
+
+namespace fps       {
+namespace ipc       {
+namespace telemetry {
+
+  //--------------------------------------------------------------------------
+  // Read only view of a queue's stats block ( see queue_telemetry.h ).  The
+  // block is mapped read only, so a probe never writes to a cache line the
+  // queue's writer or readers own.
+  //--------------------------------------------------------------------------
+  struct StatsProbe
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef detail::StatsBlock block_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    const block_t   * block_ ;
+
+  public :
+    //------------------------------------------------------------------------
+    // Point in time copy of one reader slot.
+    //------------------------------------------------------------------------
+    struct Reader
+    {
+      int32_t   pid_      ;
+      bool      alive_    ;
+      uint64_t  reads_    ;
+      uint64_t  lag_      ;
+      uint64_t  max_lag_  ;
+      uint64_t  lost_     ;
+      uint64_t  overruns_ ;
+      const Histogram * latency_ ;
+    } ;
+
+    //------------------------------------------------------------------------
+    inline StatsProbe() ;
+
+    //------------------------------------------------------------------------
+    inline ~StatsProbe() ;
+
+    //------------------------------------------------------------------------
+    // Open the stats block of the indicated queue.  Returns false if it
+    // doesn't exist or hasn't been initialized ( EAGAIN ), or isn't a stats
+    // block this build understands ( EPROTO ).
+    //------------------------------------------------------------------------
+    inline bool open( const std::string & queue_name ) ;
+
+    //------------------------------------------------------------------------
+    inline void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return block_ != NULL ; }
+    inline int32_t  last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    // Only valid while is_open() returns true.
+    //------------------------------------------------------------------------
+    inline uint64_t capacity()     const { return block_->header_.capacity_ ; }
+    inline uint32_t sample_shift() const { return block_->header_.sample_shift_ ; }
+    inline int32_t  writer_pid()   const { return block_->header_.writer_pid_ ; }
+    inline bool     writer_alive() const { return detail::process_alive( writer_pid() ) ; }
+    inline uint64_t writes()       const { return block_->writer_.writes_.load( std::memory_order_relaxed ) ; }
+    inline uint64_t full()         const { return block_->writer_.full_.load( std::memory_order_relaxed ) ; }
+    inline uint64_t high_water()   const { return block_->writer_.high_water_.load( std::memory_order_relaxed ) ; }
+
+    //------------------------------------------------------------------------
+    // Copy reader slot 'idx' ( < Max_Readers ) into 'dest'.  Returns false if
+    // the slot isn't in use.
+    //------------------------------------------------------------------------
+    inline bool reader( uint32_t idx, Reader & dest ) const ;
+  } ;
+
+  //------------------------------------------------------------------------
+  StatsProbe::
+  StatsProbe()
+    : error_( 0 )
+    , block_( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  StatsProbe::
+  ~StatsProbe()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  void
+  StatsProbe::
+  close()
+  {
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close( false ) ;
+
+    error_ = 0 ;
+    block_ = NULL ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  StatsProbe::
+  open( const std::string & queue_name )
+  {
+    close() ;
+
+    if( !shm_.open( segment_name( queue_name ), ipc::access::Read_Only ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( shm_.size() < sizeof( block_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, ipc::access::Read_Only ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    const block_t * block = shm_map_.cast<block_t>( 0 ) ;
+    if( !block->is_valid() )
+    { error_ = ( block->header_.magic_ == 0 || block->header_.magic_ == detail::StatsHeader::Magic ) ? EAGAIN : EPROTO ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    block_ = block ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  StatsProbe::
+  reader( uint32_t idx, Reader & dest ) const
+  {
+    const detail::ReaderStats & src = block_->readers_[ idx ] ;
+    dest.pid_ = src.pid_.load( std::memory_order_acquire ) ;
+    if( dest.pid_ == 0 )
+      return false ;
+
+    dest.alive_    = detail::process_alive( dest.pid_ ) ;
+    dest.reads_    = src.reads_.load( std::memory_order_relaxed ) ;
+    dest.lag_      = src.lag_.load( std::memory_order_relaxed ) ;
+    dest.max_lag_  = src.max_lag_.load( std::memory_order_relaxed ) ;
+    dest.lost_     = src.lost_.load( std::memory_order_relaxed ) ;
+    dest.overruns_ = src.overruns_.load( std::memory_order_relaxed ) ;
+    dest.latency_  = &src.latency_ ;
+    return true ;
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef FPS__IPC__RW_SPINLOCK__H
+#define FPS__IPC__RW_SPINLOCK__H
+
+#include <atomic>
+#include <cstdint>
+#include "fps_util/macros.h"
+#include "fps_ipc/backoff.h"
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // Reader-preferring reader/writer spin lock.  Any number of readers may
+  // hold the lock at once; a writer holds it alone.  Readers are admitted
+  // whenever no writer holds the lock, even if a writer is waiting, so a
+  // steady stream of readers can starve writers.  Use where writes are rare
+  // and copying the protected data out ( as Seqlocked does ) is too
+  // expensive.
+  //
+  // The state is a single 32-bit word : the top bit is set while a writer
+  // holds the lock and the remaining bits count readers holding or waiting
+  // for it.  Holds no pointers, so an RWSpinLock may be constructed inside a
+  // MappedMemory region ( see MappedMemory::construct ) and shared between
+  // processes.  Provides lock_shared/unlock_shared as well as lock/unlock, so
+  // it works w/ std::shared_lock and std::lock_guard.  T_Backoff controls how
+  // waiters spin ( see backoff.h ).
+  //----------------------------------------------------------------------------
+  template<typename T_Backoff = backoff::Default>
+  class BasicRWSpinLock
+  {
+  public :
+    typedef T_Backoff backoff_t ;
+
+    static const uint32_t Writer_Bit  = 0x80000000 ;
+    static const uint32_t Reader_Mask = ~Writer_Bit ;
+
+  private :
+    std::atomic<uint32_t> state_ ;
+
+    BasicRWSpinLock( const BasicRWSpinLock & ) ;
+    BasicRWSpinLock & operator=( const BasicRWSpinLock & ) ;
+
+  public :
+    //--------------------------------------------------------------------------
+    inline BasicRWSpinLock() : state_( 0 ) {}
+
+    //--------------------------------------------------------------------------
+    // Shared ( reader ) interface.  A reader registers itself first, so once
+    // the current writer releases the lock no new writer can get in ahead of
+    // it.
+    //--------------------------------------------------------------------------
+    inline
+    void
+    lock_shared()
+    {
+      uint32_t state = state_.fetch_add( 1, std::memory_order_acquire ) ;
+      for( uint32_t counter = 0
+         ; state & Writer_Bit
+         ; ++counter
+         )
+      { T_Backoff::wait( counter ) ;
+        state = state_.load( std::memory_order_acquire ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    bool
+    try_lock_shared()
+    {
+      uint32_t state = state_.fetch_add( 1, std::memory_order_acquire ) ;
+      if( fps_likely( ( state & Writer_Bit ) == 0 ) )
+        return true ;
+
+      state_.fetch_sub( 1, std::memory_order_relaxed ) ;
+      return false ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    void
+    unlock_shared()
+    {
+      state_.fetch_sub( 1, std::memory_order_release ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Exclusive ( writer ) interface.  A writer only gets in when there are
+    // no readers at all.
+    //--------------------------------------------------------------------------
+    inline
+    bool
+    try_lock()
+    {
+      uint32_t expected = 0 ;
+      return state_.compare_exchange_strong( expected
+                                           , Writer_Bit
+                                           , std::memory_order_acquire
+                                           , std::memory_order_relaxed
+                                           ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    void
+    lock()
+    {
+      for( uint32_t counter = 0 ;; ++counter )
+      { if( state_.load( std::memory_order_relaxed ) == 0 && try_lock() )
+          return ;
+        T_Backoff::wait( counter ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    // Readers may have registered while we held the lock, so clear only our
+    // bit.
+    //--------------------------------------------------------------------------
+    inline
+    void
+    unlock()
+    {
+      state_.fetch_sub( Writer_Bit, std::memory_order_release ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Approximate; for monitoring only.
+    //--------------------------------------------------------------------------
+    inline bool     is_locked() const { return ( state_.load( std::memory_order_acquire ) & Writer_Bit ) != 0 ; }
+    inline uint32_t readers()   const { return state_.load( std::memory_order_acquire ) & Reader_Mask ; }
+  } ;
+
+  typedef BasicRWSpinLock<> RWSpinLock ;
+
+}}
+
+#endif
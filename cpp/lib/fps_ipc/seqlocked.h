@@ -0,0 +1,163 @@
+#ifndef FPS__IPC__SEQLOCKED__H
+#define FPS__IPC__SEQLOCKED__H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "fps_system/fps_system.h"
+#include "fps_util/macros.h"
+#include "fps_ipc/backoff.h"
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // A single value of type T published by one writer to any number of
+  // readers under a sequence lock.  Readers never block the writer : load()
+  // copies the value out and retries if a store() overlapped the copy, so
+  // readers always see a value that was stored as a whole.
+  //
+  // Intended for small-to-medium snapshots ( reference data, limit tables )
+  // that are read far more often than they change.  T must be trivially
+  // copyable, since readers copy it while it may be being overwritten.  If
+  // the value is large and updated often enough that readers spend their
+  // time retrying, use an RWSpinLock instead.
+  //
+  // Holds no pointers, so a Seqlocked may be constructed inside a
+  // MappedMemory region ( see MappedMemory::construct ) and shared between
+  // processes.  Only one thread ( in one process ) may call store() or
+  // update() at a time; concurrent writers must serialize externally.
+  // T_Backoff controls how readers wait out a store in progress.
+  //----------------------------------------------------------------------------
+  template<typename T, typename T_Backoff = backoff::Default>
+  class Seqlocked
+  {
+  public :
+    typedef T         value_t ;
+    typedef T_Backoff backoff_t ;
+
+    static const std::size_t Alignment = system::cpu::Cache_Line_Size ;
+
+    static_assert( std::is_trivially_copyable<T>::value
+                 , "Seqlocked<T> requires a trivially copyable T"
+                 ) ;
+
+  private :
+    std::atomic<uint64_t> sequence_ alignas( Alignment ) ;  // Odd while a store is in progress.
+    T                     value_    alignas( Alignment ) ;
+
+    Seqlocked( const Seqlocked & ) ;
+    Seqlocked & operator=( const Seqlocked & ) ;
+
+  public :
+    //--------------------------------------------------------------------------
+    inline
+    Seqlocked()
+      : sequence_( 0 )
+      , value_()
+    {}
+
+    //--------------------------------------------------------------------------
+    inline
+    explicit
+    Seqlocked( const T & value )
+      : sequence_( 0 )
+      , value_( value )
+    {}
+
+    //--------------------------------------------------------------------------
+    // Number of completed stores.
+    //--------------------------------------------------------------------------
+    inline
+    uint64_t
+    version() const
+    { return sequence_.load( std::memory_order_acquire ) >> 1 ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Make one attempt to copy the value into 'dest'.  Returns false if a
+    // store was in progress or overlapped the copy, in which case 'dest' is
+    // unspecified.
+    //--------------------------------------------------------------------------
+    inline
+    bool
+    try_load( T & dest ) const
+    {
+      uint64_t begin = sequence_.load( std::memory_order_acquire ) ;
+      if( begin & 1 )
+        return false ;
+
+      std::memcpy( static_cast<void *>( &dest ), &value_, sizeof( T ) ) ;
+
+      std::atomic_thread_fence( std::memory_order_acquire ) ;
+      return sequence_.load( std::memory_order_relaxed ) == begin ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Copy the value into 'dest', retrying until the copy is consistent.
+    // Returns the version() that was read.
+    //--------------------------------------------------------------------------
+    inline
+    uint64_t
+    load( T & dest ) const
+    {
+      for( uint32_t counter = 0 ;; ++counter )
+      { uint64_t begin = sequence_.load( std::memory_order_acquire ) ;
+        if( fps_likely( ( begin & 1 ) == 0 ) )
+        { std::memcpy( static_cast<void *>( &dest ), &value_, sizeof( T ) ) ;
+          std::atomic_thread_fence( std::memory_order_acquire ) ;
+          if( fps_likely( sequence_.load( std::memory_order_relaxed ) == begin ) )
+            return begin >> 1 ;
+        }
+        T_Backoff::wait( counter ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    T
+    load() const
+    { T rv ;
+      load( rv ) ;
+      return rv ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Writer only.
+    //--------------------------------------------------------------------------
+    inline
+    void
+    store( const T & value )
+    {
+      uint64_t sequence = sequence_.load( std::memory_order_relaxed ) ;
+
+      // The release fence keeps the value's stores from being reordered ahead
+      // of the odd sequence number.
+      sequence_.store( sequence + 1, std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_release ) ;
+
+      std::memcpy( static_cast<void *>( &value_ ), &value, sizeof( T ) ) ;
+
+      sequence_.store( sequence + 2, std::memory_order_release ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Writer only.  Invoke fn( T & ) on a copy of the current value, then
+    // store the result.  Running 'fn' on a copy keeps it out of the window in
+    // which readers must retry.
+    //--------------------------------------------------------------------------
+    template<typename T_Fn>
+    inline
+    void
+    update( T_Fn && fn )
+    { T value ;
+      std::memcpy( static_cast<void *>( &value ), &value_, sizeof( T ) ) ;
+      fn( value ) ;
+      store( value ) ;
+    }
+  } ;
+
+}}
+
+#endif
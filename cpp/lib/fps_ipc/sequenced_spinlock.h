@@ -10,17 +10,24 @@ namespace ipc {
 
   //----------------------------------------------------------------------------
   // Synchronization lock for lossy single writer/multi-reader designs.
+  // T_Read_Backoff controls how readers wait out a write in progress, and 
+  // T_Write_Backoff how writers wait for each other ( see backoff.h ).  
+  // Writes are short, so by default readers spin on the cpu rather than yield 
+  // or sleep, while contending writers back off as a SpinLock does.
   //----------------------------------------------------------------------------
-  class SequencedSpinLock
+  template< typename T_Read_Backoff  = backoff::Spin<>
+          , typename T_Write_Backoff = backoff::Default
+          >
+  class BasicSequencedSpinLock
   {
   private :
-    SpinLock              lock_  ;
-    std::atomic<uint64_t> state_ ;
+    BasicSpinLock_Intrinsic<T_Write_Backoff> lock_  ;
+    std::atomic<uint64_t>                    state_ ;
   
   public :
     //--------------------------------------------------------------------------
     inline
-    SequencedSpinLock() 
+    BasicSequencedSpinLock() 
       : lock_ () 
       , state_( 0 )
     {}
@@ -48,11 +55,12 @@ namespace ipc {
     uint64_t 
     read_begin() 
     {
-      for( ;; ) 
+      for( uint32_t counter = 0 ;; ++counter ) 
       { uint64_t state = state_.load( std::memory_order_acquire ) ;
         if( (state & 1) == 0 )
         { return state ;
         }
+        T_Read_Backoff::wait( counter ) ;
       }
     }
 
@@ -67,6 +75,8 @@ namespace ipc {
     }
   } ;
 
+  typedef BasicSequencedSpinLock<> SequencedSpinLock ;
+
 }}
 
 #endif
@@ -12,6 +12,7 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/vfs.h>
 #include <errno.h>
 
 namespace fps {
@@ -19,10 +20,12 @@ namespace ipc {
 
   //-------------------------------------------------------------------------------------------
   SharedMemory::SharedMemory() 
-    : fd_   ( -1 )
-    , size_ ( 0 )
-    , flags_( 0 )
-    , error_( 0 )
+    : fd_       ( -1 )
+    , size_     ( 0 )
+    , page_size_( 0 )
+    , flags_    ( 0 )
+    , error_    ( 0 )
+    , huge_     ( false )
   {
   }
 
@@ -101,6 +104,49 @@ namespace ipc {
     return true ;
   }
 
+  //-------------------------------------------------------------------------------------------
+  bool
+  SharedMemory::open_fd( bool huge ) 
+  {
+    // ::shm_open() only knows about /dev/shm, so hugetlbfs files are opened directly 
+    // ( w/ the same flags shm_open would use ).  O_NONBLOCK keeps the open of a fifo
+    // that happens to share the name from blocking; it has no effect on regular files.
+    fd_ = huge 
+        ? ::open( ( std::string( constants::Huge_Page_Dir ) + name_ ).c_str(), flags_ | O_NONBLOCK | O_CLOEXEC | O_NOFOLLOW, 0666 ) 
+        : ::shm_open( name_.c_str(), flags_ | O_NONBLOCK, 0666 ) 
+        ;
+    if( fd_ < 0 ) 
+    { 
+      error_ = errno ;
+      fd_    = -1 ;
+      return false ;
+    }
+
+    // Segments are regular files; anything else ( a fifo, socket, device ... ) isn't one.
+    struct ::stat fd_info ;
+    int32_t       status = ( ::fstat( fd_, &fd_info ) != 0 ) ? errno 
+                         : S_ISREG( fd_info.st_mode )        ? 0 
+                         : EINVAL 
+                         ;
+    if( status != 0 ) 
+    { 
+      error_ = status ;
+      ::close( fd_ ) ;
+      fd_    = -1 ;
+      return false ;
+    }
+
+    huge_      = huge ;
+    page_size_ = ::sysconf( _SC_PAGESIZE ) ;
+    if( huge ) 
+    { struct ::statfs fs_info ;
+      if( ::fstatfs( fd_, &fs_info ) == 0 && fs_info.f_bsize > 0 ) 
+        page_size_ = fs_info.f_bsize ;
+    }
+
+    return true ;
+  }
+
   //-------------------------------------------------------------------------------------------
   bool
   SharedMemory::open( const std::string & name, uint32_t access_flags )
@@ -111,6 +157,7 @@ namespace ipc {
     error_ = 0 ;
     size_  = 0 ;
     flags_ = 0 ;
+    huge_  = false ;
     name_  = name ;
 
     //
@@ -136,12 +183,19 @@ namespace ipc {
     //
     // Attempt to open the desired shared memory file
     //
-    fd_    = ::shm_open( name_.c_str(), flags_, 0666 ) ;
-    if( fd_ < 0 ) 
+    bool huge = ( access_flags & access::Huge_Pages ) ;
+    if( !open_fd( huge ) ) 
     { 
-      error_ = errno ;
-      fd_    = -1 ;
-      return false ;
+      // A reader may not know the segment lives on hugetlbfs, so look there too.  
+      // Report the original error if that fails as well.
+      int32_t last_err = error_ ;
+      bool    retry    = !huge && last_err == ENOENT && !( access_flags & access::Create ) ;
+      if( !retry || !open_fd( true ) ) 
+      { 
+        error_ = last_err ;
+        return false ;
+      }
+      error_ = 0 ;
     }
 
     //
@@ -182,17 +236,19 @@ namespace ipc {
     }
 
     // Clear members
-    size_   =  0 ;
-    flags_  =  0 ;
-    fd_     = -1 ;
-    error_  = 0 ;
+    size_      =  0 ;
+    page_size_ =  0 ;
+    flags_     =  0 ;
+    fd_        = -1 ;
+    error_     =  0 ;
+    huge_      = false ;
 
     return rv ;
   }
 
   //-------------------------------------------------------------------------------------------
   bool 
-  SharedMemory::resize( uint32_t bytes ) 
+  SharedMemory::resize( uint64_t bytes ) 
   {
     error_ = 0 ;
 
@@ -208,6 +264,10 @@ namespace ipc {
       return false ;
     }
 
+    // hugetlbfs only accepts whole pages.
+    if( huge_ && page_size_ > 0 ) 
+      bytes = ( ( bytes + page_size_ - 1 ) / page_size_ ) * page_size_ ;
+
     //
     // Resize underlying shm file via ::ftruncate() system function.
     // Note: ftruncate() is called in a loop so we can retry if it fails 
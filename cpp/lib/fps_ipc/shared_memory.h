@@ -5,6 +5,7 @@
 #include "fps_system/fps_system.h"
 #include "fps_fs/path.h"
 #include "fps_ipc/ipc_util.h"
+#include "fps_ipc/constants.h"
 
 #include <sys/mman.h>
 #include <fcntl.h>    
@@ -17,11 +18,13 @@ namespace ipc {
   {
   private :
     //----------------------------------------------------------------------------------------
-    int32_t     fd_    ;  // File descriptor for shared memory region.
-    uint32_t    size_  ;  // Size in bytes of shared memory region.
-    int32_t     flags_ ;  // Open flags passed to shm_open.
-    int32_t     error_ ;  // The value of errno after the last operation.
-    std::string name_  ;  // Name of filesystem node associated w/ this shm region.
+    int32_t     fd_        ;  // File descriptor for shared memory region.
+    uint64_t    size_      ;  // Size in bytes of shared memory region.
+    uint64_t    page_size_ ;  // Page size of the backing filesystem.
+    int32_t     flags_     ;  // Open flags passed to shm_open.
+    int32_t     error_     ;  // The value of errno after the last operation.
+    bool        huge_      ;  // Backed by hugetlbfs rather than /dev/shm.
+    std::string name_      ;  // Name of filesystem node associated w/ this shm region.
    
     //----------------------------------------------------------------------------------------
     SharedMemory( const SharedMemory & ) ;
@@ -34,6 +37,12 @@ namespace ipc {
     //----------------------------------------------------------------------------------------
     bool load_size_from_filesystem() ;
 
+    //----------------------------------------------------------------------------------------
+    // Open name_ in /dev/shm, or on hugetlbfs if 'huge' is set.  Sets fd_, page_size_ and 
+    // huge_ on success, error_ on failure.
+    //----------------------------------------------------------------------------------------
+    bool open_fd( bool huge ) ;
+
   public : 
     //----------------------------------------------------------------------------------------
     SharedMemory() ;
@@ -49,9 +58,19 @@ namespace ipc {
     //   access::Read_Write  ( Read and write access )
     //   access::Create      ( Create the segment if it doesn't exist )
     //   access::Exclusive   ( Fail if the segment already exists and access::Create was specified )
+    //   access::Huge_Pages  ( Place the segment on hugetlbfs, see constants::Huge_Page_Dir )
+    //
+    // Other flags ( those meant for ipc::MappedMemory ) are ignored, so the same flag set 
+    // can be passed to both.
+    //
+    // A segment that isn't found in /dev/shm is also looked for on hugetlbfs unless 
+    // access::Create was specified, so readers needn't know how a segment was created.
     //
     // When a segment is created, the filesystem permissions are default to 0666 (octal).
     //
+    // Fails w/ EINVAL, w/o blocking, if the name refers to something other than a 
+    // regular file ( e.g. a fifo ).
+    //
     // Return true on success, false on failure.  On failure, the associated "errno" value
     // can be retrieved via the last_error() member function to assist w/ debugging.
     //----------------------------------------------------------------------------------------
@@ -67,23 +86,26 @@ namespace ipc {
 
     //----------------------------------------------------------------------------------------
     // Reserve/resize this shm segment to ensure it can hold the indicated number of bytes.
+    // Huge page segments are rounded up to a whole number of pages.
     // Return true on success, false on failure.  
     //----------------------------------------------------------------------------------------
-    bool resize( uint32_t bytes ) ;
+    bool resize( uint64_t bytes ) ;
 
     //----------------------------------------------------------------------------------------
     template<typename T>
     bool
     resize() 
     {   
-      return resize( static_cast<uint32_t>( sizeof( T ) ) ) ; 
+      return resize( sizeof( T ) ) ; 
     }
   
     //----------------------------------------------------------------------------------------
-    inline fs::Path    path()        const { return fs::Path( "/dev/shm", name_ ) ; } 
+    inline fs::Path    path()        const { return fs::Path( huge_ ? constants::Huge_Page_Dir : constants::Shm_Dir, name_ ) ; } 
     inline int32_t     fd()          const { return fd_     ; }
     inline std::string name()        const { return name_   ; }
-    inline uint32_t    size()        const { return size_   ; }
+    inline uint64_t    size()        const { return size_   ; }
+    inline uint64_t    page_size()   const { return page_size_ ; }
+    inline bool        is_huge()     const { return huge_   ; }
     inline int32_t     last_error()  const { return error_  ; }
     inline bool        is_open()     const { return fd_ > 0 ; }
     inline bool        is_readable() const { return is_open() ; }
@@ -0,0 +1,137 @@
+#ifndef FPS__IPC__SHM_ALLOCATOR__H
+#define FPS__IPC__SHM_ALLOCATOR__H
+
+#include "fps_ipc/shm_arena.h"
+#include "fps_ipc/offset_ptr.h"
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <boost/container/map.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/string.hpp>
+#include <boost/container/vector.hpp>
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // STL allocator that places elements in a ShmArena.  Its pointer type is
+  // OffsetPtr<T>, and it refers to the arena through an OffsetPtr, so a
+  // container using it may itself be constructed in the arena ( see
+  // ShmArena::construct ) and used from any process that maps the arena.
+  //
+  // Only containers that store their internal pointers as the allocator's
+  // 'pointer' type are position independent.  With libstdc++ that's
+  // std::vector and std::basic_string; node based std containers ( map,
+  // unordered_map, list ) keep raw pointers and must not be shared.  The
+  // boost::container equivalents honor the allocator's pointer type - the
+  // aliases below use them for the associative containers.
+  //
+  // Allocation failure throws std::bad_alloc, as containers expect.
+  //----------------------------------------------------------------------------
+  template<typename T>
+  class ShmAllocator
+  {
+  public :
+    typedef T                     value_type ;
+    typedef OffsetPtr<T>          pointer ;
+    typedef OffsetPtr<const T>    const_pointer ;
+    typedef OffsetPtr<void>       void_pointer ;
+    typedef OffsetPtr<const void> const_void_pointer ;
+    typedef std::size_t           size_type ;
+    typedef std::ptrdiff_t        difference_type ;
+
+    typedef std::true_type        propagate_on_container_copy_assignment ;
+    typedef std::true_type        propagate_on_container_move_assignment ;
+    typedef std::true_type        propagate_on_container_swap ;
+    typedef std::false_type       is_always_equal ;
+
+    template<typename U> struct rebind { typedef ShmAllocator<U> other ; } ;
+
+  private :
+    template<typename U> friend class ShmAllocator ;
+
+    OffsetPtr<detail::ArenaHeader> arena_ ;
+
+  public :
+    //--------------------------------------------------------------------------
+    inline explicit ShmAllocator( ShmArena & arena )            : arena_( arena.header() ) {}
+    inline explicit ShmAllocator( detail::ArenaHeader * arena ) : arena_( arena ) {}
+    inline ShmAllocator( const ShmAllocator & other )           : arena_( other.arena_ ) {}
+
+    template<typename U>
+    inline ShmAllocator( const ShmAllocator<U> & other )        : arena_( other.arena_ ) {}
+
+    //--------------------------------------------------------------------------
+    inline ShmAllocator & operator=( const ShmAllocator & other ) { arena_ = other.arena_ ; return *this ; }
+
+    //--------------------------------------------------------------------------
+    inline detail::ArenaHeader * arena() const { return arena_.get() ; }
+
+    //--------------------------------------------------------------------------
+    inline
+    pointer
+    allocate( size_type count )
+    { if( count > max_size() )
+        throw std::bad_alloc() ;
+      void * rv = arena_->allocate( count * sizeof( T ) ) ;
+      if( rv == NULL )
+        throw std::bad_alloc() ;
+      return pointer( static_cast<T *>( rv ) ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    void
+    deallocate( pointer ptr, size_type )
+    { arena_->deallocate( ptr.get() ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    size_type
+    max_size() const
+    { return std::numeric_limits<size_type>::max() / sizeof( T ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Containers copied out of the arena by value keep allocating from it.
+    //--------------------------------------------------------------------------
+    inline ShmAllocator select_on_container_copy_construction() const { return *this ; }
+  } ;
+
+  //----------------------------------------------------------------------------
+  template<typename T, typename U>
+  inline bool operator==( const ShmAllocator<T> & lhs, const ShmAllocator<U> & rhs ) { return lhs.arena() == rhs.arena() ; }
+
+  template<typename T, typename U>
+  inline bool operator!=( const ShmAllocator<T> & lhs, const ShmAllocator<U> & rhs ) { return lhs.arena() != rhs.arena() ; }
+
+  //----------------------------------------------------------------------------
+  // Position independent containers.  Constructors take a ShmAllocator, e.g.
+  //
+  //   ShmAllocator<char>  alloc( arena ) ;
+  //   shm::vector<int>  * ids = arena.construct< shm::vector<int> >( "ids", alloc ) ;
+  //----------------------------------------------------------------------------
+  namespace shm
+  {
+    template<typename T>
+    using vector = boost::container::vector< T, ShmAllocator<T> > ;
+
+    typedef boost::container::basic_string< char
+                                          , std::char_traits<char>
+                                          , ShmAllocator<char>
+                                          > string ;
+
+    template<typename K, typename V, typename C = std::less<K> >
+    using map = boost::container::map< K, V, C, ShmAllocator< std::pair<const K, V> > > ;
+
+    template<typename K, typename V, typename C = std::less<K> >
+    using flat_map = boost::container::flat_map< K, V, C, ShmAllocator< std::pair<K, V> > > ;
+  }
+
+}}
+
+#endif
@@ -0,0 +1,101 @@
+#include "fps_ipc/shm_arena.h"
+#include <errno.h>
+
+namespace fps {
+namespace ipc {
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  ShmArena::
+  create( const std::string & name, uint64_t size, uint32_t options )
+  {
+    close() ;
+    uint32_t access_flags = access::Read_Write 
+                          | access::Create 
+                          | access::Exclusive 
+                          | options 
+                          ;
+
+    if( size <= header_t::first_block_offset() ) 
+    { error_ = EINVAL ;
+      return false ;
+    }
+
+    if( !shm_.open( name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( !shm_.resize( size ) || !map_.open( shm_, access_flags ) ) 
+    { error_ = shm_.last_error() ? shm_.last_error() : map_.last_error() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    // Huge page segments may have been rounded up; use all of it.
+    header_ = map_.construct_at<header_t>( 0 ) ;
+    header_->publish( map_.size() ) ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  ShmArena::
+  open( const std::string & name, uint32_t flags )
+  {
+    close() ;
+    flags &= ~( access::Create | access::Exclusive ) ;
+
+    if( !shm_.open( name, flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( shm_.size() < sizeof( header_t ) ) 
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !map_.open( shm_, flags ) ) 
+    { error_ = map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    header_t * header = map_.cast<header_t>() ;
+    int32_t    status = header->validate( map_.size() ) ;
+    if( status != 0 ) 
+    { error_ = status ;
+      map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    header_ = header ;
+    return true ;
+  }
+
+  //-------------------------------------------------------------------------------------------
+  bool
+  ShmArena::
+  close( bool remove_from_fs )
+  {
+    bool rv = true ;
+    header_ = NULL ;
+    error_  = 0 ;
+
+    if( map_.is_open() && !map_.close() ) 
+    { error_ = map_.last_error() ;
+      rv     = false ;
+    }
+
+    if( shm_.is_open() && !shm_.close( remove_from_fs ) ) 
+    { error_ = shm_.last_error() ;
+      rv     = false ;
+    }
+
+    return rv ;
+  }
+
+}}
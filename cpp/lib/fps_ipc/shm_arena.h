@@ -0,0 +1,628 @@
+#ifndef FPS__IPC__SHM_ARENA__H
+#define FPS__IPC__SHM_ARENA__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include "fps_util/macros.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_ipc/spinlock.h"
+#include "fps_ipc/backoff.h"
+#include "fps_ipc/offset_ptr.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+
+//
+// A heap that lives in a shared memory segment.  The segment starts w/ an
+// ArenaHeader, which holds all of the allocator's state; everything after it
+// is carved into blocks.  Because the header refers to blocks by offset from
+// itself, and blocks refer to each other through OffsetPtr, any process may
+// map the segment at any address and allocate, free or follow pointers in it.
+//
+// Allocation is bump-and-free-list :
+//
+//   - Each block has a 16 byte header followed by its payload.  Block sizes
+//     ( header included ) are rounded up to a power of two, from 32 bytes to
+//     the size of the segment.
+//   - Freed blocks go onto a free list for their size class and are reused by
+//     later allocations of the same class.
+//   - Otherwise blocks are carved from the untouched space at the top of the
+//     arena.  Space is never returned to the top, nor split or coalesced.
+//
+// This suits the intended use - containers that are built up, occasionally
+// grown, and rarely torn down - and keeps allocate() and deallocate()
+// constant time.  The price is up to 2x internal fragmentation per block.
+//
+// A spin lock in the header serializes allocation across threads and
+// processes.  A process that dies while holding it ( i.e. inside allocate()
+// or deallocate() ) leaves the arena locked.
+//
+// Objects are found across processes by name : construct<T>( name, ... )
+// allocates and constructs a T and records it in a small directory in the
+// header, and find<T>( name ) looks it up.  Directory entries are changed
+// under the spin lock but each carries a sequence number, so find() reads
+// them w/o taking the lock ( or writing to the segment at all ) and works on
+// a read only attach.
+//
+
+namespace fps {
+namespace ipc {
+namespace detail {
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) ArenaHeader
+  {
+    //------------------------------------------------------------------------
+    static const uint64_t Magic          = 0x414e455241535046ull ;  // "FPSARENA"
+    static const uint32_t Version        = 2 ;
+    static const uint64_t Alignment      = 16 ;  // Of every payload.
+    static const uint32_t Min_Class      = 5 ;   // 32 byte blocks.
+    static const uint32_t Class_Count    = 64 ;
+    static const uint32_t Max_Names      = 64 ;
+    static const uint32_t Max_Name_Size  = 48 ;  // Including the terminator.
+
+    //------------------------------------------------------------------------
+    // Precedes every payload.  next_ links free blocks; it's cleared while a
+    // block is in use.
+    //------------------------------------------------------------------------
+    struct Block
+    {
+      uint64_t class_ ;
+      uint64_t next_  ;  // Offset of the next free block of this class, or zero.
+    } ;
+
+    //------------------------------------------------------------------------
+    // A directory entry.  sequence_ is odd while the entry is being changed;
+    // see begin_update() and lookup().
+    //------------------------------------------------------------------------
+    struct Name
+    {
+      std::atomic<uint64_t> sequence_ ;
+      std::atomic<uint64_t> offset_   ;  // Of the object's payload, or zero if unused.
+      std::atomic<uint64_t> size_     ;
+      char                  name_[ Max_Name_Size ] ;
+    } ;
+
+    //------------------------------------------------------------------------
+    uint64_t                  magic_       ;
+    uint32_t                  version_     ;
+    std::atomic<uint32_t>     initialized_ ;
+    uint64_t                  size_        ;  // Bytes in the segment, header included.
+    uint64_t                  top_         ;  // Offset of the untouched space.
+    uint64_t                  used_        ;  // Bytes in live blocks, headers included.
+    uint64_t                  blocks_      ;  // Live blocks.
+    BasicSpinLock_Intrinsic<> lock_        ;
+    uint64_t                  free_[ Class_Count ] ;
+    Name                      names_[ Max_Names ] ;
+
+    //------------------------------------------------------------------------
+    inline ArenaHeader() : initialized_( 0 ) {}
+
+    //------------------------------------------------------------------------
+    // Creator only.  Set up an empty arena of 'size' bytes and mark it
+    // initialized.
+    //------------------------------------------------------------------------
+    inline
+    void
+    publish( uint64_t size )
+    { magic_   = Magic ;
+      version_ = Version ;
+      size_    = size ;
+      top_     = first_block_offset() ;
+      used_    = 0 ;
+      blocks_  = 0 ;
+      std::memset( free_, 0, sizeof( free_ ) ) ;
+      for( uint32_t idx = 0 ; idx < Max_Names ; ++idx )
+      { names_[ idx ].sequence_.store( 0, std::memory_order_relaxed ) ;
+        names_[ idx ].offset_.store( 0, std::memory_order_relaxed ) ;
+        names_[ idx ].size_.store( 0, std::memory_order_relaxed ) ;
+        std::memset( names_[ idx ].name_, 0, Max_Name_Size ) ;
+      }
+      initialized_.store( 1, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Returns zero if a mapping of 'mapped_size' bytes holds a usable arena,
+    // otherwise :
+    //   EAGAIN - the creator hasn't finished initializing the arena ( retry ).
+    //   EPROTO - not an arena, or built w/ a different layout version.
+    //   EINVAL - the segment is truncated.
+    //------------------------------------------------------------------------
+    inline
+    int32_t
+    validate( uint64_t mapped_size ) const
+    {
+      if( initialized_.load( std::memory_order_acquire ) != 1 )
+        return ( magic_ == 0 || magic_ == Magic ) ? EAGAIN : EPROTO ;
+
+      if( magic_ != Magic || version_ != Version )
+        return EPROTO ;
+
+      if( size_ > mapped_size )
+        return EINVAL ;
+
+      return 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    first_block_offset()
+    { return ( sizeof( ArenaHeader ) + Alignment - 1 ) & ~( Alignment - 1 ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Smallest class whose blocks hold 'bytes' of payload, or Class_Count if
+    // no block could.
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint32_t
+    class_of( uint64_t bytes )
+    { if( bytes > ( 1ull << ( Class_Count - 2 ) ) )
+        return Class_Count ;
+      uint64_t total = bytes + sizeof( Block ) ;
+      uint32_t rv    = 64 - __builtin_clzll( total - 1 ) ;
+      return ( rv < Min_Class ) ? Min_Class : rv ;
+    }
+
+    //------------------------------------------------------------------------
+    inline char *       base()       { return reinterpret_cast<char *>( this ) ; }
+    inline const char * base() const { return reinterpret_cast<const char *>( this ) ; }
+
+    inline Block * block_at( uint64_t offset ) { return reinterpret_cast<Block *>( base() + offset ) ; }
+
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    offset_of( const void * ptr ) const
+    { return static_cast<const char *>( ptr ) - base() ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    contains( const void * ptr ) const
+    { const char * addr = static_cast<const char *>( ptr ) ;
+      return addr >= base() && addr < base() + size_ ;
+    }
+
+    //------------------------------------------------------------------------
+    // Returns NULL if the arena is exhausted ( or 'bytes' is absurdly large ).
+    //------------------------------------------------------------------------
+    inline
+    void *
+    allocate( uint64_t bytes )
+    {
+      uint32_t cls = class_of( bytes ) ;
+      if( fps_unlikely( cls >= Class_Count ) )
+        return NULL ;
+
+      std::lock_guard<BasicSpinLock_Intrinsic<> > guard( lock_ ) ;
+
+      uint64_t offset = free_[ cls ] ;
+      if( offset != 0 )
+      { free_[ cls ] = block_at( offset )->next_ ;
+      }
+      else
+      { uint64_t block_size = 1ull << cls ;
+        if( block_size > size_ - top_ )
+          return NULL ;
+        offset = top_ ;
+        top_  += block_size ;
+      }
+
+      Block * block  = block_at( offset ) ;
+      block->class_  = cls ;
+      block->next_   = 0 ;
+      used_         += 1ull << cls ;
+      ++blocks_ ;
+      return block + 1 ;
+    }
+
+    //------------------------------------------------------------------------
+    // 'ptr' must have come from allocate() on this arena, or be NULL.
+    //------------------------------------------------------------------------
+    inline
+    void
+    deallocate( void * ptr )
+    {
+      if( ptr == NULL )
+        return ;
+
+      Block  * block  = static_cast<Block *>( ptr ) - 1 ;
+      uint64_t cls    = block->class_ ;
+
+      std::lock_guard<BasicSpinLock_Intrinsic<> > guard( lock_ ) ;
+      block->next_  = free_[ cls ] ;
+      free_[ cls ]  = offset_of( block ) ;
+      used_        -= 1ull << cls ;
+      --blocks_ ;
+    }
+
+    //------------------------------------------------------------------------
+    // Payload bytes available in the block holding 'ptr'.
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    usable_size( const void * ptr )
+    { return ( 1ull << ( static_cast<const Block *>( ptr ) - 1 )->class_ ) - sizeof( Block ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Directory access.  Callers must hold lock_, and bracket every change
+    // to an entry w/ begin_update() and end_update().
+    //------------------------------------------------------------------------
+    inline
+    Name *
+    find_name( const char * name )
+    { for( uint32_t idx = 0 ; idx < Max_Names ; ++idx )
+      { if( names_[ idx ].offset_.load( std::memory_order_relaxed ) != 0 &&
+            std::strncmp( names_[ idx ].name_, name, Max_Name_Size ) == 0 )
+          return &names_[ idx ] ;
+      }
+      return NULL ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    Name *
+    free_name()
+    { for( uint32_t idx = 0 ; idx < Max_Names ; ++idx )
+      { if( names_[ idx ].offset_.load( std::memory_order_relaxed ) == 0 )
+          return &names_[ idx ] ;
+      }
+      return NULL ;
+    }
+
+    //------------------------------------------------------------------------
+    static
+    inline
+    void
+    begin_update( Name & entry )
+    { entry.sequence_.store( entry.sequence_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    static
+    inline
+    void
+    end_update( Name & entry )
+    { entry.sequence_.store( entry.sequence_.load( std::memory_order_relaxed ) + 1, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Lock free directory lookup; never writes to the segment.  Returns false
+    // if there's no completed entry for 'name', otherwise fills in the
+    // object's offset and size.  Spins while an entry is being changed, so a
+    // process that dies inside construct() or destroy() w/ an entry's
+    // sequence odd leaves lookups spinning forever ( as it leaves the arena
+    // locked ).
+    //------------------------------------------------------------------------
+    inline
+    bool
+    lookup( const char * name, uint64_t & offset, uint64_t & size ) const
+    {
+      for( uint32_t idx = 0 ; idx < Max_Names ; ++idx )
+      { const Name & entry = names_[ idx ] ;
+        for( ;; )
+        { uint64_t before = entry.sequence_.load( std::memory_order_acquire ) ;
+          if( before & 1 )
+          { backoff::cpu_pause() ;
+            continue ;
+          }
+
+          uint64_t off   = entry.offset_.load( std::memory_order_relaxed ) ;
+          uint64_t bytes = entry.size_.load( std::memory_order_relaxed ) ;
+          bool     match = off != 0 && off != UINT64_MAX &&
+                           std::strncmp( entry.name_, name, Max_Name_Size ) == 0 ;
+
+          std::atomic_thread_fence( std::memory_order_acquire ) ;
+          if( entry.sequence_.load( std::memory_order_relaxed ) != before )
+            continue ;
+
+          if( match )
+          { offset = off ;
+            size   = bytes ;
+            return true ;
+          }
+          break ;
+        }
+      }
+      return false ;
+    }
+  } ;
+
+} // detail
+
+  //--------------------------------------------------------------------------
+  // A shared memory segment holding a detail::ArenaHeader and its heap.  See
+  // the notes at the top of this file.  Containers are placed in the arena
+  // through ShmAllocator ( shm_allocator.h ).
+  //--------------------------------------------------------------------------
+  class ShmArena
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef detail::ArenaHeader header_t ;
+
+    SharedMemory shm_    ;
+    MappedMemory map_    ;
+    header_t   * header_ ;
+    int32_t      error_  ;
+
+    //------------------------------------------------------------------------
+    ShmArena( const ShmArena & ) ;
+    ShmArena & operator=( const ShmArena & ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline ShmArena() : header_( NULL ), error_( 0 ) {}
+    inline ~ShmArena() { close() ; }
+
+    //------------------------------------------------------------------------
+    // Create an arena of 'size' bytes ( header included ).  'options' takes
+    // the same ipc::access flags as SharedMemory::open and MappedMemory::open
+    // ( e.g. access::Huge_Pages, access::Populate ); Read_Write and Create are
+    // implied.  Fails w/ EEXIST if a segment of the same name exists.  Returns
+    // false on failure, w/ the errno value available via last_error().
+    //------------------------------------------------------------------------
+    bool create( const std::string & name, uint64_t size, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    // Attach to an existing arena.  Fails w/ the error codes documented for
+    // detail::ArenaHeader::validate() if the segment isn't a usable arena.
+    //
+    // Without access::Read_Write the segment is mapped read only, and only
+    // find() ( and reads through the pointers it returns ) may be used;
+    // allocate(), deallocate(), construct() and destroy() fail w/ EACCES.
+    //------------------------------------------------------------------------
+    bool open( const std::string & name, uint32_t flags = access::Read_Write ) ;
+
+    //------------------------------------------------------------------------
+    bool close( bool remove_from_fs = false ) ;
+
+    //------------------------------------------------------------------------
+    inline bool               is_open()     const { return header_ != NULL ; }
+    inline bool               is_writable() const { return is_open() && shm_.is_writable() ; }
+    inline int32_t            last_error()  const { return error_ ; }
+    inline std::string        name()        const { return shm_.name() ; }
+    inline header_t         * header()            { return header_ ; }
+
+    //------------------------------------------------------------------------
+    inline uint64_t capacity() const { return is_open() ? header_->size_ - header_t::first_block_offset() : 0 ; }
+    inline uint64_t used()     const { return is_open() ? header_->used_   : 0 ; }
+    inline uint64_t blocks()   const { return is_open() ? header_->blocks_ : 0 ; }
+
+    //------------------------------------------------------------------------
+    // Bytes never yet handed out.  Freed blocks are not included.
+    //------------------------------------------------------------------------
+    inline uint64_t untouched() const { return is_open() ? header_->size_ - header_->top_ : 0 ; }
+
+    //------------------------------------------------------------------------
+    // Raw allocation.  Payloads are aligned to header_t::Alignment ( 16 ).
+    // allocate() returns NULL and sets last_error() to ENOMEM when the arena
+    // is exhausted, EBADF if it isn't open or EACCES if it's read only.
+    //------------------------------------------------------------------------
+    inline
+    void *
+    allocate( uint64_t bytes )
+    { if( !check_writable() )
+        return NULL ;
+      void * rv = header_->allocate( bytes ) ;
+      if( rv == NULL )
+        error_ = ENOMEM ;
+      return rv ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    deallocate( void * ptr )
+    { if( check_writable() )
+        header_->deallocate( ptr ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Translate between addresses in this process and offsets from the start
+    // of the segment, e.g. to pass a location to another process.
+    //------------------------------------------------------------------------
+    inline uint64_t offset_of ( const void * ptr ) const { return header_->offset_of( ptr ) ; }
+    inline void *   address_of( uint64_t offset )        { return header_->base() + offset ; }
+
+    //------------------------------------------------------------------------
+    // Allocate and construct a T, recorded under 'name'.  Returns NULL if the
+    // name is taken ( EEXIST ), too long ( ENAMETOOLONG ), the directory is
+    // full ( ENFILE ), the arena is exhausted ( ENOMEM ), closed ( EBADF ) or
+    // read only ( EACCES ).
+    //------------------------------------------------------------------------
+    template<typename T, typename... Args>
+    T *
+    construct( const char * name, Args &&... args ) ;
+
+    //------------------------------------------------------------------------
+    // Look up an object recorded by construct().  Returns NULL if there's no
+    // object of that name ( ENOENT ), it's of a different size ( EINVAL ) or
+    // the arena is closed ( EBADF ).  Takes no lock.
+    //------------------------------------------------------------------------
+    template<typename T>
+    T *
+    find( const char * name ) ;
+
+    //------------------------------------------------------------------------
+    // Return find<T>( name ), or construct<T>( name, args... ) if not found.
+    // Not atomic : while another thread or process is still constructing an
+    // object of the same name, find() doesn't see it yet and construct()
+    // fails, so this returns NULL w/ EEXIST.  Retry to pick up the object
+    // once it's built.
+    //------------------------------------------------------------------------
+    template<typename T, typename... Args>
+    T *
+    find_or_construct( const char * name, Args &&... args ) ;
+
+    //------------------------------------------------------------------------
+    // Destroy and free an object recorded by construct().  Returns false if
+    // there was no such object, or the arena is closed or read only.
+    //------------------------------------------------------------------------
+    template<typename T>
+    bool
+    destroy( const char * name ) ;
+
+  private :
+    //------------------------------------------------------------------------
+    inline
+    bool
+    check_writable()
+    { if( fps_unlikely( !is_open() ) )
+      { error_ = EBADF ;
+        return false ;
+      }
+      if( fps_unlikely( !shm_.is_writable() ) )
+      { error_ = EACCES ;
+        return false ;
+      }
+      return true ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T, typename... Args>
+  T *
+  ShmArena::
+  construct( const char * name, Args &&... args )
+  {
+    if( !check_writable() )
+      return NULL ;
+
+    size_t name_len = std::strlen( name ) ;
+    if( name_len >= header_t::Max_Name_Size )
+    { error_ = ENAMETOOLONG ;
+      return NULL ;
+    }
+
+    // Reserve the directory entry first, so that concurrent constructs of
+    // the same name can't both succeed.  The entry is filled in w/ a
+    // placeholder offset until the object is built.
+    header_t::Name * entry = NULL ;
+    {
+      std::lock_guard<BasicSpinLock_Intrinsic<> > guard( header_->lock_ ) ;
+      if( header_->find_name( name ) != NULL )
+      { error_ = EEXIST ;
+        return NULL ;
+      }
+      if( ( entry = header_->free_name() ) == NULL )
+      { error_ = ENFILE ;
+        return NULL ;
+      }
+      header_t::begin_update( *entry ) ;
+      std::memset( entry->name_, 0, header_t::Max_Name_Size ) ;
+      std::memcpy( entry->name_, name, name_len ) ;
+      entry->size_.store( sizeof( T ), std::memory_order_relaxed ) ;
+      entry->offset_.store( UINT64_MAX, std::memory_order_relaxed ) ;
+      header_t::end_update( *entry ) ;
+    }
+
+    void * ptr = allocate( sizeof( T ) ) ;
+    if( ptr == NULL )
+    { std::lock_guard<BasicSpinLock_Intrinsic<> > guard( header_->lock_ ) ;
+      header_t::begin_update( *entry ) ;
+      entry->offset_.store( 0, std::memory_order_relaxed ) ;
+      header_t::end_update( *entry ) ;
+      return NULL ;
+    }
+
+    // If T's constructor throws, give back the block and the name before
+    // passing the exception on.
+    T * rv = NULL ;
+    try
+    { rv = new( ptr ) T( std::forward<Args>( args )... ) ;
+    }
+    catch( ... )
+    { deallocate( ptr ) ;
+      std::lock_guard<BasicSpinLock_Intrinsic<> > guard( header_->lock_ ) ;
+      header_t::begin_update( *entry ) ;
+      entry->offset_.store( 0, std::memory_order_relaxed ) ;
+      header_t::end_update( *entry ) ;
+      throw ;
+    }
+
+    // end_update()'s release store publishes the object along w/ the entry.
+    std::lock_guard<BasicSpinLock_Intrinsic<> > guard( header_->lock_ ) ;
+    header_t::begin_update( *entry ) ;
+    entry->offset_.store( offset_of( rv ), std::memory_order_relaxed ) ;
+    header_t::end_update( *entry ) ;
+    return rv ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T>
+  T *
+  ShmArena::
+  find( const char * name )
+  {
+    if( fps_unlikely( !is_open() ) )
+    { error_ = EBADF ;
+      return NULL ;
+    }
+
+    uint64_t offset = 0 ;
+    uint64_t size   = 0 ;
+    if( !header_->lookup( name, offset, size ) )
+    { error_ = ENOENT ;
+      return NULL ;
+    }
+    if( size != sizeof( T ) )
+    { error_ = EINVAL ;
+      return NULL ;
+    }
+    return reinterpret_cast<T *>( address_of( offset ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, typename... Args>
+  T *
+  ShmArena::
+  find_or_construct( const char * name, Args &&... args )
+  {
+    T * rv = find<T>( name ) ;
+    return ( rv != NULL ) ? rv : construct<T>( name, std::forward<Args>( args )... ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T>
+  bool
+  ShmArena::
+  destroy( const char * name )
+  {
+    if( !check_writable() )
+      return false ;
+
+    T * obj = NULL ;
+    {
+      std::lock_guard<BasicSpinLock_Intrinsic<> > guard( header_->lock_ ) ;
+      header_t::Name * entry = header_->find_name( name ) ;
+      uint64_t         offset = ( entry != NULL ) ? entry->offset_.load( std::memory_order_relaxed ) : 0 ;
+      if( entry == NULL || offset == UINT64_MAX || entry->size_.load( std::memory_order_relaxed ) != sizeof( T ) )
+      { error_ = ENOENT ;
+        return false ;
+      }
+      obj = reinterpret_cast<T *>( address_of( offset ) ) ;
+      header_t::begin_update( *entry ) ;
+      entry->offset_.store( 0, std::memory_order_relaxed ) ;
+      header_t::end_update( *entry ) ;
+    }
+
+    obj->~T() ;
+    deallocate( obj ) ;
+    return true ;
+  }
+
+}}
+
+#endif
@@ -3,25 +3,40 @@
 
 #include <atomic>
 #include "fps_ipc/ipc_util.h"
+#include "fps_ipc/backoff.h"
 
 namespace fps {
 namespace ipc {
 
   //----------------------------------------------------------------------------
-  class SpinLock_Atomic
+  // Test-and-set spin locks.  T_Backoff controls what a waiter does between
+  // attempts ( see backoff.h ).
+  //----------------------------------------------------------------------------
+  template<typename T_Backoff = backoff::Default>
+  class BasicSpinLock_Atomic
   {
   private :
     std::atomic_flag lock_ ;
 
   public:
+    typedef T_Backoff backoff_t ;
+
     //--------------------------------------------------------------------------
     inline
-    SpinLock_Atomic() 
+    BasicSpinLock_Atomic()
       : lock_( ATOMIC_FLAG_INIT )
     {
       // lock_ = ATOMIC_FLAG_INIT ;
     }
 
+    //--------------------------------------------------------------------------
+    inline
+    bool 
+    try_lock() 
+    {
+      return !lock_.test_and_set( std::memory_order_acquire ) ;
+    }
+
     //--------------------------------------------------------------------------
     inline
     void 
@@ -31,7 +46,7 @@ namespace ipc {
          ; lock_.test_and_set( std::memory_order_acquire ) 
          ; ++idx 
          ) 
-      { ipc::progressive_yield( idx ) ; 
+      { T_Backoff::wait( idx ) ;
       }
     }
 
@@ -45,14 +60,17 @@ namespace ipc {
   } ;
 
   //----------------------------------------------------------------------------
-  class SpinLock_Intrinsic 
+  template<typename T_Backoff = backoff::Default>
+  class BasicSpinLock_Intrinsic
   {
   public:
+    typedef T_Backoff backoff_t ;
+
     uint32_t state_ ;
 
   public:
     //----------------------------------------------------------------------------
-    inline SpinLock_Intrinsic() : state_( 0 ) {}
+    inline BasicSpinLock_Intrinsic() : state_( 0 ) {}
 
     //----------------------------------------------------------------------------
     inline
@@ -69,7 +87,7 @@ namespace ipc {
     lock()
     {
       for( uint32_t counter = 0; !try_lock(); ++counter ) 
-      { ipc::progressive_yield( counter ) ;
+      { T_Backoff::wait( counter ) ;
       }
     }
 
@@ -82,7 +100,9 @@ namespace ipc {
     }
   } ;
 
-  typedef SpinLock_Intrinsic SpinLock ;
+  typedef BasicSpinLock_Atomic<>    SpinLock_Atomic ;
+  typedef BasicSpinLock_Intrinsic<> SpinLock_Intrinsic ;
+  typedef SpinLock_Intrinsic        SpinLock ;
 
 }}
 
@@ -0,0 +1,356 @@
+#ifndef FPS__IPC__SPSC_RING_BUFFER__H
+#define FPS__IPC__SPSC_RING_BUFFER__H
+
+#include <type_traits>
+#include <cstdlib>
+#include <atomic>
+#include <utility>
+#include <new>
+#include "fps_system/fps_system.h"
+#include "fps_util/fps_util.h"
+#include "fps_ipc/queue_telemetry.h"
+
+namespace fps  {
+namespace ipc  {
+namespace spsc {
+
+//--------------------------------------------------------------------------------
+// Bounded single-producer/single-consumer ring buffer.
+//
+// The producer owns w_pos_ and the consumer owns r_pos_.  Both are free running
+// 64-bit positions published w/ release stores, so no locked read-modify-write
+// is ever executed.  Each side keeps a private copy of the other side's
+// position in its own cache line, and only reloads the shared one when the
+// cached copy says the ring is full ( producer ) or empty ( consumer ).  In
+// steady state each side therefore touches the other's cache line about once
+// per lap rather than once per message.
+//
+// Storage is rounded up to a power of two so positions wrap w/ a mask; the
+// requested capacity is still honored as the limit on queued elements.  Slots
+// are raw storage : an element is constructed in place when written and
+// destroyed when read, so reserve() costs no T() calls and reads move
+// elements out rather than copying them.
+//
+// T_Telemetry selects the instrumentation policy ( see queue_telemetry.h ).
+// The producer reports the depth it computes from its cached copy of r_pos_,
+// and the consumer its lag from its cached copy of w_pos_, so instrumenting
+// the ring adds no cross-core traffic.
+//--------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry = telemetry::None>
+class RingBuffer
+{
+public :
+  typedef T           value_t ;
+  typedef T_Telemetry telemetry_t ;
+  static const std::size_t Alignment = system::cpu::Cache_Line_Size ;
+
+private :
+  //------------------------------------------------------------------------------
+  typedef std::atomic<uint64_t> atomic_pos_t ;
+
+  //------------------------------------------------------------------------------
+  // Note: Read-only state, producer state and consumer state each occupy a
+  //       distinct cache line.
+  //------------------------------------------------------------------------------
+  uint64_t     capacity_ alignas( Alignment ) ;  // Max queued elements.
+  uint64_t     mask_ ;                           // Storage size - 1.
+  T          * data_ ;
+  T_Telemetry  telemetry_ ;
+
+  atomic_pos_t w_pos_    alignas( Alignment ) ;  // Next position to write.
+  uint64_t     r_cache_ ;                        // Producer's copy of r_pos_.
+
+  atomic_pos_t r_pos_    alignas( Alignment ) ;  // Next position to read.
+  uint64_t     w_cache_ ;                        // Consumer's copy of w_pos_.
+
+  RingBuffer( const RingBuffer & ) ;
+  RingBuffer & operator=( const RingBuffer & ) ;
+
+  //------------------------------------------------------------------------------
+  inline T * slot( uint64_t pos ) { return data_ + ( pos & mask_ ) ; }
+
+  //------------------------------------------------------------------------------
+  // Producer side : return the number of free slots, reloading the consumer's
+  // position only if the cached copy shows fewer than 'wanted'.
+  //------------------------------------------------------------------------------
+  inline
+  uint64_t
+  writable( uint64_t w_pos, uint64_t wanted )
+  { uint64_t avail = capacity_ - ( w_pos - r_cache_ ) ;
+    if( fps_unlikely( avail < wanted ) )
+    { r_cache_ = r_pos_.load( std::memory_order_acquire ) ;
+      avail    = capacity_ - ( w_pos - r_cache_ ) ;
+    }
+    return avail ;
+  }
+
+  //------------------------------------------------------------------------------
+  // Consumer side : return the number of queued elements, reloading the
+  // producer's position only if the cached copy shows fewer than 'wanted'.
+  //------------------------------------------------------------------------------
+  inline
+  uint64_t
+  readable( uint64_t r_pos, uint64_t wanted )
+  { uint64_t avail = w_cache_ - r_pos ;
+    if( fps_unlikely( avail < wanted ) )
+    { w_cache_ = w_pos_.load( std::memory_order_acquire ) ;
+      avail    = w_cache_ - r_pos ;
+    }
+    return avail ;
+  }
+
+  //------------------------------------------------------------------------------
+  static
+  inline
+  uint64_t
+  storage_size( uint64_t capacity )
+  { uint64_t rv = 1 ;
+    while( rv < capacity )
+      rv <<= 1 ;
+    return rv ;
+  }
+
+public :
+  //------------------------------------------------------------------------------
+  inline RingBuffer() ;
+  inline RingBuffer( uint64_t capacity ) ;
+  inline ~RingBuffer() ;
+
+  //------------------------------------------------------------------------------
+  bool clear() ;
+  bool reserve( uint64_t capacity ) ;
+
+  //------------------------------------------------------------------------------
+  inline bool     valid()    const { return capacity_ > 0 ; }
+  inline uint64_t capacity() const { return capacity_ ; }
+
+  //------------------------------------------------------------------------------
+  // Publish this ring's telemetry under 'name' for the queue_stats tool, w/ 
+  // both ends recorded by the calling process.  Call after reserve() and 
+  // before either side starts.  Always returns false for telemetry::None.
+  //------------------------------------------------------------------------------
+  inline
+  bool
+  publish_telemetry( const std::string & name )
+  { return telemetry_.create( name, capacity_ ) && telemetry_.attach_reader() ;
+  }
+
+  inline const T_Telemetry & telemetry() const { return telemetry_ ; }
+
+  //------------------------------------------------------------------------------
+  // Approximate when called concurrently w/ the producer or consumer.
+  //------------------------------------------------------------------------------
+  inline
+  uint64_t
+  size() const
+  { uint64_t r_pos = r_pos_.load( std::memory_order_acquire ) ;
+    return w_pos_.load( std::memory_order_acquire ) - r_pos ;
+  }
+
+  //------------------------------------------------------------------------------
+  // Producer only.  Each returns false if the ring is full.
+  //------------------------------------------------------------------------------
+  inline bool write( const T & value ) { return emplace( value ) ; }
+  inline bool write( T && value )      { return emplace( std::move( value ) ) ; }
+
+  //------------------------------------------------------------------------------
+  // Construct an element in place from 'args'.
+  //------------------------------------------------------------------------------
+  template<typename... T_Args>
+  inline bool emplace( T_Args &&... args ) ;
+
+  //------------------------------------------------------------------------------
+  // Copy up to 'count' elements from 'src', publishing them w/ a single store.
+  // Returns the number written.
+  //------------------------------------------------------------------------------
+  inline uint64_t try_write_n( const T * src, uint64_t count ) ;
+
+  //------------------------------------------------------------------------------
+  // Consumer only.  Move the oldest element into 'result'.  Returns false if
+  // the ring is empty.
+  //------------------------------------------------------------------------------
+  inline bool read ( T & result ) ;
+
+  //------------------------------------------------------------------------------
+  // Move up to 'max_count' elements into 'dest', releasing their slots w/ a
+  // single store.  Returns the number read.
+  //------------------------------------------------------------------------------
+  inline uint64_t try_read_n( T * dest, uint64_t max_count ) ;
+} ;
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+RingBuffer<T,T_Telemetry>::RingBuffer()
+  : capacity_( 0 )
+  , mask_    ( 0 )
+  , data_    ( NULL )
+  , w_pos_   ( 0 )
+  , r_cache_ ( 0 )
+  , r_pos_   ( 0 )
+  , w_cache_ ( 0 )
+{}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+RingBuffer<T,T_Telemetry>::RingBuffer( uint64_t capacity )
+  : capacity_( 0 )
+  , mask_    ( 0 )
+  , data_    ( NULL )
+  , w_pos_   ( 0 )
+  , r_cache_ ( 0 )
+  , r_pos_   ( 0 )
+  , w_cache_ ( 0 )
+{
+  reserve( capacity ) ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+RingBuffer<T,T_Telemetry>::~RingBuffer()
+{
+  clear() ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+bool
+RingBuffer<T,T_Telemetry>::clear()
+{
+  if( capacity_ == 0 || data_ == NULL )
+    return true ;
+
+  // Only slots between the read and write positions hold live elements.
+  uint64_t w_pos = w_pos_.load( std::memory_order_acquire ) ;
+  for( uint64_t pos = r_pos_.load( std::memory_order_relaxed ) ; pos != w_pos ; ++pos )
+    slot( pos )->~T() ;
+
+  free( data_ ) ;
+  data_     = NULL ;
+  capacity_ = 0 ;
+  mask_     = 0 ;
+  w_pos_.store( 0, std::memory_order_relaxed ) ;
+  r_pos_.store( 0, std::memory_order_relaxed ) ;
+  r_cache_  = 0 ;
+  w_cache_  = 0 ;
+  return true ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+bool
+RingBuffer<T,T_Telemetry>::reserve( uint64_t capacity )
+{
+  if( valid() || size() > 0 || capacity == 0 )
+    return false ;
+
+  uint64_t slots = storage_size( capacity ) ;
+  int32_t  rv    = ::posix_memalign( reinterpret_cast<void**>( &data_ )
+                                   , Alignment
+                                   , slots * sizeof( T )
+                                   ) ;
+  if( rv )
+  { data_ = NULL ;
+    return false ;
+  }
+
+  capacity_ = capacity ;
+  mask_     = slots - 1 ;
+
+  w_pos_.store( 0, std::memory_order_relaxed ) ;
+  r_pos_.store( 0, std::memory_order_relaxed ) ;
+  r_cache_ = 0 ;
+  w_cache_ = 0 ;
+
+  return true ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+template<typename... T_Args>
+bool
+RingBuffer<T,T_Telemetry>::emplace( T_Args &&... args )
+{
+  uint64_t w_pos = w_pos_.load( std::memory_order_relaxed ) ;
+
+  // Only look at the consumer's position if our cached copy says we're full.
+  if( fps_unlikely( writable( w_pos, 1 ) == 0 ) )
+  { telemetry_.on_full() ;
+    return false ;
+  }
+
+  new ( slot( w_pos ) ) T( std::forward<T_Args>( args )... ) ;
+  telemetry_.on_write( w_pos, w_pos + 1, w_pos + 1 - r_cache_ ) ;
+  w_pos_.store( w_pos + 1, std::memory_order_release ) ;
+  return true ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+uint64_t
+RingBuffer<T,T_Telemetry>::try_write_n( const T * src, uint64_t count )
+{
+  uint64_t w_pos = w_pos_.load( std::memory_order_relaxed ) ;
+  uint64_t avail = writable( w_pos, count ) ;
+  if( count > avail )
+  { telemetry_.on_full() ;
+    count = avail ;
+  }
+
+  for( uint64_t idx = 0 ; idx < count ; ++idx )
+    new ( slot( w_pos + idx ) ) T( src[ idx ] ) ;
+
+  if( count > 0 )
+  { telemetry_.on_write( w_pos, w_pos + count, w_pos + count - r_cache_ ) ;
+    w_pos_.store( w_pos + count, std::memory_order_release ) ;
+  }
+  return count ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+bool
+RingBuffer<T,T_Telemetry>::read( T & result )
+{
+  uint64_t r_pos = r_pos_.load( std::memory_order_relaxed ) ;
+
+  // Only look at the producer's position if our cached copy says we're empty.
+  if( fps_unlikely( readable( r_pos, 1 ) == 0 ) )
+    return false ;
+
+  T * src = slot( r_pos ) ;
+  result = std::move( *src ) ;
+  src->~T() ;
+  r_pos_.store( r_pos + 1, std::memory_order_release ) ;
+
+  if( telemetry_.on_read( r_pos, r_pos + 1 ) )
+    telemetry_.on_lag( w_cache_ - ( r_pos + 1 ) ) ;
+  return true ;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, typename T_Telemetry>
+uint64_t
+RingBuffer<T,T_Telemetry>::try_read_n( T * dest, uint64_t max_count )
+{
+  uint64_t r_pos = r_pos_.load( std::memory_order_relaxed ) ;
+  uint64_t count = readable( r_pos, max_count ) ;
+  if( count > max_count )
+    count = max_count ;
+
+  for( uint64_t idx = 0 ; idx < count ; ++idx )
+  { T * src = slot( r_pos + idx ) ;
+    dest[ idx ] = std::move( *src ) ;
+    src->~T() ;
+  }
+
+  if( count > 0 )
+  { r_pos_.store( r_pos + count, std::memory_order_release ) ;
+    if( telemetry_.on_read( r_pos, r_pos + count ) )
+      telemetry_.on_lag( w_cache_ - ( r_pos + count ) ) ;
+  }
+  return count ;
+}
+
+}}}
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef FPS__IPC__SPSC_SHM_QUEUE__H
+#define FPS__IPC__SPSC_SHM_QUEUE__H
+
+#include "fps_ipc/spsc_shm_queue_reader.h"
+#include "fps_ipc/spsc_shm_queue_writer.h"
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef FPS__IPC__SPSC_SHM_QUEUE_READER__H
+#define FPS__IPC__SPSC_SHM_QUEUE_READER__H
+
+#include "fps_ipc/spsc_shm_ring.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_util/macros.h"
+
+namespace fps  {
+namespace ipc  {
+namespace spsc {
+
+  //--------------------------------------------------------------------------
+  // Reading end of a lossless single-writer/single-reader shm queue ( see
+  // ShmQueueWriter ).  Every message written is read exactly once, in order.
+  // Only one reader may be attached at a time : open() fails w/ EBUSY while
+  // another live reader holds the queue.
+  //
+  // T_Capacity must match the writer's, or be zero to accept any capacity.
+  // W/ telemetry::Shm the reader attaches to the writer's stats block in
+  // open() ( see queue_telemetry.h ).
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity = 0, typename T_Telemetry = telemetry::None>
+  class ShmQueueReader
+  {
+  public :
+    typedef T_Telemetry telemetry_t ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef spsc::detail::ShmRing<T, T_Capacity> impl_t ;
+    typedef swmr::detail::QueueHeader            header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    const header_t  * header_ ;
+    impl_t          * impl_  ;
+    uint64_t          r_pos_ ;    // Private copy of impl_->r_pos_.
+    uint64_t          w_cache_ ;  // Last known value of impl_->w_pos_.
+    T_Telemetry       telemetry_ ;
+
+    ShmQueueReader( const ShmQueueReader & ) ;
+    ShmQueueReader & operator=( const ShmQueueReader & ) ;
+
+    //------------------------------------------------------------------------
+    // Queued messages, reloading the writer's position only if the cached
+    // copy shows fewer than 'wanted'.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    readable( uint64_t wanted )
+    { uint64_t avail = w_cache_ - r_pos_ ;
+      if( fps_unlikely( avail < wanted ) )
+      { w_cache_ = impl_->w_pos_.load( std::memory_order_acquire ) ;
+        avail    = w_cache_ - r_pos_ ;
+      }
+      return avail ;
+    }
+
+  public :
+    //------------------------------------------------------------------------
+    ShmQueueReader() ;
+    ~ShmQueueReader() ;
+
+    //------------------------------------------------------------------------
+    // Attach to the indicated shm queue.  Return true on success, false on
+    // failure and sets internal error_ member to the associated system errno
+    // value (if possible).  Besides the header validation errors documented
+    // for swmr::ShmQueueReader ( EAGAIN, EPROTO, EINVAL ), fails w/ EBUSY
+    // if another reader is attached.
+    //
+    // The reader publishes its position, so the queue is always mapped
+    // read/write.  'options' may include access::Populate and access::Lock.
+    //------------------------------------------------------------------------
+    bool open( const std::string & shm_q_name, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Copy the next message into 'dest'.  Returns false if the queue is empty
+    // or not open.
+    //------------------------------------------------------------------------
+    inline bool read( T & dest ) ;
+
+    //------------------------------------------------------------------------
+    // Copy up to 'max_count' messages into 'dest', releasing their slots w/ a
+    // single store.  Returns the number read.
+    //------------------------------------------------------------------------
+    inline uint32_t read_batch( T * dest, uint32_t max_count ) ;
+
+    //------------------------------------------------------------------------
+    // Zero copy read.  front() returns the next message in place, or NULL if
+    // the queue is empty; pop() releases it to the writer.
+    //------------------------------------------------------------------------
+    inline const T * front() ;
+    inline void      pop() ;
+
+    //------------------------------------------------------------------------
+    inline uint64_t size()       const { return ( impl_ != NULL ) ? impl_->size() : 0 ; }
+    inline uint64_t capacity()   const { return ( impl_ != NULL ) ? impl_->capacity() : T_Capacity ; }
+    inline uint64_t read_count() const { return r_pos_ ; }
+
+    //------------------------------------------------------------------------
+    inline bool is_writer_alive() const { return header_ != NULL && header_->writer_alive() ; }
+
+    //------------------------------------------------------------------------
+    inline bool    is_open()    const { return impl_ != NULL ; }
+    inline int32_t last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    inline const T_Telemetry & telemetry() const { return telemetry_ ; }
+
+    //------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  ShmQueueReader()
+    : error_  ( 0 )
+    , header_ ( NULL )
+    , impl_   ( NULL )
+    , r_pos_  ( 0 )
+    , w_cache_( 0 )
+  {}
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  ~ShmQueueReader()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  void
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  close()
+  {
+    if( impl_ != NULL )
+      impl_->detach_reader() ;
+
+    telemetry_.close() ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close( false ) ;
+
+    error_   = 0 ;
+    header_  = NULL ;
+    impl_    = NULL ;
+    r_pos_   = 0 ;
+    w_cache_ = 0 ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  bool
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  open( const std::string & shm_q_name, uint32_t options )
+  {
+    close() ;
+    uint32_t access_flags = ipc::access::Read_Write
+                          | ( options & ( ipc::access::Populate | ipc::access::Lock ) )
+                          ;
+
+    if( !shm_.open( shm_q_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    // The writer creates the segment before sizing it.
+    if( shm_.size() < sizeof( header_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    const header_t * header = shm_map_.cast<header_t>( 0 ) ;
+    error_ = header->validate( swmr::queue_kind::Spsc
+                             , sizeof( T )
+                             , T_Capacity
+                             , swmr::TypeHash<T>::value()
+                             , shm_map_.size()
+                             ) ;
+    if( error_ == 0 )
+      error_ = shm_map_.cast<impl_t>( sizeof( header_t ) )->attach_reader() ;
+
+    if( error_ != 0 )
+    { shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    header_  = header ;
+    impl_    = shm_map_.cast<impl_t>( sizeof( header_t ) ) ;
+    r_pos_   = impl_->r_pos_.load( std::memory_order_acquire ) ;
+    w_cache_ = r_pos_ ;
+
+    // Telemetry is best effort, and never fails the queue.
+    telemetry_.attach( shm_q_name ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  bool
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  read( T & dest )
+  {
+    if( fps_unlikely( impl_ == NULL || readable( 1 ) == 0 ) )
+      return false ;
+
+    dest = *impl_->slot( r_pos_ ) ;
+    impl_->r_pos_.store( ++r_pos_, std::memory_order_release ) ;
+
+    if( telemetry_.on_read( r_pos_ - 1, r_pos_ ) )
+      telemetry_.on_lag( w_cache_ - r_pos_ ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  uint32_t
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  read_batch( T * dest, uint32_t max_count )
+  {
+    if( fps_unlikely( impl_ == NULL ) )
+      return 0 ;
+
+    uint64_t count = readable( max_count ) ;
+    if( count > max_count )
+      count = max_count ;
+
+    for( uint64_t idx = 0 ; idx < count ; ++idx )
+      dest[ idx ] = *impl_->slot( r_pos_ + idx ) ;
+
+    if( count > 0 )
+    { r_pos_ += count ;
+      impl_->r_pos_.store( r_pos_, std::memory_order_release ) ;
+      if( telemetry_.on_read( r_pos_ - count, r_pos_ ) )
+        telemetry_.on_lag( w_cache_ - r_pos_ ) ;
+    }
+    return count ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  const T *
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  front()
+  {
+    if( fps_unlikely( impl_ == NULL || readable( 1 ) == 0 ) )
+      return NULL ;
+    return impl_->slot( r_pos_ ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  void
+  ShmQueueReader<T,T_Capacity,T_Telemetry>::
+  pop()
+  {
+    impl_->r_pos_.store( ++r_pos_, std::memory_order_release ) ;
+    if( telemetry_.on_read( r_pos_ - 1, r_pos_ ) )
+      telemetry_.on_lag( w_cache_ - r_pos_ ) ;
+  }
+
+}}}
+
+#endif
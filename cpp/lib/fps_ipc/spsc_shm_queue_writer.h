@@ -0,0 +1,343 @@
+#ifndef FPS__IPC__SPSC_SHM_QUEUE_WRITER__H
+#define FPS__IPC__SPSC_SHM_QUEUE_WRITER__H
+
+#include "fps_ipc/spsc_shm_ring.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_util/macros.h"
+#include <type_traits>
+#include <utility>
+#include <new>
+
+namespace fps  {
+namespace ipc  {
+namespace spsc {
+
+  //--------------------------------------------------------------------------
+  // Writing end of a lossless single-writer/single-reader shm queue.  Unlike
+  // the swmr queues, the writer never overwrites unread messages : write()
+  // returns false while the queue is full, and the caller decides whether to
+  // retry, back off or fail.
+  //
+  // T_Capacity fixes the capacity at compile time, which turns the index
+  // mask into a constant.  Leave it zero to choose the capacity in open().
+  // Either way the slots are rounded up to a power of two, while the
+  // requested capacity is still honored as the limit on queued messages.
+  //
+  // The writer keeps a private copy of the reader's position and only loads
+  // the shared one when that copy says the queue is full, so in steady state
+  // the writer touches the reader's cache line about once per lap.
+  //
+  // Elements are copied into shared memory and may outlive either process,
+  // so T must be trivially destructible and hold no pointers.
+  //
+  // T_Telemetry selects the instrumentation policy ( see queue_telemetry.h ).
+  // W/ telemetry::Shm the writer creates the queue's stats block in open().
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity = 0, typename T_Telemetry = telemetry::None>
+  class ShmQueueWriter
+  {
+  public :
+    typedef T_Telemetry telemetry_t ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef spsc::detail::ShmRing<T, T_Capacity> impl_t ;
+    typedef swmr::detail::QueueHeader            header_t ;
+
+    static_assert( std::is_trivially_destructible<T>::value
+                 , "spsc::ShmQueueWriter<T> requires a trivially destructible T"
+                 ) ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    header_t        * header_ ;
+    impl_t          * impl_  ;
+    uint64_t          w_pos_ ;    // Private copy of impl_->w_pos_.
+    uint64_t          r_cache_ ;  // Last known value of impl_->r_pos_.
+    T_Telemetry       telemetry_ ;
+
+    ShmQueueWriter( const ShmQueueWriter & ) ;
+    ShmQueueWriter & operator=( const ShmQueueWriter & ) ;
+
+    //------------------------------------------------------------------------
+    // Free slots, reloading the reader's position only if the cached copy
+    // shows fewer than 'wanted'.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    writable( uint64_t wanted )
+    { uint64_t avail = impl_->capacity() - ( w_pos_ - r_cache_ ) ;
+      if( fps_unlikely( avail < wanted ) )
+      { r_cache_ = impl_->r_pos_.load( std::memory_order_acquire ) ;
+        avail    = impl_->capacity() - ( w_pos_ - r_cache_ ) ;
+      }
+      return avail ;
+    }
+
+  public :
+    //------------------------------------------------------------------------
+    ShmQueueWriter() ;
+    ~ShmQueueWriter() ;
+
+    //------------------------------------------------------------------------
+    // Create the indicated shm queue, holding up to 'capacity' messages.
+    // Fails w/ EEXIST if the segment already exists, and w/ EINVAL if
+    // 'capacity' is zero or T_Capacity is set and 'capacity' differs.
+    // Return true on success, false on failure and sets internal error_
+    // member to the associated system errno value (if possible).
+    //
+    // 'options' may request huge pages, prefaulting, locking and numa
+    // placement for the segment, as for swmr::ShmQueueWriter.
+    //------------------------------------------------------------------------
+    bool open( const std::string & shm_q_name, uint64_t capacity = T_Capacity, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Each returns false if the queue is full or not open.
+    //------------------------------------------------------------------------
+    inline bool write( const T & value ) { return emplace( value ) ; }
+
+    template<typename... T_Args>
+    inline bool emplace( T_Args &&... args ) ;
+
+    //------------------------------------------------------------------------
+    // Copy up to 'count' messages from 'src', publishing them w/ a single
+    // store.  Returns the number written.
+    //------------------------------------------------------------------------
+    inline uint32_t write_batch( const T * src, uint32_t count ) ;
+
+    //------------------------------------------------------------------------
+    // Zero copy write.  claim() returns the next slot's storage, or NULL if
+    // the queue is full or not open; commit() publishes it.  The slot holds
+    // stale data, so every field must be assigned.
+    //------------------------------------------------------------------------
+    inline T    * claim() ;
+    inline void   commit() ;
+
+    //------------------------------------------------------------------------
+    // Approximate; the reader may be consuming concurrently.
+    //------------------------------------------------------------------------
+    inline uint64_t size()     const { return ( impl_ != NULL ) ? impl_->size() : 0 ; }
+    inline uint64_t capacity() const { return ( impl_ != NULL ) ? impl_->capacity() : T_Capacity ; }
+
+    //------------------------------------------------------------------------
+    // Messages written since the queue was created.
+    //------------------------------------------------------------------------
+    inline uint64_t write_count() const { return w_pos_ ; }
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    is_reader_attached() const
+    { return impl_ != NULL && impl_->reader_pid_.load( std::memory_order_acquire ) != 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    // Bytes occupied by a queue segment of 'capacity' messages.
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    segment_size( uint64_t capacity = T_Capacity )
+    { return sizeof( header_t ) + impl_t::segment_bytes( capacity ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline bool    is_open()    const { return impl_ != NULL ; }
+    inline int32_t last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    inline const T_Telemetry & telemetry() const { return telemetry_ ; }
+
+    //------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  ShmQueueWriter()
+    : error_  ( 0 )
+    , header_ ( NULL )
+    , impl_   ( NULL )
+    , w_pos_  ( 0 )
+    , r_cache_( 0 )
+  {}
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  ~ShmQueueWriter()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  void
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  close()
+  {
+    if( header_ != NULL )
+      header_->on_writer_close() ;
+
+    telemetry_.close() ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    error_   = 0 ;
+    header_  = NULL ;
+    impl_    = NULL ;
+    w_pos_   = 0 ;
+    r_cache_ = 0 ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  bool
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  open( const std::string & shm_q_name, uint64_t capacity, uint32_t options )
+  {
+    close() ;
+    if( capacity == 0 || ( T_Capacity > 0 && capacity != T_Capacity ) )
+    { error_ = EINVAL ;
+      return false ;
+    }
+
+    uint32_t access_flags = ipc::access::Read_Write
+                          | ipc::access::Create
+                          | ipc::access::Exclusive
+                          | options
+                          ;
+
+    if( !shm_.open( shm_q_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( !shm_.resize( segment_size( capacity ) ) )
+    { error_ = shm_.last_error() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    // As w/ the swmr queues, the header is only marked initialized once the
+    // ring has been constructed.
+    header_ = shm_map_.construct_at<header_t>( 0 ) ;
+    impl_   = shm_map_.construct_at<impl_t>( sizeof( header_t ), capacity ) ;
+    if( header_ == NULL || impl_ == NULL )
+    { header_ = NULL ;
+      impl_   = NULL ;
+      error_  = EINVAL ;
+      shm_map_.close() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    const char * w_pos = reinterpret_cast<const char *>( &impl_->w_pos_ ) ;
+    header_->publish( swmr::queue_kind::Spsc
+                    , sizeof( T )
+                    , capacity
+                    , swmr::TypeHash<T>::value()
+                    , segment_size( capacity )
+                    , w_pos - reinterpret_cast<const char *>( header_ )
+                    ) ;
+
+    // Telemetry is best effort, and never fails the queue.
+    telemetry_.create( shm_q_name, capacity ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  template<typename... T_Args>
+  bool
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  emplace( T_Args &&... args )
+  {
+    if( fps_unlikely( impl_ == NULL ) )
+      return false ;
+
+    if( fps_unlikely( writable( 1 ) == 0 ) )
+    { telemetry_.on_full() ;
+      return false ;
+    }
+
+    new ( impl_->slot( w_pos_ ) ) T( std::forward<T_Args>( args )... ) ;
+    telemetry_.on_write( w_pos_, w_pos_ + 1, w_pos_ + 1 - r_cache_ ) ;
+    impl_->w_pos_.store( ++w_pos_, std::memory_order_release ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  uint32_t
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  write_batch( const T * src, uint32_t count )
+  {
+    if( fps_unlikely( impl_ == NULL ) )
+      return 0 ;
+
+    uint64_t avail = writable( count ) ;
+    if( count > avail )
+    { telemetry_.on_full() ;
+      count = avail ;
+    }
+
+    for( uint32_t idx = 0 ; idx < count ; ++idx )
+      new ( impl_->slot( w_pos_ + idx ) ) T( src[ idx ] ) ;
+
+    if( count > 0 )
+    { telemetry_.on_write( w_pos_, w_pos_ + count, w_pos_ + count - r_cache_ ) ;
+      w_pos_ += count ;
+      impl_->w_pos_.store( w_pos_, std::memory_order_release ) ;
+    }
+    return count ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  T *
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  claim()
+  {
+    if( fps_unlikely( impl_ == NULL ) )
+      return NULL ;
+
+    if( fps_unlikely( writable( 1 ) == 0 ) )
+    { telemetry_.on_full() ;
+      return NULL ;
+    }
+    return impl_->slot( w_pos_ ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry>
+  void
+  ShmQueueWriter<T,T_Capacity,T_Telemetry>::
+  commit()
+  {
+    telemetry_.on_write( w_pos_, w_pos_ + 1, w_pos_ + 1 - r_cache_ ) ;
+    impl_->w_pos_.store( ++w_pos_, std::memory_order_release ) ;
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef FPS__IPC__SPSC_SHM_RING__H
+#define FPS__IPC__SPSC_SHM_RING__H
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <signal.h>
+#include <unistd.h>
+#include "fps_system/fps_system.h"
+
+namespace fps    {
+namespace ipc    {
+namespace spsc   {
+namespace detail {
+
+  //--------------------------------------------------------------------------
+  // Shared state of a lossless single-writer/single-reader shm queue.  Lives
+  // in the segment right after the swmr::detail::QueueHeader, and is
+  // followed directly by the element slots.
+  //
+  // Positions are free running 64-bit counters : the writer owns w_pos_ and
+  // the reader owns r_pos_, each on its own cache line.  Storage is a power
+  // of two so positions map to slots w/ a mask.  When T_Capacity is
+  // non-zero the capacity and mask are compile-time constants; otherwise
+  // they're chosen when the queue is created and read from capacity_/mask_.
+  //
+  // Holds no pointers : the slots are found relative to 'this'.
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity>
+  struct ShmRing
+  {
+    //------------------------------------------------------------------------
+    static const std::size_t Alignment       = system::cpu::Cache_Line_Size ;
+    static const uint64_t    Static_Capacity = T_Capacity ;
+
+    //------------------------------------------------------------------------
+    static
+    inline
+    constexpr
+    uint64_t
+    storage_size( uint64_t capacity )
+    { return ( capacity <= 1 ) ? 1 : ( 1ull << ( 64 - __builtin_clzll( capacity - 1 ) ) ) ;
+    }
+
+    static const uint64_t Static_Mask = ( T_Capacity > 0 ) ? storage_size( T_Capacity ) - 1 : 0 ;
+
+    //------------------------------------------------------------------------
+    uint64_t              capacity_   alignas( Alignment ) ;  // Max queued elements.
+    uint64_t              mask_       ;                       // Storage size - 1.
+    std::atomic<int32_t>  reader_pid_ ;                       // Attached reader, or zero.
+
+    std::atomic<uint64_t> w_pos_      alignas( Alignment ) ;  // Next position to write.
+    std::atomic<uint64_t> r_pos_      alignas( Alignment ) ;  // Next position to read.
+
+    //------------------------------------------------------------------------
+    inline
+    explicit
+    ShmRing( uint64_t capacity )
+      : capacity_  ( capacity )
+      , mask_      ( storage_size( capacity ) - 1 )
+      , reader_pid_( 0 )
+      , w_pos_     ( 0 )
+      , r_pos_     ( 0 )
+    {}
+
+    //------------------------------------------------------------------------
+    // Bytes needed for the ring and its slots.
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    segment_bytes( uint64_t capacity )
+    { return sizeof( ShmRing ) + storage_size( capacity ) * sizeof( T ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline uint64_t capacity() const { return ( T_Capacity > 0 ) ? Static_Capacity : capacity_ ; }
+    inline uint64_t mask()     const { return ( T_Capacity > 0 ) ? Static_Mask     : mask_ ; }
+
+    //------------------------------------------------------------------------
+    inline
+    T *
+    slot( uint64_t pos )
+    { return reinterpret_cast<T *>( this + 1 ) + ( pos & mask() ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Approximate when called concurrently w/ the writer or reader.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    size() const
+    { uint64_t r_pos = r_pos_.load( std::memory_order_acquire ) ;
+      return w_pos_.load( std::memory_order_acquire ) - r_pos ;
+    }
+
+    //------------------------------------------------------------------------
+    // Claim the reader role for the calling process.  Fails w/ EBUSY if a
+    // live process ( this one included ) holds it; a dead reader's claim is 
+    // taken over.
+    //------------------------------------------------------------------------
+    inline
+    int32_t
+    attach_reader()
+    {
+      int32_t self = ::getpid() ;
+      for( ;; )
+      { int32_t pid = reader_pid_.load( std::memory_order_acquire ) ;
+        if( pid != 0 && ( pid == self || ::kill( pid, 0 ) == 0 || errno == EPERM ) )
+          return EBUSY ;
+        if( reader_pid_.compare_exchange_strong( pid, self, std::memory_order_acq_rel ) )
+          return 0 ;
+      }
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    detach_reader()
+    { int32_t self = ::getpid() ;
+      reader_pid_.compare_exchange_strong( self, 0, std::memory_order_release ) ;
+    }
+  } ;
+
+}}}}
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef FPS__IPC__SWMR_BYTE_RING__H
+#define FPS__IPC__SWMR_BYTE_RING__H
+
+#include "fps_system/fps_system.h"       // For cache line size
+#include "fps_util/fps_util.h"           // For fps_likely/unlikely
+#include "fps_container/byte_queue.h"    // For container::ByteRange
+#include "fps_ipc/swmr_ring_buffer.h"    // For swmr::read_status
+#include <atomic>
+#include <cstring>
+
+//
+// Single-Writer/Multiple-Reader lossy ring of variable length records.
+//
+// The ring is a power-of-two sized byte array that lives directly after the
+// ByteRing header in a shared memory segment.  Positions are 64-bit byte
+// offsets that increase monotonically; a position maps to 'pos & mask' in the
+// array.  Each record is a RecordHeader ( length, type, sequence number )
+// followed by its payload, padded to Record_Alignment bytes.  Records never
+// straddle the end of the array - when one doesn't fit, the writer fills the
+// remainder w/ a padding record and wraps to offset zero - so readers always
+// see a record's payload as one contiguous container::ByteRange.
+//
+// Records can't have a sequence lock at a fixed address because later records
+// overwrite them at arbitrary offsets.  Instead the writer's two cursors form a
+// sequence lock keyed on byte position : w_intent_ is advanced before a record
+// is written and w_pos_ after it is published.  A record that starts at 'pos'
+// is intact as long as w_intent_ <= pos + capacity.
+//
+
+namespace fps {
+namespace ipc {
+namespace swmr {
+namespace detail {
+
+  //-----------------------------------------------------------------------------------
+  struct RecordHeader
+  {
+    static const uint32_t Data    = 0 ;
+    static const uint32_t Padding = 1 ;
+
+    uint32_t length_ ;  // Payload length in bytes ( excluding this header ).
+    uint32_t type_   ;  // Data or Padding
+    uint64_t seq_    ;  // Record sequence number, starting at 1 ( 0 for padding ).
+  } ;
+
+  //-----------------------------------------------------------------------------------
+  // Reader-side description of a record, populated by ByteRing::read().
+  //-----------------------------------------------------------------------------------
+  struct Record
+  {
+    uint64_t             pos_   ;  // Position of the record header.
+    uint64_t             end_   ;  // Position of the following record.
+    uint64_t             seq_   ;  // Record sequence number.
+    container::ByteRange bytes_ ;  // Payload, pointing into the shared segment.
+  } ;
+
+  //-----------------------------------------------------------------------------------
+  class ByteRing
+  {
+  public :
+    //---------------------------------------------------------------------------------
+    static const uint32_t Record_Alignment = sizeof( RecordHeader ) ;
+    static const uint32_t Minimum_Capacity = 4096 ;
+
+    //---------------------------------------------------------------------------------
+    // Number of bytes needed for the header plus a ring of 'capacity' bytes.
+    //---------------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    segment_size( uint32_t capacity )
+    { return sizeof( ByteRing ) + capacity ;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Ring capacities must be powers of two no smaller than Minimum_Capacity.
+    //---------------------------------------------------------------------------------
+    static
+    inline
+    bool
+    valid_capacity( uint32_t capacity )
+    { return capacity >= Minimum_Capacity && ( capacity & ( capacity - 1 ) ) == 0 ;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Space consumed in the ring by a record w/ the indicated payload length.
+    //---------------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    record_size( uint32_t length )
+    { return ( static_cast<uint64_t>( sizeof( RecordHeader ) ) + length + ( Record_Alignment - 1 ) )
+             & ~static_cast<uint64_t>( Record_Alignment - 1 ) ;
+    }
+
+  private :
+    //---------------------------------------------------------------------------------
+    typedef std::atomic<uint64_t> atomic_pos_t ;
+
+    //---------------------------------------------------------------------------------
+    // Read-only after construction.
+    //---------------------------------------------------------------------------------
+    uint64_t     capacity_ alignas( system::cpu::Cache_Line_Size ) ;
+    uint64_t     mask_   ;
+    uint64_t     max_length_ ;
+
+    //---------------------------------------------------------------------------------
+    // Published by the writer.
+    //---------------------------------------------------------------------------------
+    atomic_pos_t w_intent_ alignas( system::cpu::Cache_Line_Size ) ;  // End of the record being written.
+    atomic_pos_t w_pos_  ;   // End of the last published record.
+    atomic_pos_t w_last_ ;   // Start of the last published record.
+    atomic_pos_t w_seq_  ;   // Sequence number of the last published record.
+
+    //---------------------------------------------------------------------------------
+    // Writer private state for claim()/commit().
+    //---------------------------------------------------------------------------------
+    uint64_t     c_pos_ alignas( system::cpu::Cache_Line_Size ) ;
+    uint64_t     c_end_ ;
+    uint64_t     c_seq_ ;
+
+    //---------------------------------------------------------------------------------
+    ByteRing( const ByteRing & ) = delete ;
+    ByteRing & operator=( const ByteRing & ) = delete ;
+
+    //---------------------------------------------------------------------------------
+    inline       char * data()       { return reinterpret_cast<char *>( this ) + sizeof( ByteRing ) ; }
+    inline const char * data() const { return reinterpret_cast<const char *>( this ) + sizeof( ByteRing ) ; }
+
+    //---------------------------------------------------------------------------------
+    inline
+    RecordHeader *
+    header_at( uint64_t pos )
+    { return reinterpret_cast<RecordHeader *>( data() + ( pos & mask_ ) ) ;
+    }
+
+  public :
+    //---------------------------------------------------------------------------------
+    // Note: 'capacity' must satisfy valid_capacity(), and the segment this is
+    //       constructed in must provide segment_size( capacity ) bytes.
+    //---------------------------------------------------------------------------------
+    inline explicit ByteRing( uint32_t capacity ) ;
+
+    //---------------------------------------------------------------------------------
+    inline uint64_t capacity()   const { return capacity_ ; }
+    inline uint32_t max_length() const { return static_cast<uint32_t>( max_length_ ) ; }
+
+    //---------------------------------------------------------------------------------
+    // Copy a record into the ring and publish it.  Returns false if 'length'
+    // exceeds max_length().
+    //---------------------------------------------------------------------------------
+    inline bool write( const char * src, uint32_t length ) ;
+
+    //---------------------------------------------------------------------------------
+    // Zero copy write.  claim() reserves space for a record of 'length' bytes and
+    // returns a pointer to its payload ( NULL if 'length' exceeds max_length() ).
+    // commit() publishes it.  Every claim() must be followed by one commit().
+    //---------------------------------------------------------------------------------
+    inline char * claim( uint32_t length ) ;
+    inline void   commit() ;
+
+    //---------------------------------------------------------------------------------
+    // Locate the first data record at or after position 'r_pos'.  Returns a
+    // read_status value, and on success populates 'rec'.  The payload in
+    // 'rec.bytes_' is only guaranteed to be intact while intact( rec.pos_ )
+    // continues to return true.
+    //---------------------------------------------------------------------------------
+    inline int32_t read( uint64_t r_pos, Record & rec ) const ;
+
+    //---------------------------------------------------------------------------------
+    // Return true if the record starting at position 'pos' hasn't been
+    // ( and isn't being ) overwritten.
+    //---------------------------------------------------------------------------------
+    inline
+    bool
+    intact( uint64_t pos ) const
+    { std::atomic_thread_fence( std::memory_order_acquire ) ;
+      return w_intent_.load( std::memory_order_relaxed ) <= ( pos + capacity_ ) ;
+    }
+
+    //---------------------------------------------------------------------------------
+    inline uint64_t write_position() const { return w_pos_.load( std::memory_order_acquire ) ; }
+    inline uint64_t last_position()  const { return w_last_.load( std::memory_order_acquire ) ; }
+    inline uint64_t write_sequence() const { return w_seq_.load( std::memory_order_acquire ) ; }
+
+    //---------------------------------------------------------------------------------
+    // The write sequence counter itself ( see QueueHeader ).
+    //---------------------------------------------------------------------------------
+    inline const atomic_pos_t & write_sequence_counter() const { return w_seq_ ; }
+  } ;
+
+  //-----------------------------------------------------------------------------------
+  ByteRing::
+  ByteRing( uint32_t capacity )
+    : capacity_  ( capacity )
+    , mask_      ( capacity - 1 )
+    , max_length_( ( capacity / 2 ) - sizeof( RecordHeader ) )
+    , w_intent_  ( 0 )
+    , w_pos_     ( 0 )
+    , w_last_    ( 0 )
+    , w_seq_     ( 0 )
+    , c_pos_     ( 0 )
+    , c_end_     ( 0 )
+    , c_seq_     ( 0 )
+  {
+  }
+
+  //-----------------------------------------------------------------------------------
+  char *
+  ByteRing::
+  claim( uint32_t length )
+  {
+    if( fps_unlikely( length > max_length_ ) )
+      return NULL ;
+
+    uint64_t pos      = w_pos_.load( std::memory_order_relaxed ) ;
+    uint64_t rec_size = record_size( length ) ;
+    uint64_t to_end   = capacity_ - ( pos & mask_ ) ;
+    uint64_t pad_size = ( rec_size > to_end ) ? to_end : 0 ;
+
+    c_pos_ = pos + pad_size ;
+    c_end_ = c_pos_ + rec_size ;
+    c_seq_ = w_seq_.load( std::memory_order_relaxed ) + 1 ;
+
+    // Sequence lock 'write_begin' : announce the range about to be overwritten
+    // before touching it.
+    w_intent_.store( c_end_, std::memory_order_relaxed ) ;
+    std::atomic_thread_fence( std::memory_order_release ) ;
+
+    if( pad_size > 0 )
+    { RecordHeader * pad = header_at( pos ) ;
+      pad->length_ = static_cast<uint32_t>( pad_size - sizeof( RecordHeader ) ) ;
+      pad->type_   = RecordHeader::Padding ;
+      pad->seq_    = 0 ;
+    }
+
+    RecordHeader * hdr = header_at( c_pos_ ) ;
+    hdr->length_ = length ;
+    hdr->type_   = RecordHeader::Data ;
+    hdr->seq_    = c_seq_ ;
+    return reinterpret_cast<char *>( hdr + 1 ) ;
+  }
+
+  //-----------------------------------------------------------------------------------
+  void
+  ByteRing::
+  commit()
+  {
+    // Sequence lock 'write_end'
+    w_last_.store( c_pos_, std::memory_order_relaxed ) ;
+    w_seq_.store ( c_seq_, std::memory_order_relaxed ) ;
+    w_pos_.store ( c_end_, std::memory_order_release ) ;
+  }
+
+  //-----------------------------------------------------------------------------------
+  bool
+  ByteRing::
+  write( const char * src, uint32_t length )
+  {
+    char * dest = claim( length ) ;
+    if( fps_unlikely( dest == NULL ) )
+      return false ;
+
+    std::memcpy( dest, src, length ) ;
+    commit() ;
+    return true ;
+  }
+
+  //-----------------------------------------------------------------------------------
+  int32_t
+  ByteRing::
+  read( uint64_t r_pos, Record & rec ) const
+  {
+    uint64_t w_pos = w_pos_.load( std::memory_order_acquire ) ;
+    for( ;; )
+    {
+      if( r_pos == w_pos )
+        return read_status::Empty ;
+
+      if( fps_unlikely( r_pos > w_pos || ( w_pos - r_pos ) > capacity_ ) )
+        return read_status::Overrun ;
+
+      uint64_t             offset = r_pos & mask_ ;
+      const RecordHeader * hdr    = reinterpret_cast<const RecordHeader *>( data() + offset ) ;
+      uint32_t             length = hdr->length_ ;
+      uint32_t             type   = hdr->type_ ;
+      uint64_t             seq    = hdr->seq_ ;
+      uint64_t             size   = record_size( length ) ;
+
+      // Validate the header against the writer's intent before trusting any of it.
+      if( !intact( r_pos ) || ( offset + size ) > capacity_ )
+        return read_status::Overrun ;
+
+      if( type == RecordHeader::Padding )
+      { r_pos += size ;
+        continue ;
+      }
+
+      rec.pos_ = r_pos ;
+      rec.end_ = r_pos + size ;
+      rec.seq_ = seq ;
+      rec.bytes_.assign( reinterpret_cast<const char *>( hdr + 1 ), length ) ;
+      return read_status::Success ;
+    }
+  }
+
+}}}}
+
+#endif
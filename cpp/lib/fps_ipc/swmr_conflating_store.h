@@ -0,0 +1,352 @@
+#ifndef FPS__IPC__SWMR_CONFLATING_STORE__H
+#define FPS__IPC__SWMR_CONFLATING_STORE__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include "fps_util/fps_util.h"      // For fps_likely/unlikely
+#include "fps_ipc/swmr_sequence_lock.h"
+#include <type_traits>
+#include <atomic>
+#include <new>
+
+//
+// Single-Writer/Multiple-Reader conflating store : the latest value for each
+// of T_Keys keys, for data such as top-of-book where intermediate updates are
+// worthless once superseded.
+//
+// Every update is stamped w/ a 64-bit, monotonically increasing sequence
+// number ( the first has sequence number 1 ).  The writer stores the value
+// and its sequence number in the key's slot under the slot's SequenceLock,
+// then appends the key to the dirty ring at index 'seq % T_Dirty_Capacity' and
+// publishes 'seq'.  A reader that has seen updates up to 'r_seq' catches up
+// by walking the dirty ring from r_seq + 1 and reading only the keys listed
+// there.  A key updated several times since the reader's last visit appears
+// several times in the ring, but is delivered once : an entry is skipped
+// when the slot already holds a newer update, since that update's own entry
+// comes later.
+//
+// A reader that has fallen T_Dirty_Capacity or more updates behind ( or more
+// than T_Keys, when a full pass is cheaper ) scans every slot instead,
+// delivering those stamped after r_seq.  Either way a reader's work is bounded
+// by the number of keys, no matter how far behind it is.  A resync may deliver
+// a key twice, never zero times.
+//
+
+namespace fps    {
+namespace ipc    {
+namespace swmr   {
+namespace detail {
+
+  //-----------------------------------------------------------------------------------
+  template<typename T>
+  class KeySlot
+  {
+  private :
+    //---------------------------------------------------------------------------------
+    swmr::SequenceLock lock_ ;
+    uint64_t           seq_  ;   // Sequence number of the update in data_ ( 0 if never written ).
+    T                  data_ ;
+
+  public :
+    //---------------------------------------------------------------------------------
+    inline KeySlot() : seq_( 0 ) {}
+
+    //---------------------------------------------------------------------------------
+    // Copy out a consistent value and its sequence number, retrying while the
+    // writer is mid update.  Returns the sequence number ( 0 if never written ).
+    //---------------------------------------------------------------------------------
+    inline
+    uint64_t
+    read( T & dest ) const
+    {
+      for( ;; )
+      { uint64_t begin_state = lock_.read_begin() ;
+        uint64_t seq         = seq_ ;
+        dest = data_ ;
+        if( lock_.read_end( begin_state ) )
+          return seq ;
+      }
+    }
+
+    //---------------------------------------------------------------------------------
+    // Sequence number of the slot's current value.  May be stale by the time
+    // it returns.
+    //---------------------------------------------------------------------------------
+    inline
+    uint64_t
+    sequence() const
+    {
+      for( ;; )
+      { uint64_t begin_state = lock_.read_begin() ;
+        uint64_t seq         = seq_ ;
+        if( lock_.read_end( begin_state ) )
+          return seq ;
+      }
+    }
+
+    //---------------------------------------------------------------------------------
+    inline
+    void
+    write( const T & value, uint64_t seq )
+    {
+      lock_.write_begin() ;
+      data_ = value ;
+      seq_  = seq ;
+      lock_.write_end() ;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Two phase, in place update.  claim() opens the sequence lock and returns
+    // the slot's current value for modification, commit() stamps the new
+    // sequence number and closes the lock.
+    //---------------------------------------------------------------------------------
+    inline T & claim() { lock_.write_begin() ; return data_ ; }
+
+    //---------------------------------------------------------------------------------
+    inline
+    void
+    commit( uint64_t seq )
+    { seq_ = seq ;
+      lock_.write_end() ;
+    }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  class ConflatingStore
+  {
+  public :
+    static const uint32_t Keys           = T_Keys ;
+    static const uint32_t Dirty_Capacity = T_Dirty_Capacity ;
+    typedef KeySlot<T> slot_t ;
+
+    static_assert( T_Keys > 0, "swmr::ConflatingStore requires at least one key" ) ;
+    static_assert( T_Dirty_Capacity > 0 && ( T_Dirty_Capacity & ( T_Dirty_Capacity - 1 ) ) == 0
+                 , "swmr::ConflatingStore dirty ring capacity must be a power of two"
+                 ) ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef
+    typename
+    std::aligned_storage<sizeof(slot_t) * Keys, alignof(slot_t)>::type
+    storage_t ;
+
+    //------------------------------------------------------------------------
+    typedef std::atomic<uint32_t> atomic_key_t ;
+    typedef std::atomic<uint64_t> atomic_seq_t ;
+
+    //------------------------------------------------------------------------
+    atomic_seq_t w_seq_ alignas( system::cpu::Cache_Line_Size ) ;
+    atomic_key_t dirty_[ Dirty_Capacity ] alignas( system::cpu::Cache_Line_Size ) ;
+    storage_t    storage_ alignas( system::cpu::Cache_Line_Size ) ;
+
+    //------------------------------------------------------------------------
+    ConflatingStore( const ConflatingStore & ) = delete ;
+    ConflatingStore & operator=( const ConflatingStore & ) = delete ;
+
+    //------------------------------------------------------------------------
+    inline       slot_t * data()       { return reinterpret_cast<slot_t *>( &storage_ ) ; }
+    inline const slot_t * data() const { return reinterpret_cast<const slot_t *>( &storage_ ) ; }
+
+    //------------------------------------------------------------------------
+    // Stamp the update of 'key' w/ the next sequence number and publish it.
+    //------------------------------------------------------------------------
+    inline
+    void
+    publish( uint32_t key, uint64_t seq )
+    { append( key, seq ) ;
+      advance( seq ) ;
+    }
+
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    uint32_t scan( uint64_t r_seq, T_Visitor & visitor ) const ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline ConflatingStore() ;
+
+    //------------------------------------------------------------------------
+    // Writer only.  'key' must be less than Keys.
+    //------------------------------------------------------------------------
+    inline
+    void
+    write( uint32_t key, const T & value )
+    { uint64_t seq = w_seq_.load( std::memory_order_relaxed ) + 1 ;
+      data()[ key ].write( value, seq ) ;
+      publish( key, seq ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Writer only.  In place update of 'key' : claim() returns the current
+    // value for modification, commit() publishes it.  Every claim() must be
+    // followed by exactly one commit() of the same key before the next
+    // update, and readers of the key spin in between.
+    //------------------------------------------------------------------------
+    inline T & claim( uint32_t key ) { return data()[ key ].claim() ; }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    commit( uint32_t key )
+    { uint64_t seq = w_seq_.load( std::memory_order_relaxed ) + 1 ;
+      data()[ key ].commit( seq ) ;
+      publish( key, seq ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Copy the latest value of 'key' into 'dest'.  Returns its sequence
+    // number, or zero if 'key' has never been written.
+    //------------------------------------------------------------------------
+    inline uint64_t read( uint32_t key, T & dest ) const { return data()[ key ].read( dest ) ; }
+
+    //------------------------------------------------------------------------
+    // Writer only.  Publishing update 'seq' of 'key' takes two steps : append
+    // the key to the dirty ring, then advance the write sequence.  write()
+    // and commit() do both.
+    //
+    // The entry is stored w/ release so that a reader who finds it ( i.e.
+    // finds an older entry overwritten ) also sees every write sequence that
+    // preceded it; see poll().
+    //------------------------------------------------------------------------
+    inline
+    void
+    append( uint32_t key, uint64_t seq )
+    { dirty_[ seq & ( Dirty_Capacity - 1 ) ].store( key, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    void
+    advance( uint64_t seq )
+    { w_seq_.store( seq, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Invoke 'visitor( key, const T & )' once for each key updated after
+    // 'r_seq', w/ its latest value, and advance 'r_seq' to the last update
+    // accounted for.  Returns the number of keys visited.  'resynced' is set
+    // if the dirty ring couldn't be used and every slot was scanned.
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    inline
+    uint32_t
+    poll( uint64_t & r_seq, T_Visitor && visitor, bool & resynced ) const
+    { return poll( r_seq, write_sequence(), visitor, resynced ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // As above, but accounts only for updates up to 'w_seq', a write sequence
+    // previously returned by write_sequence().
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    uint32_t poll( uint64_t & r_seq, uint64_t w_seq, T_Visitor && visitor, bool & resynced ) const ;
+
+    //------------------------------------------------------------------------
+    // Number of updates published so far ( sequence number of the newest ).
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    write_sequence() const
+    { return w_seq_.load( std::memory_order_acquire ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // The write sequence counter itself, for the queue header ( see
+    // QueueHeader ).
+    //------------------------------------------------------------------------
+    inline const atomic_seq_t & write_sequence_counter() const { return w_seq_ ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  ConflatingStore<T,T_Keys,T_Dirty_Capacity>::
+  ConflatingStore()
+  {
+    w_seq_.store( 0, std::memory_order_relaxed ) ;
+    for( uint32_t idx = 0 ; idx < Dirty_Capacity ; ++idx )
+      dirty_[ idx ].store( 0, std::memory_order_relaxed ) ;
+    for( uint32_t idx = 0 ; idx < Keys ; ++idx )
+      new ( data() + idx ) slot_t() ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  template<typename T_Visitor>
+  uint32_t
+  ConflatingStore<T,T_Keys,T_Dirty_Capacity>::
+  scan( uint64_t r_seq, T_Visitor & visitor ) const
+  {
+    // Values newer than w_seq are delivered too, and may be delivered again
+    // by the next poll.
+    T        value ;
+    uint32_t count = 0 ;
+    for( uint32_t key = 0 ; key < Keys ; ++key )
+    { if( data()[ key ].sequence() <= r_seq )
+        continue ;
+
+      uint64_t seq = data()[ key ].read( value ) ;
+      if( seq > r_seq )
+      { visitor( key, static_cast<const T &>( value ) ) ;
+        ++count ;
+      }
+    }
+    return count ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  template<typename T_Visitor>
+  uint32_t
+  ConflatingStore<T,T_Keys,T_Dirty_Capacity>::
+  poll( uint64_t & r_seq, uint64_t w_seq, T_Visitor && visitor, bool & resynced ) const
+  {
+    resynced = false ;
+
+    if( w_seq <= r_seq )
+      return 0 ;
+
+    uint64_t backlog = w_seq - r_seq ;
+    if( fps_unlikely( backlog >= Dirty_Capacity || backlog > Keys ) )
+    { resynced = true ;
+      uint32_t count = scan( r_seq, visitor ) ;
+      r_seq = w_seq ;
+      return count ;
+    }
+
+    // An entry is only trusted if the key's slot still holds that very
+    // update, so an entry the writer has since reused names a slot w/ a
+    // newer sequence number and is skipped.
+    T        value ;
+    uint32_t count = 0 ;
+    for( uint64_t seq = r_seq + 1 ; seq <= w_seq ; ++seq )
+    { uint32_t key = dirty_[ seq & ( Dirty_Capacity - 1 ) ].load( std::memory_order_relaxed ) ;
+      if( fps_unlikely( key >= Keys ) )
+        continue ;
+
+      if( data()[ key ].read( value ) == seq )
+      { visitor( key, static_cast<const T &>( value ) ) ;
+        ++count ;
+      }
+    }
+
+    // The skipped entry's own update is lost from the ring though, so if the
+    // writer lapped us while we walked it, rescan to pick it up.  Entries are
+    // appended before the write sequence advances, so the entry for r_seq + 1
+    // may already be overwritten while the write sequence still reads
+    // r_seq + Dirty_Capacity.  Entries are stored w/ release, so once we've
+    // read an overwritten one the fence guarantees the load below sees at
+    // least that.
+    std::atomic_thread_fence( std::memory_order_acquire ) ;
+    if( fps_unlikely( w_seq_.load( std::memory_order_relaxed ) - r_seq >= Dirty_Capacity ) )
+    { resynced = true ;
+      count += scan( r_seq, visitor ) ;
+    }
+
+    r_seq = w_seq ;
+    return count ;
+  }
+
+}}}}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef FPS__IPC__SWMR_QUEUE_HEADER__H
+#define FPS__IPC__SWMR_QUEUE_HEADER__H
+
+#include "fps_system/fps_system.h"  // For cache line size
+#include <atomic>
+#include <typeinfo>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+
+//
+// Every swmr shared memory queue segment starts w/ a QueueHeader, followed by
+// the queue implementation at offset sizeof( QueueHeader ) ( one cache line ).
+// The lossless spsc shm queues ( spsc_shm_queue.h ) use the same header.
+//
+// The writer fills in the header, constructs the queue, and only then sets
+// the initialized flag ( w/ release ordering ).  Readers check the flag ( w/
+// acquire ordering ) before anything else, so a reader that attaches while
+// the writer is still setting up sees EAGAIN rather than a partially built
+// queue.  Everything else a reader needs to know - that the segment is a
+// queue, built w/ the same layout version, for the same element type and
+// capacity - is checked against the header in constant time.
+//
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  namespace queue_kind
+  {
+    enum Enum
+    { Fixed      = 1   // ShmQueueWriter/ShmQueueReader - fixed size elements.
+    , Bytes      = 2   // ShmByteQueueWriter/ShmByteQueueReader - variable length records.
+    , Spsc       = 3   // spsc::ShmQueueWriter/ShmQueueReader - lossless, fixed size elements.
+    , Conflating = 4   // ShmConflatingStoreWriter/ShmConflatingStoreReader - latest value per key.
+    } ;
+
+    //------------------------------------------------------------------------
+    inline
+    const char *
+    to_string( uint32_t kind )
+    { switch( kind )
+      { case Fixed      : return "fixed" ;
+        case Bytes      : return "bytes" ;
+        case Spsc       : return "spsc" ;
+        case Conflating : return "conflating" ;
+      }
+      return "unknown" ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Identifies the element type of a queue across processes.  The default
+  // hashes the ( mangled ) type name, which is stable for a given compiler
+  // ABI.  Specialize this to pin a type's identity explicitly.
+  //--------------------------------------------------------------------------
+  template<typename T>
+  struct TypeHash
+  {
+    static
+    inline
+    uint64_t
+    value()
+    { // 64-bit FNV-1a
+      uint64_t rv = 14695981039346656037ull ;
+      for( const char * ptr = typeid( T ).name() ; *ptr ; ++ptr )
+      { rv ^= static_cast<uint8_t>( *ptr ) ;
+        rv *= 1099511628211ull ;
+      }
+      return rv ;
+    }
+  } ;
+
+namespace detail {
+
+  //--------------------------------------------------------------------------
+  struct alignas( system::cpu::Cache_Line_Size ) QueueHeader
+  {
+    //------------------------------------------------------------------------
+    static const uint64_t Magic   = 0x5146534d57535046ull ;  // "FPSWMSFQ"
+    static const uint32_t Version = 1 ;
+
+    //------------------------------------------------------------------------
+    uint64_t              magic_        ;
+    uint32_t              version_      ;
+    uint32_t              kind_         ;  // A queue_kind value.
+    uint64_t              element_size_ ;  // sizeof( T ), or zero for byte queues.
+    uint64_t              capacity_     ;  // Elements, bytes for byte queues, or keys for conflating stores.
+    uint64_t              type_hash_    ;  // TypeHash<T>::value(), or zero for byte queues.
+    uint64_t              segment_size_ ;  // Bytes required by header + queue.
+    uint64_t              w_seq_offset_ ;  // Offset of the queue's write sequence counter.
+    int32_t               writer_pid_   ;  // Zero once the writer has closed the queue.
+    std::atomic<uint32_t> initialized_  ;
+
+    //------------------------------------------------------------------------
+    inline
+    QueueHeader()
+      : magic_       ( 0 )
+      , version_     ( 0 )
+      , kind_        ( 0 )
+      , element_size_( 0 )
+      , capacity_    ( 0 )
+      , type_hash_   ( 0 )
+      , segment_size_( 0 )
+      , w_seq_offset_( 0 )
+      , writer_pid_  ( 0 )
+      , initialized_ ( 0 )
+    {}
+
+    //------------------------------------------------------------------------
+    // Writer only.  Fill in the header and mark the queue initialized.  Must be
+    // called after the queue itself has been constructed.
+    //------------------------------------------------------------------------
+    inline
+    void
+    publish( uint32_t kind
+           , uint64_t element_size
+           , uint64_t capacity
+           , uint64_t type_hash
+           , uint64_t segment_size
+           , uint64_t w_seq_offset
+           )
+    { magic_        = Magic ;
+      version_      = Version ;
+      kind_         = kind ;
+      element_size_ = element_size ;
+      capacity_     = capacity ;
+      type_hash_    = type_hash ;
+      segment_size_ = segment_size ;
+      w_seq_offset_ = w_seq_offset ;
+      writer_pid_   = ::getpid() ;
+      initialized_.store( 1, std::memory_order_release ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Writer only.  Note that the writer has gone away.
+    //------------------------------------------------------------------------
+    inline void on_writer_close() { writer_pid_ = 0 ; }
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    is_initialized() const
+    { return initialized_.load( std::memory_order_acquire ) == 1 ;
+    }
+
+    //------------------------------------------------------------------------
+    // Return true if the segment holds an initialized queue w/ a layout this
+    // build understands.
+    //------------------------------------------------------------------------
+    inline
+    bool
+    is_queue() const
+    { return is_initialized() && magic_ == Magic && version_ == Version ;
+    }
+
+    //------------------------------------------------------------------------
+    // Validate a mapping of 'mapped_size' bytes against what the reader
+    // expects.  A zero 'capacity' matches any capacity.  Returns zero on
+    // success, otherwise :
+    //   EAGAIN - the writer hasn't finished initializing the queue ( retry ).
+    //   EPROTO - not a queue, or built w/ a different layout version.
+    //   EINVAL - a queue of a different kind, element type or capacity, or
+    //            the segment is truncated.
+    //------------------------------------------------------------------------
+    inline
+    int32_t
+    validate( uint32_t kind
+            , uint64_t element_size
+            , uint64_t capacity
+            , uint64_t type_hash
+            , uint64_t mapped_size
+            ) const
+    {
+      // A fresh segment is zero filled, so until the flag is set the magic
+      // number is either zero or ( briefly ) already in place.
+      if( !is_initialized() )
+        return ( magic_ == 0 || magic_ == Magic ) ? EAGAIN : EPROTO ;
+
+      if( magic_ != Magic || version_ != Version )
+        return EPROTO ;
+
+      if( kind_         != kind
+       || element_size_ != element_size
+       || type_hash_    != type_hash
+       || ( capacity != 0 && capacity_ != capacity )
+       || segment_size_  > mapped_size
+       || w_seq_offset_ + sizeof( uint64_t ) > segment_size_
+        )
+        return EINVAL ;
+
+      return 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    // Number of messages published to the queue.  Only valid once
+    // is_queue() returns true and the full segment is mapped.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    write_sequence() const
+    { const char * base = reinterpret_cast<const char *>( this ) ;
+      return reinterpret_cast<const std::atomic<uint64_t> *>( base + w_seq_offset_ )->load( std::memory_order_acquire ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Return true if the writing process is still running.
+    //------------------------------------------------------------------------
+    inline
+    bool
+    writer_alive() const
+    { int32_t pid = writer_pid_ ;
+      return pid > 0 && ( ::kill( pid, 0 ) == 0 || errno == EPERM ) ;
+    }
+  } ;
+
+}}}}
+
+#endif
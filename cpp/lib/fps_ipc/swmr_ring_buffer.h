@@ -4,27 +4,62 @@
 #include "fps_system/fps_system.h"  // For cache line size
 #include "fps_util/fps_util.h"      // For fps_likely/unlikely
 #include "fps_ipc/swmr_sequence_lock.h"
+#include "fps_ipc/ipc_util.h"          // For futex_wait/futex_wake
+#include "fps_ipc/options.h"
 #include <type_traits>
+#include <utility>
+#include <algorithm>
 
 //
 // Single-Writer/Multiple-Reader obstruction free (for the writer) ringbuffer 
 // implementation.  
 //
+// Every message is stamped with a 64-bit, monotonically increasing sequence
+// number ( the first message written has sequence number 1 ).  The message
+// with sequence number 'seq' lives in slot '(seq - 1) % Capacity', so a reader
+// that has consumed 'r_seq' messages expects to find sequence number 'r_seq + 1'
+// in slot 'r_seq % Capacity'.  A smaller value means the writer hasn't gotten
+// there yet, a larger value means the reader has been lapped.
+//
 
 namespace fps {
 namespace ipc {
 namespace swmr {
+
+  //-----------------------------------------------------------------------------------
+  // Result codes returned by RingBuffer read operations.
+  //-----------------------------------------------------------------------------------
+  namespace read_status
+  {
+    enum Enum
+    { Empty   = 0   // No message w/ the requested sequence number has been written yet.
+    , Success = 1   // The requested message was copied out.
+    , Overrun = 2   // The requested message was overwritten before it could be read.
+    } ;
+  }
+
 namespace detail {
 
   //-----------------------------------------------------------------------------------
-  template<typename T>
-  class Slot 
+  // Slots are packed at their natural alignment unless T_Alignment ( see
+  // opt::Slot_Alignment ) asks for more.
+  //-----------------------------------------------------------------------------------
+  template<typename T, uint32_t T_Alignment>
+  struct slot_alignment
+    : std::integral_constant< std::size_t
+                            , std::max( { static_cast<std::size_t>( T_Alignment ), alignof( T ), alignof( uint64_t ) } )
+                            >
+  {} ;
+
+  //-----------------------------------------------------------------------------------
+  template<typename T, uint32_t T_Alignment = 0>
+  class alignas( slot_alignment<T, T_Alignment>::value ) Slot 
   {
   private :
     //---------------------------------------------------------------------------------
-    swmr::SequenceLock lock_  ;
-    uint32_t           valid_ ;
-    T                  data_  ;
+    swmr::SequenceLock lock_ ;
+    uint64_t           seq_  ;   // Sequence number of the message in data_ ( 0 if unused ).
+    T                  data_ ;
 
     //---------------------------------------------------------------------------------
     inline void write_begin() { lock_.write_begin() ; }
@@ -36,44 +71,120 @@ namespace detail {
 
   public : 
     //---------------------------------------------------------------------------------
-    inline Slot() : valid_( false ) {}
+    inline Slot() : seq_( 0 ) {}
 
     //---------------------------------------------------------------------------------
     inline       T & data()       { return data_ ; }
     inline const T & data() const { return data_ ; }
 
+    //---------------------------------------------------------------------------------
+    inline uint64_t sequence() const { return seq_ ; }
+
+    //---------------------------------------------------------------------------------
+    // Copy out the message w/ sequence number 'seq'.  Returns a read_status value.
+    // A torn read of the requested message means the writer is overwriting it, 
+    // which can only happen once the reader has been lapped.
     //---------------------------------------------------------------------------------
     inline 
-    bool 
-    read( T & dest ) const
+    int32_t
+    read( uint64_t seq, T & dest ) const
     {
-      if( !valid_ ) 
-        return false ; 
-
       uint64_t begin_state = lock_.read_begin() ;
+      uint64_t slot_seq    = seq_ ;
+      if( slot_seq != seq )
+        return ( slot_seq > seq ) 
+               ? read_status::Overrun 
+               : read_status::Empty 
+               ;
+
       dest = data_ ; 
-      return lock_.read_end( begin_state ) ;
+      return lock_.read_end( begin_state )
+             ? read_status::Success
+             : read_status::Overrun
+             ;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Like read(), but instead of copying the message out, invoke 'visitor' on it
+    // in place while holding the slot's sequence lock.  The visitor may observe a
+    // message that is being overwritten, so anything it extracts must be discarded
+    // unless read_status::Success is returned.
+    //---------------------------------------------------------------------------------
+    template<typename T_Visitor>
+    inline
+    int32_t
+    visit( uint64_t seq, T_Visitor && visitor ) const
+    {
+      uint64_t begin_state = lock_.read_begin() ;
+      uint64_t slot_seq    = seq_ ;
+      if( slot_seq != seq )
+        return ( slot_seq > seq ) 
+               ? read_status::Overrun 
+               : read_status::Empty 
+               ;
+
+      visitor( static_cast<const T &>( data_ ) ) ;
+      return lock_.read_end( begin_state )
+             ? read_status::Success
+             : read_status::Overrun
+             ;
     }
 
     //---------------------------------------------------------------------------------
     inline 
     void 
-    write( const T & value ) 
+    write( const T & value, uint64_t seq )
+    { 
+      lock_.write_begin() ;
+      data_ = value ;
+      seq_  = seq ;
+      lock_.write_end() ;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Two phase, in place write.  claim() opens the sequence lock and returns the 
+    // slot's storage ( which still holds the previous message ), commit() stamps 
+    // the new sequence number and closes the lock.
+    //---------------------------------------------------------------------------------
+    inline 
+    T & 
+    claim() 
     { 
       lock_.write_begin() ;
-      data_  = value ; 
-      valid_ = true ;
+      return data_ ;
+    }
+
+    //---------------------------------------------------------------------------------
+    inline 
+    void 
+    commit( uint64_t seq ) 
+    { 
+      seq_ = seq ;
       lock_.write_end() ;
     }
   } ;
 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  // T_Opts : Named template parameters, see fps_ipc/options.h.  Currently
+  //          only opt::Slot_Alignment.
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
   class RingBuffer
   {
   public :
     static const uint32_t Capacity = T_Capacity ;
-    typedef Slot<T> slot_t ;
+
+    //------------------------------------------------------------------------
+    static 
+    const 
+    uint32_t 
+    Slot_Alignment = ntp::get_value< opt::Slot_Alignment<0>, T_Opts...>::value ;
+
+    static_assert( ( Slot_Alignment & ( Slot_Alignment - 1 ) ) == 0
+                 , "swmr::RingBuffer slot alignment must be zero or a power of two" 
+                 ) ;
+
+    typedef Slot<T, Slot_Alignment> slot_t ;
 
   private :
     //------------------------------------------------------------------------
@@ -84,10 +195,27 @@ namespace detail {
     
     //------------------------------------------------------------------------
     typedef std::atomic<uint32_t> atomic_idx_t ;
+    typedef std::atomic<uint64_t> atomic_seq_t ;
 
+    //------------------------------------------------------------------------
+    // Note: w_idx_ is the writer's cursor, w_seq_ is the number of messages
+    //       published so far.  Readers only consult w_seq_ to resynchronize
+    //       after an overrun.
     //------------------------------------------------------------------------
     atomic_idx_t w_idx_ alignas( system::cpu::Cache_Line_Size ) ;
-    storage_t    storage_ ;
+    atomic_seq_t w_seq_ ;
+
+    //------------------------------------------------------------------------
+    // Blocking reader support.  Readers that park register in waiters_ and 
+    // sleep on the futex word wake_word_, which the writer only bumps while
+    // waiters_ is non-zero.  Both are modified by readers, so they're kept 
+    // off the writer's cache line.
+    //------------------------------------------------------------------------
+    mutable atomic_idx_t waiters_ alignas( system::cpu::Cache_Line_Size ) ;
+    mutable atomic_idx_t wake_word_ ;
+
+    //------------------------------------------------------------------------
+    storage_t    storage_ alignas( system::cpu::Cache_Line_Size ) ;
 
     //------------------------------------------------------------------------
     RingBuffer( const RingBuffer & ) = delete ;
@@ -113,6 +241,22 @@ namespace detail {
     //------------------------------------------------------------------------
     void init() ;
 
+    //------------------------------------------------------------------------
+    // Make messages up to 'seq' visible to readers.  Costs a single 
+    // ( predictable ) branch over the release store while no reader is 
+    // parked.
+    //------------------------------------------------------------------------
+    inline 
+    void 
+    publish( uint64_t seq ) 
+    { w_seq_.store( seq, std::memory_order_release ) ;
+      if( fps_unlikely( waiters_.load( std::memory_order_relaxed ) != 0 ) ) 
+        wake() ;
+    }
+
+    //------------------------------------------------------------------------
+    void wake() ;
+
   public :
     //------------------------------------------------------------------------
     inline RingBuffer() ;
@@ -121,10 +265,109 @@ namespace detail {
     inline void write( const T & value ) ;
 
     //------------------------------------------------------------------------
-    inline bool read( uint32_t idx, T & dest ) const ;
+    // Write 'count' elements from 'src' and publish them to readers with a 
+    // single release store on the write sequence.  If 'count' exceeds
+    // Capacity only the trailing Capacity elements are written, since the
+    // leading elements would be overwritten before any reader could observe
+    // them ( their sequence numbers are still consumed ).
+    //------------------------------------------------------------------------
+    inline void write_batch( const T * src, uint32_t count ) ;
+
+    //------------------------------------------------------------------------
+    // Zero copy write.  claim() returns the storage of the next slot so the
+    // message can be built in place, commit() publishes it.  Every claim()
+    // must be followed by exactly one commit() before the next write.  Readers
+    // that reach the claimed slot spin until it is committed, so keep the
+    // window between the two calls short.
+    //------------------------------------------------------------------------
+    inline T  & claim() ;
+    inline void commit() ;
+
+    //------------------------------------------------------------------------
+    // Copy the message following 'r_seq' ( ie. the message w/ sequence
+    // number r_seq + 1 ) into 'dest'.  Returns a read_status value.
+    //------------------------------------------------------------------------
+    inline int32_t read( uint64_t r_seq, T & dest ) const ;
+
+    //------------------------------------------------------------------------
+    // Copy up to 'max_count' consecutive messages following 'r_seq' into
+    // 'dest'.  Returns the number of messages read.  The reason the batch
+    // ended ( Empty, Overrun or Success if 'max_count' was reached ) is
+    // stored in 'status'.  The write sequence is never consulted.
+    //------------------------------------------------------------------------
+    inline
+    uint32_t
+    read_batch( uint64_t r_seq, T * dest, uint32_t max_count, int32_t & status ) const ;
+
+    //------------------------------------------------------------------------
+    // Invoke 'visitor' on the message following 'r_seq' in place, rather than
+    // copying it out.  Returns a read_status value ( see Slot::visit ).
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    inline
+    int32_t
+    visit( uint64_t r_seq, T_Visitor && visitor ) const
+    { return data()[ index_of( r_seq ) ].visit( r_seq + 1, std::forward<T_Visitor>( visitor ) ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Block the calling reader until a message following 'r_seq' may be 
+    // available, or for at most 'timeout_nanos' ( forever if zero ).  The 
+    // ring buffer must be mapped writable.  Returns false on timeout.
+    //
+    // Note: The writer doesn't fence between publishing a message and 
+    //       checking for waiters ( that would cost every write a full 
+    //       barrier ), so a reader that parks at the same instant can miss 
+    //       its wakeup.  Callers should bound each park w/ a timeout.
+    //------------------------------------------------------------------------
+    inline bool park( uint64_t r_seq, uint64_t timeout_nanos ) const ;
+
+    //------------------------------------------------------------------------
+    // Number of readers currently parked.
+    //------------------------------------------------------------------------
+    inline 
+    uint32_t 
+    waiter_count() const 
+    { return waiters_.load( std::memory_order_relaxed ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Number of messages published so far ( sequence number of the newest ).
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    write_sequence() const
+    { return w_seq_.load( std::memory_order_acquire ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // The write sequence counter itself, so that its location can be recorded
+    // in the queue header for tools that don't know T ( see QueueHeader ).
+    //------------------------------------------------------------------------
+    inline const atomic_seq_t & write_sequence_counter() const { return w_seq_ ; }
+
+    //------------------------------------------------------------------------
+    // A reader positioned at the returned value will next read the oldest
+    // message still held by the ring.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    oldest_sequence() const
+    { uint64_t w_seq = write_sequence() ;
+      return ( w_seq > Capacity ) ? ( w_seq - Capacity ) : 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    static
+    uint32_t
+    index_of( uint64_t r_seq )
+    { return static_cast<uint32_t>( r_seq % Capacity ) ;
+    }
 
     //------------------------------------------------------------------------
     inline uint32_t advance( uint32_t idx ) const ;
+    inline uint32_t advance( uint32_t idx, uint32_t count ) const ;
 
     //------------------------------------------------------------------------
     // Note : Debug Only 
@@ -138,8 +381,8 @@ namespace detail {
   } ;
 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
-  RingBuffer<T,T_Capacity>::
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  RingBuffer<T,T_Capacity,T_Opts...>::
   RingBuffer() 
   {
     init() ;
@@ -148,51 +391,169 @@ namespace detail {
   //--------------------------------------------------------------------------
   // TODO: std::enable_if< std::is_default_constructable<T>::value > 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
   void
-  RingBuffer<T,T_Capacity>::
+  RingBuffer<T,T_Capacity,T_Opts...>::
   init() 
   { 
     w_idx_.store( 0, std::memory_order_relaxed ) ;
+    w_seq_.store( 0, std::memory_order_relaxed ) ;
+    waiters_.store( 0, std::memory_order_relaxed ) ;
+    wake_word_.store( 0, std::memory_order_relaxed ) ;
     for( uint32_t idx = 0 ; idx < Capacity ; ++idx ) 
-      new ( data() + w_idx_ ) slot_t() ;
+      new ( data() + idx ) slot_t() ;
   }
 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
   void
-  RingBuffer<T,T_Capacity>::
+  RingBuffer<T,T_Capacity,T_Opts...>::
   write( const T & value ) 
   { 
     uint32_t cur_idx = w_idx_.load( std::memory_order_relaxed ) ;
-    data()[ cur_idx ].write( value ) ;
+    uint64_t cur_seq = w_seq_.load( std::memory_order_relaxed ) + 1 ;
+    data()[ cur_idx ].write( value, cur_seq ) ;
   
     if( cur_idx == (Capacity - 1) ) 
-      w_idx_.store( 0, std::memory_order_release ) ;
+      w_idx_.store( 0, std::memory_order_relaxed ) ;
     else 
-      w_idx_.store( cur_idx + 1, std::memory_order_release ) ;
+      w_idx_.store( cur_idx + 1, std::memory_order_relaxed ) ;
+
+    publish( cur_seq ) ;
   }
   
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  void
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  write_batch( const T * src, uint32_t count ) 
+  { 
+    if( fps_unlikely( count == 0 ) ) 
+      return ;
+
+    uint32_t cur_idx = w_idx_.load( std::memory_order_relaxed ) ;
+    uint64_t cur_seq = w_seq_.load( std::memory_order_relaxed ) ;
+    if( fps_unlikely( count > Capacity ) ) 
+    { cur_idx  = advance( cur_idx, count - Capacity ) ;
+      cur_seq += ( count - Capacity ) ;
+      src     += ( count - Capacity ) ;
+      count    = Capacity ;
+    }
+
+    slot_t * slots = data() ;
+    for( uint32_t idx = 0 ; idx < count ; ++idx ) 
+    { slots[ cur_idx ].write( src[ idx ], ++cur_seq ) ;
+      if( ++cur_idx == Capacity ) 
+        cur_idx = 0 ;
+    }
+
+    w_idx_.store( cur_idx, std::memory_order_relaxed ) ;
+    publish( cur_seq ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  T &
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  claim() 
+  { 
+    return data()[ w_idx_.load( std::memory_order_relaxed ) ].claim() ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  void
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  commit() 
+  { 
+    uint32_t cur_idx = w_idx_.load( std::memory_order_relaxed ) ;
+    uint64_t cur_seq = w_seq_.load( std::memory_order_relaxed ) + 1 ;
+    data()[ cur_idx ].commit( cur_seq ) ;
+
+    if( cur_idx == (Capacity - 1) )
+      w_idx_.store( 0, std::memory_order_relaxed ) ;
+    else
+      w_idx_.store( cur_idx + 1, std::memory_order_relaxed ) ;
+
+    publish( cur_seq ) ;
+  }
+
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  void
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  wake() 
+  {
+    wake_word_.fetch_add( 1, std::memory_order_release ) ;
+    ipc::futex_wake( reinterpret_cast<volatile uint32_t *>( &wake_word_ ) ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
   bool
-  RingBuffer<T,T_Capacity>::
-  read( uint32_t r_idx, T & dest ) const
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  park( uint64_t r_seq, uint64_t timeout_nanos ) const
   {
-    if( r_idx >= Capacity )  //TODO: Add unlikely() macro
-      return false ;
+    // Sample the wake word before registering, then recheck the write 
+    // sequence so that a message published in between isn't slept through.
+    uint32_t word = wake_word_.load( std::memory_order_acquire ) ;
+    waiters_.fetch_add( 1, std::memory_order_seq_cst ) ;
 
-    uint32_t w_idx = w_idx_.load( std::memory_order_acquire ) ;
-    if( r_idx == w_idx ) 
-      return false ;
-    
-    return data()[ r_idx ].read( dest ) ;
+    bool rv = true ;
+    if( write_sequence() <= r_seq ) 
+      rv = ipc::futex_wait( reinterpret_cast<const volatile uint32_t *>( &wake_word_ ), word, timeout_nanos ) ;
+
+    waiters_.fetch_sub( 1, std::memory_order_relaxed ) ;
+    return rv ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  int32_t
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  read( uint64_t r_seq, T & dest ) const
+  {
+    return data()[ index_of( r_seq ) ].read( r_seq + 1, dest ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  uint32_t
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  read_batch( uint64_t r_seq, T * dest, uint32_t max_count, int32_t & status ) const
+  {
+    const slot_t * slots = data() ;
+    uint32_t       r_idx = index_of( r_seq ) ;
+    uint32_t       count = 0 ;
+
+    status = read_status::Success ;
+    for( ; count < max_count ; ++count )
+    { status = slots[ r_idx ].read( ++r_seq, dest[ count ] ) ;
+      if( status != read_status::Success )
+        break ;
+      if( ++r_idx == Capacity ) 
+        r_idx = 0 ;
+    }
+
+    return count ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
+  uint32_t 
+  RingBuffer<T,T_Capacity,T_Opts...>::
+  advance( uint32_t idx, uint32_t count ) const
+  {
+    idx += ( count % Capacity ) ;
+    if( idx >= Capacity ) 
+      idx -= Capacity ;
+    return idx ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename... T_Opts>
   uint32_t 
-  RingBuffer<T, T_Capacity>::
+  RingBuffer<T,T_Capacity,T_Opts...>::
   advance( uint32_t idx ) const
   {
     ++idx ;
@@ -0,0 +1,7 @@
+#ifndef FPS__IPC__SWMR_SHM_BYTE_QUEUE__H
+#define FPS__IPC__SWMR_SHM_BYTE_QUEUE__H
+
+#include "fps_ipc/swmr_shm_byte_queue_reader.h"
+#include "fps_ipc/swmr_shm_byte_queue_writer.h"
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef FPS__IPC__SWMR_SHM_BYTE_QUEUE_READER__H
+#define FPS__IPC__SWMR_SHM_BYTE_QUEUE_READER__H
+
+#include "fps_ipc/swmr_byte_ring.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_fs/path.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_util/fps_util.h" // For fps_likely/unlikely
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // Reader for a lossy single-writer/multi-reader queue of variable length
+  // records in shared memory ( see swmr_byte_ring.h ).
+  //
+  // Records are returned as container::ByteRange views into the shared
+  // segment rather than copied out.  Since the writer never waits for
+  // readers, a view is only trustworthy until the writer laps it : call
+  // intact() after consuming a record ( or use visit(), which does so ) and
+  // discard anything derived from it if intact() returns false.
+  //--------------------------------------------------------------------------
+  struct ShmByteQueueReader
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef swmr::detail::ByteRing    impl_t ;
+    typedef swmr::detail::Record      record_t ;
+    typedef swmr::detail::QueueHeader header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    uint64_t          r_pos_ ;          // Position of the next record to read.
+    uint64_t          r_seq_ ;          // Sequence number of the last record read.
+    uint64_t          lost_count_ ;     // Records skipped due to overruns.
+    uint64_t          overrun_count_ ;  // Number of times this reader was lapped.
+    record_t          rec_ ;            // The last record returned.
+    const impl_t    * impl_  ;
+
+    //------------------------------------------------------------------------
+    // Skip forward to the newest record in the ring.  Record boundaries can't
+    // be located from an arbitrary position, so the newest record is the
+    // oldest one a lapped reader can safely resume from.
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_overrun()
+    { r_pos_ = impl_->last_position() ;
+      ++overrun_count_ ;
+    }
+
+  public :
+    //------------------------------------------------------------------------
+    inline ShmByteQueueReader() ;
+
+    //------------------------------------------------------------------------
+    inline ~ShmByteQueueReader() ;
+
+    //------------------------------------------------------------------------
+    // Open the indicated shm queue for reading.
+    // Return true on success, false on failure and sets internal error_
+    // member to the associated system errno value (if possible).  See
+    // ShmQueueReader::open() for the meaning of EAGAIN, EPROTO and EINVAL,
+    // and for 'options'.
+    //------------------------------------------------------------------------
+    inline bool open( const std::string & shm_q_name, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    inline void close() ;
+
+    //------------------------------------------------------------------------
+    // Point 'dest' at the payload of the next record.  Returns false if no
+    // new record is available.  If this reader was lapped, it resumes at the
+    // newest record in the queue and updates lost_count() / overrun_count().
+    //------------------------------------------------------------------------
+    inline bool read( container::ByteRange & dest ) ;
+
+    //------------------------------------------------------------------------
+    // Return true if the record most recently returned by read() hasn't been
+    // overwritten.
+    //------------------------------------------------------------------------
+    inline
+    bool
+    intact() const
+    { return ( impl_ != NULL ) && impl_->intact( rec_.pos_ ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Invoke 'visitor' ( a callable taking 'const container::ByteRange &' ) on
+    // the next record in place.  Returns true if the record was still intact
+    // once the visitor returned.  If it wasn't, the reader resynchronizes and
+    // retries, so only the output of the last invocation is meaningful.
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    inline bool visit( T_Visitor && visitor ) ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()       const { return impl_ != NULL ; }
+    inline int32_t  last_error()    const { return error_ ; }
+    inline uint64_t sequence()      const { return r_seq_ ; }
+    inline uint64_t lost_count()    const { return lost_count_ ; }
+    inline uint64_t overrun_count() const { return overrun_count_ ; }
+
+    //--------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  ShmByteQueueReader::
+  ShmByteQueueReader()
+    : error_        ( 0 )
+    , r_pos_        ( 0 )
+    , r_seq_        ( 0 )
+    , lost_count_   ( 0 )
+    , overrun_count_( 0 )
+    , rec_          ()
+    , impl_         ( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  ShmByteQueueReader::
+  ~ShmByteQueueReader()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  void
+  ShmByteQueueReader::
+  close()
+  {
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close( false ) ;
+
+    error_         = 0 ;
+    impl_          = NULL ;
+    r_pos_         = 0 ;
+    r_seq_         = 0 ;
+    lost_count_    = 0 ;
+    overrun_count_ = 0 ;
+    rec_           = record_t() ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  ShmByteQueueReader::
+  open( const std::string & shm_q_name, uint32_t options )
+  {
+    close() ;
+    uint32_t access_flags = ipc::access::Read_Only
+                          | ( options & ( ipc::access::Populate | ipc::access::Lock ) )
+                          ;
+
+    if( !shm_.open( shm_q_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    // The writer creates the segment before sizing it.
+    if( shm_.size() < sizeof( header_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // Any capacity is acceptable, so the header only vouches for the kind
+    // of queue; the ring's own capacity is still sanity checked below.
+    const header_t * header = shm_map_.cast<header_t>( 0 ) ;
+    error_ = header->validate( queue_kind::Bytes, 0, 0, 0, shm_map_.size() ) ;
+    if( error_ != 0 )
+    { shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    impl_ = shm_map_.cast<impl_t>( sizeof( header_t ) ) ;
+    if( impl_ == NULL
+     || !impl_t::valid_capacity( impl_->capacity() )
+     || sizeof( header_t ) + impl_t::segment_size( impl_->capacity() ) > shm_map_.size()
+      )
+    { error_ = EINVAL ;
+      impl_  = NULL ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // Start w/ the oldest record if the writer hasn't wrapped yet, otherwise
+    // w/ the newest.  Records skipped here don't count as lost.
+    if( impl_->write_position() > impl_->capacity() )
+      r_pos_ = impl_->last_position() ;
+
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  ShmByteQueueReader::
+  read( container::ByteRange & dest )
+  {
+    if( fps_unlikely( NULL == impl_ ) )
+      return false ;
+
+    for( ;; )
+    {
+      int32_t status = impl_->read( r_pos_, rec_ ) ;
+      if( fps_likely( status == read_status::Success ) )
+      {
+        // Any gap in sequence numbers is a loss, except before the first record.
+        if( fps_unlikely( rec_.seq_ != r_seq_ + 1 ) && r_seq_ != 0 && rec_.seq_ > r_seq_ )
+          lost_count_ += ( rec_.seq_ - r_seq_ - 1 ) ;
+
+        r_seq_ = rec_.seq_ ;
+        r_pos_ = rec_.end_ ;
+        dest   = rec_.bytes_ ;
+        return true ;
+      }
+
+      if( status == read_status::Empty )
+        return false ;
+
+      on_overrun() ;
+    }
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T_Visitor>
+  bool
+  ShmByteQueueReader::
+  visit( T_Visitor && visitor )
+  {
+    container::ByteRange range ;
+    for( ;; )
+    {
+      if( !read( range ) )
+        return false ;
+
+      visitor( static_cast<const container::ByteRange &>( range ) ) ;
+      if( fps_likely( intact() ) )
+        return true ;
+
+      // The record was overwritten while the visitor ran.
+      ++lost_count_ ;
+      on_overrun() ;
+    }
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef FPS__IPC__SWMR_SHM_BYTE_QUEUE_WRITER__H
+#define FPS__IPC__SWMR_SHM_BYTE_QUEUE_WRITER__H
+
+#include "fps_ipc/swmr_byte_ring.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_fs/path.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // Writer for a lossy single-writer/multi-reader queue of variable length
+  // records in shared memory ( see swmr_byte_ring.h ).
+  //--------------------------------------------------------------------------
+  struct ShmByteQueueWriter
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef swmr::detail::ByteRing    impl_t ;
+    typedef swmr::detail::QueueHeader header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    header_t        * header_ ;
+    impl_t          * impl_  ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline ShmByteQueueWriter() ;
+
+    //------------------------------------------------------------------------
+    inline ~ShmByteQueueWriter() ;
+
+    //------------------------------------------------------------------------
+    // Create the indicated shm queue w/ a ring of 'capacity' bytes, which must
+    // be a power of two no smaller than detail::ByteRing::Minimum_Capacity.
+    // Return true on success, false on failure and sets internal error_
+    // member to the associated system errno value (if possible).  See
+    // ShmQueueWriter::open() for 'options'.
+    //------------------------------------------------------------------------
+    inline bool open( const std::string & shm_q_name, uint32_t capacity, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    inline void close() ;
+
+    //------------------------------------------------------------------------
+    // Append a record.  Returns false if the queue isn't open or 'length'
+    // exceeds max_length().
+    //------------------------------------------------------------------------
+    inline
+    bool
+    write( const char * src, uint32_t length )
+    { return fps_likely( impl_ != NULL ) && impl_->write( src, length ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    write( const container::ByteRange & src )
+    { return write( src.begin(), src.size() ) ;
+    }
+
+    //------------------------------------------------------------------------
+    // Zero copy write.  claim() returns a pointer to 'length' bytes of
+    // payload space in the ring ( NULL on failure ), commit() publishes it.
+    //------------------------------------------------------------------------
+    inline
+    char *
+    claim( uint32_t length )
+    { return fps_likely( impl_ != NULL ) ? impl_->claim( length ) : NULL ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    bool
+    commit()
+    { if( fps_unlikely( impl_ == NULL ) )
+        return false ;
+      impl_->commit() ;
+      return true ;
+    }
+
+    //------------------------------------------------------------------------
+    // Bytes occupied by a queue segment of 'capacity' ( header + ring ).
+    //------------------------------------------------------------------------
+    static
+    inline
+    uint64_t
+    segment_size( uint32_t capacity )
+    { return sizeof( header_t ) + impl_t::segment_size( capacity ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return impl_ != NULL ; }
+    inline int32_t  last_error() const { return error_ ; }
+    inline uint64_t capacity()   const { return impl_ ? impl_->capacity()   : 0 ; }
+    inline uint32_t max_length() const { return impl_ ? impl_->max_length() : 0 ; }
+
+    //------------------------------------------------------------------------
+    // Note: Debug Only
+    //------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  ShmByteQueueWriter::
+  ShmByteQueueWriter()
+    : error_ ( 0 )
+    , header_( NULL )
+    , impl_  ( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  ShmByteQueueWriter::
+  ~ShmByteQueueWriter()
+  {
+    close() ;
+  }
+
+  //------------------------------------------------------------------------
+  void
+  ShmByteQueueWriter::
+  close()
+  {
+    if( header_ != NULL )
+      header_->on_writer_close() ;
+
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    error_  = 0 ;
+    header_ = NULL ;
+    impl_   = NULL ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  ShmByteQueueWriter::
+  open( const std::string & shm_q_name, uint32_t capacity, uint32_t options )
+  {
+    close() ;
+    if( !impl_t::valid_capacity( capacity ) )
+    { error_ = EINVAL ;
+      return false ;
+    }
+
+    int32_t access_flags = ipc::access::Read_Write
+                         | ipc::access::Create
+                         | ipc::access::Exclusive
+                         | options
+                         ;
+
+    if( !shm_.open( shm_q_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( !shm_.resize( segment_size( capacity ) ) )
+    { error_ = shm_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    header_ = shm_map_.construct_at<header_t>( 0 ) ;
+    impl_   = shm_map_.construct_at<impl_t>( sizeof( header_t ), capacity ) ;
+    if( header_ == NULL || impl_ == NULL )
+    { header_ = NULL ;
+      impl_   = NULL ;
+      error_  = EINVAL ;
+      shm_map_.close() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    const char * w_seq = reinterpret_cast<const char *>( &impl_->write_sequence_counter() ) ;
+    header_->publish( queue_kind::Bytes
+                    , 0
+                    , capacity
+                    , 0
+                    , segment_size( capacity )
+                    , w_seq - reinterpret_cast<const char *>( header_ )
+                    ) ;
+
+    return true ;
+  }
+
+}}}
+
+#endif
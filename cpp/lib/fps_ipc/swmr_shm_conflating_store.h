@@ -0,0 +1,7 @@
+#ifndef FPS__IPC__SWMR_SHM_CONFLATING_STORE__H
+#define FPS__IPC__SWMR_SHM_CONFLATING_STORE__H
+
+#include "fps_ipc/swmr_shm_conflating_store_reader.h"
+#include "fps_ipc/swmr_shm_conflating_store_writer.h"
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef FPS__IPC__SWMR_SHM_CONFLATING_STORE_READER__H
+#define FPS__IPC__SWMR_SHM_CONFLATING_STORE_READER__H
+
+#include "fps_ipc/swmr_conflating_store.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_util/macros.h"
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // Reader side of a shared memory conflating store ( see
+  // swmr_conflating_store.h ).  Template arguments must match the writer's.
+  // Readers map the store read only, and any number of them may attach.
+  //--------------------------------------------------------------------------
+  template< typename T
+          , uint32_t T_Keys
+          , uint32_t T_Dirty_Capacity = 4096
+          >
+  struct ShmConflatingStoreReader
+  {
+  public :
+    static const uint32_t Keys           = T_Keys ;
+    static const uint32_t Dirty_Capacity = T_Dirty_Capacity ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef swmr::detail::ConflatingStore<T, T_Keys, T_Dirty_Capacity> impl_t ;
+    typedef swmr::detail::QueueHeader                                   header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    uint64_t          r_seq_ ;          // Sequence number of the last update accounted for.
+    uint64_t          resync_count_ ;   // Number of polls that fell back to a full scan.
+    const impl_t    * impl_ ;
+
+  public :
+    //------------------------------------------------------------------------
+    ShmConflatingStoreReader() ;
+
+    //------------------------------------------------------------------------
+    ~ShmConflatingStoreReader() ;
+
+    //------------------------------------------------------------------------
+    // Open the indicated shm store for reading.  Return true on success,
+    // false on failure and sets internal error_ member to the associated
+    // system errno value (if possible).  Header validation errors are as for
+    // ShmQueueReader::open() : EAGAIN, EPROTO or EINVAL.
+    //
+    // A freshly opened reader has seen nothing, so its first poll() visits
+    // every key written so far.
+    //------------------------------------------------------------------------
+    bool open( const std::string & shm_name, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Invoke 'visitor( uint32_t key, const T & value )' for each key updated
+    // since the last poll, w/ its latest value.  A key updated many times in
+    // between is visited once.  Returns the number of keys visited ( zero if
+    // nothing changed or the store is closed ).
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    uint32_t poll( T_Visitor && visitor ) ;
+
+    //------------------------------------------------------------------------
+    // Copy the latest value of 'key' into 'dest'.  Returns false if the
+    // store isn't open, 'key' is out of range or has never been written.
+    //------------------------------------------------------------------------
+    bool read( uint32_t key, T & dest ) const ;
+
+    //------------------------------------------------------------------------
+    // sequence() is the writer sequence number this reader has caught up to,
+    // and resync_count() the number of polls that found the reader too far
+    // behind to use the dirty ring.
+    //------------------------------------------------------------------------
+    inline uint64_t sequence()     const { return r_seq_ ; }
+    inline uint64_t resync_count() const { return resync_count_ ; }
+
+    //------------------------------------------------------------------------
+    // Number of updates published since this reader last caught up.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    lag() const
+    { uint64_t w_seq = ( impl_ != NULL ) ? impl_->write_sequence() : 0 ;
+      return ( w_seq > r_seq_ ) ? ( w_seq - r_seq_ ) : 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    inline bool    is_open()    const { return impl_ != NULL ; }
+    inline int32_t last_error() const { return error_ ; }
+
+    //--------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  ShmConflatingStoreReader()
+    : error_       ( 0 )
+    , r_seq_       ( 0 )
+    , resync_count_( 0 )
+    , impl_        ( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  ~ShmConflatingStoreReader()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  void
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  close()
+  {
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close( false ) ;
+
+    error_        = 0 ;
+    impl_         = NULL ;
+    r_seq_        = 0 ;
+    resync_count_ = 0 ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  bool
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  open( const std::string & shm_name, uint32_t options )
+  {
+    close() ;
+    uint32_t access_flags = ipc::access::Read_Only
+                          | ( options & ( ipc::access::Populate | ipc::access::Lock ) )
+                          ;
+
+    if( !shm_.open( shm_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    // The writer creates the segment before sizing it.
+    if( shm_.size() < sizeof( header_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // The dirty ring capacity isn't recorded in the header, but a mismatch
+    // changes the store's size and is caught by the segment size check.
+    const header_t * header = shm_map_.cast<header_t>( 0 ) ;
+    error_ = ( header != NULL )
+           ? header->validate( queue_kind::Conflating, sizeof( T ), Keys, TypeHash<T>::value(), shm_map_.size() )
+           : EAGAIN
+           ;
+    if( error_ == 0 && header->segment_size_ != sizeof( header_t ) + sizeof( impl_t ) )
+      error_ = EINVAL ;
+
+    if( error_ != 0 )
+    { shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    impl_ = shm_map_.cast<impl_t>( sizeof( header_t ) ) ;
+    if( impl_ == NULL )
+    { error_ = EINVAL ;
+      shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    r_seq_ = 0 ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  template<typename T_Visitor>
+  uint32_t
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  poll( T_Visitor && visitor )
+  {
+    if( fps_unlikely( NULL == impl_ ) )
+      return 0 ;
+
+    bool     resynced = false ;
+    uint32_t count    = impl_->poll( r_seq_, visitor, resynced ) ;
+    if( fps_unlikely( resynced ) )
+      ++resync_count_ ;
+
+    return count ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  bool
+  ShmConflatingStoreReader<T,T_Keys,T_Dirty_Capacity>::
+  read( uint32_t key, T & dest ) const
+  {
+    if( fps_unlikely( NULL == impl_ || key >= Keys ) )
+      return false ;
+
+    return impl_->read( key, dest ) != 0 ;
+  }
+
+}}}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef FPS__IPC__SWMR_SHM_CONFLATING_STORE_WRITER__H
+#define FPS__IPC__SWMR_SHM_CONFLATING_STORE_WRITER__H
+
+#include "fps_ipc/swmr_conflating_store.h"
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // Writer side of a shared memory conflating store ( see
+  // swmr_conflating_store.h ) : the latest value of each of T_Keys keys,
+  // plus a ring of the last T_Dirty_Capacity keys updated.  Like the swmr
+  // queues, the writer never waits for readers.
+  //--------------------------------------------------------------------------
+  template< typename T
+          , uint32_t T_Keys
+          , uint32_t T_Dirty_Capacity = 4096
+          >
+  struct ShmConflatingStoreWriter
+  {
+  public :
+    static const uint32_t Keys           = T_Keys ;
+    static const uint32_t Dirty_Capacity = T_Dirty_Capacity ;
+
+  private :
+    //------------------------------------------------------------------------
+    typedef swmr::detail::ConflatingStore<T, T_Keys, T_Dirty_Capacity> impl_t ;
+    typedef swmr::detail::QueueHeader                                   header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    uint32_t          claimed_ ;   // Key handed out by claim(), or Keys.
+    header_t        * header_ ;
+    impl_t          * impl_  ;
+
+  public :
+    //------------------------------------------------------------------------
+    ShmConflatingStoreWriter() ;
+
+    //------------------------------------------------------------------------
+    ~ShmConflatingStoreWriter() ;
+
+    //------------------------------------------------------------------------
+    // Create the indicated shm store.  Return true on success, false on
+    // failure and sets internal error_ member to the associated system errno
+    // value (if possible).  'options' is as for ShmQueueWriter::open().
+    //------------------------------------------------------------------------
+    bool open( const std::string & shm_name, uint32_t options = 0 ) ;
+
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Replace the value of 'key'.  Returns false if the store isn't open or
+    // 'key' is out of range.
+    //------------------------------------------------------------------------
+    bool write( uint32_t key, const T & src ) ;
+
+    //------------------------------------------------------------------------
+    // In place update.  claim() returns a pointer to the current value of
+    // 'key' ( NULL if the store isn't open or 'key' is out of range ) for
+    // modification, and commit() publishes it.  Readers of that key spin
+    // until commit() is called, so keep the update short.
+    //------------------------------------------------------------------------
+    T  * claim( uint32_t key ) ;
+    bool commit() ;
+
+    //------------------------------------------------------------------------
+    // Number of updates published so far.
+    //------------------------------------------------------------------------
+    inline
+    uint64_t
+    sequence() const
+    { return ( impl_ != NULL ) ? impl_->write_sequence() : 0 ;
+    }
+
+    //------------------------------------------------------------------------
+    // Bytes occupied by the store segment ( header + store ).
+    //------------------------------------------------------------------------
+    static inline uint64_t segment_size() { return sizeof( header_t ) + sizeof( impl_t ) ; }
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()     const { return impl_ != NULL ; }
+    inline int32_t  last_error()  const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    // Note: Debug Only
+    //------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+    inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  ShmConflatingStoreWriter()
+    : error_  ( 0 )
+    , claimed_( Keys )
+    , header_ ( NULL )
+    , impl_   ( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  ~ShmConflatingStoreWriter()
+  {
+    close() ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  void
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  close()
+  {
+    // Don't leave a key locked behind us.
+    if( claimed_ != Keys )
+      commit() ;
+
+    if( header_ != NULL )
+      header_->on_writer_close() ;
+
+    if( shm_.is_open() )
+      shm_.close() ;
+
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    error_   = 0 ;
+    claimed_ = Keys ;
+    header_  = NULL ;
+    impl_    = NULL ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  bool
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  open( const std::string & shm_name, uint32_t options )
+  {
+    close() ;
+    int32_t access_flags = ipc::access::Read_Write
+                         | ipc::access::Create
+                         | ipc::access::Exclusive
+                         | options
+                         ;
+
+    if( !shm_.open( shm_name, access_flags ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( !shm_.resize( segment_size() ) )
+    { error_ = shm_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, access_flags ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    // Same layout as the swmr queues, so shm_queue_list and QueueProbe
+    // recognize the segment.
+    header_ = shm_map_.construct_at<header_t>( 0 ) ;
+    impl_   = shm_map_.construct_at<impl_t>( sizeof( header_t ) ) ;
+    if( header_ == NULL || impl_ == NULL )
+    { header_ = NULL ;
+      impl_   = NULL ;
+      error_  = EINVAL ;
+      shm_map_.close() ;
+      shm_.close( true ) ;
+      return false ;
+    }
+
+    const char * w_seq = reinterpret_cast<const char *>( &impl_->write_sequence_counter() ) ;
+    header_->publish( queue_kind::Conflating
+                    , sizeof( T )
+                    , Keys
+                    , TypeHash<T>::value()
+                    , segment_size()
+                    , w_seq - reinterpret_cast<const char *>( header_ )
+                    ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  bool
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  write( uint32_t key, const T & src )
+  {
+    if( fps_unlikely( NULL == impl_ || key >= Keys ) )
+      return false ;
+
+    impl_->write( key, src ) ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  T *
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  claim( uint32_t key )
+  {
+    if( fps_unlikely( NULL == impl_ || key >= Keys ) )
+      return NULL ;
+
+    claimed_ = key ;
+    return &( impl_->claim( key ) ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Keys, uint32_t T_Dirty_Capacity>
+  bool
+  ShmConflatingStoreWriter<T,T_Keys,T_Dirty_Capacity>::
+  commit()
+  {
+    if( fps_unlikely( NULL == impl_ || claimed_ == Keys ) )
+      return false ;
+
+    impl_->commit( claimed_ ) ;
+    claimed_ = Keys ;
+    return true ;
+  }
+
+}}}
+
+#endif
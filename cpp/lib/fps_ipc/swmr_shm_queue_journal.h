@@ -0,0 +1,370 @@
+#ifndef FPS__IPC__SWMR_SHM_QUEUE_JOURNAL__H
+#define FPS__IPC__SWMR_SHM_QUEUE_JOURNAL__H
+
+#include "fps_ipc/swmr_shm_queue.h"
+#include "fps_ipc/journal.h"
+#include "fps_ipc/backoff.h"
+#include "fps_time/clock.h"
+#include "fps_time/constants.h"
+#include "fps_util/macros.h"
+#include <atomic>
+#include <vector>
+#include <ctime>
+
+//
+// Record a swmr shm queue to disk, and play it back.
+//
+//   ShmQueueJournal : A reader that drains the queue in batches of up to
+//                     Batch_Size messages and appends them to a
+//                     journal::Writer.  Each message is recorded w/ its
+//                     queue sequence number and the time its batch was
+//                     captured; messages the journal was lapped out of are
+//                     recorded as a single gap record.  A writer restart
+//                     starts the queue's sequence numbers over; the
+//                     journal's carry on from the last one recorded, so
+//                     they only ever increase ( which seek() relies on ).
+//   ShmQueueReplay  : Feeds a journal back into a ShmQueueWriter, either as
+//                     fast as possible or at ( a multiple of ) the pace it
+//                     was captured at.
+//
+// Capture costs a batch copy out of the ring and a copy into the page
+// cache; there are no per message system calls, so a journal keeps up w/
+// any writer a plain reader does.  Like any swmr reader it can't slow the
+// writer down, so it must be given a cpu of its own to be lossless at full
+// rate.
+//
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // T_Backoff paces run() while the queue is empty.  T_Opts must match the
+  // writer's ( see ShmQueueWriter ).
+  //--------------------------------------------------------------------------
+  template< typename    T
+          , uint32_t    T_Capacity
+          , typename    T_Backoff = backoff::Default
+          , typename... T_Opts
+          >
+  class ShmQueueJournal
+  {
+  public :
+    //------------------------------------------------------------------------
+    typedef ShmQueueReader<T, T_Capacity, T_Backoff, telemetry::None, T_Opts...> reader_t ;
+
+    //------------------------------------------------------------------------
+    static const uint32_t Batch_Size = ( T_Capacity < 256 ) ? T_Capacity : 256 ;
+
+  private :
+    //------------------------------------------------------------------------
+    reader_t        reader_ ;
+    journal::Writer journal_ ;
+    std::vector<T>  batch_ ;
+    int32_t         error_ ;
+    uint64_t        base_ ;    // Added to queue sequence numbers; see poll().
+
+    ShmQueueJournal( const ShmQueueJournal & ) ;
+    ShmQueueJournal & operator=( const ShmQueueJournal & ) ;
+
+  public :
+    //------------------------------------------------------------------------
+    ShmQueueJournal() ;
+    ~ShmQueueJournal() ;
+
+    //------------------------------------------------------------------------
+    // Attach to 'queue_name' and open ( or append to ) the journal at
+    // 'path'.  'options' is passed to ShmQueueReader::open(), and
+    // 'chunk_size' and 'checkpoint_interval' to journal::Writer::open().
+    // Returns false and sets last_error() on failure.
+    //------------------------------------------------------------------------
+    bool open( const std::string & queue_name
+             , const std::string & path
+             , uint32_t            options             = 0
+             , uint64_t            chunk_size          = journal::Default_Chunk_Size
+             , uint32_t            checkpoint_interval = journal::Default_Checkpoint_Interval
+             ) ;
+
+    //------------------------------------------------------------------------
+    void close() ;
+
+    //------------------------------------------------------------------------
+    // Journal everything published since the last call.  Returns the
+    // number of messages recorded.  If the journal can't grow, last_error()
+    // is set and the messages read are lost.
+    //------------------------------------------------------------------------
+    uint64_t poll() ;
+
+    //------------------------------------------------------------------------
+    // poll() until 'stop' is set, then drain the queue one last time and
+    // checkpoint.  Returns the number of messages recorded.
+    //------------------------------------------------------------------------
+    uint64_t run( const std::atomic<bool> & stop ) ;
+
+    //------------------------------------------------------------------------
+    inline bool    is_open()    const { return journal_.is_open() ; }
+    inline int32_t last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    inline uint64_t record_count() const { return journal_.record_count() ; }
+    inline uint64_t lost_count()   const { return reader_.lost_count() ; }
+
+    //------------------------------------------------------------------------
+    inline const reader_t        & reader()  const { return reader_ ; }
+    inline       journal::Writer & journal()       { return journal_ ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  ShmQueueJournal()
+    : batch_( Batch_Size )
+    , error_( 0 )
+    , base_ ( 0 )
+  {
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  ~ShmQueueJournal()
+  { close() ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  bool
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  open( const std::string & queue_name
+      , const std::string & path
+      , uint32_t            options
+      , uint64_t            chunk_size
+      , uint32_t            checkpoint_interval
+      )
+  {
+    close() ;
+
+    if( !reader_.open( queue_name, false, options ) )
+    { error_ = reader_.last_error() ;
+      return false ;
+    }
+
+    if( !journal_.open( path, sizeof( T ), TypeHash<T>::value(), chunk_size, checkpoint_interval ) )
+    { error_ = journal_.last_error() ;
+      reader_.close() ;
+      return false ;
+    }
+
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  void
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  close()
+  {
+    journal_.close() ;
+    reader_.close() ;
+    error_ = 0 ;
+    base_  = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  uint64_t
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  poll()
+  {
+    if( fps_unlikely( !journal_.is_open() ) )
+      return 0 ;
+
+    uint64_t rv = 0 ;
+    for( ;; )
+    {
+      uint32_t count = reader_.read_batch( batch_.data(), Batch_Size ) ;
+      if( count == 0 )
+        return rv ;
+
+      // A batch is contiguous, so a gap can only precede it.  A sequence that
+      // goes backwards means the writer restarted, which isn't a loss; the
+      // journal's numbering carries on from its last record so that its
+      // index stays sorted.
+      uint64_t first     = reader_.sequence() - count + 1 + base_ ;
+      uint64_t last      = journal_.last_sequence() ;
+      uint64_t timestamp = time::Clock::now() ;
+      if( fps_unlikely( last != 0 && first <= last ) )
+      { base_ += last + 1 - first ;
+        first  = last + 1 ;
+      }
+      else if( fps_unlikely( last != 0 && first > last + 1 ) )
+        journal_.append_gap( last + 1, first - last - 1, timestamp ) ;
+
+      for( uint32_t idx = 0 ; idx < count ; ++idx )
+      { if( fps_unlikely( !journal_.append( &batch_[ idx ], sizeof( T ), first + idx, timestamp ) ) )
+        { error_ = journal_.last_error() ;
+          return rv + idx ;
+        }
+      }
+
+      rv += count ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename... T_Opts>
+  uint64_t
+  ShmQueueJournal<T,T_Capacity,T_Backoff,T_Opts...>::
+  run( const std::atomic<bool> & stop )
+  {
+    uint64_t rv = 0 ;
+    for( uint32_t counter = 0 ; !stop.load( std::memory_order_acquire ) ; )
+    { uint64_t count = poll() ;
+      if( count > 0 )
+      { rv     += count ;
+        counter = 0 ;
+      }
+      else
+        T_Backoff::wait( counter++ ) ;
+    }
+
+    rv += poll() ;
+    journal_.checkpoint() ;
+    return rv ;
+  }
+
+  //--------------------------------------------------------------------------
+  // Replays a journal written by ShmQueueJournal<T, ...>.
+  //--------------------------------------------------------------------------
+  template<typename T>
+  class ShmQueueReplay
+  {
+  private :
+    //------------------------------------------------------------------------
+    journal::Reader journal_ ;
+    int32_t         error_ ;
+    uint64_t        gap_count_ ;   // Messages the journal recorded as lost.
+
+    ShmQueueReplay( const ShmQueueReplay & ) ;
+    ShmQueueReplay & operator=( const ShmQueueReplay & ) ;
+
+    //------------------------------------------------------------------------
+    // Sleep until shortly before 'deadline', then spin.
+    //------------------------------------------------------------------------
+    static
+    inline
+    void
+    wait_until( uint64_t deadline )
+    {
+      static const uint64_t Spin_Nanos = 100000 ;
+      for( uint64_t now = time::Clock::now() ; now < deadline ; now = time::Clock::now() )
+      { if( deadline - now > Spin_Nanos )
+        { uint64_t        nanos = deadline - now - Spin_Nanos ;
+          struct timespec ts    = { static_cast<time_t>( nanos / time::Nanos_Per_Second )
+                                  , static_cast<long>  ( nanos % time::Nanos_Per_Second )
+                                  } ;
+          ::nanosleep( &ts, NULL ) ;
+        }
+      }
+    }
+
+  public :
+    //------------------------------------------------------------------------
+    ShmQueueReplay()
+      : error_    ( 0 )
+      , gap_count_( 0 )
+    {}
+
+    //------------------------------------------------------------------------
+    // Open the journal at 'path'.  Fails w/ EINVAL if it holds something
+    // other than T's.
+    //------------------------------------------------------------------------
+    inline
+    bool
+    open( const std::string & path )
+    { gap_count_ = 0 ;
+      if( !journal_.open( path, sizeof( T ), TypeHash<T>::value() ) )
+      { error_ = journal_.last_error() ;
+        return false ;
+      }
+      error_ = 0 ;
+      return true ;
+    }
+
+    //------------------------------------------------------------------------
+    inline void close() { journal_.close() ; error_ = 0 ; }
+
+    //------------------------------------------------------------------------
+    // Resume from the first message w/ a sequence number of at least
+    // 'sequence'.  These are the journal's sequence numbers, which match the
+    // queue's up to the first writer restart the journal spans.
+    //------------------------------------------------------------------------
+    inline void seek( uint64_t sequence ) { journal_.seek( sequence ) ; }
+
+    //------------------------------------------------------------------------
+    // Publish up to 'max_count' ( zero for all ) of the remaining messages
+    // via 'writer' ( a ShmQueueWriter<T, ...> ).  A 'speed' of 1.0 keeps the
+    // original spacing between captured batches, 2.0 halves it, and zero
+    // or less publishes as fast as possible.  Returns the number of
+    // messages published.
+    //------------------------------------------------------------------------
+    template<typename T_Writer>
+    uint64_t replay( T_Writer & writer, double speed = 1.0, uint64_t max_count = 0 ) ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return journal_.is_open() ; }
+    inline int32_t  last_error() const { return error_ ; }
+    inline uint64_t gap_count()  const { return gap_count_ ; }
+
+    //------------------------------------------------------------------------
+    inline journal::Reader & journal() { return journal_ ; }
+  } ;
+
+  //--------------------------------------------------------------------------
+  template<typename T>
+  template<typename T_Writer>
+  uint64_t
+  ShmQueueReplay<T>::
+  replay( T_Writer & writer, double speed, uint64_t max_count )
+  {
+    uint64_t rv      = 0 ;
+    uint64_t w_begin = 0 ;
+    uint64_t r_begin = 0 ;
+    while( max_count == 0 || rv < max_count )
+    {
+      const journal::RecordHeader * record = journal_.next() ;
+      if( record == NULL )
+        break ;
+
+      if( fps_unlikely( record->flags_ & journal::record_flags::Gap ) )
+      { uint64_t count ;
+        std::memcpy( &count, record->payload(), sizeof( count ) ) ;
+        gap_count_ += count ;
+        continue ;
+      }
+
+      if( speed > 0.0 )
+      { if( fps_unlikely( w_begin == 0 ) )
+        { w_begin = time::Clock::now() ;
+          r_begin = record->timestamp_ ;
+        }
+        else if( record->timestamp_ > r_begin )
+          wait_until( w_begin + static_cast<uint64_t>( ( record->timestamp_ - r_begin ) / speed ) ) ;
+      }
+
+      // Payloads are only 8 byte aligned in the journal, so copy rather than
+      // cast.
+      T * slot = writer.claim() ;
+      if( fps_unlikely( slot == NULL ) )
+      { error_ = EBADF ;
+        break ;
+      }
+      std::memcpy( static_cast<void *>( slot ), record->payload(), sizeof( T ) ) ;
+      writer.commit() ;
+      ++rv ;
+    }
+    return rv ;
+  }
+
+}}}
+
+#endif
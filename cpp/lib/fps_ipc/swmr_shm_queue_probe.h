@@ -0,0 +1,143 @@
+#ifndef FPS__IPC__SWMR_SHM_QUEUE_PROBE__H
+#define FPS__IPC__SWMR_SHM_QUEUE_PROBE__H
+
+#include "fps_ipc/swmr_queue_header.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include <cerrno>
+
+namespace fps  {
+namespace ipc  {
+namespace swmr {
+
+  //--------------------------------------------------------------------------
+  // Read only view of any swmr shm queue's header, regardless of its kind or
+  // element type.  Used by monitoring tools to discover queues and sample
+  // their write sequence w/o attaching a reader.
+  //--------------------------------------------------------------------------
+  struct ShmQueueProbe
+  {
+  private :
+    //------------------------------------------------------------------------
+    typedef swmr::detail::QueueHeader header_t ;
+
+    //------------------------------------------------------------------------
+    ipc::SharedMemory shm_ ;
+    ipc::MappedMemory shm_map_ ;
+    int32_t           error_ ;
+    const header_t  * header_ ;
+
+  public :
+    //------------------------------------------------------------------------
+    inline ShmQueueProbe() ;
+
+    //------------------------------------------------------------------------
+    inline ~ShmQueueProbe() ;
+
+    //------------------------------------------------------------------------
+    // Open the indicated shm segment.  Returns false if it doesn't hold an
+    // initialized queue ( EAGAIN if the writer is still setting one up,
+    // EPROTO if it isn't a queue or has an unknown layout, EINVAL if it's
+    // truncated ) or can't be opened.
+    //------------------------------------------------------------------------
+    inline bool open( const std::string & shm_name ) ;
+
+    //------------------------------------------------------------------------
+    inline void close() ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_open()    const { return header_ != NULL ; }
+    inline int32_t  last_error() const { return error_ ; }
+
+    //------------------------------------------------------------------------
+    // Only valid while is_open() returns true.
+    //------------------------------------------------------------------------
+    inline uint32_t kind()           const { return header_->kind_ ; }
+    inline uint64_t element_size()   const { return header_->element_size_ ; }
+    inline uint64_t capacity()       const { return header_->capacity_ ; }
+    inline uint64_t type_hash()      const { return header_->type_hash_ ; }
+    inline uint64_t segment_size()   const { return header_->segment_size_ ; }
+    inline int32_t  writer_pid()     const { return header_->writer_pid_ ; }
+    inline bool     writer_alive()   const { return header_->writer_alive() ; }
+    inline uint64_t write_sequence() const { return header_->write_sequence() ; }
+
+    //------------------------------------------------------------------------
+    inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
+  } ;
+
+  //------------------------------------------------------------------------
+  ShmQueueProbe::
+  ShmQueueProbe()
+    : error_ ( 0 )
+    , header_( NULL )
+  {
+  }
+
+  //------------------------------------------------------------------------
+  ShmQueueProbe::
+  ~ShmQueueProbe()
+  { close() ;
+  }
+
+  //------------------------------------------------------------------------
+  void
+  ShmQueueProbe::
+  close()
+  {
+    if( shm_map_.is_open() )
+      shm_map_.close() ;
+
+    if( shm_.is_open() )
+      shm_.close( false ) ;
+
+    error_  = 0 ;
+    header_ = NULL ;
+  }
+
+  //------------------------------------------------------------------------
+  bool
+  ShmQueueProbe::
+  open( const std::string & shm_name )
+  {
+    close() ;
+
+    if( !shm_.open( shm_name, ipc::access::Read_Only ) )
+    { error_ = shm_.last_error() ;
+      return false ;
+    }
+
+    if( shm_.size() < sizeof( header_t ) )
+    { error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+
+    if( !shm_map_.open( shm_, ipc::access::Read_Only ) )
+    { error_ = shm_map_.last_error() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    const header_t * header = shm_map_.cast<header_t>( 0 ) ;
+    if( !header->is_initialized() )
+      error_ = ( header->magic_ == 0 || header->magic_ == header_t::Magic ) ? EAGAIN : EPROTO ;
+    else if( !header->is_queue() )
+      error_ = EPROTO ;
+    else if( header->segment_size_ > shm_map_.size()
+          || header->w_seq_offset_ + sizeof( uint64_t ) > header->segment_size_
+           )
+      error_ = EINVAL ;
+
+    if( error_ != 0 )
+    { shm_map_.close() ;
+      shm_.close() ;
+      return false ;
+    }
+
+    header_ = header ;
+    return true ;
+  }
+
+}}}
+
+#endif
@@ -2,10 +2,16 @@
 #define FPS__IPC__SWMR_SHM_QUEUE_READER__H
 
 #include "fps_ipc/swmr_ring_buffer.h"
+#include "fps_ipc/swmr_queue_header.h"
 #include "fps_fs/path.h"
 #include "fps_ipc/shared_memory.h"
 #include "fps_ipc/mapped_memory.h"
 #include "fps_util/fps_util.h" // For fps_likely/unlikely
+#include "fps_ipc/ipc_util.h"
+#include "fps_ipc/backoff.h"
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_ipc/notifier.h"
+#include <ctime>
 
 // #include <iostream>
 
@@ -14,20 +20,78 @@ namespace ipc  {
 namespace swmr {
 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  // T_Telemetry selects the instrumentation policy ( see queue_telemetry.h ).
+  // W/ telemetry::Shm the reader attaches to the writer's stats block in
+  // open(), and records its lag, overruns and message latency.
+  //
+  // T_Opts must match the writer's ( see ShmQueueWriter ).
+  //--------------------------------------------------------------------------
+  template< typename    T
+          , uint32_t    T_Capacity
+          , typename    T_Backoff   = backoff::Default
+          , typename    T_Telemetry = telemetry::None
+          , typename... T_Opts
+          >
   struct ShmQueueReader
   {
   private :
     //------------------------------------------------------------------------
-    typedef swmr::detail::RingBuffer<T, T_Capacity> impl_t ;
+    typedef swmr::detail::RingBuffer<T, T_Capacity, T_Opts...> impl_t ;
+    typedef swmr::detail::QueueHeader                           header_t ;
     static const uint32_t Capacity = T_Capacity ;
+
+  public :
+    typedef T_Backoff   backoff_t ;
+    typedef T_Telemetry telemetry_t ;
+
+    //------------------------------------------------------------------------
+    // Defaults for read_wait().  The spin phase waits via T_Backoff ( by 
+    // default pause, sched_yield, then 1us sleeps - see backoff.h ), after 
+    // which a waitable reader parks for up to Default_Park_Nanos at a time.
+    //------------------------------------------------------------------------
+    static const uint32_t Default_Spin_Limit = 64 ;
+    static const uint64_t Default_Park_Nanos = 1000000 ;
+
+  private :
     
     //------------------------------------------------------------------------
     ipc::SharedMemory shm_ ;
     ipc::MappedMemory shm_map_ ;
     int32_t           error_ ;
-    mutable uint32_t  r_idx_ ;
+    mutable uint64_t  r_seq_ ;          // Sequence number of the last message consumed.
+    mutable uint64_t  lost_count_ ;     // Messages skipped due to overruns.
+    mutable uint64_t  overrun_count_ ;  // Number of times this reader was lapped.
+    bool              waitable_ ;       // Opened w/ write access to the futex word.
+    uint32_t          spin_limit_ ;     // read_wait() spin budget.
+    uint64_t          park_nanos_ ;     // Upper bound on a single futex park.
     const impl_t    * impl_  ;
+    mutable T_Telemetry telemetry_ ;
+    notify::Subscriber  notify_ ;
+
+    //------------------------------------------------------------------------
+    // Skip forward to the oldest message still held by the ring buffer.
+    //------------------------------------------------------------------------
+    void on_overrun() const ;
+
+    //------------------------------------------------------------------------
+    // Report the 'count' messages just consumed.
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_read( uint32_t count ) const
+    { if( telemetry_.on_read( r_seq_ + 1 - count, r_seq_ + 1 ) )
+        telemetry_.on_lag( lag() ) ;
+    }
+
+    //------------------------------------------------------------------------
+    inline
+    static
+    uint64_t
+    monotonic_nanos()
+    { ::timespec ts ;
+      ::clock_gettime( CLOCK_MONOTONIC, &ts ) ;
+      return static_cast<uint64_t>( ts.tv_sec ) * 1000000000 + ts.tv_nsec ;
+    }
     
   public :
     //------------------------------------------------------------------------
@@ -39,75 +103,192 @@ namespace swmr {
     //------------------------------------------------------------------------
     // Open the indicated shm queue for reading.  
     // Return true on success, false on failure and sets internal error_ 
-    // member to the associated system errno value (if possible).
+    // member to the associated system errno value (if possible).  The 
+    // segment's header is validated first : EAGAIN means the writer hasn't 
+    // finished creating the queue ( retry ), EPROTO that the segment isn't a 
+    // queue this build understands, and EINVAL that it's a queue of another 
+    // element type or capacity.
+    //
+    // A 'waitable' reader maps the queue read/write so that read_wait() can 
+    // park on a futex in the shared segment rather than poll.  It never 
+    // writes anything but the queue's waiter bookkeeping.
+    //
+    // 'options' may include access::Populate and access::Lock to prefault 
+    // the reader's mapping, and access::Notify to wait via notify_fd() ( the
+    // writer must have been opened w/ access::Notify too ); anything else is 
+    // ignored.
     //------------------------------------------------------------------------
-    bool open( const std::string & shm_q_name ) ;
+    bool open( const std::string & shm_q_name, bool waitable = false, uint32_t options = 0 ) ;
 
     //------------------------------------------------------------------------
     void close() ;
     
+    //------------------------------------------------------------------------
+    // Read the next message into 'dest'.  Returns false if no new message is
+    // available.  If the writer lapped this reader, the reader skips ahead to 
+    // the oldest message still in the queue and updates lost_count() and 
+    // overrun_count() accordingly.
     //------------------------------------------------------------------------
     bool read( T & dest ) const ;
 
+    //------------------------------------------------------------------------
+    // Read up to 'max_count' elements into 'dest'.  Returns the number of 
+    // elements read ( zero if the queue is empty or closed ).
+    //------------------------------------------------------------------------
+    uint32_t read_batch( T * dest, uint32_t max_count ) const ;
+
+    //------------------------------------------------------------------------
+    // Zero copy read.  Invoke 'visitor' ( a callable taking 'const T &' ) on 
+    // the next message in place, under the slot's sequence lock, so that 
+    // only the fields it needs are copied out.  Returns true if the visitor 
+    // saw a consistent message.  After an overrun the visitor is invoked 
+    // again on the oldest remaining message, so only the output of the last 
+    // invocation is meaningful.
+    //------------------------------------------------------------------------
+    template<typename T_Visitor>
+    bool visit( T_Visitor && visitor ) const ;
+
+    //------------------------------------------------------------------------
+    // Blocking read.  Spin for up to spin_limit() attempts, then ( for 
+    // waitable readers ) park on the queue's futex until the writer 
+    // publishes, or ( otherwise ) keep polling w/ 1us sleeps.  Returns false 
+    // if no message arrived within 'timeout_nanos' ( zero waits forever ) or 
+    // the queue isn't open.
+    //------------------------------------------------------------------------
+    bool read_wait( T & dest, uint64_t timeout_nanos = 0 ) const ;
+
+    //------------------------------------------------------------------------
+    // Configure read_wait().  'park_nanos' bounds each individual futex wait,
+    // which in turn bounds the delay caused by a missed wakeup ( see 
+    // detail::RingBuffer::park ).
+    //------------------------------------------------------------------------
+    inline 
+    void 
+    set_wait_policy( uint32_t spin_limit, uint64_t park_nanos = Default_Park_Nanos ) 
+    { spin_limit_ = spin_limit ;
+      park_nanos_ = ( park_nanos > 0 ) ? park_nanos : Default_Park_Nanos ;
+    }
+
+    //------------------------------------------------------------------------
+    // Event loop support ( see notifier.h ).  notify_fd() becomes readable 
+    // when the writer publishes to a queue this reader had drained, and is -1
+    // unless the reader was opened w/ access::Notify.  prepare_wait() must be
+    // called before blocking on it : it returns true if the queue is still 
+    // empty and the writer will signal the next message, or false if there's
+    // something to read ( or notification isn't enabled ).
+    //------------------------------------------------------------------------
+    inline int32_t notify_fd() const { return notify_.fd() ; }
+    bool prepare_wait() const ;
+
+    //------------------------------------------------------------------------
+    inline bool     is_waitable() const { return waitable_ ; }
+    inline uint32_t spin_limit()  const { return spin_limit_ ; }
+    inline uint64_t park_nanos()  const { return park_nanos_ ; }
+
     //------------------------------------------------------------------------
     inline bool    is_open()    const { return impl_ != NULL ; }
     inline int32_t last_error() const { return error_ ; }
 
+    //------------------------------------------------------------------------
+    inline const T_Telemetry & telemetry() const { return telemetry_ ; }
+
+    //------------------------------------------------------------------------
+    // Gap detection support.  sequence() is the sequence number of the last 
+    // message consumed ( the writer numbers messages from 1 ), lost_count() 
+    // is the total number of messages skipped because this reader was lapped,
+    // and overrun_count() is the number of times that happened.
+    //------------------------------------------------------------------------
+    inline uint64_t sequence()      const { return r_seq_ ; }
+    inline uint64_t lost_count()    const { return lost_count_ ; }
+    inline uint64_t overrun_count() const { return overrun_count_ ; }
+
+    //------------------------------------------------------------------------
+    // Number of published messages this reader has yet to consume.
+    //------------------------------------------------------------------------
+    inline 
+    uint64_t 
+    lag() const 
+    { uint64_t w_seq = ( impl_ != NULL ) ? impl_->write_sequence() : 0 ;
+      return ( w_seq > r_seq_ ) ? ( w_seq - r_seq_ ) : 0 ; 
+    }
+
     //--------------------------------------------------------------------------
     inline const ipc::SharedMemory & shared_memory() const { return shm_ ; }
     inline const ipc::MappedMemory & mapped_memory() const { return shm_map_ ; }
   } ;
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
-  ShmQueueReader<T,T_Capacity>::
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
   ShmQueueReader()  
-    : error_( 0 ) 
-    , r_idx_( 0 ) 
-    , impl_ ( NULL ) 
+    : error_        ( 0 ) 
+    , r_seq_        ( 0 ) 
+    , lost_count_   ( 0 ) 
+    , overrun_count_( 0 ) 
+    , waitable_     ( false ) 
+    , spin_limit_   ( Default_Spin_Limit ) 
+    , park_nanos_   ( Default_Park_Nanos ) 
+    , impl_         ( NULL ) 
   { 
   }
     
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
-  ShmQueueReader<T,T_Capacity>::
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
   ~ShmQueueReader()  
   { close() ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
   void 
-  ShmQueueReader<T,T_Capacity>::
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
   close()
   {
+    telemetry_.close() ;
+    notify_.close() ;
+
     if( shm_map_.is_open() ) 
       shm_map_.close() ;
 
     if( shm_.is_open() ) 
       shm_.close( false ) ;
 
-    error_ = 0 ;
-    impl_  = NULL ;
-    r_idx_ = 0 ;
+    error_         = 0 ;
+    impl_          = NULL ;
+    r_seq_         = 0 ;
+    lost_count_    = 0 ;
+    overrun_count_ = 0 ;
+    waitable_      = false ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
   bool
-  ShmQueueReader<T,T_Capacity>::
-  open( const std::string & shm_q_name ) 
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  open( const std::string & shm_q_name, bool waitable, uint32_t options ) 
   {
     close() ;
+    uint32_t access_flags = ( waitable ? ipc::access::Read_Write : ipc::access::Read_Only ) 
+                          | ( options & ( ipc::access::Populate | ipc::access::Lock ) ) 
+                          ;
 
-    if( !shm_.open( shm_q_name, ipc::access::Read_Only ) ) 
+    if( !shm_.open( shm_q_name, access_flags ) ) 
     { 
       error_ = shm_.last_error() ;
       // std::cout << "ShmQueueReader::open :: Failed to open shm segment" << std::endl ;
       return false ;
     }
   
-    if( !shm_map_.open( shm_, ipc::access::Read_Only ) ) 
+    // The writer creates the segment before sizing it.
+    if( shm_.size() < sizeof( header_t ) ) 
+    { 
+      error_ = EAGAIN ;
+      shm_.close() ;
+      return false ;
+    }
+  
+    if( !shm_map_.open( shm_, access_flags ) ) 
     { 
       error_ = shm_map_.last_error() ;
       // std::cout << "ShmQueueReader::open :: Failed to create mmap over shm segment" << std::endl ;
@@ -115,34 +296,199 @@ namespace swmr {
       return false ;
     }
   
+    // Check the header before touching the queue : the writer may still be 
+    // setting it up, or the segment may hold something else entirely.
+    const header_t * header = shm_map_.cast<header_t>( 0 ) ;
+    error_ = ( header != NULL ) 
+           ? header->validate( queue_kind::Fixed, sizeof( T ), Capacity, TypeHash<T>::value(), shm_map_.size() ) 
+           : EAGAIN 
+           ;
+
+    // Slot alignment isn't recorded in the header, but it changes the size 
+    // of the ring buffer.
+    if( error_ == 0 && header->segment_size_ != sizeof( header_t ) + sizeof( impl_t ) ) 
+      error_ = EINVAL ;
+
+    if( error_ != 0 ) 
+    { 
+      shm_map_.close() ;
+      shm_.close() ;  
+      return false ;
+    }
+
     // TODO: Should I just close the ipc::SharedMemory instance now?
-    impl_ = shm_map_.cast<impl_t>() ;
+    impl_ = shm_map_.cast<impl_t>( sizeof( header_t ) ) ;
     if( impl_ == NULL ) 
     { 
       // std::cout << "Error :: Failed to cast mapped memory to implentation type" << std::endl ;
+      error_ = EINVAL ;
       shm_map_.close() ;
       shm_.close() ;  
       return false ;
     }
   
+    if( ( options & ipc::access::Notify ) && !notify_.attach( shm_q_name ) ) 
+    { error_ = notify_.last_error() ;
+      impl_  = NULL ;
+      shm_map_.close() ;
+      shm_.close() ;  
+      return false ;
+    }
+
+    // Start w/ the oldest message still held by the queue.
+    r_seq_ = impl_->oldest_sequence() ;
+    waitable_ = waitable ;
+
+    // Telemetry is best effort, and never fails the queue.
+    telemetry_.attach( shm_q_name ) ;
     return true ;
   }
   
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
   bool
-  ShmQueueReader<T,T_Capacity>::
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
   read( T & dest ) const
   {
     if( fps_unlikely( NULL == impl_ ) ) 
       return false ;
   
-    if( !impl_->read( r_idx_, dest ) ) 
+    for( ;; ) 
+    { 
+      int32_t status = impl_->read( r_seq_, dest ) ;
+      if( fps_likely( status == read_status::Success ) ) 
+      { ++r_seq_ ;
+        on_read( 1 ) ;
+        return true ;
+      }
+
+      if( status == read_status::Empty ) 
+        return false ;
+
+      on_overrun() ;
+    }
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  uint32_t
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  read_batch( T * dest, uint32_t max_count ) const
+  {
+    if( fps_unlikely( NULL == impl_ ) ) 
+      return 0 ;
+
+    for( ;; ) 
+    { 
+      int32_t  status = read_status::Success ;
+      uint32_t count  = impl_->read_batch( r_seq_, dest, max_count, status ) ;
+      r_seq_ += count ;
+      if( count > 0 ) 
+        on_read( count ) ;
+
+      if( count > 0 || status != read_status::Overrun ) 
+        return count ;
+
+      on_overrun() ;
+    }
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  template<typename T_Visitor>
+  bool
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  visit( T_Visitor && visitor ) const
+  {
+    if( fps_unlikely( NULL == impl_ ) ) 
+      return false ;
+  
+    for( ;; ) 
+    { 
+      int32_t status = impl_->visit( r_seq_, visitor ) ;
+      if( fps_likely( status == read_status::Success ) ) 
+      { ++r_seq_ ;
+        on_read( 1 ) ;
+        return true ;
+      }
+
+      if( status == read_status::Empty ) 
+        return false ;
+
+      on_overrun() ;
+    }
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  bool
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  read_wait( T & dest, uint64_t timeout_nanos ) const
+  {
+    if( fps_likely( read( dest ) ) ) 
+      return true ;
+
+    if( fps_unlikely( NULL == impl_ ) ) 
       return false ;
 
-    r_idx_ = impl_->advance( r_idx_ ) ;
+    uint64_t deadline = ( timeout_nanos > 0 ) ? monotonic_nanos() + timeout_nanos : 0 ;
+    for( uint32_t counter = 0 ;; ++counter ) 
+    { 
+      uint64_t park = park_nanos_ ;
+      if( deadline != 0 ) 
+      { uint64_t now = monotonic_nanos() ;
+        if( now >= deadline ) 
+          return false ;
+        if( deadline - now < park ) 
+          park = deadline - now ;
+      }
+
+      if( counter < spin_limit_ || !waitable_ ) 
+        T_Backoff::wait( counter ) ;
+      else
+        impl_->park( r_seq_, park ) ;
+
+      if( read( dest ) ) 
+        return true ;
+    }
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  bool
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  prepare_wait() const
+  {
+    if( fps_unlikely( NULL == impl_ || !notify_.is_open() ) ) 
+      return false ;
+
+    // Consume the signal that woke us before arming for the next one.
+    notify_.drain() ;
+    notify_.arm() ;
+    if( impl_->write_sequence() > r_seq_ ) 
+    { notify_.disarm() ;
+      return false ;
+    }
     return true ;
   }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Backoff, typename T_Telemetry, typename... T_Opts>
+  void
+  ShmQueueReader<T,T_Capacity,T_Backoff,T_Telemetry,T_Opts...>::
+  on_overrun() const
+  {
+    // The message following r_seq_ is gone, so always skip at least one 
+    // message even if the writer hasn't published its new sequence yet.
+    uint64_t oldest = impl_->oldest_sequence() ;
+    if( oldest <= r_seq_ ) 
+      oldest = r_seq_ + 1 ;
+
+    lost_count_ += ( oldest - r_seq_ ) ;
+    ++overrun_count_ ;
+    telemetry_.on_lost( oldest - r_seq_ ) ;
+    r_seq_ = oldest ;
+  }
 }}}
 
 #endif
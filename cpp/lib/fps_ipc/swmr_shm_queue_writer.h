@@ -2,28 +2,63 @@
 #define FPS__IPC__SWMR_SHM_QUEUE_WRITER__H
 
 #include "fps_ipc/swmr_ring_buffer.h"
+#include "fps_ipc/swmr_queue_header.h"
 #include "fps_fs/path.h"
 #include "fps_ipc/shared_memory.h"
 #include "fps_ipc/mapped_memory.h"
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_ipc/notifier.h"
 
 namespace fps  {
 namespace ipc  {
 namespace swmr {
 
   //--------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  // T_Telemetry selects the instrumentation policy ( see queue_telemetry.h ).
+  // W/ telemetry::Shm the writer creates the queue's stats block in open().
+  // The writer never waits for readers, so it records no depth; reader lag
+  // is recorded by the readers.
+  //
+  // T_Opts are named template parameters for the ring buffer ( see 
+  // fps_ipc/options.h ), eg. opt::Slot_Alignment<64>.  Readers must be built 
+  // w/ the same options.
+  //--------------------------------------------------------------------------
+  template< typename    T
+          , uint32_t    T_Capacity
+          , typename    T_Telemetry = telemetry::None
+          , typename... T_Opts
+          >
   struct ShmQueueWriter
   {
+  public :
+    typedef T_Telemetry telemetry_t ;
+
   private :
     //------------------------------------------------------------------------
-    typedef swmr::detail::RingBuffer<T, T_Capacity> impl_t ;
+    typedef swmr::detail::RingBuffer<T, T_Capacity, T_Opts...> impl_t ;
+    typedef swmr::detail::QueueHeader                           header_t ;
     static const uint32_t Capacity = T_Capacity ;
     
     //------------------------------------------------------------------------
     ipc::SharedMemory shm_ ;
     ipc::MappedMemory shm_map_ ;
     int32_t           error_ ;
+    header_t        * header_ ;
     impl_t          * impl_  ;
+    T_Telemetry       telemetry_ ;
+    notify::Publisher notify_ ;
+
+    //------------------------------------------------------------------------
+    // Report the 'count' messages about to be published.
+    //------------------------------------------------------------------------
+    inline
+    void
+    on_write( uint64_t count )
+    { if( T_Telemetry::Enabled )
+      { uint64_t w_seq = impl_->write_sequence() ;
+        telemetry_.on_write( w_seq + 1, w_seq + 1 + count, 0 ) ;
+      }
+    }
     
   public :
     //------------------------------------------------------------------------
@@ -36,8 +71,16 @@ namespace swmr {
     // Open the indicated shm queue for reading.  
     // Return true on success, false on failure and sets internal error_ 
     // member to the associated system errno value (if possible).
+    //
+    // 'options' may request huge pages, prefaulting, locking and numa 
+    // placement for the segment ( access::Huge_Pages, access::Populate, 
+    // access::Lock and access::numa_node() ).  Prefaulting avoids taking 
+    // page faults while the first lap of the ring is written.
+    //
+    // W/ access::Notify the writer also creates the queue's notify block, so
+    // readers may wait on a file descriptor ( see notifier.h ).
     //------------------------------------------------------------------------
-    bool open( const std::string & shm_q_name ) ;
+    bool open( const std::string & shm_q_name, uint32_t options = 0 ) ;
 
     //------------------------------------------------------------------------
     void close() ;
@@ -45,6 +88,21 @@ namespace swmr {
     //------------------------------------------------------------------------
     bool write( const T & dest ) ;
 
+    //------------------------------------------------------------------------
+    // Write 'count' elements from 'src', publishing the whole span to 
+    // readers at once.  Returns false if the queue isn't open.
+    //------------------------------------------------------------------------
+    bool write_batch( const T * src, uint32_t count ) ;
+
+    //------------------------------------------------------------------------
+    // Zero copy write.  claim() returns a pointer to the next slot's storage
+    // ( NULL if the queue isn't open ) so the message can be built in place, 
+    // and commit() publishes it to readers.  The slot still holds whatever 
+    // message it carried a lap ago, so every field must be assigned.
+    //------------------------------------------------------------------------
+    T  * claim() ;
+    bool commit() ;
+
     //------------------------------------------------------------------------
     inline 
     uint32_t 
@@ -52,10 +110,32 @@ namespace swmr {
     { return ( impl_ != NULL ) ? impl_->write_index() : 0 ; 
     }
 
+    //------------------------------------------------------------------------
+    // Number of readers currently parked in ShmQueueReader::read_wait().
+    //------------------------------------------------------------------------
+    inline 
+    uint32_t 
+    waiter_count() const 
+    { return ( impl_ != NULL ) ? impl_->waiter_count() : 0 ; 
+    }
+
+    //------------------------------------------------------------------------
+    // Bytes occupied by the queue segment ( header + ring buffer ).
+    //------------------------------------------------------------------------
+    static inline uint64_t segment_size() { return sizeof( header_t ) + sizeof( impl_t ) ; }
+
     //------------------------------------------------------------------------
     inline bool     is_open()     const { return impl_ != NULL ; }
     inline int32_t  last_error()  const { return error_ ; }
 
+    //------------------------------------------------------------------------
+    inline const T_Telemetry & telemetry() const { return telemetry_ ; }
+
+    //------------------------------------------------------------------------
+    // Number of times a waiting reader was signalled.
+    //------------------------------------------------------------------------
+    inline uint64_t notify_count() const { return notify_.signals() ; }
+
     //------------------------------------------------------------------------
     // Note: Debug Only
     //------------------------------------------------------------------------
@@ -64,48 +144,58 @@ namespace swmr {
   } ;
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
-  ShmQueueWriter<T,T_Capacity>::
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
   ShmQueueWriter()  
-    : error_( 0 ) 
-    , impl_ ( NULL ) 
+    : error_ ( 0 ) 
+    , header_( NULL ) 
+    , impl_  ( NULL ) 
   { 
   }
     
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
-  ShmQueueWriter<T,T_Capacity>::
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
   ~ShmQueueWriter()  
   {
     close() ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
   void 
-  ShmQueueWriter<T,T_Capacity>::
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
   close()
   {
+    // Let probes know the writer has gone away before unmapping.
+    if( header_ != NULL ) 
+      header_->on_writer_close() ;
+
+    telemetry_.close() ;
+    notify_.close() ;
+
     if( shm_.is_open() ) 
       shm_.close() ;
     
     if( shm_map_.is_open() ) 
       shm_map_.close() ;
 
-    error_ = 0 ;
-    impl_  = NULL ;
+    error_  = 0 ;
+    header_ = NULL ;
+    impl_   = NULL ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
   bool
-  ShmQueueWriter<T,T_Capacity>::
-  open( const std::string & shm_q_name ) 
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
+  open( const std::string & shm_q_name, uint32_t options ) 
   {
     close() ;
     int32_t access_flags = ipc::access::Read_Write 
                          | ipc::access::Create 
                          | ipc::access::Exclusive 
+                         | options 
                          ;
 
     if( !shm_.open( shm_q_name, access_flags ) )
@@ -113,7 +203,7 @@ namespace swmr {
       return false ;
     }
 
-    if( !shm_.resize<impl_t>() ) 
+    if( !shm_.resize( segment_size() ) ) 
     { error_ = shm_.last_error() ;
       shm_.close() ;
       return false ;
@@ -124,28 +214,99 @@ namespace swmr {
       shm_.close() ;
       return false ;
     }
-  
-    // TODO: Should I just close the ipc::SharedMemory instance now?
-    impl_ = shm_map_.construct<impl_t>() ;
-    if( impl_ == NULL ) 
-    { shm_map_.close() ;
-      shm_.close() ;  
+
+    // Unlike telemetry, readers that asked for notification depend on it, so
+    // it's set up before the queue is published.
+    if( ( options & ipc::access::Notify ) && !notify_.create( shm_q_name ) ) 
+    { error_ = notify_.last_error() ;
+      shm_map_.close() ;
+      shm_.close( true ) ;
       return false ;
     }
   
+    // The header goes first so readers can validate the segment before 
+    // touching the queue.  It's only marked initialized once the queue 
+    // itself has been constructed.
+    header_ = shm_map_.construct_at<header_t>( 0 ) ;
+    impl_   = shm_map_.construct_at<impl_t>( sizeof( header_t ) ) ;
+    if( header_ == NULL || impl_ == NULL ) 
+    { header_ = NULL ;
+      impl_   = NULL ;
+      error_  = EINVAL ;
+      notify_.close() ;
+      shm_map_.close() ;
+      shm_.close( true ) ;  
+      return false ;
+    }
+
+    const char * w_seq = reinterpret_cast<const char *>( &impl_->write_sequence_counter() ) ;
+    header_->publish( queue_kind::Fixed
+                    , sizeof( T ) 
+                    , Capacity
+                    , TypeHash<T>::value() 
+                    , segment_size() 
+                    , w_seq - reinterpret_cast<const char *>( header_ ) 
+                    ) ;
+
+    // Telemetry is best effort, and never fails the queue.
+    telemetry_.create( shm_q_name, Capacity ) ;
     return true ;
   }
 
   //------------------------------------------------------------------------
-  template<typename T, uint32_t T_Capacity>
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
   bool 
-  ShmQueueWriter<T,T_Capacity>::
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
   write( const T & src ) 
   {
     if( fps_unlikely( NULL == impl_ ) ) 
       return false ; 
 
+    on_write( 1 ) ;
     impl_->write( src ) ;
+    notify_.notify() ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
+  bool 
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
+  write_batch( const T * src, uint32_t count ) 
+  {
+    if( fps_unlikely( NULL == impl_ ) ) 
+      return false ; 
+
+    on_write( count ) ;
+    impl_->write_batch( src, count ) ;
+    notify_.notify() ;
+    return true ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
+  T *
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
+  claim() 
+  {
+    if( fps_unlikely( NULL == impl_ ) ) 
+      return NULL ; 
+
+    return &( impl_->claim() ) ;
+  }
+
+  //------------------------------------------------------------------------
+  template<typename T, uint32_t T_Capacity, typename T_Telemetry, typename... T_Opts>
+  bool 
+  ShmQueueWriter<T,T_Capacity,T_Telemetry,T_Opts...>::
+  commit() 
+  {
+    if( fps_unlikely( NULL == impl_ ) ) 
+      return false ; 
+
+    on_write( 1 ) ;
+    impl_->commit() ;
+    notify_.notify() ;
     return true ;
   }
 
@@ -0,0 +1,434 @@
+#define BOOST_TEST_MODULE fps_ipc__lock
+
+#include "fps_ipc/spinlock.h"
+#include "fps_ipc/ticket_lock.h"
+#include "fps_ipc/mcs_lock.h"
+#include "fps_ipc/rw_spinlock.h"
+#include "fps_ipc/seqlocked.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_string/format.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const uint32_t Test_Threads     = 4 ;
+static const uint64_t Test_Iterations  = 50000 ;  // Per thread.
+static const char     Test_Shm_Name[]  = "fps_ipc.lock.unit_test" ;
+
+//--------------------------------------------------------------------------------
+// State guarded by the lock under test.  The two counters are updated w/ plain
+// ( non-atomic ) read-modify-writes, so any overlap between critical sections
+// shows up as a miscount or a mismatch.
+//--------------------------------------------------------------------------------
+struct Guarded
+{
+  uint64_t count_ ;
+  uint64_t shadow_ ;
+} ;
+
+//--------------------------------------------------------------------------------
+template<typename T_Lockable>
+inline
+void
+bump( T_Lockable & lock, Guarded & guarded )
+{
+  std::lock_guard<T_Lockable> guard( lock ) ;
+  uint64_t count = guarded.count_ ;
+  guarded.shadow_ = count + 1 ;
+  guarded.count_  = guarded.shadow_ ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__ticket )
+{
+  std::cout << "[ ipc::TicketLock unit tests ]" << std::endl ;
+
+  ipc::TicketLock lock ;
+  BOOST_CHECK( lock.queue_length() == 0 ) ;
+  BOOST_CHECK( lock.try_lock() ) ;
+  BOOST_CHECK( !lock.try_lock() ) ;
+  BOOST_CHECK( lock.queue_length() == 1 ) ;
+  lock.unlock() ;
+  BOOST_CHECK( lock.try_lock() ) ;
+  lock.unlock() ;
+
+  Guarded                  guarded = { 0, 0 } ;
+  std::vector<std::thread> threads ;
+  for( uint32_t idx = 0 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [&]()
+      { for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+          bump( lock, guarded ) ;
+      }
+    ) ;
+  }
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK_MESSAGE
+  ( guarded.count_ == Test_Threads * Test_Iterations && guarded.shadow_ == guarded.count_
+  , string::sprintf( "\n\tipc::TicketLock :: count is %lu, expected %lu", guarded.count_, Test_Threads * Test_Iterations )
+  ) ;
+  BOOST_CHECK( lock.queue_length() == 0 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__mcs )
+{
+  std::cout << "[ ipc::McsLock unit tests ]" << std::endl ;
+
+  //
+  // Slot management.
+  //
+  typedef ipc::McsLock<4> small_t ;
+  small_t * small = new small_t() ;
+  uint32_t  slots[ 4 ] ;
+  for( uint32_t idx = 0 ; idx < 4 ; ++idx )
+    BOOST_CHECK( ( slots[ idx ] = small->attach() ) == idx ) ;
+  BOOST_CHECK( small->attach() == small_t::Invalid_Slot ) ;
+  small->detach( slots[ 2 ] ) ;
+  BOOST_CHECK( small->attach() == 2 ) ;
+
+  BOOST_CHECK( !small->is_locked() ) ;
+  BOOST_CHECK( small->try_lock( 0 ) ) ;
+  BOOST_CHECK( !small->try_lock( 1 ) ) ;
+  BOOST_CHECK( small->is_locked() ) ;
+  small->unlock( 0 ) ;
+  BOOST_CHECK( !small->is_locked() ) ;
+  for( uint32_t idx = 0 ; idx < 4 ; ++idx )
+    small->detach( idx ) ;
+
+  // Handles beyond Max_Slots, and default constructed ones, are invalid and
+  // refuse to lock.
+  {
+    small_t::Handle handles[ 4 ] = { *small, *small, *small, *small } ;
+    small_t::Handle extra( *small ) ;
+    small_t::Handle unbound ;
+    for( uint32_t idx = 0 ; idx < 4 ; ++idx )
+      BOOST_CHECK( handles[ idx ].valid() ) ;
+    BOOST_CHECK( !extra.valid() && extra.slot() == small_t::Invalid_Slot ) ;
+    BOOST_CHECK( !unbound.valid() ) ;
+
+    BOOST_CHECK( !extra.try_lock() && !unbound.try_lock() ) ;
+    BOOST_CHECK_THROW( extra.lock(), except::LogicError ) ;
+    BOOST_CHECK_THROW( unbound.lock(), except::LogicError ) ;
+    BOOST_CHECK_THROW( extra.unlock(), except::LogicError ) ;
+    BOOST_CHECK( !small->is_locked() ) ;
+
+    BOOST_CHECK( handles[ 3 ].try_lock() ) ;
+    handles[ 3 ].unlock() ;
+  }
+  BOOST_CHECK( small->attach() == 0 ) ;
+  delete small ;
+
+  //
+  // Mutual exclusion, w/ the lock and the guarded state in shared memory.
+  //
+  typedef ipc::McsLock<> lock_t ;
+  struct Segment
+  {
+    lock_t  lock_ ;
+    Guarded guarded_ ;
+  } ;
+
+  fs::Path shm_path( "/dev/shm", Test_Shm_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+
+  uint32_t access_flags = ipc::access::Read_Write | ipc::access::Create ;
+  ipc::SharedMemory shm ;
+  ipc::MappedMemory shm_map ;
+  BOOST_REQUIRE( shm.open( Test_Shm_Name, access_flags ) ) ;
+  BOOST_REQUIRE( shm.resize<Segment>() ) ;
+  BOOST_REQUIRE( shm_map.open( shm, access_flags ) ) ;
+
+  Segment * segment = shm_map.construct<Segment>() ;
+  BOOST_REQUIRE( segment != NULL ) ;
+  segment->guarded_.count_  = 0 ;
+  segment->guarded_.shadow_ = 0 ;
+
+  std::vector<std::thread> threads ;
+  for( uint32_t idx = 0 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [segment]()
+      { lock_t::Handle handle( segment->lock_ ) ;
+        if( !handle.valid() )
+          return ;
+        for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+          bump( handle, segment->guarded_ ) ;
+      }
+    ) ;
+  }
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK_MESSAGE
+  ( segment->guarded_.count_ == Test_Threads * Test_Iterations && segment->guarded_.shadow_ == segment->guarded_.count_
+  , string::sprintf( "\n\tipc::McsLock :: count is %lu, expected %lu", segment->guarded_.count_, Test_Threads * Test_Iterations )
+  ) ;
+  BOOST_CHECK( !segment->lock_.is_locked() ) ;
+
+  // Every Handle released its slot.
+  uint32_t slot = segment->lock_.attach() ;
+  BOOST_CHECK( slot == 0 ) ;
+  segment->lock_.detach( slot ) ;
+
+  shm_map.close() ;
+  shm.close( true ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__spinlock )
+{
+  std::cout << "[ ipc::SpinLock unit tests ]" << std::endl ;
+
+  ipc::SpinLock_Atomic    atomic_lock ;
+  ipc::SpinLock_Intrinsic intrinsic_lock ;
+  BOOST_CHECK( atomic_lock.try_lock() && !atomic_lock.try_lock() ) ;
+  BOOST_CHECK( intrinsic_lock.try_lock() && !intrinsic_lock.try_lock() ) ;
+  atomic_lock.unlock() ;
+  intrinsic_lock.unlock() ;
+
+  Guarded                  guarded = { 0, 0 } ;
+  std::vector<std::thread> threads ;
+  for( uint32_t idx = 0 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [&]()
+      { for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+          bump( atomic_lock, guarded ) ;
+      }
+    ) ;
+  }
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK( guarded.count_ == Test_Threads * Test_Iterations ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__backoff )
+{
+  std::cout << "[ ipc::backoff unit tests ]" << std::endl ;
+
+  typedef ipc::backoff::Thread_Stats stats_t ;
+  ipc::backoff::Counters & counters = stats_t::counters() ;
+
+  //
+  // Progressive : 4 spins, 12 pauses, 16 yields, then alternate sleep / yield.
+  //
+  typedef ipc::backoff::Progressive<4, 16, 32, 1000, stats_t> progressive_t ;
+  counters.reset() ;
+  for( uint32_t counter = 0 ; counter < 40 ; ++counter )
+    progressive_t::wait( counter ) ;
+
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Spin  ] == 4 ) ;
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Pause ] == 12 ) ;
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Yield ] == 20 ) ;
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Sleep ] == 4 ) ;
+  BOOST_CHECK( counters.total() == 40 ) ;
+
+  //
+  // No_Sleep never leaves the yield phase.
+  //
+  typedef ipc::backoff::Progressive<4, 16, UINT32_MAX, 1000, stats_t> no_sleep_t ;
+  counters.reset() ;
+  for( uint32_t counter = 0 ; counter < 64 ; ++counter )
+    no_sleep_t::wait( counter ) ;
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Sleep ] == 0 ) ;
+
+  //
+  // Fixed policies.
+  //
+  counters.reset() ;
+  for( uint32_t counter = 0 ; counter < 10 ; ++counter )
+  { ipc::backoff::Spin<stats_t>::wait( counter ) ;
+    ipc::backoff::Exponential<8, stats_t>::wait( counter ) ;
+    ipc::backoff::Yield<stats_t>::wait( counter ) ;
+  }
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Pause ] == 20 ) ;
+  BOOST_CHECK( counters.phase_[ ipc::backoff::phase::Yield ] == 10 ) ;
+
+  //
+  // Counters are per thread.
+  //
+  uint64_t other_total = 1 ;
+  std::thread other( [&other_total]() { other_total = stats_t::counters().total() ; } ) ;
+  other.join() ;
+  BOOST_CHECK( other_total == 0 ) ;
+
+  //
+  // A lock w/ a non-default policy.
+  //
+  ipc::BasicSpinLock_Atomic< ipc::backoff::Spin<> > spin_lock ;
+  Guarded                                           guarded = { 0, 0 } ;
+  std::vector<std::thread>                          threads ;
+  for( uint32_t idx = 0 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [&]()
+      { for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+          bump( spin_lock, guarded ) ;
+      }
+    ) ;
+  }
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK( guarded.count_ == Test_Threads * Test_Iterations ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__rw_spinlock )
+{
+  std::cout << "[ ipc::RWSpinLock unit tests ]" << std::endl ;
+
+  ipc::RWSpinLock lock ;
+  BOOST_CHECK( lock.try_lock_shared() ) ;
+  BOOST_CHECK( lock.try_lock_shared() ) ;
+  BOOST_CHECK( lock.readers() == 2 ) ;
+  BOOST_CHECK( !lock.try_lock() ) ;
+  lock.unlock_shared() ;
+  lock.unlock_shared() ;
+
+  BOOST_CHECK( lock.try_lock() ) ;
+  BOOST_CHECK( lock.is_locked() ) ;
+  BOOST_CHECK( !lock.try_lock_shared() ) ;
+  BOOST_CHECK( !lock.try_lock() ) ;
+  BOOST_CHECK( lock.readers() == 0 ) ;
+  lock.unlock() ;
+  BOOST_CHECK( !lock.is_locked() ) ;
+
+  //
+  // Readers check the guarded state is never seen mid-update while a writer
+  // bumps it.
+  //
+  Guarded                  guarded = { 0, 0 } ;
+  std::atomic<uint64_t>    torn( 0 ) ;
+  std::vector<std::thread> threads ;
+  threads.emplace_back
+  ( [&]()
+    { for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+        bump( lock, guarded ) ;
+    }
+  ) ;
+  for( uint32_t idx = 1 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [&]()
+      { for( uint64_t iter = 0 ; iter < Test_Iterations ; ++iter )
+        { std::shared_lock<ipc::RWSpinLock> guard( lock ) ;
+          if( guarded.count_ != guarded.shadow_ )
+            ++torn ;
+        }
+      }
+    ) ;
+  }
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK( guarded.count_ == Test_Iterations ) ;
+  BOOST_CHECK( torn == 0 ) ;
+  BOOST_CHECK( lock.readers() == 0 && !lock.is_locked() ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__lock__seqlocked )
+{
+  std::cout << "[ ipc::Seqlocked unit tests ]" << std::endl ;
+
+  //
+  // Every field of a Limits holds the same value, so a torn read shows up as
+  // a mismatch.
+  //
+  struct Limits
+  {
+    uint64_t field_[ 24 ] ;
+  } ;
+  typedef ipc::Seqlocked<Limits> seqlocked_t ;
+
+  fs::Path shm_path( "/dev/shm", Test_Shm_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+
+  uint32_t access_flags = ipc::access::Read_Write | ipc::access::Create ;
+  ipc::SharedMemory shm ;
+  ipc::MappedMemory shm_map ;
+  BOOST_REQUIRE( shm.open( Test_Shm_Name, access_flags ) ) ;
+  BOOST_REQUIRE( shm.resize<seqlocked_t>() ) ;
+  BOOST_REQUIRE( shm_map.open( shm, access_flags ) ) ;
+
+  seqlocked_t * limits = shm_map.construct<seqlocked_t>() ;
+  BOOST_REQUIRE( limits != NULL ) ;
+  BOOST_CHECK( limits->version() == 0 ) ;
+  BOOST_CHECK( limits->load().field_[ 0 ] == 0 ) ;
+
+  Limits value ;
+  for( uint32_t idx = 0 ; idx < 24 ; ++idx )
+    value.field_[ idx ] = 7 ;
+  limits->store( value ) ;
+  BOOST_CHECK( limits->version() == 1 ) ;
+  BOOST_CHECK( limits->try_load( value ) && value.field_[ 23 ] == 7 ) ;
+
+  limits->update( []( Limits & v ) { v.field_[ 0 ] = 8 ; } ) ;
+  BOOST_CHECK( limits->load( value ) == 2 ) ;
+  BOOST_CHECK( value.field_[ 0 ] == 8 && value.field_[ 1 ] == 7 ) ;
+
+  //
+  // One writer, several readers.
+  //
+  std::atomic<bool>        done( false ) ;
+  std::atomic<uint64_t>    torn( 0 ) ;
+  std::atomic<uint64_t>    backwards( 0 ) ;
+  std::vector<std::thread> threads ;
+  for( uint32_t idx = 1 ; idx < Test_Threads ; ++idx )
+  { threads.emplace_back
+    ( [&]()
+      { uint64_t last = 0 ;
+        while( !done.load() )
+        { Limits copy = limits->load() ;
+          for( uint32_t field = 1 ; field < 24 ; ++field )
+          { if( copy.field_[ field ] != copy.field_[ 0 ] )
+            { ++torn ;
+              break ;
+            }
+          }
+          if( copy.field_[ 0 ] < last )
+            ++backwards ;
+          last = copy.field_[ 0 ] ;
+        }
+      }
+    ) ;
+  }
+
+  for( uint64_t iter = 10 ; iter < Test_Iterations ; ++iter )
+    limits->update( [iter]( Limits & v ) { for( uint32_t idx = 0 ; idx < 24 ; ++idx ) v.field_[ idx ] = iter ; } ) ;
+  done = true ;
+  for( std::thread & thread : threads )
+    thread.join() ;
+
+  BOOST_CHECK( torn == 0 ) ;
+  BOOST_CHECK( backwards == 0 ) ;
+  BOOST_CHECK( limits->load().field_[ 5 ] == Test_Iterations - 1 ) ;
+
+  shm_map.close() ;
+  shm.close( true ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
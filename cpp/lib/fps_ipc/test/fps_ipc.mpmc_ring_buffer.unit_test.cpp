@@ -0,0 +1,197 @@
+#define BOOST_TEST_MODULE fps_ipc__mpmc_ring_buffer
+
+#include "fps_ipc/mpmc_ring_buffer.h"
+#include "fps_ipc/shared_memory.h"
+#include "fps_ipc/mapped_memory.h"
+#include "fps_string/format.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const uint32_t Test_Capacity     = 1024 ;
+static const uint32_t Test_Producers    = 4 ;
+static const uint64_t Test_Messages     = 100000 ;  // Per producer.
+static const char     Test_Queue_Name[] = "fps_ipc.mpmc_ring_buffer.unit_test" ;
+
+//--------------------------------------------------------------------------------
+// Messages carry the producer id in the high 32 bits, and a per-producer 
+// sequence number ( starting at 1 ) in the low 32 bits.
+//--------------------------------------------------------------------------------
+inline uint64_t make_msg( uint32_t producer, uint32_t seq ) { return ( static_cast<uint64_t>( producer ) << 32 ) | seq ; }
+inline uint32_t producer_of( uint64_t msg ) { return static_cast<uint32_t>( msg >> 32 ) ; }
+inline uint32_t sequence_of( uint64_t msg ) { return static_cast<uint32_t>( msg ) ; }
+
+//--------------------------------------------------------------------------------
+template<typename T_Ring>
+void
+run_producers( T_Ring & ring, std::vector<std::thread> & threads )
+{
+  for( uint32_t producer = 0 ; producer < Test_Producers ; ++producer ) 
+  { threads.emplace_back
+    ( [&ring, producer]()
+      { for( uint32_t seq = 1 ; seq <= Test_Messages ; ++seq ) 
+        { while( !ring.write( make_msg( producer, seq ) ) ) 
+            std::this_thread::yield() ;
+        }
+      }
+    ) ;
+  }
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__mpmc_ring_buffer__basics )
+{
+  std::cout << "[ ipc::mpmc::RingBuffer basic unit tests ]" << std::endl ;
+
+  typedef ipc::mpmc::RingBuffer<uint64_t, 8> ring_t ;
+  ring_t * ring = new ring_t() ;
+
+  uint64_t value = 0 ;
+  BOOST_CHECK( ring->empty() && !ring->read( value ) ) ;
+
+  //
+  // Fill, overfill and drain across several laps.
+  //
+  uint64_t next_write = 1 ;
+  uint64_t next_read  = 1 ;
+  for( uint32_t lap = 0 ; lap < 5 ; ++lap ) 
+  { while( ring->write( next_write ) ) 
+      ++next_write ;
+    BOOST_CHECK_MESSAGE
+    ( ring->size() == ring_t::Capacity 
+    , string::sprintf( "\n\tmpmc::RingBuffer::size() is %lu when full, expected %u", ring->size(), ring_t::Capacity ) 
+    ) ;
+
+    while( ring->read( value ) ) 
+    { BOOST_CHECK( value == next_read ) ;
+      ++next_read ;
+    }
+    BOOST_CHECK( ring->empty() && next_read == next_write ) ;
+  }
+
+  delete ring ;
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__mpsc_ring_buffer__producers )
+{
+  std::cout << "[ ipc::mpsc::RingBuffer multi-producer unit tests ]" << std::endl ;
+
+  typedef ipc::mpsc::RingBuffer<uint64_t, Test_Capacity> ring_t ;
+  ring_t * ring = new ring_t() ;
+
+  std::vector<std::thread> threads ;
+  run_producers( *ring, threads ) ;
+
+  //
+  // Every message arrives exactly once, in order per producer.
+  //
+  std::vector<uint32_t> last_seq( Test_Producers, 0 ) ;
+  uint64_t errors = 0 ;
+  uint64_t msg    = 0 ;
+  for( uint64_t count = 0 ; count < Test_Producers * Test_Messages ; ) 
+  { if( !ring->read( msg ) ) 
+    { std::this_thread::yield() ;
+      continue ;
+    }
+
+    uint32_t producer = producer_of( msg ) ;
+    if( producer >= Test_Producers || sequence_of( msg ) != last_seq[ producer ] + 1 ) 
+      ++errors ;
+    else
+      last_seq[ producer ] = sequence_of( msg ) ;
+    ++count ;
+  }
+
+  for( std::thread & thread : threads ) 
+    thread.join() ;
+
+  BOOST_CHECK_MESSAGE
+  ( errors == 0 
+  , string::sprintf( "\n\tmpsc::RingBuffer delivered %lu messages out of order", errors ) 
+  ) ;
+  BOOST_CHECK( ring->empty() && !ring->read( msg ) ) ;
+
+  delete ring ;
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__mpmc_ring_buffer__shm )
+{
+  std::cout << "[ ipc::mpmc::RingBuffer shared memory unit tests ]" << std::endl ;
+
+  typedef ipc::mpmc::RingBuffer<uint64_t, Test_Capacity> ring_t ;
+
+  fs::Path shm_path( "/dev/shm", Test_Queue_Name ) ;
+  if( shm_path.exists() ) 
+    shm_path.rm() ;
+
+  uint32_t access_flags = ipc::access::Read_Write | ipc::access::Create ;
+  ipc::SharedMemory shm ;
+  ipc::MappedMemory shm_map ;
+  BOOST_REQUIRE( shm.open( Test_Queue_Name, access_flags ) ) ;
+  BOOST_REQUIRE( shm.resize<ring_t>() ) ;
+  BOOST_REQUIRE( shm_map.open( shm, access_flags ) ) ;
+
+  ring_t * ring = shm_map.construct<ring_t>() ;
+  BOOST_REQUIRE( ring != NULL ) ;
+
+  std::vector<std::thread> threads ;
+  run_producers( *ring, threads ) ;
+
+  //
+  // Two consumers share the work.  Each should still see every producer's 
+  // messages in order, and together they should see all of them.
+  //
+  std::atomic<uint64_t> consumed( 0 ) ;
+  std::atomic<uint64_t> errors  ( 0 ) ;
+  std::atomic<uint64_t> checksum( 0 ) ;
+  for( uint32_t consumer = 0 ; consumer < 2 ; ++consumer ) 
+  { threads.emplace_back
+    ( [&]()
+      { std::vector<uint32_t> last_seq( Test_Producers, 0 ) ;
+        uint64_t msg ;
+        while( consumed.load() < Test_Producers * Test_Messages ) 
+        { if( !ring->read( msg ) ) 
+          { std::this_thread::yield() ;
+            continue ;
+          }
+
+          uint32_t producer = producer_of( msg ) ;
+          if( producer >= Test_Producers || sequence_of( msg ) <= last_seq[ producer ] ) 
+            ++errors ;
+          else
+            last_seq[ producer ] = sequence_of( msg ) ;
+          checksum += sequence_of( msg ) ;
+          ++consumed ;
+        }
+      }
+    ) ;
+  }
+
+  for( std::thread & thread : threads ) 
+    thread.join() ;
+
+  BOOST_CHECK( errors == 0 ) ;
+  BOOST_CHECK_MESSAGE
+  ( checksum == Test_Producers * ( Test_Messages * ( Test_Messages + 1 ) / 2 ) 
+  , string::sprintf( "\n\tmpmc::RingBuffer checksum mismatch ( %lu )", checksum.load() ) 
+  ) ;
+  BOOST_CHECK( ring->empty() ) ;
+
+  shm_map.close() ;
+  shm.close( true ) ;
+  if( shm_path.exists() ) 
+    shm_path.rm() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE fps_ipc__notifier
+
+#include "fps_ipc/notifier.h"
+#include "fps_ipc/thread_fifo.h"
+#include "fps_ipc/swmr_shm_queue.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char     Test_Queue_Name[] = "fps_ipc.notifier.unit_test" ;
+static const uint32_t Test_Capacity     = 64 ;
+
+typedef ipc::swmr::ShmQueueWriter<uint64_t, Test_Capacity> writer_t ;
+typedef ipc::swmr::ShmQueueReader<uint64_t, Test_Capacity> reader_t ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_segments()
+{
+  fs::Path shm_path( "/dev/shm", Test_Queue_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+
+  fs::Path notify_path( "/dev/shm", ipc::notify::segment_name( Test_Queue_Name ) ) ;
+  if( notify_path.exists() )
+    notify_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+static
+bool
+readable( int32_t fd )
+{
+  ::pollfd pfd = { fd, POLLIN, 0 } ;
+  return ::poll( &pfd, 1, 0 ) == 1 && ( pfd.revents & POLLIN ) ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__notifier__thread_fifo )
+{
+  std::cout << "[ ipc::ThreadFifo notification unit tests ]" << std::endl ;
+
+  ipc::ThreadFifo<uint64_t> fifo( 16 ) ;
+  BOOST_CHECK( fifo.notify_fd() < 0 && !fifo.prepare_wait() ) ;
+  BOOST_REQUIRE( fifo.enable_notify() ) ;
+  BOOST_REQUIRE( fifo.notify_fd() >= 0 ) ;
+
+  // Nothing is signalled until the reader has found the fifo empty.
+  BOOST_CHECK( fifo.write( 1 ) ) ;
+  BOOST_CHECK( !readable( fifo.notify_fd() ) ) ;
+  BOOST_CHECK( !fifo.prepare_wait() ) ;
+
+  uint64_t value = 0 ;
+  BOOST_CHECK( fifo.read( value ) && value == 1 ) ;
+  BOOST_CHECK( fifo.prepare_wait() ) ;
+  BOOST_CHECK( !readable( fifo.notify_fd() ) ) ;
+
+  // Only the empty to non-empty transition is signalled.
+  BOOST_CHECK( fifo.write( 2 ) ) ;
+  BOOST_CHECK( readable( fifo.notify_fd() ) ) ;
+  uint64_t batch[ 2 ] = { 3, 4 } ;
+  BOOST_CHECK( fifo.try_write_n( batch, 2 ) == 2 ) ;
+
+  uint64_t counter = 0 ;
+  BOOST_CHECK( ::read( fifo.notify_fd(), &counter, sizeof( counter ) ) == sizeof( counter ) ) ;
+  BOOST_CHECK( counter == 1 ) ;
+
+  while( fifo.read( value ) ) ;
+  BOOST_CHECK( value == 4 ) ;
+
+  //
+  // A consumer blocked in epoll_wait() wakes for a producer thread.
+  //
+  int32_t epoll_fd = ::epoll_create1( 0 ) ;
+  BOOST_REQUIRE( epoll_fd >= 0 ) ;
+  ::epoll_event event ;
+  event.events  = EPOLLIN ;
+  event.data.fd = fifo.notify_fd() ;
+  BOOST_REQUIRE( ::epoll_ctl( epoll_fd, EPOLL_CTL_ADD, fifo.notify_fd(), &event ) == 0 ) ;
+
+  static const uint64_t Count = 10000 ;
+  std::thread producer( [&]()
+  { for( uint64_t idx = 1 ; idx <= Count ; ++idx )
+    { while( !fifo.write( idx ) )
+        ;
+      if( idx % 1000 == 0 )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+    }
+  } ) ;
+
+  uint64_t expected = 1 ;
+  bool     ordered  = true ;
+  while( expected <= Count )
+  { while( fifo.read( value ) )
+      ordered &= ( value == expected++ ) ;
+    if( expected <= Count && fifo.prepare_wait() )
+      BOOST_REQUIRE( ::epoll_wait( epoll_fd, &event, 1, 5000 ) == 1 ) ;
+  }
+  producer.join() ;
+  BOOST_CHECK( ordered ) ;
+  ::close( epoll_fd ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__notifier__swmr_shm_queue )
+{
+  std::cout << "[ ipc::swmr::ShmQueue notification unit tests ]" << std::endl ;
+  remove_dangling_segments() ;
+
+  // Readers can't ask for notification the writer didn't enable.
+  writer_t writer ;
+  reader_t reader_a ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( !reader_a.open( Test_Queue_Name, false, ipc::access::Notify ) && reader_a.last_error() == EAGAIN ) ;
+  writer.close() ;
+  remove_dangling_segments() ;
+
+  BOOST_REQUIRE( writer.open( Test_Queue_Name, ipc::access::Notify ) ) ;
+
+  reader_t plain ;
+  BOOST_REQUIRE( plain.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( plain.notify_fd() < 0 && !plain.prepare_wait() ) ;
+
+  reader_t reader_b ;
+  BOOST_REQUIRE( reader_a.open( Test_Queue_Name, false, ipc::access::Notify ) ) ;
+  BOOST_REQUIRE( reader_b.open( Test_Queue_Name, false, ipc::access::Notify ) ) ;
+  BOOST_REQUIRE( reader_a.notify_fd() >= 0 && reader_b.notify_fd() >= 0 ) ;
+
+  // Readers that haven't armed aren't signalled.
+  BOOST_CHECK( writer.write( 1 ) ) ;
+  BOOST_CHECK( writer.notify_count() == 0 ) ;
+  BOOST_CHECK( !reader_a.prepare_wait() ) ;
+
+  uint64_t value = 0 ;
+  BOOST_CHECK( reader_a.read( value ) && reader_b.read( value ) ) ;
+  BOOST_CHECK( reader_a.prepare_wait() && reader_b.prepare_wait() ) ;
+
+  // Each armed reader is signalled once, however many messages follow.
+  BOOST_CHECK( writer.write( 2 ) ) ;
+  uint64_t batch[ 3 ] = { 3, 4, 5 } ;
+  BOOST_CHECK( writer.write_batch( batch, 3 ) ) ;
+  BOOST_CHECK( writer.notify_count() == 2 ) ;
+  BOOST_CHECK( readable( reader_a.notify_fd() ) && readable( reader_b.notify_fd() ) ) ;
+
+  while( reader_a.read( value ) ) ;
+  BOOST_CHECK( value == 5 ) ;
+  BOOST_CHECK( reader_a.prepare_wait() ) ;
+  BOOST_CHECK( !readable( reader_a.notify_fd() ) ) ;
+
+  // A reader that takes over a slot gets a fifo of its own.
+  reader_b.close() ;
+  reader_t reader_c ;
+  BOOST_REQUIRE( reader_c.open( Test_Queue_Name, false, ipc::access::Notify ) ) ;
+  while( reader_c.read( value ) ) ;
+  BOOST_CHECK( reader_c.prepare_wait() ) ;
+
+  uint64_t * slot = writer.claim() ;
+  BOOST_REQUIRE( slot != NULL ) ;
+  *slot = 6 ;
+  BOOST_CHECK( writer.commit() ) ;
+  BOOST_CHECK( writer.notify_count() == 4 ) ;
+  BOOST_CHECK( readable( reader_a.notify_fd() ) && readable( reader_c.notify_fd() ) ) ;
+  BOOST_CHECK( reader_c.read( value ) && value == 6 ) ;
+
+  //
+  // A consumer blocked in epoll_wait() wakes for a producer thread.
+  //
+  while( reader_a.read( value ) ) ;
+  int32_t epoll_fd = ::epoll_create1( 0 ) ;
+  BOOST_REQUIRE( epoll_fd >= 0 ) ;
+  ::epoll_event event ;
+  event.events  = EPOLLIN ;
+  event.data.fd = reader_a.notify_fd() ;
+  BOOST_REQUIRE( ::epoll_ctl( epoll_fd, EPOLL_CTL_ADD, reader_a.notify_fd(), &event ) == 0 ) ;
+
+  // Paced so the reader is never lapped.
+  static const uint64_t Count = 2000 ;
+  std::thread producer( [&]()
+  { for( uint64_t idx = 7 ; idx < 7 + Count ; ++idx )
+    { writer.write( idx ) ;
+      if( idx % 16 == 0 )
+        std::this_thread::sleep_for( std::chrono::microseconds( 200 ) ) ;
+    }
+  } ) ;
+
+  uint64_t expected = 7 ;
+  bool     ordered  = true ;
+  while( expected < 7 + Count )
+  { while( reader_a.read( value ) )
+      ordered &= ( value == expected++ ) ;
+    if( expected < 7 + Count && reader_a.prepare_wait() )
+      BOOST_REQUIRE( ::epoll_wait( epoll_fd, &event, 1, 5000 ) == 1 ) ;
+  }
+  producer.join() ;
+  BOOST_CHECK( ordered ) ;
+  BOOST_CHECK( reader_a.lost_count() == 0 ) ;
+  ::close( epoll_fd ) ;
+
+  // Closing a reader removes its fifo ( reader_a attached first, to slot 0 ).
+  std::string fifo = ipc::notify::fifo_path( Test_Queue_Name, 0 ) ;
+  BOOST_CHECK( fs::Path( fifo ).is_pipe() ) ;
+  reader_a.close() ;
+  reader_c.close() ;
+  plain.close() ;
+  BOOST_CHECK( !fs::Path( fifo ).exists() ) ;
+
+  writer.close() ;
+  remove_dangling_segments() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
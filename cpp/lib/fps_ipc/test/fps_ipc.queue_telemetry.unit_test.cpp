@@ -0,0 +1,217 @@
+#define BOOST_TEST_MODULE fps_ipc__queue_telemetry
+
+#include "fps_ipc/queue_telemetry.h"
+#include "fps_ipc/queue_telemetry_probe.h"
+#include "fps_ipc/thread_fifo.h"
+#include "fps_ipc/spsc_shm_queue.h"
+#include "fps_ipc/swmr_shm_queue.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char Test_Queue_Name[] = "fps_ipc.queue_telemetry.unit_test" ;
+
+//--------------------------------------------------------------------------------
+// Sample every position so latency counts are deterministic.
+//--------------------------------------------------------------------------------
+typedef ipc::telemetry::Shm<0> telemetry_t ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_segments()
+{
+  fs::Path shm_path( "/dev/shm", Test_Queue_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+
+  fs::Path stats_path( "/dev/shm", ipc::telemetry::segment_name( Test_Queue_Name ) ) ;
+  if( stats_path.exists() )
+    stats_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__queue_telemetry__histogram )
+{
+  std::cout << "[ ipc::telemetry::Histogram unit tests ]" << std::endl ;
+
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( 0 ) == 0 ) ;
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( 1 ) == 0 ) ;
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( 2 ) == 1 ) ;
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( 1023 ) == 9 ) ;
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( 1024 ) == 10 ) ;
+  BOOST_CHECK( ipc::telemetry::Histogram::bucket_of( ~0ull ) == 63 ) ;
+
+  ipc::telemetry::Histogram histogram ;
+  histogram.clear() ;
+  BOOST_CHECK( histogram.total() == 0 && histogram.percentile( 0.5 ) == 0 ) ;
+
+  for( uint32_t idx = 0 ; idx < 90 ; ++idx )
+    histogram.record( 100 ) ;
+  for( uint32_t idx = 0 ; idx < 10 ; ++idx )
+    histogram.record( 5000 ) ;
+
+  BOOST_CHECK( histogram.total() == 100 ) ;
+  BOOST_CHECK( histogram.percentile( 0.50 ) == 128 ) ;
+  BOOST_CHECK( histogram.percentile( 0.95 ) == 8192 ) ;
+  BOOST_CHECK( histogram.percentile( 1.00 ) == 8192 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__queue_telemetry__thread_fifo )
+{
+  std::cout << "[ ipc::ThreadFifo telemetry unit tests ]" << std::endl ;
+  remove_dangling_segments() ;
+
+  // Telemetry is opt-in; the default policy publishes nothing.
+  ipc::ThreadFifo<uint64_t> plain( 8 ) ;
+  BOOST_CHECK( !plain.publish_telemetry( Test_Queue_Name ) ) ;
+
+  ipc::ThreadFifo<uint64_t, telemetry_t> fifo( 8 ) ;
+  BOOST_REQUIRE( fifo.publish_telemetry( Test_Queue_Name ) ) ;
+
+  ipc::telemetry::StatsProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( probe.capacity() == 8 && probe.writer_alive() ) ;
+
+  for( uint64_t idx = 0 ; idx < 8 ; ++idx )
+    BOOST_CHECK( fifo.write( idx ) ) ;
+  BOOST_CHECK( !fifo.write( 8 ) ) ;
+
+  uint64_t batch[ 4 ] = { 0 } ;
+  BOOST_CHECK( fifo.try_read_n( batch, 3 ) == 3 ) ;
+  BOOST_CHECK( fifo.try_write_n( batch, 4 ) == 3 ) ;
+
+  uint64_t value = 0 ;
+  while( fifo.read( value ) ) ;
+
+  BOOST_CHECK( probe.writes() == 11 ) ;
+  BOOST_CHECK( probe.full() == 2 ) ;
+  BOOST_CHECK( probe.high_water() == 8 ) ;
+
+  // Each call records at most one latency sample, and a batch write stamps
+  // only its last message : of the 9 read calls, the two that consumed the
+  // leading messages of the 3 message batch found no timestamp.
+  ipc::telemetry::StatsProbe::Reader reader ;
+  BOOST_REQUIRE( probe.reader( 0, reader ) ) ;
+  BOOST_CHECK( reader.alive_ ) ;
+  BOOST_CHECK( reader.reads_ == 11 ) ;
+  BOOST_CHECK( reader.lag_ == 0 ) ;
+  BOOST_CHECK( reader.max_lag_ == 5 ) ;
+  BOOST_CHECK( reader.latency_->total() == 7 ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__queue_telemetry__spsc_shm_queue )
+{
+  std::cout << "[ ipc::spsc::ShmQueue telemetry unit tests ]" << std::endl ;
+  remove_dangling_segments() ;
+
+  ipc::spsc::ShmQueueWriter<uint64_t, 4, telemetry_t> writer ;
+  ipc::spsc::ShmQueueReader<uint64_t, 4, telemetry_t> reader ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( writer.telemetry().is_open() ) ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( reader.telemetry().is_open() ) ;
+
+  // A reader built w/o telemetry still attaches to an instrumented queue.
+  reader.close() ;
+  ipc::spsc::ShmQueueReader<uint64_t, 4> plain_reader ;
+  BOOST_REQUIRE( plain_reader.open( Test_Queue_Name ) ) ;
+  plain_reader.close() ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+
+  for( uint64_t idx = 1 ; idx <= 4 ; ++idx )
+    BOOST_CHECK( writer.write( idx ) ) ;
+  BOOST_CHECK( !writer.write( 5 ) ) ;
+  BOOST_CHECK( writer.claim() == NULL ) ;
+
+  uint64_t value = 0 ;
+  BOOST_CHECK( reader.read( value ) && value == 1 ) ;
+  BOOST_CHECK( reader.front() != NULL ) ;
+  reader.pop() ;
+
+  ipc::telemetry::StatsProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( probe.writes() == 4 && probe.full() == 2 && probe.high_water() == 4 ) ;
+
+  ipc::telemetry::StatsProbe::Reader stats ;
+  uint32_t slots = 0 ;
+  for( uint32_t idx = 0 ; idx < ipc::telemetry::Max_Readers ; ++idx )
+  { if( probe.reader( idx, stats ) )
+      ++slots ;
+  }
+  BOOST_CHECK( slots == 1 ) ;
+  BOOST_REQUIRE( probe.reader( 0, stats ) ) ;
+  BOOST_CHECK( stats.reads_ == 2 && stats.lag_ == 2 && stats.max_lag_ == 3 ) ;
+  BOOST_CHECK( stats.latency_->total() == 2 ) ;
+
+  // The stats block outlives the writer, and releases the reader's slot.
+  reader.close() ;
+  writer.close() ;
+  BOOST_CHECK( probe.writer_pid() == 0 && !probe.reader( 0, stats ) ) ;
+  BOOST_CHECK( probe.writes() == 4 ) ;
+  probe.close() ;
+  remove_dangling_segments() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__queue_telemetry__swmr_shm_queue )
+{
+  std::cout << "[ ipc::swmr::ShmQueue telemetry unit tests ]" << std::endl ;
+  remove_dangling_segments() ;
+
+  static const uint32_t Capacity = 8 ;
+  typedef ipc::swmr::ShmQueueWriter<uint64_t, Capacity, telemetry_t>                   writer_t ;
+  typedef ipc::swmr::ShmQueueReader<uint64_t, Capacity, ipc::backoff::Default, telemetry_t> reader_t ;
+
+  writer_t writer ;
+  reader_t fast ;
+  reader_t slow ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( fast.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( slow.open( Test_Queue_Name ) ) ;
+
+  uint64_t value = 0 ;
+  for( uint64_t idx = 1 ; idx <= 20 ; ++idx )
+  { BOOST_CHECK( writer.write( idx ) ) ;
+    BOOST_CHECK( fast.read( value ) && value == idx ) ;
+  }
+
+  // The slow reader was lapped.
+  while( slow.read( value ) ) ;
+  BOOST_CHECK( slow.lost_count() == 12 ) ;
+
+  ipc::telemetry::StatsProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( probe.writes() == 20 && probe.full() == 0 ) ;
+
+  ipc::telemetry::StatsProbe::Reader stats ;
+  BOOST_REQUIRE( probe.reader( 0, stats ) ) ;
+  BOOST_CHECK( stats.reads_ == 20 && stats.lost_ == 0 && stats.max_lag_ == 0 ) ;
+  BOOST_CHECK( stats.latency_->total() == 20 ) ;
+
+  BOOST_REQUIRE( probe.reader( 1, stats ) ) ;
+  BOOST_CHECK( stats.reads_ == 8 && stats.lost_ == 12 && stats.overruns_ == 1 ) ;
+  BOOST_CHECK( stats.max_lag_ == 7 && stats.lag_ == 0 ) ;
+
+  // A reader's slot is released when it closes.
+  slow.close() ;
+  BOOST_CHECK( !probe.reader( 1, stats ) ) ;
+
+  fast.close() ;
+  writer.close() ;
+  remove_dangling_segments() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -9,6 +9,8 @@
 #include <boost/test/unit_test.hpp>
 #include <thread>
 #include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace fps ;
 
@@ -99,3 +101,97 @@ BOOST_AUTO_TEST_CASE( fps_ipc__shm__basics )
   }
 }
 
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__shm__mapping_options )
+{
+  std::cout << std::endl 
+            << "[ ipc::MappedMemory mapping option unit tests ]" 
+            << std::endl ;
+
+  static const char     Test_Name[] = "fps_ipc.shm.options.unit_test" ;
+  static const uint64_t Test_Size   = 1024 * 1024 ;
+
+  fs::Path test_path( "/dev/shm", Test_Name ) ;
+  if( test_path.exists() ) 
+    test_path.rm() ;
+
+  ipc::SharedMemory shm ;
+  BOOST_REQUIRE( shm.open( Test_Name, ipc::access::Create | ipc::access::Read_Write ) ) ;
+  BOOST_CHECK( !shm.is_huge() && shm.page_size() > 0 ) ;
+
+  //
+  // Segments larger than 4GB ( sparse, so nothing is allocated ).
+  //
+  uint64_t large_size = ( 5ULL << 30 ) ;
+  BOOST_REQUIRE( shm.resize( large_size ) ) ;
+  BOOST_CHECK( shm.size() == large_size ) ;
+  {
+    ipc::MappedMemory shm_map ;
+    BOOST_REQUIRE( shm_map.open( shm, ipc::access::Read_Write ) ) ;
+    BOOST_CHECK( shm_map.size() == large_size ) ;
+
+    uint64_t * tail = shm_map.cast<uint64_t>( large_size - sizeof( uint64_t ) ) ;
+    BOOST_REQUIRE( tail != NULL ) ;
+    *tail = 42 ;
+    BOOST_CHECK( shm_map.cast<uint64_t>( large_size ) == NULL ) ;
+  }
+  std::cout << "|--[ size ( > 4GB ) : " << large_size << " ]" << std::endl ;
+
+  //
+  // Prefaulted, locked and numa bound mappings.
+  //
+  BOOST_REQUIRE( shm.resize( Test_Size ) ) ;
+  {
+    ipc::MappedMemory shm_map ;
+    BOOST_CHECK( shm_map.open( shm, ipc::access::Read_Write | ipc::access::Populate ) ) ;
+    shm_map.close() ;
+
+    // mlock() is subject to RLIMIT_MEMLOCK.
+    bool locked = shm_map.open( shm, ipc::access::Read_Write | ipc::access::Lock ) ;
+    BOOST_CHECK( locked || shm_map.last_error() == EPERM || shm_map.last_error() == ENOMEM || shm_map.last_error() == EAGAIN ) ;
+    std::cout << "|--[ Lock           : " << ( locked ? "ok" : "unavailable" ) << " ]" << std::endl ;
+    shm_map.close() ;
+
+    // Every machine has node 0, but containers may not permit mbind().
+    bool bound = shm_map.open( shm, ipc::access::Read_Write | ipc::access::Populate | ipc::access::numa_node( 0 ) ) ;
+    BOOST_CHECK( bound || shm_map.last_error() == EPERM || shm_map.last_error() == ENOSYS ) ;
+    std::cout << "|--[ numa_node( 0 ) : " << ( bound ? "ok" : "unavailable" ) << " ]" << std::endl ;
+    shm_map.close() ;
+
+    BOOST_CHECK( ipc::access::numa_node_of( ipc::access::numa_node( 3 ) | ipc::access::Lock ) == 3 ) ;
+    BOOST_CHECK( ipc::access::numa_node_of( ipc::access::Read_Write ) == -1 ) ;
+  }
+
+  shm.close( true ) ;
+  BOOST_CHECK( !test_path.exists() ) ;
+
+  //
+  // Huge page segments, if a hugetlbfs mount w/ reserved pages is available.
+  //
+  bool huge = shm.open( Test_Name, ipc::access::Create | ipc::access::Read_Write | ipc::access::Huge_Pages ) ;
+  std::cout << "|--[ Huge_Pages     : " << ( huge ? "ok" : "unavailable" ) << " ]" << std::endl ;
+  if( huge ) 
+  { BOOST_CHECK( shm.is_huge() && shm.page_size() > Test_Size / 1024 ) ;
+    BOOST_CHECK( shm.resize( 1 ) && shm.size() == shm.page_size() ) ;
+
+    // Readers find the segment w/o being told it's on hugetlbfs.
+    ipc::SharedMemory reader ;
+    BOOST_CHECK( reader.open( Test_Name, ipc::access::Read_Only ) && reader.is_huge() ) ;
+    reader.close() ;
+    shm.close( true ) ;
+  }
+  else
+    BOOST_CHECK( shm.last_error() == ENOENT || shm.last_error() == EACCES ) ;
+
+  //
+  // Something other than a segment under the same name fails to open, w/o 
+  // blocking on it.
+  //
+  BOOST_REQUIRE( ::mkfifo( test_path.c_str(), 0600 ) == 0 ) ;
+  BOOST_CHECK( !shm.open( Test_Name, ipc::access::Read_Only ) && shm.last_error() == EINVAL ) ;
+  BOOST_CHECK( !shm.open( Test_Name, ipc::access::Read_Write ) && shm.last_error() == EINVAL ) ;
+  ::unlink( test_path.c_str() ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
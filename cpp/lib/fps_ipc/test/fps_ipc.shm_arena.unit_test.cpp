@@ -0,0 +1,271 @@
+#define BOOST_TEST_MODULE fps_ipc__shm_arena
+
+#include "fps_ipc/shm_arena.h"
+#include "fps_ipc/shm_allocator.h"
+#include "fps_ipc/offset_ptr.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char     Test_Shm_Name[] = "fps_ipc.shm_arena.unit_test" ;
+static const uint64_t Test_Arena_Size = 4 * 1024 * 1024 ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_segment()
+{
+  fs::Path shm_path( "/dev/shm", Test_Shm_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__shm_arena__offset_ptr )
+{
+  std::cout << "[ ipc::OffsetPtr unit tests ]" << std::endl ;
+
+  int values[ 4 ] = { 10, 20, 30, 40 } ;
+
+  ipc::OffsetPtr<int> null_ptr ;
+  BOOST_CHECK( !null_ptr && null_ptr == nullptr && null_ptr.get() == NULL ) ;
+
+  ipc::OffsetPtr<int> ptr( &values[ 1 ] ) ;
+  BOOST_CHECK( ptr && *ptr == 20 && ptr[ 1 ] == 30 ) ;
+
+  // Copies remain valid at a different address.
+  ipc::OffsetPtr<int> * copy = new ipc::OffsetPtr<int>( ptr ) ;
+  BOOST_CHECK( copy->get() == &values[ 1 ] ) ;
+  delete copy ;
+
+  ++ptr ;
+  BOOST_CHECK( *ptr == 30 ) ;
+  ptr -= 2 ;
+  BOOST_CHECK( *ptr == 10 && ( ptr + 3 ) - ptr == 3 ) ;
+  BOOST_CHECK( ptr < ptr + 1 ) ;
+
+  ipc::OffsetPtr<const int>  const_ptr( ptr ) ;
+  ipc::OffsetPtr<void>       void_ptr( ptr ) ;
+  BOOST_CHECK( const_ptr == ptr && void_ptr.get() == &values[ 0 ] ) ;
+  BOOST_CHECK( ipc::static_pointer_cast<int>( void_ptr ) == ptr ) ;
+
+  ptr = nullptr ;
+  BOOST_CHECK( !ptr ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__shm_arena__allocation )
+{
+  std::cout << "[ ipc::ShmArena allocation unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  ipc::ShmArena arena ;
+  BOOST_REQUIRE( arena.create( Test_Shm_Name, Test_Arena_Size ) ) ;
+  BOOST_CHECK( arena.is_open() ) ;
+  BOOST_CHECK( arena.used() == 0 && arena.blocks() == 0 ) ;
+  BOOST_CHECK( arena.capacity() == arena.untouched() ) ;
+
+  // A second create of the same name fails.
+  ipc::ShmArena duplicate ;
+  BOOST_CHECK( !duplicate.create( Test_Shm_Name, Test_Arena_Size ) ) ;
+  BOOST_CHECK( duplicate.last_error() == EEXIST ) ;
+
+  // Payloads are 16 byte aligned and sized to a power of two block.
+  char * small = static_cast<char *>( arena.allocate( 1 ) ) ;
+  char * large = static_cast<char *>( arena.allocate( 1000 ) ) ;
+  BOOST_REQUIRE( small != NULL && large != NULL ) ;
+  BOOST_CHECK( reinterpret_cast<uintptr_t>( small ) % 16 == 0 ) ;
+  BOOST_CHECK( reinterpret_cast<uintptr_t>( large ) % 16 == 0 ) ;
+  BOOST_CHECK( ipc::detail::ArenaHeader::usable_size( small ) == 16 ) ;
+  BOOST_CHECK( ipc::detail::ArenaHeader::usable_size( large ) == 1008 ) ;
+  BOOST_CHECK( arena.used() == 32 + 1024 && arena.blocks() == 2 ) ;
+  std::memset( large, 0xff, 1000 ) ;
+
+  // Freed blocks are reused by allocations of the same class.
+  uint64_t untouched = arena.untouched() ;
+  arena.deallocate( large ) ;
+  BOOST_CHECK( arena.blocks() == 1 ) ;
+  BOOST_CHECK( arena.allocate( 900 ) == large ) ;
+  BOOST_CHECK( arena.untouched() == untouched ) ;
+
+  // Offsets translate back to addresses.
+  BOOST_CHECK( arena.address_of( arena.offset_of( small ) ) == small ) ;
+
+  // Exhaustion.
+  BOOST_CHECK( arena.allocate( Test_Arena_Size ) == NULL ) ;
+  BOOST_CHECK( arena.last_error() == ENOMEM ) ;
+
+  // Named objects.
+  struct Limits
+  {
+    uint64_t max_qty_ ;
+    double   max_notional_ ;
+  } ;
+  Limits * limits = arena.construct<Limits>( "limits", Limits{ 100, 1e6 } ) ;
+  BOOST_REQUIRE( limits != NULL ) ;
+  BOOST_CHECK( arena.find<Limits>( "limits" ) == limits ) ;
+  BOOST_CHECK( arena.construct<Limits>( "limits" ) == NULL && arena.last_error() == EEXIST ) ;
+  BOOST_CHECK( arena.find<uint64_t>( "limits" ) == NULL && arena.last_error() == EINVAL ) ;
+  BOOST_CHECK( arena.find<Limits>( "missing" ) == NULL && arena.last_error() == ENOENT ) ;
+  BOOST_CHECK( arena.find_or_construct<Limits>( "limits" ) == limits ) ;
+  BOOST_CHECK( arena.destroy<Limits>( "limits" ) ) ;
+  BOOST_CHECK( arena.find<Limits>( "limits" ) == NULL ) ;
+  BOOST_CHECK( !arena.destroy<Limits>( "limits" ) ) ;
+
+  // A constructor that throws gives back both the block and the name.
+  struct Throws
+  {
+    uint64_t value_ ;
+    explicit Throws( bool fail ) : value_( 7 ) { if( fail ) throw std::runtime_error( "Throws" ) ; }
+  } ;
+  uint64_t blocks = arena.blocks() ;
+  BOOST_CHECK_THROW( arena.construct<Throws>( "throws", true ), std::runtime_error ) ;
+  BOOST_CHECK( arena.blocks() == blocks ) ;
+  BOOST_CHECK( arena.find<Throws>( "throws" ) == NULL && arena.last_error() == ENOENT ) ;
+  Throws * throws = arena.construct<Throws>( "throws", false ) ;
+  BOOST_REQUIRE( throws != NULL ) ;
+  BOOST_CHECK( throws->value_ == 7 && arena.find<Throws>( "throws" ) == throws ) ;
+  BOOST_CHECK( arena.destroy<Throws>( "throws" ) ) ;
+
+  BOOST_CHECK( arena.close( true ) ) ;
+  BOOST_CHECK( !arena.is_open() ) ;
+
+  // A closed arena fails cleanly.
+  BOOST_CHECK( arena.allocate( 1 ) == NULL && arena.last_error() == EBADF ) ;
+  BOOST_CHECK( arena.find<Limits>( "limits" ) == NULL && arena.last_error() == EBADF ) ;
+  BOOST_CHECK( arena.construct<Limits>( "limits" ) == NULL && arena.last_error() == EBADF ) ;
+  BOOST_CHECK( !arena.destroy<Limits>( "limits" ) && arena.last_error() == EBADF ) ;
+
+  // Opening a segment that isn't an arena fails.
+  ipc::SharedMemory shm ;
+  BOOST_REQUIRE( shm.open( Test_Shm_Name, ipc::access::Read_Write | ipc::access::Create ) ) ;
+  BOOST_REQUIRE( shm.resize( Test_Arena_Size ) ) ;
+  BOOST_CHECK( !arena.open( Test_Shm_Name ) && arena.last_error() == EAGAIN ) ;
+  shm.close( true ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__shm_arena__containers )
+{
+  std::cout << "[ ipc::ShmAllocator unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  typedef ipc::shm::flat_map<ipc::shm::string, uint32_t> symbol_map_t ;
+  typedef ipc::shm::map<uint32_t, ipc::shm::string>      name_map_t ;
+  typedef ipc::shm::vector<uint64_t>                     vector_t ;
+
+  //
+  // Build a symbol table in one mapping of the arena...
+  //
+  ipc::ShmArena writer ;
+  BOOST_REQUIRE( writer.create( Test_Shm_Name, Test_Arena_Size ) ) ;
+  ipc::ShmAllocator<char> alloc( writer ) ;
+
+  symbol_map_t * symbols = writer.construct<symbol_map_t>( "symbols", alloc ) ;
+  name_map_t   * names   = writer.construct<name_map_t>( "names", alloc ) ;
+  vector_t     * prices  = writer.construct<vector_t>( "prices", alloc ) ;
+  BOOST_REQUIRE( symbols != NULL && names != NULL && prices != NULL ) ;
+
+  static const uint32_t Symbol_Count = 2000 ;
+  char buffer[ 32 ] ;
+  for( uint32_t idx = 0 ; idx < Symbol_Count ; ++idx )
+  { ::snprintf( buffer, sizeof( buffer ), "SYM.%u", idx ) ;
+    symbols->emplace( ipc::shm::string( buffer, alloc ), idx ) ;
+    names->emplace( idx, ipc::shm::string( buffer, alloc ) ) ;
+    prices->push_back( idx * 100 ) ;
+  }
+
+  //
+  // ... and read it through a second mapping at a different address.
+  //
+  ipc::ShmArena reader ;
+  BOOST_REQUIRE( reader.open( Test_Shm_Name ) ) ;
+  BOOST_REQUIRE( reader.header() != writer.header() ) ;
+
+  const symbol_map_t * r_symbols = reader.find<symbol_map_t>( "symbols" ) ;
+  const name_map_t   * r_names   = reader.find<name_map_t>( "names" ) ;
+  const vector_t     * r_prices  = reader.find<vector_t>( "prices" ) ;
+  BOOST_REQUIRE( r_symbols != NULL && r_names != NULL && r_prices != NULL ) ;
+  BOOST_CHECK( r_symbols->size() == Symbol_Count ) ;
+  BOOST_CHECK( r_names->size()   == Symbol_Count ) ;
+  BOOST_CHECK( r_prices->size()  == Symbol_Count ) ;
+
+  bool all_found = true ;
+  for( uint32_t idx = 0 ; idx < Symbol_Count ; ++idx )
+  { ::snprintf( buffer, sizeof( buffer ), "SYM.%u", idx ) ;
+    symbol_map_t::const_iterator s_iter = r_symbols->find( ipc::shm::string( buffer, alloc ) ) ;
+    name_map_t::const_iterator   n_iter = r_names->find( idx ) ;
+    if( s_iter == r_symbols->end() || s_iter->second != idx
+     || n_iter == r_names->end()   || std::strcmp( n_iter->second.c_str(), buffer ) != 0
+     || ( *r_prices )[ idx ] != idx * 100
+      )
+      all_found = false ;
+  }
+  BOOST_CHECK( all_found ) ;
+
+  // Everything the containers allocated lies within the arena.
+  BOOST_CHECK( reader.header()->contains( &( *r_prices )[ 0 ] ) ) ;
+  BOOST_CHECK( reader.header()->contains( r_names->begin()->second.c_str() ) ) ;
+
+  //
+  // Tearing the containers down returns their memory.
+  //
+  BOOST_CHECK( writer.destroy<symbol_map_t>( "symbols" ) ) ;
+  BOOST_CHECK( writer.destroy<name_map_t>( "names" ) ) ;
+  BOOST_CHECK( writer.destroy<vector_t>( "prices" ) ) ;
+  BOOST_CHECK( writer.blocks() == 0 && writer.used() == 0 ) ;
+
+  reader.close() ;
+  writer.close( true ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__shm_arena__read_only )
+{
+  std::cout << "[ ipc::ShmArena read only unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  ipc::ShmArena writer ;
+  BOOST_REQUIRE( writer.create( Test_Shm_Name, Test_Arena_Size ) ) ;
+  int * value = writer.construct<int>( "x", 42 ) ;
+  BOOST_REQUIRE( value != NULL ) ;
+
+  // find() takes no lock, so works on a read only mapping.
+  ipc::ShmArena reader ;
+  BOOST_REQUIRE( reader.open( Test_Shm_Name, ipc::access::Read_Only ) ) ;
+  BOOST_CHECK( !reader.is_writable() && writer.is_writable() ) ;
+
+  const int * found = reader.find<int>( "x" ) ;
+  BOOST_REQUIRE( found != NULL ) ;
+  BOOST_CHECK( *found == 42 ) ;
+  BOOST_CHECK( reader.find<int>( "y" ) == NULL && reader.last_error() == ENOENT ) ;
+
+  // Changes made by the writer are seen by the reader.
+  BOOST_CHECK( writer.construct<int>( "y", 7 ) != NULL ) ;
+  BOOST_CHECK( reader.find<int>( "y" ) != NULL && *reader.find<int>( "y" ) == 7 ) ;
+  BOOST_CHECK( writer.destroy<int>( "y" ) ) ;
+  BOOST_CHECK( reader.find<int>( "y" ) == NULL ) ;
+
+  // Everything that writes to the segment is refused.
+  BOOST_CHECK( reader.allocate( 16 ) == NULL && reader.last_error() == EACCES ) ;
+  BOOST_CHECK( reader.construct<int>( "z", 1 ) == NULL && reader.last_error() == EACCES ) ;
+  BOOST_CHECK( !reader.destroy<int>( "x" ) && reader.last_error() == EACCES ) ;
+  BOOST_CHECK( reader.find_or_construct<int>( "x" ) != NULL ) ;
+
+  reader.close() ;
+  writer.close( true ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
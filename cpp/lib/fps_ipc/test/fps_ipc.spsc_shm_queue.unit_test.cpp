@@ -0,0 +1,217 @@
+#define BOOST_TEST_MODULE fps_ipc__spsc_shm_queue
+
+#include "fps_ipc/spsc_shm_queue.h"
+#include "fps_ipc/swmr_shm_queue_probe.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char Test_Queue_Name[] = "fps_ipc.spsc_shm_queue.unit_test" ;
+
+//--------------------------------------------------------------------------------
+struct Message
+{
+  uint64_t seq_ ;
+  uint64_t check_ ;  // ~seq_, to catch torn copies.
+} ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_segment()
+{
+  fs::Path shm_path( "/dev/shm", Test_Queue_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__spsc_shm_queue__basics )
+{
+  std::cout << "[ ipc::spsc::ShmQueue unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  typedef ipc::spsc::ShmQueueWriter<Message> writer_t ;
+  typedef ipc::spsc::ShmQueueReader<Message> reader_t ;
+
+  //
+  // Capacity is chosen at runtime, and 5 rounds up to 8 slots but only 5
+  // messages may be queued.
+  //
+  writer_t writer ;
+  BOOST_CHECK( !writer.open( Test_Queue_Name, 0 ) && writer.last_error() == EINVAL ) ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name, 5 ) ) ;
+  BOOST_CHECK( writer.capacity() == 5 ) ;
+  BOOST_CHECK( writer.shared_memory().size() >= writer_t::segment_size( 5 ) ) ;
+  BOOST_CHECK( !writer.is_reader_attached() ) ;
+
+  // The segment identifies itself to probes.
+  ipc::swmr::ShmQueueProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( probe.kind() == ipc::swmr::queue_kind::Spsc ) ;
+  BOOST_CHECK( probe.capacity() == 5 ) ;
+  probe.close() ;
+
+  reader_t reader ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( writer.is_reader_attached() && reader.is_writer_alive() ) ;
+
+  // Only one reader at a time.
+  reader_t second ;
+  BOOST_CHECK( !second.open( Test_Queue_Name ) && second.last_error() == EBUSY ) ;
+
+  // Readers of another element type or capacity are refused.
+  ipc::spsc::ShmQueueReader<uint64_t>   wrong_type ;
+  ipc::spsc::ShmQueueReader<Message, 8> wrong_capacity ;
+  BOOST_CHECK( !wrong_type.open( Test_Queue_Name ) && wrong_type.last_error() == EINVAL ) ;
+  BOOST_CHECK( !wrong_capacity.open( Test_Queue_Name ) && wrong_capacity.last_error() == EINVAL ) ;
+
+  //
+  // Backpressure rather than overwrite.
+  //
+  Message msg ;
+  for( uint64_t seq = 1 ; seq <= 5 ; ++seq )
+    BOOST_CHECK( writer.write( Message{ seq, ~seq } ) ) ;
+  BOOST_CHECK( !writer.write( Message{ 6, ~6ull } ) ) ;
+  BOOST_CHECK( writer.claim() == NULL ) ;
+  BOOST_CHECK( writer.size() == 5 && reader.size() == 5 ) ;
+
+  BOOST_CHECK( reader.read( msg ) && msg.seq_ == 1 ) ;
+  BOOST_CHECK( writer.emplace( Message{ 6, ~6ull } ) ) ;
+  BOOST_CHECK( !writer.write( Message{ 7, ~7ull } ) ) ;
+
+  Message batch[ 8 ] ;
+  BOOST_CHECK( reader.read_batch( batch, 8 ) == 5 ) ;
+  BOOST_CHECK( batch[ 0 ].seq_ == 2 && batch[ 4 ].seq_ == 6 ) ;
+  BOOST_CHECK( !reader.read( msg ) && reader.front() == NULL ) ;
+
+  //
+  // Batches are truncated to the free space.
+  //
+  for( uint64_t idx = 0 ; idx < 8 ; ++idx )
+    batch[ idx ] = Message{ 7 + idx, ~( 7 + idx ) } ;
+  BOOST_CHECK( writer.write_batch( batch, 8 ) == 5 ) ;
+  BOOST_CHECK( reader.read_batch( batch, 2 ) == 2 && batch[ 1 ].seq_ == 8 ) ;
+
+  //
+  // Zero copy.
+  //
+  Message * slot = writer.claim() ;
+  BOOST_REQUIRE( slot != NULL ) ;
+  slot->seq_   = 12 ;
+  slot->check_ = ~12ull ;
+  writer.commit() ;
+
+  for( uint64_t seq = 9 ; seq <= 12 ; ++seq )
+  { const Message * next = reader.front() ;
+    BOOST_REQUIRE( next != NULL ) ;
+    BOOST_CHECK( next->seq_ == seq ) ;
+    reader.pop() ;
+  }
+  BOOST_CHECK( reader.front() == NULL ) ;
+  BOOST_CHECK( writer.write_count() == 12 && reader.read_count() == 12 ) ;
+
+  //
+  // A reader that detaches and reattaches picks up where it left off.
+  //
+  BOOST_CHECK( writer.write( Message{ 13, ~13ull } ) ) ;
+  reader.close() ;
+  BOOST_CHECK( !writer.is_reader_attached() ) ;
+  BOOST_REQUIRE( second.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( second.read( msg ) && msg.seq_ == 13 ) ;
+  second.close() ;
+
+  writer.close() ;
+  remove_dangling_segment() ;
+
+  //
+  // Compile-time capacity.
+  //
+  typedef ipc::spsc::ShmQueueWriter<Message, 4> fixed_writer_t ;
+  fixed_writer_t fixed ;
+  BOOST_CHECK( !fixed.open( Test_Queue_Name, 3 ) && fixed.last_error() == EINVAL ) ;
+  BOOST_REQUIRE( fixed.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( fixed.capacity() == 4 ) ;
+
+  ipc::spsc::ShmQueueReader<Message, 4> fixed_reader ;
+  BOOST_REQUIRE( fixed_reader.open( Test_Queue_Name ) ) ;
+  for( uint64_t seq = 1 ; seq <= 4 ; ++seq )
+    BOOST_CHECK( fixed.write( Message{ seq, ~seq } ) ) ;
+  BOOST_CHECK( !fixed.write( Message{ 5, ~5ull } ) ) ;
+  BOOST_CHECK( fixed_reader.read( msg ) && msg.seq_ == 1 ) ;
+
+  fixed_reader.close() ;
+  fixed.close() ;
+  remove_dangling_segment() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__spsc_shm_queue__lossless )
+{
+  std::cout << "[ ipc::spsc::ShmQueue lossless transfer ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  static const uint64_t Message_Count = 1000000 ;
+
+  ipc::spsc::ShmQueueWriter<Message, 1024> writer ;
+  ipc::spsc::ShmQueueReader<Message, 1024> reader ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+
+  std::thread producer
+  ( [&writer]()
+    { Message batch[ 16 ] ;
+      uint64_t seq = 1 ;
+      while( seq <= Message_Count )
+      { if( seq % 3 == 0 )
+        { if( writer.write( Message{ seq, ~seq } ) )
+            ++seq ;
+          else
+            std::this_thread::yield() ;
+          continue ;
+        }
+
+        uint32_t count = 0 ;
+        for( ; count < 16 && seq + count <= Message_Count ; ++count )
+          batch[ count ] = Message{ seq + count, ~( seq + count ) } ;
+        uint32_t written = writer.write_batch( batch, count ) ;
+        if( written == 0 )
+          std::this_thread::yield() ;
+        seq += written ;
+      }
+    }
+  ) ;
+
+  uint64_t expected = 1 ;
+  uint64_t errors   = 0 ;
+  Message  batch[ 32 ] ;
+  while( expected <= Message_Count )
+  { uint32_t count = reader.read_batch( batch, 32 ) ;
+    if( count == 0 )
+    { std::this_thread::yield() ;
+      continue ;
+    }
+    for( uint32_t idx = 0 ; idx < count ; ++idx, ++expected )
+    { if( batch[ idx ].seq_ != expected || batch[ idx ].check_ != ~expected )
+        ++errors ;
+    }
+  }
+  producer.join() ;
+
+  BOOST_CHECK( errors == 0 ) ;
+  BOOST_CHECK( reader.size() == 0 ) ;
+  BOOST_CHECK( reader.read_count() == Message_Count && writer.write_count() == Message_Count ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_dangling_segment() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -0,0 +1,258 @@
+#define BOOST_TEST_MODULE fps_ipc__swmr_conflating_store
+
+#include "fps_ipc/swmr_shm_conflating_store.h"
+#include "fps_ipc/swmr_shm_queue_probe.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char Test_Store_Name[] = "fps_ipc.swmr_conflating_store.unit_test" ;
+
+//--------------------------------------------------------------------------------
+struct Quote
+{
+  uint64_t bid_ ;
+  uint64_t ask_ ;   // ~bid_, to catch torn copies.
+} ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_segment()
+{
+  fs::Path shm_path( "/dev/shm", Test_Store_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+static
+Quote
+make_quote( uint64_t bid )
+{ Quote rv = { bid, ~bid } ;
+  return rv ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_conflating_store__basics )
+{
+  std::cout << "[ ipc::swmr::ShmConflatingStore unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  static const uint32_t Keys = 16 ;
+  typedef ipc::swmr::ShmConflatingStoreWriter<Quote, Keys, 64> writer_t ;
+  typedef ipc::swmr::ShmConflatingStoreReader<Quote, Keys, 64> reader_t ;
+
+  writer_t writer ;
+  BOOST_REQUIRE( writer.open( Test_Store_Name ) ) ;
+  BOOST_CHECK( writer.shared_memory().size() >= writer_t::segment_size() ) ;
+
+  // The segment identifies itself to probes.
+  ipc::swmr::ShmQueueProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Store_Name ) ) ;
+  BOOST_CHECK( probe.kind() == ipc::swmr::queue_kind::Conflating ) ;
+  BOOST_CHECK( probe.capacity() == Keys ) ;
+  probe.close() ;
+
+  // Readers must agree on the key count and dirty ring capacity.
+  ipc::swmr::ShmConflatingStoreReader<Quote, Keys * 2, 64> wrong_keys ;
+  BOOST_CHECK( !wrong_keys.open( Test_Store_Name ) && wrong_keys.last_error() == EINVAL ) ;
+  ipc::swmr::ShmConflatingStoreReader<Quote, Keys, 128> wrong_ring ;
+  BOOST_CHECK( !wrong_ring.open( Test_Store_Name ) && wrong_ring.last_error() == EINVAL ) ;
+
+  BOOST_CHECK( !writer.write( Keys, make_quote( 1 ) ) ) ;
+  BOOST_CHECK( writer.claim( Keys ) == NULL ) ;
+  BOOST_CHECK( !writer.commit() ) ;
+
+  reader_t reader ;
+  BOOST_REQUIRE( reader.open( Test_Store_Name ) ) ;
+
+  Quote quote ;
+  BOOST_CHECK( !reader.read( 3, quote ) ) ;
+
+  std::vector<uint64_t> seen( Keys, 0 ) ;
+  auto visitor = [&]( uint32_t key, const Quote & value ) { ++seen[ key ] ; quote = value ; } ;
+  BOOST_CHECK( reader.poll( visitor ) == 0 ) ;
+
+  // Many updates to few keys are delivered once per key, w/ the latest value.
+  for( uint64_t idx = 1 ; idx <= 10 ; ++idx )
+  { BOOST_CHECK( writer.write( 3, make_quote( idx ) ) ) ;
+    BOOST_CHECK( writer.write( 5, make_quote( idx * 100 ) ) ) ;
+  }
+  BOOST_CHECK( writer.sequence() == 20 && reader.lag() == 20 ) ;
+
+  // More updates than keys, so this is a full scan.
+  BOOST_CHECK( reader.poll( visitor ) == 2 ) ;
+  BOOST_CHECK( seen[ 3 ] == 1 && seen[ 5 ] == 1 ) ;
+  BOOST_CHECK( reader.sequence() == 20 && reader.lag() == 0 ) ;
+  BOOST_CHECK( reader.resync_count() == 1 ) ;
+
+  BOOST_CHECK( reader.read( 3, quote ) && quote.bid_ == 10 ) ;
+  BOOST_CHECK( reader.read( 5, quote ) && quote.bid_ == 1000 ) ;
+
+  // A few updates are found via the dirty ring.
+  for( uint64_t idx = 11 ; idx <= 13 ; ++idx )
+    BOOST_CHECK( writer.write( 7, make_quote( idx ) ) ) ;
+  BOOST_CHECK( writer.write( 3, make_quote( 14 ) ) ) ;
+
+  std::fill( seen.begin(), seen.end(), 0 ) ;
+  BOOST_CHECK( reader.poll( visitor ) == 2 ) ;
+  BOOST_CHECK( seen[ 7 ] == 1 && seen[ 3 ] == 1 ) ;
+  BOOST_CHECK( reader.resync_count() == 1 ) ;
+  BOOST_CHECK( reader.read( 7, quote ) && quote.bid_ == 13 ) ;
+
+  // In place updates.
+  Quote * slot = writer.claim( 7 ) ;
+  BOOST_REQUIRE( slot != NULL ) ;
+  BOOST_CHECK( slot->bid_ == 13 ) ;
+  *slot = make_quote( 15 ) ;
+  BOOST_CHECK( writer.commit() ) ;
+  BOOST_CHECK( !writer.commit() ) ;
+
+  BOOST_CHECK( reader.poll( visitor ) == 1 ) ;
+  BOOST_CHECK( quote.bid_ == 15 && quote.ask_ == ~15ull ) ;
+
+  // A late reader starts w/ a snapshot of every key written so far.
+  reader_t late ;
+  BOOST_REQUIRE( late.open( Test_Store_Name ) ) ;
+  std::fill( seen.begin(), seen.end(), 0 ) ;
+  BOOST_CHECK( late.poll( visitor ) == 3 ) ;
+  BOOST_CHECK( seen[ 3 ] == 1 && seen[ 5 ] == 1 && seen[ 7 ] == 1 ) ;
+
+  late.close() ;
+  reader.close() ;
+  writer.close() ;
+  remove_dangling_segment() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_conflating_store__lapped )
+{
+  std::cout << "[ ipc::swmr::ShmConflatingStore lapped reader unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  // More keys than dirty ring entries, so a reader can fall off the ring
+  // before a full scan becomes the cheaper option.
+  static const uint32_t Keys = 256 ;
+  ipc::swmr::ShmConflatingStoreWriter<Quote, Keys, 16> writer ;
+  ipc::swmr::ShmConflatingStoreReader<Quote, Keys, 16> reader ;
+  BOOST_REQUIRE( writer.open( Test_Store_Name ) ) ;
+  BOOST_REQUIRE( reader.open( Test_Store_Name ) ) ;
+
+  std::vector<uint64_t> seen( Keys, 0 ) ;
+  auto visitor = [&]( uint32_t key, const Quote & value ) { seen[ key ] = value.bid_ ; } ;
+
+  for( uint32_t key = 0 ; key < 15 ; ++key )
+    BOOST_CHECK( writer.write( key, make_quote( key + 1 ) ) ) ;
+  BOOST_CHECK( reader.poll( visitor ) == 15 ) ;
+  BOOST_CHECK( reader.resync_count() == 0 ) ;
+
+  // 40 updates to 40 distinct keys laps the 16 entry ring.
+  for( uint32_t key = 100 ; key < 140 ; ++key )
+    BOOST_CHECK( writer.write( key, make_quote( key + 1 ) ) ) ;
+  BOOST_CHECK( reader.poll( visitor ) == 40 ) ;
+  BOOST_CHECK( reader.resync_count() == 1 ) ;
+  for( uint32_t key = 100 ; key < 140 ; ++key )
+    BOOST_CHECK( seen[ key ] == key + 1 ) ;
+
+  // Nothing is delivered twice once the reader has caught up.
+  BOOST_CHECK( reader.poll( visitor ) == 0 ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_dangling_segment() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_conflating_store__lapped_by_one )
+{
+  std::cout << "[ ipc::swmr::ConflatingStore lapped by one entry unit tests ]" << std::endl ;
+
+  // A reader takes the write sequence, then the writer laps the ring by
+  // exactly one entry before the walk begins : the entry for r_seq + 1 is
+  // overwritten, but the write sequence hasn't yet moved past
+  // r_seq + Dirty_Capacity.
+  static const uint32_t Keys = 64 ;
+  static const uint32_t Ring = 8 ;
+  typedef ipc::swmr::detail::ConflatingStore<Quote, Keys, Ring> store_t ;
+  store_t * store = new store_t() ;
+
+  store->write( 0, make_quote( 1 ) ) ;
+  store->write( 1, make_quote( 2 ) ) ;
+  uint64_t w_seq = store->write_sequence() ;
+
+  for( uint32_t key = 10 ; key < 10 + Ring - 2 ; ++key )
+    store->write( key, make_quote( key ) ) ;
+  BOOST_REQUIRE( store->write_sequence() == Ring ) ;
+  store->append( 20, Ring + 1 ) ;   // Writer paused before advance().
+
+  std::vector<uint64_t> seen( Keys, 0 ) ;
+  auto     visitor  = [&]( uint32_t key, const Quote & value ) { seen[ key ] = value.bid_ ; } ;
+  uint64_t r_seq    = 0 ;
+  bool     resynced = false ;
+  store->poll( r_seq, w_seq, visitor, resynced ) ;
+  BOOST_CHECK( resynced ) ;
+  BOOST_CHECK( r_seq == w_seq ) ;
+
+  // Key 0's entry was overwritten, so only the rescan can deliver it.
+  BOOST_CHECK( seen[ 0 ] == 1 && seen[ 1 ] == 2 ) ;
+
+  delete store ;
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_conflating_store__concurrent )
+{
+  std::cout << "[ ipc::swmr::ShmConflatingStore concurrency unit tests ]" << std::endl ;
+  remove_dangling_segment() ;
+
+  static const uint32_t Keys         = 64 ;
+  static const uint64_t Update_Count = 200000 ;
+  ipc::swmr::ShmConflatingStoreWriter<Quote, Keys, 256> writer ;
+  ipc::swmr::ShmConflatingStoreReader<Quote, Keys, 256> reader ;
+  BOOST_REQUIRE( writer.open( Test_Store_Name ) ) ;
+  BOOST_REQUIRE( reader.open( Test_Store_Name ) ) ;
+
+  // Key k's n'th update carries bid n * Keys + k, so per key values only
+  // ever increase.  The reader must never see a torn or stale value, and
+  // must end up w/ every key's final value.
+  std::thread producer( [&]()
+  { for( uint64_t idx = 0 ; idx < Update_Count ; ++idx )
+      writer.write( idx % Keys, make_quote( idx ) ) ;
+  } ) ;
+
+  std::vector<uint64_t> latest( Keys, 0 ) ;
+  bool torn  = false ;
+  bool stale = false ;
+  auto visitor = [&]( uint32_t key, const Quote & value )
+  { torn  |= ( value.ask_ != ~value.bid_ || value.bid_ % Keys != key ) ;
+    stale |= ( value.bid_ < latest[ key ] ) ;
+    latest[ key ] = value.bid_ ;
+  } ;
+
+  while( reader.sequence() < Update_Count )
+    reader.poll( visitor ) ;
+  producer.join() ;
+
+  BOOST_CHECK( !torn ) ;
+  BOOST_CHECK( !stale ) ;
+  for( uint32_t key = 0 ; key < Keys ; ++key )
+    BOOST_CHECK( latest[ key ] == Update_Count - Keys + key ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_dangling_segment() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -0,0 +1,574 @@
+#define BOOST_TEST_MODULE fps_ipc__swmr_shm_queue
+
+#include "fps_ipc/swmr_shm_queue.h"
+#include "fps_ipc/swmr_shm_byte_queue.h"
+#include "fps_ipc/swmr_shm_queue_probe.h"
+#include "fps_string/format.h"
+#include "fps_fs/path.h"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const uint32_t Test_Capacity     = 64 ;
+static const char     Test_Queue_Name[] = "fps_ipc.swmr_shm_queue.unit_test" ;
+
+typedef ipc::swmr::ShmQueueWriter<uint64_t, Test_Capacity> writer_t ;
+typedef ipc::swmr::ShmQueueReader<uint64_t, Test_Capacity> reader_t ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_test_queue()
+{
+  fs::Path shm_path( "/dev/shm", Test_Queue_Name ) ;
+  if( shm_path.exists() )
+    shm_path.rm() ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__batch )
+{
+  std::cout << "[ ipc::swmr::ShmQueue batch unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  writer_t writer ;
+  reader_t reader ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name ), "\n\tShmQueueWriter::open() failed" ) ;
+  BOOST_REQUIRE_MESSAGE( reader.open( Test_Queue_Name ), "\n\tShmQueueReader::open() failed" ) ;
+
+  std::vector<uint64_t> src( 40 ) ;
+  std::vector<uint64_t> dst( Test_Capacity ) ;
+  uint64_t next_seq = 1 ;
+  uint64_t read_seq = 1 ;
+
+  //
+  // Write and drain several batches that straddle the end of the ring.
+  //
+  for( uint32_t pass = 0 ; pass < 5 ; ++pass )
+  {
+    for( auto & value : src )
+      value = next_seq++ ;
+    BOOST_CHECK( writer.write_batch( src.data(), src.size() ) ) ;
+
+    uint32_t total = 0 ;
+    while( uint32_t count = reader.read_batch( dst.data(), 16 ) )
+    {
+      BOOST_CHECK_MESSAGE
+      ( count <= 16
+      , string::sprintf( "\n\tShmQueueReader::read_batch() returned %u elements (max 16)", count )
+      ) ;
+
+      for( uint32_t idx = 0 ; idx < count ; ++idx, ++read_seq )
+      { BOOST_CHECK_MESSAGE
+        ( dst[ idx ] == read_seq
+        , string::sprintf( "\n\tShmQueueReader::read_batch() sequencing error %lu != %lu", dst[ idx ], read_seq )
+        ) ;
+      }
+      total += count ;
+    }
+
+    BOOST_CHECK_MESSAGE
+    ( total == src.size()
+    , string::sprintf( "\n\tShmQueueReader::read_batch() drained %u elements - expected %u"
+                     , total
+                     , static_cast<uint32_t>( src.size() )
+                     )
+    ) ;
+  }
+
+  //
+  // Single element reads and batch reads must share a read index.
+  //
+  BOOST_CHECK( writer.write( next_seq ) ) ;
+  BOOST_CHECK( writer.write( next_seq + 1 ) ) ;
+  uint64_t value = 0 ;
+  BOOST_CHECK( reader.read( value ) && value == next_seq ) ;
+  BOOST_CHECK( reader.read_batch( dst.data(), dst.size() ) == 1 && dst[ 0 ] == next_seq + 1 ) ;
+  BOOST_CHECK( reader.read_batch( dst.data(), dst.size() ) == 0 ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__overrun )
+{
+  std::cout << "[ ipc::swmr::ShmQueue overrun unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  writer_t writer ;
+  reader_t reader ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name ), "\n\tShmQueueWriter::open() failed" ) ;
+  BOOST_REQUIRE_MESSAGE( reader.open( Test_Queue_Name ), "\n\tShmQueueReader::open() failed" ) ;
+
+  //
+  // Lap the reader twice and a bit.  The reader should skip straight to the
+  // oldest message still held by the queue and account for everything it missed.
+  //
+  const uint64_t total = ( Test_Capacity * 2 ) + 5 ;
+  for( uint64_t seq = 1 ; seq <= total ; ++seq )
+    writer.write( seq ) ;
+
+  BOOST_CHECK_MESSAGE
+  ( reader.lag() == total
+  , string::sprintf( "\n\tShmQueueReader::lag() returned %lu - expected %lu", reader.lag(), total )
+  ) ;
+
+  uint64_t value = 0 ;
+  BOOST_REQUIRE( reader.read( value ) ) ;
+
+  const uint64_t expected_lost = total - Test_Capacity ;
+  BOOST_CHECK_MESSAGE
+  ( value == expected_lost + 1
+  , string::sprintf( "\n\tShmQueueReader::read() returned %lu after overrun - expected %lu", value, expected_lost + 1 )
+  ) ;
+  BOOST_CHECK_MESSAGE
+  ( reader.lost_count() == expected_lost
+  , string::sprintf( "\n\tShmQueueReader::lost_count() returned %lu - expected %lu", reader.lost_count(), expected_lost )
+  ) ;
+  BOOST_CHECK( reader.overrun_count() == 1 ) ;
+
+  //
+  // The remainder of the ring should be readable in order, w/ no further loss.
+  //
+  uint64_t next = value + 1 ;
+  while( reader.read( value ) )
+  { BOOST_CHECK_MESSAGE
+    ( value == next
+    , string::sprintf( "\n\tShmQueueReader::read() sequencing error %lu != %lu", value, next )
+    ) ;
+    ++next ;
+  }
+  BOOST_CHECK( next == total + 1 ) ;
+  BOOST_CHECK( reader.sequence() == total ) ;
+  BOOST_CHECK( reader.lost_count() == expected_lost ) ;
+
+  //
+  // A batch read that gets lapped should resynchronize the same way.
+  //
+  for( uint64_t seq = total + 1 ; seq <= total + Test_Capacity + 10 ; ++seq )
+    writer.write( seq ) ;
+
+  std::vector<uint64_t> dst( Test_Capacity ) ;
+  uint32_t count = reader.read_batch( dst.data(), dst.size() ) ;
+  BOOST_CHECK( count == Test_Capacity ) ;
+  BOOST_CHECK( count > 0 && dst[ 0 ] == total + 11 ) ;
+  BOOST_CHECK( reader.lost_count() == expected_lost + 10 ) ;
+  BOOST_CHECK( reader.overrun_count() == 2 ) ;
+
+  //
+  // A reader that attaches late starts w/ the oldest message, not a loss.
+  //
+  reader_t late_reader ;
+  BOOST_REQUIRE( late_reader.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( late_reader.read( value ) && value == total + 11 ) ;
+  BOOST_CHECK( late_reader.lost_count() == 0 ) ;
+
+  late_reader.close() ;
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+struct Snapshot
+{
+  uint64_t seq_ ;
+  uint64_t levels_[ 31 ] ;
+} ;
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__claim_visit )
+{
+  std::cout << "[ ipc::swmr::ShmQueue claim/commit & visit unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  ipc::swmr::ShmQueueWriter<Snapshot, Test_Capacity> writer ;
+  ipc::swmr::ShmQueueReader<Snapshot, Test_Capacity> reader ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name ), "\n\tShmQueueWriter::open() failed" ) ;
+  BOOST_REQUIRE_MESSAGE( reader.open( Test_Queue_Name ), "\n\tShmQueueReader::open() failed" ) ;
+
+  //
+  // Build messages in place across more than one lap of the ring.
+  //
+  uint64_t next_seq = 1 ;
+  for( uint32_t pass = 0 ; pass < 3 ; ++pass )
+  {
+    for( uint32_t idx = 0 ; idx < ( Test_Capacity / 2 ) ; ++idx, ++next_seq )
+    { Snapshot * snap = writer.claim() ;
+      BOOST_REQUIRE( snap != NULL ) ;
+      snap->seq_ = next_seq ;
+      for( uint32_t lvl = 0 ; lvl < 31 ; ++lvl )
+        snap->levels_[ lvl ] = next_seq * 100 + lvl ;
+      BOOST_CHECK( writer.commit() ) ;
+    }
+
+    //
+    // Pull only the fields we care about out of each message.
+    //
+    uint64_t seq = 0 ;
+    uint64_t top = 0 ;
+    auto visitor = [&]( const Snapshot & snap ) { seq = snap.seq_ ; top = snap.levels_[ 0 ] ; } ;
+
+    uint64_t expected = next_seq - ( Test_Capacity / 2 ) ;
+    while( reader.visit( visitor ) )
+    { BOOST_CHECK_MESSAGE
+      ( seq == expected && top == expected * 100
+      , string::sprintf( "\n\tShmQueueReader::visit() saw seq %lu / top %lu - expected %lu", seq, top, expected )
+      ) ;
+      ++expected ;
+    }
+    BOOST_CHECK( expected == next_seq ) ;
+  }
+
+  //
+  // Copying reads see in-place writes too.
+  //
+  Snapshot * snap = writer.claim() ;
+  snap->seq_ = next_seq ;
+  writer.commit() ;
+
+  Snapshot copy ;
+  BOOST_CHECK( reader.read( copy ) && copy.seq_ == next_seq ) ;
+  BOOST_CHECK( reader.lost_count() == 0 ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__read_wait )
+{
+  std::cout << "[ ipc::swmr::ShmQueue read_wait unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  writer_t writer ;
+  reader_t reader ;
+  reader_t poller ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name ), "\n\tShmQueueWriter::open() failed" ) ;
+  BOOST_REQUIRE_MESSAGE( reader.open( Test_Queue_Name, true ), "\n\tShmQueueReader::open( waitable ) failed" ) ;
+  BOOST_REQUIRE_MESSAGE( poller.open( Test_Queue_Name ), "\n\tShmQueueReader::open() failed" ) ;
+  BOOST_CHECK( reader.is_waitable() && !poller.is_waitable() ) ;
+
+  //
+  // Timeouts w/ nothing to read, whether parked or polling.
+  //
+  uint64_t value = 0 ;
+  reader.set_wait_policy( 4 ) ;
+  BOOST_CHECK( !reader.read_wait( value, 2000000 ) ) ;
+  BOOST_CHECK( !poller.read_wait( value, 2000000 ) ) ;
+
+  //
+  // A parked reader is woken by the writer.  Use a park timeout far longer 
+  // than the test so that only a wakeup ( not a timeout ) can complete it.
+  //
+  static const uint64_t Message_Count = 1000 ;
+  reader.set_wait_policy( 0, 10 * 1000000000ull ) ;
+
+  std::atomic<uint64_t> r_count( 0 ) ;
+  std::atomic<bool>     r_ordered( true ) ;
+  std::thread r_thread
+  ( [&]()
+    { uint64_t msg = 0 ;
+      for( uint64_t expected = 1 ; expected <= Message_Count ; ++expected ) 
+      { if( !reader.read_wait( msg, 5 * 1000000000ull ) ) 
+          break ;
+        if( msg != expected ) 
+          r_ordered = false ;
+        ++r_count ;
+      }
+    } 
+  ) ;
+
+  for( uint64_t seq = 1 ; seq <= Message_Count ; ++seq ) 
+  { if( seq % ( Test_Capacity / 4 ) == 1 ) 
+    { // Wait for the reader to drain the last burst and park again.
+      for( uint32_t idx = 0 ; idx < 1000 && ( r_count < seq - 1 || writer.waiter_count() == 0 ) ; ++idx ) 
+        std::this_thread::sleep_for( std::chrono::microseconds( 50 ) ) ;
+    }
+    writer.write( seq ) ;
+  }
+
+  r_thread.join() ;
+  BOOST_CHECK_MESSAGE
+  ( r_count == Message_Count 
+  , string::sprintf( "\n\tShmQueueReader::read_wait() returned %lu messages, expected %lu", r_count.load(), Message_Count )
+  ) ;
+  BOOST_CHECK( r_ordered ) ;
+  BOOST_CHECK( reader.lost_count() == 0 ) ;
+
+  //
+  // The poller sees the same messages ( minus those overwritten ).
+  //
+  BOOST_CHECK( poller.read_wait( value, 1000000 ) ) ;
+
+  poller.close() ;
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+// Fill 'buf' w/ a pattern derived from 'seq', of a length that varies w/ 'seq'.
+//--------------------------------------------------------------------------------
+static
+uint32_t
+make_record( uint64_t seq, char * buf )
+{
+  uint32_t length = 1 + static_cast<uint32_t>( ( seq * 37 ) % 300 ) ;
+  for( uint32_t idx = 0 ; idx < length ; ++idx )
+    buf[ idx ] = static_cast<char>( seq + idx ) ;
+  return length ;
+}
+
+//--------------------------------------------------------------------------------
+static
+bool
+check_record( uint64_t seq, const container::ByteRange & range )
+{
+  char     expected[ 512 ] ;
+  uint32_t length = make_record( seq, expected ) ;
+  return range.size() == length && std::memcmp( range.begin(), expected, length ) == 0 ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_byte_queue )
+{
+  std::cout << "[ ipc::swmr::ShmByteQueue unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  static const uint32_t Byte_Capacity = 4096 ;
+
+  ipc::swmr::ShmByteQueueWriter writer ;
+  ipc::swmr::ShmByteQueueReader reader ;
+  BOOST_CHECK( !writer.open( Test_Queue_Name, 1000 ) && writer.last_error() == EINVAL ) ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name, Byte_Capacity ), "\n\tShmByteQueueWriter::open() failed" ) ;
+  BOOST_REQUIRE_MESSAGE( reader.open( Test_Queue_Name ), "\n\tShmByteQueueReader::open() failed" ) ;
+  BOOST_CHECK( writer.capacity() == Byte_Capacity ) ;
+
+  container::ByteRange range ;
+  char                 buf[ 512 ] ;
+  BOOST_CHECK( !reader.read( range ) ) ;
+  BOOST_CHECK( !writer.write( buf, writer.max_length() + 1 ) ) ;
+
+  //
+  // Variable length records, read as they're written, across many laps of the
+  // ring so that padding records and wrap-around are exercised.
+  //
+  uint64_t seq = 1 ;
+  for( ; seq <= 1000 ; ++seq )
+  { uint32_t length = make_record( seq, buf ) ;
+    BOOST_REQUIRE( writer.write( buf, length ) ) ;
+    BOOST_REQUIRE( reader.read( range ) ) ;
+    BOOST_CHECK_MESSAGE
+    ( reader.sequence() == seq && check_record( seq, range ) && reader.intact()
+    , string::sprintf( "\n\tShmByteQueueReader::read() returned bad record ( seq %lu, expected %lu )", reader.sequence(), seq )
+    ) ;
+  }
+  BOOST_CHECK( !reader.read( range ) ) ;
+
+  //
+  // Zero copy writes and in-place reads.
+  //
+  char * dest = writer.claim( 64 ) ;
+  BOOST_REQUIRE( dest != NULL ) ;
+  std::memset( dest, 'x', 64 ) ;
+  BOOST_CHECK( writer.commit() ) ;
+
+  uint32_t x_count = 0 ;
+  BOOST_CHECK( reader.visit( [&]( const container::ByteRange & r ) { x_count = std::count( r.begin(), r.end(), 'x' ) ; } ) ) ;
+  BOOST_CHECK( x_count == 64 ) ;
+  ++seq ;
+
+  //
+  // Overrun : the writer laps a reader that is holding a record.  The reader
+  // must notice the held record is gone, resync and account for the loss.
+  //
+  uint64_t first = seq ;
+  for( ; seq < first + 10 ; ++seq )
+    writer.write( buf, make_record( seq, buf ) ) ;
+
+  BOOST_REQUIRE( reader.read( range ) && reader.sequence() == first ) ;
+  BOOST_CHECK( reader.intact() ) ;
+
+  for( ; seq < first + 200 ; ++seq )
+    writer.write( buf, make_record( seq, buf ) ) ;
+
+  BOOST_CHECK( !reader.intact() ) ;
+  BOOST_REQUIRE( reader.read( range ) ) ;
+  BOOST_CHECK_MESSAGE
+  ( reader.sequence() == seq - 1 && check_record( seq - 1, range )
+  , string::sprintf( "\n\tShmByteQueueReader::read() after overrun returned seq %lu, expected %lu", reader.sequence(), seq - 1 )
+  ) ;
+  BOOST_CHECK( reader.overrun_count() == 1 ) ;
+  BOOST_CHECK_MESSAGE
+  ( reader.lost_count() == ( seq - 1 ) - first - 1
+  , string::sprintf( "\n\tShmByteQueueReader::lost_count() is %lu, expected %lu", reader.lost_count(), ( seq - 1 ) - first - 1 )
+  ) ;
+  BOOST_CHECK( !reader.read( range ) ) ;
+
+  //
+  // A late reader starts at the newest record.
+  //
+  ipc::swmr::ShmByteQueueReader late_reader ;
+  BOOST_REQUIRE( late_reader.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( late_reader.read( range ) && late_reader.sequence() == seq - 1 ) ;
+  BOOST_CHECK( late_reader.lost_count() == 0 ) ;
+
+  late_reader.close() ;
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__header )
+{
+  std::cout << "[ ipc::swmr::QueueHeader unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  //
+  // Readers of the wrong element type, capacity or kind are refused.
+  //
+  writer_t writer ;
+  BOOST_REQUIRE_MESSAGE( writer.open( Test_Queue_Name ), "\n\tShmQueueWriter::open() failed" ) ;
+
+  ipc::swmr::ShmQueueReader<uint32_t, Test_Capacity>     bad_type ;
+  ipc::swmr::ShmQueueReader<uint64_t, Test_Capacity * 2> bad_capacity ;
+  ipc::swmr::ShmByteQueueReader                          bad_kind ;
+  BOOST_CHECK( !bad_type.open( Test_Queue_Name )     && bad_type.last_error()     == EINVAL ) ;
+  BOOST_CHECK( !bad_capacity.open( Test_Queue_Name ) && bad_capacity.last_error() == EINVAL ) ;
+  BOOST_CHECK( !bad_kind.open( Test_Queue_Name )     && bad_kind.last_error()     == EINVAL ) ;
+
+  reader_t reader ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+
+  //
+  // The probe reads any queue's header and write sequence.
+  //
+  for( uint64_t value = 1 ; value <= 10 ; ++value )
+    writer.write( value ) ;
+
+  ipc::swmr::ShmQueueProbe probe ;
+  BOOST_REQUIRE( probe.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( probe.kind()           == ipc::swmr::queue_kind::Fixed ) ;
+  BOOST_CHECK( probe.element_size()   == sizeof( uint64_t ) ) ;
+  BOOST_CHECK( probe.capacity()       == Test_Capacity ) ;
+  BOOST_CHECK( probe.type_hash()      == ipc::swmr::TypeHash<uint64_t>::value() ) ;
+  BOOST_CHECK( probe.write_sequence() == 10 ) ;
+  BOOST_CHECK( probe.writer_alive() ) ;
+
+  writer.write( 11 ) ;
+  BOOST_CHECK( probe.write_sequence() == 11 ) ;
+
+  writer.close() ;
+  BOOST_CHECK( !probe.writer_alive() ) ;
+  probe.close() ;
+  reader.close() ;
+  remove_test_queue() ;
+
+  //
+  // A segment the writer has created but not yet sized or initialized.
+  //
+  ipc::SharedMemory shm ;
+  BOOST_REQUIRE( shm.open( Test_Queue_Name, ipc::access::Read_Write | ipc::access::Create ) ) ;
+  BOOST_CHECK( !reader.open( Test_Queue_Name ) && reader.last_error() == EAGAIN ) ;
+
+  BOOST_REQUIRE( shm.resize( writer_t::segment_size() ) ) ;
+  BOOST_CHECK( !reader.open( Test_Queue_Name ) && reader.last_error() == EAGAIN ) ;
+  BOOST_CHECK( !probe.open( Test_Queue_Name )  && probe.last_error()  == EAGAIN ) ;
+
+  //
+  // Garbage.
+  //
+  ipc::MappedMemory shm_map ;
+  BOOST_REQUIRE( shm_map.open( shm, ipc::access::Read_Write ) ) ;
+  std::memset( shm_map.cast<char>(), 0x5a, shm_map.size() ) ;
+  BOOST_CHECK( !reader.open( Test_Queue_Name ) && reader.last_error() == EPROTO ) ;
+  BOOST_CHECK( !probe.open( Test_Queue_Name )  && probe.last_error()  == EPROTO ) ;
+
+  shm_map.close() ;
+  shm.close( true ) ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue__slot_alignment )
+{
+  std::cout << "[ ipc::swmr::ShmQueue slot alignment unit tests ]" << std::endl ;
+  remove_test_queue() ;
+
+  typedef ipc::opt::Slot_Alignment<system::cpu::Cache_Line_Size> line_t ;
+  typedef ipc::swmr::detail::RingBuffer<uint64_t, Test_Capacity>          packed_ring_t ;
+  typedef ipc::swmr::detail::RingBuffer<uint64_t, Test_Capacity, line_t>  padded_ring_t ;
+
+  BOOST_CHECK( packed_ring_t::Slot_Alignment == 0 ) ;
+  BOOST_CHECK( sizeof( packed_ring_t::slot_t ) < system::cpu::Cache_Line_Size ) ;
+  BOOST_CHECK( padded_ring_t::Slot_Alignment == system::cpu::Cache_Line_Size ) ;
+  BOOST_CHECK( sizeof( padded_ring_t::slot_t ) == system::cpu::Cache_Line_Size ) ;
+  BOOST_CHECK( alignof( padded_ring_t::slot_t ) == system::cpu::Cache_Line_Size ) ;
+
+  // Line pairs, and a slot that spans more than one line.
+  typedef ipc::opt::Slot_Alignment<2 * system::cpu::Cache_Line_Size> pair_t ;
+  typedef ipc::swmr::detail::RingBuffer<uint64_t, Test_Capacity, pair_t> pair_ring_t ;
+  typedef ipc::swmr::detail::RingBuffer<Snapshot, Test_Capacity, line_t> wide_ring_t ;
+  BOOST_CHECK( sizeof( pair_ring_t::slot_t ) == 2 * system::cpu::Cache_Line_Size ) ;
+  BOOST_CHECK( sizeof( wide_ring_t::slot_t ) % system::cpu::Cache_Line_Size == 0 ) ;
+
+  typedef ipc::swmr::ShmQueueWriter<uint64_t, Test_Capacity, ipc::telemetry::None, line_t>                         padded_writer_t ;
+  typedef ipc::swmr::ShmQueueReader<uint64_t, Test_Capacity, ipc::backoff::Default, ipc::telemetry::None, line_t> padded_reader_t ;
+  BOOST_CHECK( padded_writer_t::segment_size() > writer_t::segment_size() ) ;
+
+  padded_writer_t writer ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+
+  // Readers must be built w/ the writer's slot alignment.
+  reader_t packed_reader ;
+  BOOST_CHECK( !packed_reader.open( Test_Queue_Name ) && packed_reader.last_error() == EINVAL ) ;
+
+  padded_reader_t reader ;
+  BOOST_REQUIRE( reader.open( Test_Queue_Name ) ) ;
+
+  uint64_t value = 0 ;
+  for( uint64_t idx = 1 ; idx <= Test_Capacity * 2 + 3 ; ++idx )
+  { BOOST_CHECK( writer.write( idx ) ) ;
+    BOOST_CHECK( reader.read( value ) && value == idx ) ;
+  }
+  BOOST_CHECK( !reader.read( value ) ) ;
+
+  reader.close() ;
+  writer.close() ;
+  remove_test_queue() ;
+
+  // And the reverse.
+  writer_t packed_writer ;
+  BOOST_REQUIRE( packed_writer.open( Test_Queue_Name ) ) ;
+  BOOST_CHECK( !reader.open( Test_Queue_Name ) && reader.last_error() == EINVAL ) ;
+  packed_writer.close() ;
+  remove_test_queue() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -0,0 +1,349 @@
+#define BOOST_TEST_MODULE fps_ipc__swmr_shm_queue_journal
+
+#include "fps_ipc/swmr_shm_queue_journal.h"
+#include "fps_fs/path.h"
+#include "fps_time/clock.h"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace fps ;
+
+//--------------------------------------------------------------------------------
+static const char     Test_Queue_Name[]   = "fps_ipc.swmr_shm_queue_journal.unit_test" ;
+static const char     Test_Replay_Name[]  = "fps_ipc.swmr_shm_queue_journal.unit_test.replay" ;
+static const char     Test_Journal_Path[] = "/tmp/fps_ipc.swmr_shm_queue_journal.unit_test.journal" ;
+static const uint32_t Test_Capacity       = 64 ;
+
+//--------------------------------------------------------------------------------
+struct Message
+{
+  uint64_t value_ ;
+  uint64_t check_ ;   // ~value_
+  char     text_[ 20 ] ;
+} ;
+
+typedef ipc::swmr::ShmQueueWriter <Message, Test_Capacity> writer_t ;
+typedef ipc::swmr::ShmQueueReader <Message, Test_Capacity> reader_t ;
+typedef ipc::swmr::ShmQueueJournal<Message, Test_Capacity> journal_t ;
+typedef ipc::swmr::ShmQueueReplay <Message>                replay_t ;
+
+//--------------------------------------------------------------------------------
+static
+void
+remove_dangling_files()
+{
+  const std::string paths[] = { std::string( "/dev/shm/" ) + Test_Queue_Name
+                              , std::string( "/dev/shm/" ) + Test_Replay_Name
+                              , Test_Journal_Path
+                              , ipc::journal::index_path( Test_Journal_Path )
+                              } ;
+  for( const std::string & path : paths )
+  { fs::Path fs_path( path ) ;
+    if( fs_path.exists() )
+      fs_path.rm() ;
+  }
+}
+
+//--------------------------------------------------------------------------------
+static
+Message
+make_message( uint64_t value )
+{ Message rv = { value, ~value, "journal" } ;
+  return rv ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__journal__basics )
+{
+  std::cout << "[ ipc::journal unit tests ]" << std::endl ;
+  remove_dangling_files() ;
+
+  // Records of varying length, a chunk size small enough to force the file to
+  // grow several times, and a checkpoint every 4 records.
+  ipc::journal::Writer writer ;
+  BOOST_REQUIRE( writer.open( Test_Journal_Path, 0, 0, 4096, 4 ) ) ;
+
+  std::string payload ;
+  for( uint64_t seq = 1 ; seq <= 500 ; ++seq )
+  { payload.assign( seq % 37, static_cast<char>( 'a' + seq % 26 ) ) ;
+    BOOST_REQUIRE( writer.append( payload.data(), payload.size(), seq, seq * 1000 ) ) ;
+  }
+  BOOST_CHECK( writer.record_count() == 500 && writer.last_sequence() == 500 ) ;
+
+  // A reader can follow the journal while it's being written.
+  ipc::journal::Reader reader ;
+  BOOST_REQUIRE( reader.open( Test_Journal_Path ) ) ;
+  BOOST_CHECK( reader.committed_count() == 500 ) ;
+
+  uint64_t count   = 0 ;
+  bool     correct = true ;
+  while( const ipc::journal::RecordHeader * record = reader.next() )
+  { ++count ;
+    correct &= ( record->sequence_ == count && record->timestamp_ == count * 1000 ) ;
+    correct &= ( record->length() == count % 37 ) ;
+    correct &= ( record->length() == 0 || record->payload()[ 0 ] == static_cast<char>( 'a' + count % 26 ) ) ;
+  }
+  BOOST_CHECK( count == 500 && correct ) ;
+
+  // Records appended after the reader reached the end are picked up.
+  BOOST_CHECK( writer.append( "tail", 4, 501, 501000 ) ) ;
+  const ipc::journal::RecordHeader * record = reader.next() ;
+  BOOST_REQUIRE( record != NULL ) ;
+  BOOST_CHECK( record->sequence_ == 501 && std::string( record->payload(), 4 ) == "tail" ) ;
+  BOOST_CHECK( reader.next() == NULL ) ;
+
+  // Seeking uses the index.
+  reader.seek( 250 ) ;
+  record = reader.next() ;
+  BOOST_CHECK( record != NULL && record->sequence_ == 250 ) ;
+  reader.seek( 10000 ) ;
+  BOOST_CHECK( reader.next() == NULL ) ;
+  reader.rewind() ;
+  record = reader.next() ;
+  BOOST_CHECK( record != NULL && record->sequence_ == 1 ) ;
+
+  writer.close() ;
+  reader.close() ;
+
+  // Reopening appends after the last record; the header must match.
+  ipc::journal::Writer typed ;
+  BOOST_CHECK( !typed.open( Test_Journal_Path, sizeof( Message ) ) && typed.last_error() == EINVAL ) ;
+  BOOST_REQUIRE( writer.open( Test_Journal_Path, 0, 0, 4096, 4 ) ) ;
+  BOOST_CHECK( writer.record_count() == 501 && writer.last_sequence() == 501 ) ;
+
+  // A writer that dies between checkpoints loses nothing it finished appending.
+  writer.close() ;
+  pid_t pid = ::fork() ;
+  BOOST_REQUIRE( pid >= 0 ) ;
+  if( pid == 0 )
+  { ipc::journal::Writer child ;
+    if( !child.open( Test_Journal_Path, 0, 0, 4096, 4 ) )
+      ::_exit( 1 ) ;
+    for( uint64_t seq = 502 ; seq <= 511 ; ++seq )
+      child.append( "child", 5, seq, seq * 1000 ) ;
+    ::_exit( 0 ) ;
+  }
+  int status = 0 ;
+  BOOST_REQUIRE( ::waitpid( pid, &status, 0 ) == pid ) ;
+  BOOST_REQUIRE( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 ) ;
+
+  BOOST_REQUIRE( reader.open( Test_Journal_Path ) ) ;
+  BOOST_CHECK( reader.committed_count() == 509 ) ;
+
+  BOOST_REQUIRE( writer.open( Test_Journal_Path, 0, 0, 4096, 4 ) ) ;
+  BOOST_CHECK( writer.record_count() == 511 && writer.last_sequence() == 511 ) ;
+  BOOST_CHECK( writer.append( "after", 5, 512, 512000 ) ) ;
+  writer.close() ;
+
+  count = 0 ;
+  uint64_t last = 0 ;
+  while( ( record = reader.next() ) != NULL )
+  { ++count ;
+    last = record->sequence_ ;
+  }
+  BOOST_CHECK( count == 512 && last == 512 ) ;
+  reader.close() ;
+
+  // Not a journal.
+  BOOST_CHECK( !reader.open( ipc::journal::index_path( Test_Journal_Path ) ) && reader.last_error() == EPROTO ) ;
+
+  remove_dangling_files() ;
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue_journal__capture_and_replay )
+{
+  std::cout << "[ ipc::swmr::ShmQueueJournal/ShmQueueReplay unit tests ]" << std::endl ;
+  remove_dangling_files() ;
+
+  writer_t  writer ;
+  journal_t tee ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( tee.open( Test_Queue_Name, Test_Journal_Path ) ) ;
+  BOOST_CHECK( tee.poll() == 0 ) ;
+
+  for( uint64_t value = 1 ; value <= 50 ; ++value )
+    BOOST_CHECK( writer.write( make_message( value ) ) ) ;
+  BOOST_CHECK( tee.poll() == 50 ) ;
+
+  // Lap the journal : 200 messages through a 64 slot queue.
+  for( uint64_t value = 51 ; value <= 250 ; ++value )
+    BOOST_CHECK( writer.write( make_message( value ) ) ) ;
+  uint64_t captured = tee.poll() ;
+  BOOST_CHECK( captured > 0 && captured <= Test_Capacity ) ;
+  BOOST_CHECK( tee.lost_count() == 200 - captured ) ;
+  BOOST_CHECK( tee.record_count() == 50 + captured + 1 ) ;
+
+  // Spaced out batches, for timed replay.
+  for( uint64_t value = 251 ; value <= 260 ; ++value )
+  { BOOST_CHECK( writer.write( make_message( value ) ) ) ;
+    BOOST_CHECK( tee.poll() == 1 ) ;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) ) ;
+  }
+  tee.close() ;
+  writer.close() ;
+
+  // The journal holds T's and nothing else.
+  ipc::swmr::ShmQueueReplay<uint64_t> wrong_type ;
+  BOOST_CHECK( !wrong_type.open( Test_Journal_Path ) && wrong_type.last_error() == EINVAL ) ;
+
+  //
+  // Replay as fast as possible.
+  //
+  writer_t replay_writer ;
+  reader_t replay_reader ;
+  replay_t replay ;
+  BOOST_REQUIRE( replay_writer.open( Test_Replay_Name ) ) ;
+  BOOST_REQUIRE( replay_reader.open( Test_Replay_Name ) ) ;
+  BOOST_REQUIRE( replay.open( Test_Journal_Path ) ) ;
+
+  BOOST_CHECK( replay.replay( replay_writer, 0.0, 50 ) == 50 ) ;
+  Message  msg ;
+  uint64_t expected = 1 ;
+  bool     correct  = true ;
+  while( replay_reader.read( msg ) )
+    correct &= ( msg.value_ == expected++ && msg.check_ == ~msg.value_ ) ;
+  BOOST_CHECK( correct && expected == 51 ) ;
+
+  BOOST_CHECK( replay.replay( replay_writer, 0.0, captured ) == captured ) ;
+  BOOST_CHECK( replay.gap_count() == 200 - captured ) ;
+  expected = 251 - captured ;
+  while( replay_reader.read( msg ) )
+    correct &= ( msg.value_ == expected++ ) ;
+  BOOST_CHECK( correct && expected == 251 ) ;
+
+  //
+  // Replay the spaced out tail at double speed : 45ms of capture in ~22ms.
+  //
+  uint64_t begin = time::Clock::now() ;
+  BOOST_CHECK( replay.replay( replay_writer, 2.0 ) == 10 ) ;
+  uint64_t elapsed = time::Clock::now() - begin ;
+  BOOST_CHECK( elapsed >= 20 * time::Nanos_Per_Milli ) ;
+  BOOST_CHECK( elapsed <  45 * time::Nanos_Per_Milli ) ;
+  while( replay_reader.read( msg ) )
+    correct &= ( msg.value_ == expected++ ) ;
+  BOOST_CHECK( correct && expected == 261 ) ;
+
+  // Seek back into the middle of the journal.
+  replay.seek( 20 ) ;
+  BOOST_CHECK( replay.replay( replay_writer, 0.0, 1 ) == 1 ) ;
+  BOOST_CHECK( replay_reader.read( msg ) && msg.value_ == 20 ) ;
+
+  replay.close() ;
+  replay_reader.close() ;
+  replay_writer.close() ;
+  remove_dangling_files() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue_journal__writer_restart )
+{
+  std::cout << "[ ipc::swmr::ShmQueueJournal writer restart unit tests ]" << std::endl ;
+  remove_dangling_files() ;
+
+  // Two writer lifetimes appended to one journal.  The second starts its
+  // sequence numbers over, but the journal's keep increasing.
+  for( uint64_t lifetime = 0 ; lifetime < 2 ; ++lifetime )
+  { writer_t  writer ;
+    journal_t tee ;
+    BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+    BOOST_REQUIRE( tee.open( Test_Queue_Name, Test_Journal_Path, 0, ipc::journal::Default_Chunk_Size, 4 ) ) ;
+    for( uint64_t value = 1 ; value <= 10 ; ++value )
+      BOOST_CHECK( writer.write( make_message( lifetime * 10 + value ) ) ) ;
+    BOOST_CHECK( tee.poll() == 10 ) ;
+    BOOST_CHECK( tee.journal().last_sequence() == lifetime * 10 + 10 ) ;
+    tee.close() ;
+    writer.close() ;
+    fs::Path( std::string( "/dev/shm/" ) + Test_Queue_Name ).rm() ;
+  }
+
+  writer_t replay_writer ;
+  reader_t replay_reader ;
+  replay_t replay ;
+  BOOST_REQUIRE( replay_writer.open( Test_Replay_Name ) ) ;
+  BOOST_REQUIRE( replay_reader.open( Test_Replay_Name ) ) ;
+  BOOST_REQUIRE( replay.open( Test_Journal_Path ) ) ;
+
+  BOOST_CHECK( replay.replay( replay_writer, 0.0 ) == 20 ) ;
+  BOOST_CHECK( replay.gap_count() == 0 ) ;
+  Message  msg ;
+  uint64_t expected = 1 ;
+  bool     correct  = true ;
+  while( replay_reader.read( msg ) )
+    correct &= ( msg.value_ == expected++ ) ;
+  BOOST_CHECK( correct && expected == 21 ) ;
+
+  // Seeks land on the right record in either lifetime.
+  replay.seek( 15 ) ;
+  BOOST_CHECK( replay.replay( replay_writer, 0.0, 1 ) == 1 ) ;
+  BOOST_CHECK( replay_reader.read( msg ) && msg.value_ == 15 ) ;
+  replay.seek( 3 ) ;
+  BOOST_CHECK( replay.replay( replay_writer, 0.0, 1 ) == 1 ) ;
+  BOOST_CHECK( replay_reader.read( msg ) && msg.value_ == 3 ) ;
+
+  replay.close() ;
+  replay_reader.close() ;
+  replay_writer.close() ;
+  remove_dangling_files() ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__swmr_shm_queue_journal__concurrent )
+{
+  std::cout << "[ ipc::swmr::ShmQueueJournal concurrency unit tests ]" << std::endl ;
+  remove_dangling_files() ;
+
+  static const uint32_t Capacity = 4096 ;
+  static const uint64_t Count    = 200000 ;
+  ipc::swmr::ShmQueueWriter <Message, Capacity> writer ;
+  ipc::swmr::ShmQueueJournal<Message, Capacity> tee ;
+  BOOST_REQUIRE( writer.open( Test_Queue_Name ) ) ;
+  BOOST_REQUIRE( tee.open( Test_Queue_Name, Test_Journal_Path ) ) ;
+
+  std::atomic<bool> stop( false ) ;
+  uint64_t          captured = 0 ;
+  std::thread journal_thread( [&]() { captured = tee.run( stop ) ; } ) ;
+
+  // Paced so that the journal keeps up even on a single cpu.
+  for( uint64_t value = 1 ; value <= Count ; ++value )
+  { writer.write( make_message( value ) ) ;
+    if( value % 1024 == 0 )
+      std::this_thread::sleep_for( std::chrono::microseconds( 200 ) ) ;
+  }
+
+  stop.store( true, std::memory_order_release ) ;
+  journal_thread.join() ;
+  BOOST_CHECK( captured == Count ) ;
+  BOOST_CHECK( tee.lost_count() == 0 ) ;
+  tee.close() ;
+  writer.close() ;
+
+  ipc::journal::Reader reader ;
+  BOOST_REQUIRE( reader.open( Test_Journal_Path, sizeof( Message ) ) ) ;
+  BOOST_CHECK( reader.committed_count() == Count ) ;
+
+  uint64_t expected = 1 ;
+  bool     correct  = true ;
+  while( const ipc::journal::RecordHeader * record = reader.next() )
+  { Message msg ;
+    std::memcpy( &msg, record->payload(), sizeof( msg ) ) ;
+    correct &= ( record->sequence_ == expected && msg.value_ == expected ) ;
+    ++expected ;
+  }
+  BOOST_CHECK( correct && expected == Count + 1 ) ;
+  reader.close() ;
+
+  remove_dangling_files() ;
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
@@ -8,6 +8,8 @@
 #include <boost/test/unit_test.hpp>
 #include <thread>
 #include <iostream>
+#include <vector>
+#include <string>
 
 using namespace fps ;
 
@@ -152,3 +154,137 @@ BOOST_AUTO_TEST_CASE( fps_ipc__fifo )
   writer_thread.join() ;
 }
 
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__fifo__capacity )
+{
+  std::cout << "[ ipc::ThreadFifo<> capacity unit test ]" << std::endl ;
+
+  //
+  // Storage is rounded up to a power of two internally, but the requested 
+  // capacity must still be the limit.
+  //
+  const uint64_t capacities[] = { 1, 2, 5, 511, 512 } ;
+  for( uint64_t capacity : capacities ) 
+  { ipc::ThreadFifo<uint64_t> fifo( capacity ) ;
+    BOOST_REQUIRE( fifo.valid() && fifo.capacity() == capacity ) ;
+    BOOST_CHECK( !fifo.reserve( capacity ) ) ;
+
+    uint64_t next_write = 0 ;
+    uint64_t next_read  = 0 ;
+    uint64_t value      = 0 ;
+    for( uint32_t lap = 0 ; lap < 3 ; ++lap ) 
+    { while( fifo.write( next_write ) ) 
+        ++next_write ;
+      BOOST_CHECK_MESSAGE
+      ( fifo.size() == capacity 
+      , string::sprintf( "\n\tipc::ThreadFifo :: size() is %lu when full, expected %lu", fifo.size(), capacity ) 
+      ) ;
+
+      // Drain half, then refill, so that positions wrap at odd offsets.
+      for( uint64_t idx = 0 ; idx < ( capacity + 1 ) / 2 && fifo.read( value ) ; ++idx, ++next_read ) 
+        BOOST_CHECK( value == next_read ) ;
+    }
+
+    while( fifo.read( value ) ) 
+    { BOOST_CHECK( value == next_read ) ;
+      ++next_read ;
+    }
+    BOOST_CHECK( fifo.size() == 0 && next_read == next_write ) ;
+
+    BOOST_CHECK( fifo.clear() && !fifo.valid() ) ;
+    BOOST_CHECK( !fifo.write( value ) ) ;
+  }
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+// Counts live instances, so tests can tell when the fifo constructs and
+// destroys elements.
+//--------------------------------------------------------------------------------
+struct Tracked
+{
+  static int64_t live_ ;
+
+  std::string value_ ;
+
+  Tracked() { ++live_ ; }
+  Tracked( const std::string & value ) : value_( value ) { ++live_ ; }
+  Tracked( const Tracked & rhs ) : value_( rhs.value_ ) { ++live_ ; }
+  Tracked( Tracked && rhs ) : value_( std::move( rhs.value_ ) ) { ++live_ ; }
+  ~Tracked() { --live_ ; }
+
+  Tracked & operator=( const Tracked & rhs ) { value_ = rhs.value_ ; return *this ; }
+  Tracked & operator=( Tracked && rhs ) { value_ = std::move( rhs.value_ ) ; return *this ; }
+} ;
+
+int64_t Tracked::live_ = 0 ;
+
+//--------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( fps_ipc__fifo__move_and_bulk )
+{
+  std::cout << "[ ipc::ThreadFifo<> move & bulk unit test ]" << std::endl ;
+
+  {
+    //
+    // Storage is constructed lazily.
+    //
+    ipc::ThreadFifo<Tracked> fifo( 1000 ) ;
+    BOOST_CHECK_MESSAGE
+    ( Tracked::live_ == 0 
+    , string::sprintf( "\n\tipc::ThreadFifo :: reserve() constructed %ld elements", Tracked::live_ ) 
+    ) ;
+
+    //
+    // Move, copy and emplace writes.  Reads move the element out.
+    //
+    std::string long_value( 100, 'x' ) ;
+    Tracked     src( long_value ) ;
+    BOOST_CHECK( fifo.write( src ) && src.value_ == long_value ) ;
+    BOOST_CHECK( fifo.write( std::move( src ) ) && src.value_.empty() ) ;
+    BOOST_CHECK( fifo.emplace( long_value ) ) ;
+    BOOST_CHECK( fifo.size() == 3 && Tracked::live_ == 4 ) ;
+
+    Tracked dest ;
+    for( uint32_t idx = 0 ; idx < 3 ; ++idx ) 
+      BOOST_CHECK( fifo.read( dest ) && dest.value_ == long_value ) ;
+    BOOST_CHECK( !fifo.read( dest ) ) ;
+    BOOST_CHECK_MESSAGE
+    ( Tracked::live_ == 2 
+    , string::sprintf( "\n\tipc::ThreadFifo :: %ld live elements after draining, expected 2", Tracked::live_ ) 
+    ) ;
+
+    //
+    // Bulk transfers, across the wrap point and up against the capacity.
+    //
+    std::vector<Tracked> batch ;
+    for( uint32_t idx = 0 ; idx < 600 ; ++idx ) 
+      batch.emplace_back( std::to_string( idx ) ) ;
+
+    BOOST_CHECK( fifo.try_write_n( batch.data(), batch.size() ) == 600 ) ;
+    BOOST_CHECK( fifo.try_write_n( batch.data(), batch.size() ) == 400 ) ;
+    BOOST_CHECK( fifo.try_write_n( batch.data(), batch.size() ) == 0 ) ;
+    BOOST_CHECK( fifo.size() == 1000 ) ;
+
+    std::vector<Tracked> out( 700 ) ;
+    BOOST_CHECK( fifo.try_read_n( out.data(), out.size() ) == 700 ) ;
+    bool ordered = true ;
+    for( uint32_t idx = 0 ; idx < 700 ; ++idx ) 
+      ordered &= ( out[ idx ].value_ == std::to_string( idx % 600 ) ) ;
+    BOOST_CHECK( ordered ) ;
+
+    BOOST_CHECK( fifo.try_write_n( batch.data(), batch.size() ) == 600 ) ;
+    BOOST_CHECK( fifo.size() == 900 ) ;
+  }
+
+  //
+  // Elements still queued are destroyed w/ the fifo.
+  //
+  BOOST_CHECK_MESSAGE
+  ( Tracked::live_ == 0 
+  , string::sprintf( "\n\tipc::ThreadFifo :: %ld elements leaked", Tracked::live_ ) 
+  ) ;
+
+  std::cout << "|--[ Success ]" << std::endl << std::endl ;
+}
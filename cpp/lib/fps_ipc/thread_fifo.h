@@ -3,182 +3,122 @@
 
 #include <type_traits>
 #include <cstdlib>
+#include <utility>
 #include "fps_system/fps_system.h"
+#include "fps_ipc/spsc_ring_buffer.h"
+#include "fps_ipc/notifier.h"
 
 namespace fps {
 namespace ipc {
 
 //--------------------------------------------------------------------------------
-// TODO: Test the following
-// 
-//       Should each array slot occupy an entire cache line?
-//       (See: <system-hdrs>/adm-i386/cache.h - Macro: L1_CACHE_BYTES)
-//
+// Bounded single-producer/single-consumer fifo for passing values between two
+// threads.  See spsc::RingBuffer for the implementation.
 //--------------------------------------------------------------------------------
-template<typename T>
+template<typename T, typename T_Telemetry = telemetry::None>
 class ThreadFifo
 {
 public :
-  typedef T value_t ;
+  typedef T           value_t ;
+  typedef T_Telemetry telemetry_t ;
   static const std::size_t Alignment = system::cpu::Cache_Line_Size ;
 
 private :
   //------------------------------------------------------------------------------
-  // Note: The 'alignas' specifiers below guarantee that the size_, r_idx, and 
-  //       w_idx_ members will reside in distinct cache lines.
-  //------------------------------------------------------------------------------
-  uint64_t          capacity_ alignas( Alignment ) ;
-  volatile uint64_t size_     alignas( Alignment ) ;
-  uint64_t          r_idx_    alignas( Alignment ) ;
-  uint64_t          w_idx_    alignas( Alignment ) ;
-  T               * data_ ;
+  spsc::RingBuffer<T, T_Telemetry> impl_ ;
+  notify::EventFd                  notify_ ;
 
   ThreadFifo( const ThreadFifo & ) ;
   ThreadFifo & operator=( const ThreadFifo & ) ;
 
+  //------------------------------------------------------------------------------
+  template<typename T_Count>
+  inline
+  T_Count
+  notified( T_Count written )
+  { if( written )
+      notify_.notify() ;
+    return written ;
+  }
+
 public :
   //------------------------------------------------------------------------------
-  inline ThreadFifo() ;
-  inline ThreadFifo( uint64_t capacity ) ;
-  inline ~ThreadFifo() ;
+  inline ThreadFifo() {}
+  inline ThreadFifo( uint64_t capacity ) : impl_( capacity ) {}
+  inline ~ThreadFifo() {}
 
   //------------------------------------------------------------------------------
-  bool clear() ;
-  bool reserve( uint64_t capacity ) ;
+  inline bool clear()                    { return impl_.clear() ; }
+  inline bool reserve( uint64_t capacity ) { return impl_.reserve( capacity ) ; }
 
   //------------------------------------------------------------------------------
-  inline bool     valid()    const { return capacity_ > 0 ; }
-  inline uint64_t capacity() const { return capacity_ ; }
-  inline uint64_t size()     const { return size_ ; }
+  inline bool     valid()    const { return impl_.valid() ; }
+  inline uint64_t capacity() const { return impl_.capacity() ; }
+  inline uint64_t size()     const { return impl_.size() ; }
 
   //------------------------------------------------------------------------------
-  inline bool write( const T & value ) ;
-  inline bool read ( T & result ) ;
-} ;
+  // See spsc::RingBuffer::publish_telemetry().
+  //------------------------------------------------------------------------------
+  inline bool                publish_telemetry( const std::string & name ) { return impl_.publish_telemetry( name ) ; }
+  inline const T_Telemetry & telemetry() const                             { return impl_.telemetry() ; }
 
-//------------------------------------------------------------------------------
-template<typename T>
-ThreadFifo<T>::ThreadFifo() 
-  : capacity_( 0 ) 
-  , size_    ( 0 )
-  , r_idx_   ( 0 ) 
-  , w_idx_   ( 0 )
-  , data_    ( NULL )
-{}
-
-//------------------------------------------------------------------------------
-template<typename T>
-ThreadFifo<T>::ThreadFifo( uint64_t capacity ) 
-  : capacity_( 0 ) 
-  , size_    ( 0 )
-  , r_idx_   ( 0 ) 
-  , w_idx_   ( 0 )
-  , data_    ( NULL )
-{
-  reserve( capacity ) ;
-}
-
-//------------------------------------------------------------------------------
-template<typename T>
-ThreadFifo<T>::~ThreadFifo() 
-{ 
-  clear() ;
-}
-
-//------------------------------------------------------------------------------
-template<typename T>
-bool
-ThreadFifo<T>::clear()
-{
-  if( capacity_ == 0 || data_ == NULL ) 
+  //------------------------------------------------------------------------------
+  // Event loop support ( see notifier.h ).  Call enable_notify() before either
+  // thread starts; notify_fd() then becomes readable when the writer publishes
+  // to a fifo the reader had drained.  Reader thread only : prepare_wait() must
+  // be called before blocking on notify_fd(), and returns true if the fifo is
+  // still empty and the writer will signal the next element, or false if
+  // there's something to read ( or notification isn't enabled ).
+  //------------------------------------------------------------------------------
+  inline bool    enable_notify()   { return notify_.open() ; }
+  inline int32_t notify_fd() const { return notify_.fd() ; }
+
+  inline
+  bool
+  prepare_wait()
+  {
+    if( !notify_.is_open() )
+      return false ;
+
+    notify_.drain() ;
+    notify_.arm() ;
+    if( impl_.size() > 0 )
+    { notify_.disarm() ;
+      return false ;
+    }
     return true ;
+  }
 
-  for( uint32_t idx = 0 ; idx < capacity_ ; ++idx ) 
-    data_[ idx ].~T() ;
-  
-  free( data_ ) ;
-  data_     = NULL ;
-  size_     = 0 ;
-  capacity_ = 0 ;
-  w_idx_    = 0 ;
-  r_idx_    = 0 ;
-}
-
-//------------------------------------------------------------------------------
-template<typename T>
-bool
-ThreadFifo<T>::reserve( uint64_t capacity ) 
-{
-  if( valid() || size() > 0 ) 
-    return false ;
-
-  int32_t rv = ::posix_memalign( reinterpret_cast<void**>( &data_ )
-                               , Alignment
-                               , capacity * sizeof( T ) 
-                               ) ;
-  if( rv ) 
-    return false ;
-
-  capacity_ = capacity ;
-  for( uint32_t idx = 0 ; idx < capacity_ ; ++idx ) 
-    new ( &data_[ idx ] ) T() ;
-
-  w_idx_ = 0 ;
-  r_idx_ = 0 ;
-  size_  = 0 ;
-
-  return true ;
-}
-
-//------------------------------------------------------------------------------
-template<typename T>
-bool
-ThreadFifo<T>::write( const T & value ) 
-{ 
-  // Make sure the buffer isn't full
-  if( size_ == capacity_ ) 
-    return false ;
-
-  // Write data to buffer
-  data_[ w_idx_ ] = value ;
- 
-  // Increase fifo size by 1
-  ::__sync_fetch_and_add( &size_, 1 ) ; 
-
-  // Increment & normalize write index 
-  // TODO: Figure out how to ditch the conditional
-  if( w_idx_ == (capacity_-1) ) 
-    w_idx_ = 0 ;
-  else 
-    ++w_idx_ ;
-  
-  return true ;
-}
-
-//------------------------------------------------------------------------------
-template<typename T>
-bool
-ThreadFifo<T>::read( T & result ) 
-{
-  // Make sure there's something to read
-  if( size_ == 0 ) 
-    return false ;
-
-  // Read data element
-  result = data_[ r_idx_ ] ;
-  
-  // Reduce fifo size by 1
-  ::__sync_fetch_and_sub( &size_, 1 ) ;
-
-  // Increment & normalize read index 
-  // TODO: Figure out how to ditch the conditional
-  if( r_idx_ == (capacity_-1) ) 
-    r_idx_ = 0 ;
-  else 
-    ++r_idx_ ;
-
-  return true ;
-}
+  //------------------------------------------------------------------------------
+  // Writer thread only.  Each returns false if the fifo is full.
+  //------------------------------------------------------------------------------
+  inline bool write( const T & value ) { return notified( impl_.write( value ) ) ; }
+  inline bool write( T && value )      { return notified( impl_.write( std::move( value ) ) ) ; }
+
+  //------------------------------------------------------------------------------
+  template<typename... T_Args>
+  inline
+  bool
+  emplace( T_Args &&... args )
+  { return notified( impl_.emplace( std::forward<T_Args>( args )... ) ) ;
+  }
+
+  //------------------------------------------------------------------------------
+  // Copy up to 'count' elements from 'src' and publish them to the reader at
+  // once.  Returns the number written.
+  //------------------------------------------------------------------------------
+  inline uint64_t try_write_n( const T * src, uint64_t count ) { return notified( impl_.try_write_n( src, count ) ) ; }
+
+  //------------------------------------------------------------------------------
+  // Reader thread only.  Elements are moved out of the fifo.
+  //------------------------------------------------------------------------------
+  inline bool read ( T & result ) { return impl_.read( result ) ; }
+
+  //------------------------------------------------------------------------------
+  // Move up to 'max_count' elements into 'dest'.  Returns the number read.
+  //------------------------------------------------------------------------------
+  inline uint64_t try_read_n( T * dest, uint64_t max_count ) { return impl_.try_read_n( dest, max_count ) ; }
+} ;
 
 }}
 
@@ -0,0 +1,100 @@
+#ifndef FPS__IPC__TICKET_LOCK__H
+#define FPS__IPC__TICKET_LOCK__H
+
+#include <atomic>
+#include <cstdint>
+#include "fps_system/fps_system.h"
+#include "fps_ipc/backoff.h"
+
+namespace fps {
+namespace ipc {
+
+  //----------------------------------------------------------------------------
+  // FIFO spin lock.  Each locker takes a ticket from next_ and waits for
+  // serving_ to reach it, so the lock is granted in arrival order and no
+  // waiter can starve.  Waiters only read serving_, which is written once per
+  // hand-off, rather than retrying an atomic exchange on a shared word.
+  //
+  // Holds no pointers, so a TicketLock may be constructed inside a
+  // MappedMemory region ( see MappedMemory::construct ) and shared between
+  // processes.  T_Backoff controls how waiters spin ( see backoff.h ).
+  //----------------------------------------------------------------------------
+  template<typename T_Backoff = backoff::Default>
+  class BasicTicketLock
+  {
+  public :
+    typedef T_Backoff backoff_t ;
+
+  private :
+    static const std::size_t Alignment = system::cpu::Cache_Line_Size ;
+
+    std::atomic<uint32_t> next_    alignas( Alignment ) ;  // Next ticket to hand out.
+    std::atomic<uint32_t> serving_ alignas( Alignment ) ;  // Ticket that holds the lock.
+
+    BasicTicketLock( const BasicTicketLock & ) ;
+    BasicTicketLock & operator=( const BasicTicketLock & ) ;
+
+  public:
+    //--------------------------------------------------------------------------
+    inline
+    BasicTicketLock()
+      : next_   ( 0 )
+      , serving_( 0 )
+    {}
+
+    //--------------------------------------------------------------------------
+    // Only take a ticket if it would be served immediately.
+    //--------------------------------------------------------------------------
+    inline
+    bool
+    try_lock()
+    {
+      uint32_t ticket = serving_.load( std::memory_order_relaxed ) ;
+      return next_.compare_exchange_strong( ticket
+                                          , ticket + 1
+                                          , std::memory_order_acquire
+                                          , std::memory_order_relaxed
+                                          ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    inline
+    void
+    lock()
+    {
+      uint32_t ticket = next_.fetch_add( 1, std::memory_order_relaxed ) ;
+      for( uint32_t counter = 0
+         ; serving_.load( std::memory_order_acquire ) != ticket
+         ; ++counter
+         )
+      { T_Backoff::wait( counter ) ;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    // Only the holder writes serving_, so a plain increment is enough.
+    //--------------------------------------------------------------------------
+    inline
+    void
+    unlock()
+    {
+      serving_.store( serving_.load( std::memory_order_relaxed ) + 1, std::memory_order_release ) ;
+    }
+
+    //--------------------------------------------------------------------------
+    // Number of lockers holding or waiting for the lock ( approximate ).
+    //--------------------------------------------------------------------------
+    inline
+    uint32_t
+    queue_length() const
+    {
+      uint32_t serving = serving_.load( std::memory_order_acquire ) ;
+      return next_.load( std::memory_order_acquire ) - serving ;
+    }
+  } ;
+
+  typedef BasicTicketLock<> TicketLock ;
+
+}}
+
+#endif